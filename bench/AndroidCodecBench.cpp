@@ -12,12 +12,15 @@
 #include "src/core/SkOSFile.h"
 #include "tools/flags/CommandLineFlags.h"
 
-AndroidCodecBench::AndroidCodecBench(SkString baseName, SkData* encoded, int sampleSize)
+AndroidCodecBench::AndroidCodecBench(SkString baseName, SkData* encoded, int sampleSize,
+                                     bool resample)
     : fData(SkRef(encoded))
     , fSampleSize(sampleSize)
+    , fResample(resample)
 {
     // Parse filename and the color type to give the benchmark a useful name
-    fName.printf("AndroidCodec_%s_SampleSize%d", baseName.c_str(), sampleSize);
+    fName.printf("AndroidCodec_%s_%s%d", baseName.c_str(), resample ? "Resample" : "SampleSize",
+                 sampleSize);
 }
 
 const char* AndroidCodecBench::onGetName() {
@@ -44,6 +47,7 @@ void AndroidCodecBench::onDraw(int n, SkCanvas* canvas) {
     std::unique_ptr<SkAndroidCodec> codec;
     SkAndroidCodec::AndroidOptions options;
     options.fSampleSize = fSampleSize;
+    options.fResampleToDimensions = fResample;
     for (int i = 0; i < n; i++) {
         codec = SkAndroidCodec::MakeFromData(fData);
 #ifdef SK_DEBUG
@@ -20,8 +20,9 @@
  */
 class AndroidCodecBench : public Benchmark {
 public:
-    // Calls encoded->ref()
-    AndroidCodecBench(SkString basename, SkData* encoded, int sampleSize);
+    // Calls encoded->ref(). If resample is true, the image is filtered (rather than sampled)
+    // down to the dimensions that sampleSize would produce.
+    AndroidCodecBench(SkString basename, SkData* encoded, int sampleSize, bool resample = false);
 
 protected:
     const char* onGetName() override;
@@ -33,6 +34,7 @@ private:
     SkString                fName;
     sk_sp<SkData>           fData;
     const int               fSampleSize;
+    const bool              fResample;
     SkImageInfo             fInfo;          // Set in onDelayedSetup.
     SkAutoMalloc            fPixelStorage;  // Set in onDelayedSetup.
     using INHERITED = Benchmark;
@@ -19,19 +19,26 @@ enum Align {
 
 const char* gAlignName[] = { "left", "middle", "right" };
 
+extern bool gSkUseAccumulationAA;
+
 // Inspired by crbug.com/455429
 class BigPathBench : public Benchmark {
     SkPath      fPath;
     SkString    fName;
     Align       fAlign;
     bool        fRound;
+    bool        fAccum;
 
 public:
-    BigPathBench(Align align, bool round) : fAlign(align), fRound(round) {
+    BigPathBench(Align align, bool round, bool accum = false)
+            : fAlign(align), fRound(round), fAccum(accum) {
         fName.printf("bigpath_%s", gAlignName[fAlign]);
         if (round) {
             fName.append("_round");
         }
+        if (accum) {
+            fName.append("_accum");
+        }
     }
 
 protected:
@@ -67,9 +74,12 @@ protected:
                 break;
         }
 
+        const bool useAccumulationAA = gSkUseAccumulationAA;
+        gSkUseAccumulationAA |= fAccum;
         for (int i = 0; i < loops; i++) {
             canvas->drawPath(fPath, paint);
         }
+        gSkUseAccumulationAA = useAccumulationAA;
     }
 
 private:
@@ -83,3 +93,7 @@ DEF_BENCH( return new BigPathBench(kRight_Align,    false); )
 DEF_BENCH( return new BigPathBench(kLeft_Align,     true); )
 DEF_BENCH( return new BigPathBench(kMiddle_Align,   true); )
 DEF_BENCH( return new BigPathBench(kRight_Align,    true); )
+
+DEF_BENCH( return new BigPathBench(kLeft_Align,     false, true); )
+DEF_BENCH( return new BigPathBench(kMiddle_Align,   false, true); )
+DEF_BENCH( return new BigPathBench(kRight_Align,    false, true); )
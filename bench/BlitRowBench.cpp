@@ -0,0 +1,66 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "bench/Benchmark.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkString.h"
+#include "include/private/SkColorData.h"
+#include "src/base/SkRandom.h"
+#include "src/core/SkBlitRow.h"
+
+#include <cstdint>
+#include <vector>
+
+// Times the SkOpts blit rows directly, on long rows and on short spans where the tail matters.
+class BlitRowBench : public Benchmark {
+public:
+    enum Proc { kS32A_Opaque, kColor32 };
+
+    BlitRowBench(Proc proc, int width) : fProc(proc), fWidth(width) {
+        fName.printf("SkOpts::%s_%d",
+                     proc == kS32A_Opaque ? "blit_row_s32a_opaque" : "blit_row_color32", width);
+    }
+
+    bool isSuitableFor(Backend backend) override { return backend == Backend::kNonRendering; }
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        SkRandom rand;
+        fSrc.resize(fWidth);
+        fDst.resize(fWidth);
+        for (int i = 0; i < fWidth; i++) {
+            fSrc[i] = SkPreMultiplyColor(rand.nextU());
+            fDst[i] = SkPreMultiplyColor(rand.nextU());
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        // Keep the number of pixels blended per loop about the same for every width.
+        const int rows = 1024 / fWidth + 1;
+        const SkPMColor color = SkPreMultiplyColor(0x80FACE04);
+        while (loops --> 0) {
+            for (int y = 0; y < rows; y++) {
+                if (fProc == kS32A_Opaque) {
+                    SkOpts::blit_row_s32a_opaque(fDst.data(), fSrc.data(), fWidth, 0xFF);
+                } else {
+                    SkOpts::blit_row_color32(fDst.data(), fWidth, color);
+                }
+            }
+        }
+    }
+
+private:
+    Proc                   fProc;
+    int                    fWidth;
+    SkString               fName;
+    std::vector<SkPMColor> fSrc, fDst;
+};
+
+DEF_BENCH(return new BlitRowBench(BlitRowBench::kS32A_Opaque, 1023));
+DEF_BENCH(return new BlitRowBench(BlitRowBench::kS32A_Opaque,   13));
+DEF_BENCH(return new BlitRowBench(BlitRowBench::kColor32,     1023));
+DEF_BENCH(return new BlitRowBench(BlitRowBench::kColor32,       13));
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "bench/Benchmark.h"
+#include "include/codec/SkCodec.h"
+#include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkStream.h"
+#include "include/core/SkString.h"
+#include "src/core/SkOSFile.h"
+#include "src/utils/SkOSPath.h"
+#include "tools/Resources.h"
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/**
+ * Decodes every image in resources/images that SkCodec supports with SkCodecs::DecodeImages(),
+ * either on the calling thread or on a thread pool with one thread per core.
+ */
+class CodecBatchDecodeBench : public Benchmark {
+public:
+    explicit CodecBatchDecodeBench(bool threaded) : fThreaded(threaded) {
+        fName.printf("codec_batch_decode_%s", threaded ? "threaded" : "serial");
+    }
+
+    bool isSuitableFor(Backend backend) override { return Backend::kNonRendering == backend; }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        const SkString dir = GetResourcePath("images");
+        SkOSFile::Iter iter(dir.c_str());
+        SkString name;
+        while (iter.next(&name)) {
+            sk_sp<SkData> encoded =
+                    SkData::MakeFromFileName(SkOSPath::Join(dir.c_str(), name.c_str()).c_str());
+            if (encoded && SkCodec::MakeFromData(encoded)) {
+                fEncoded.push_back(std::move(encoded));
+            }
+        }
+        if (fThreaded) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool();
+            fMaxImagesInFlight = 2 * std::max(1, (int)std::thread::hardware_concurrency());
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        std::vector<SkCodecs::ImageDecodeRequest> requests(fEncoded.size());
+        for (int i = 0; i < loops; i++) {
+            for (size_t j = 0; j < fEncoded.size(); j++) {
+                requests[j].fStream = SkMemoryStream::Make(fEncoded[j]);
+            }
+            SkCodecs::DecodeImages(requests, fExecutor.get(), fMaxImagesInFlight,
+                                   [](size_t, sk_sp<SkImage>, SkCodec::Result) {});
+        }
+    }
+
+private:
+    const bool                  fThreaded;
+    SkString                    fName;
+    std::vector<sk_sp<SkData>>  fEncoded;
+    std::unique_ptr<SkExecutor> fExecutor;
+    int                         fMaxImagesInFlight = 1;
+};
+
+DEF_BENCH(return new CodecBatchDecodeBench(false));
+DEF_BENCH(return new CodecBatchDecodeBench(true));
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "bench/Benchmark.h"
+#include "include/codec/SkCodec.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkStream.h"
+#include "include/core/SkString.h"
+#include "src/utils/SkOSPath.h"
+#include "tools/Resources.h"
+
+#include <memory>
+
+/**
+ * Decodes an image straight from its file, either through SkStream::MakeFromFile(), which maps
+ * the file into memory so that the codec can read it in place, or through an SkFILEStream,
+ * which the codec copies out of in chunks.
+ */
+class CodecFileBench : public Benchmark {
+public:
+    CodecFileBench(const char* name, bool mapped)
+            : fPath(SkOSPath::Join(GetResourcePath("images").c_str(), name)), fMapped(mapped) {
+        fName.printf("codec_file_%s_%s", mapped ? "mapped" : "buffered", name);
+    }
+
+    bool isSuitableFor(Backend backend) override { return Backend::kNonRendering == backend; }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        std::unique_ptr<SkCodec> codec = SkCodec::MakeFromStream(this->openFile());
+        if (codec) {
+            fBitmap.allocPixels(codec->getInfo().makeColorType(kN32_SkColorType)
+                                               .makeAlphaType(kPremul_SkAlphaType));
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; i++) {
+            std::unique_ptr<SkCodec> codec = SkCodec::MakeFromStream(this->openFile());
+            if (codec) {
+                codec->getPixels(fBitmap.pixmap());
+            }
+        }
+    }
+
+private:
+    std::unique_ptr<SkStream> openFile() const {
+        if (fMapped) {
+            return SkStream::MakeFromFile(fPath.c_str());
+        }
+        return std::make_unique<SkFILEStream>(fPath.c_str());
+    }
+
+    const SkString fPath;
+    const bool     fMapped;
+    SkString       fName;
+    SkBitmap       fBitmap;
+};
+
+DEF_BENCH(return new CodecFileBench("mandrill_512.png", true));
+DEF_BENCH(return new CodecFileBench("mandrill_512.png", false));
+DEF_BENCH(return new CodecFileBench("mandrill_512_q075.jpg", true));
+DEF_BENCH(return new CodecFileBench("mandrill_512_q075.jpg", false));
@@ -7,6 +7,7 @@
 
 #include "bench/Benchmark.h"
 #include "include/core/SkBitmap.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkStream.h"
 #include "include/encode/SkJpegEncoder.h"
 #include "include/encode/SkPngEncoder.h"
@@ -58,6 +59,19 @@ static bool encode_jpeg(SkWStream* dst, const SkPixmap& src) {
     return SkJpegEncoder::Encode(dst, src, opts);
 }
 
+// Encodes stripes of rows on a thread pool with |threads| threads, or one per core if 0.
+static bool encode_jpeg_threaded(SkWStream* dst, const SkPixmap& src, int threads) {
+    static SkExecutor* gExecutors[5] = {};
+    SkExecutor*& executor = gExecutors[threads];
+    if (!executor) {
+        executor = SkExecutor::MakeFIFOThreadPool(threads).release();
+    }
+    SkJpegEncoder::Options opts;
+    opts.fQuality = 90;
+    opts.fExecutor = executor;
+    return SkJpegEncoder::Encode(dst, src, opts);
+}
+
 static bool encode_webp_lossy(SkWStream* dst, const SkPixmap& src) {
     SkWebpEncoder::Options opts;
     opts.fCompression = SkWebpEncoder::Compression::kLossy;
@@ -82,15 +96,38 @@ static bool encode_png(SkWStream* dst,
     return SkPngEncoder::Encode(dst, src, opts);
 }
 
+// Filters and deflates stripes of rows on a thread pool, one thread per core.
+static bool encode_png_threaded(SkWStream* dst, const SkPixmap& src, int zlibLevel) {
+    static SkExecutor* gExecutor = SkExecutor::MakeFIFOThreadPool().release();
+    SkPngEncoder::Options opts;
+    opts.fZLibLevel = zlibLevel;
+    opts.fExecutor = gExecutor;
+    return SkPngEncoder::Encode(dst, src, opts);
+}
+
 #define PNG(FLAG, ZLIBLEVEL) [](SkWStream* d, const SkPixmap& s) { \
            return encode_png(d, s, SkPngEncoder::FilterFlag::FLAG, ZLIBLEVEL); }
 
+#define JPEG_MT(THREADS) [](SkWStream* d, const SkPixmap& s) { \
+           return encode_jpeg_threaded(d, s, THREADS); }
+
+#define PNG_MT(ZLIBLEVEL) [](SkWStream* d, const SkPixmap& s) { \
+           return encode_png_threaded(d, s, ZLIBLEVEL); }
+
 static const char* srcs[2] = {"images/mandrill_512.png", "images/color_wheel.jpg"};
 
 // The Android Photos app uses a quality of 90 on JPEG encodes
 DEF_BENCH(return new EncodeBench(srcs[0], &encode_jpeg, "JPEG"));
 DEF_BENCH(return new EncodeBench(srcs[1], &encode_jpeg, "JPEG"));
 
+// Large enough to be split into several stripes, to show how the encode scales with threads.
+static const char* kLargeSrc = "images/mandrill_1600.png";
+DEF_BENCH(return new EncodeBench(kLargeSrc, &encode_jpeg, "JPEG"));
+DEF_BENCH(return new EncodeBench(kLargeSrc, JPEG_MT(1), "JPEG_mt1"));
+DEF_BENCH(return new EncodeBench(kLargeSrc, JPEG_MT(2), "JPEG_mt2"));
+DEF_BENCH(return new EncodeBench(kLargeSrc, JPEG_MT(4), "JPEG_mt4"));
+DEF_BENCH(return new EncodeBench(kLargeSrc, JPEG_MT(0), "JPEG_mt"));
+
 // TODO: What is the appropriate quality to use to benchmark WEBP encodes?
 DEF_BENCH(return new EncodeBench(srcs[0], encode_webp_lossy, "WEBP"));
 DEF_BENCH(return new EncodeBench(srcs[1], encode_webp_lossy, "WEBP"));
@@ -122,4 +159,11 @@ DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 6), "PNG_6n"));
 DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 3), "PNG_3n"));
 DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 1), "PNG_1n"));
 
+DEF_BENCH(return new EncodeBench(srcs[0], PNG_MT(6), "PNG_mt"));
+DEF_BENCH(return new EncodeBench(srcs[0], PNG_MT(1), "PNG_1_mt"));
+DEF_BENCH(return new EncodeBench(srcs[1], PNG_MT(6), "PNG_mt"));
+DEF_BENCH(return new EncodeBench(srcs[1], PNG_MT(1), "PNG_1_mt"));
+
+#undef PNG_MT
+#undef JPEG_MT
 #undef PNG
@@ -6,7 +6,12 @@
  */
 
 #include "bench/Benchmark.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkString.h"
 #include "src/core/SkResourceCache.h"
+#include "src/core/SkTaskGroup.h"
+
+#include <memory>
 
 namespace {
 static void* gGlobalAddress;
@@ -72,6 +77,57 @@ private:
     using INHERITED = Benchmark;
 };
 
+// Finds recs in the global cache from several threads at once, the way threads drawing the same
+// images do, to measure how much they contend for the cache.
+class ImageCacheThreadedBench : public Benchmark {
+    enum {
+        CACHE_COUNT = 500
+    };
+    const int fThreads;
+    SkString fName;
+    std::unique_ptr<SkExecutor> fExecutor;
+
+public:
+    explicit ImageCacheThreadedBench(int threads) : fThreads(threads) {
+        fName.printf("imagecache_threads_%d", threads);
+    }
+
+protected:
+    bool isSuitableFor(Backend backend) override {
+        return backend == Backend::kNonRendering;
+    }
+
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    void onDelayedSetup() override {
+        fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        // Anything else using the global cache may have purged our recs, so add them each time.
+        for (int i = 0; i < CACHE_COUNT; ++i) {
+            SkResourceCache::Add(new TestRec(TestKey(i), i));
+        }
+
+        SkTaskGroup tg(*fExecutor);
+        tg.batch(fThreads, [loops](int thread) {
+            for (int i = 0; i < loops; ++i) {
+                TestKey key((thread * 31 + i) % CACHE_COUNT);
+                (void)SkResourceCache::Find(key, TestRec::Visitor, nullptr);
+            }
+        });
+        tg.wait();
+    }
+
+private:
+    using INHERITED = Benchmark;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 DEF_BENCH( return new ImageCacheBench(); )
+DEF_BENCH( return new ImageCacheThreadedBench(1); )
+DEF_BENCH( return new ImageCacheThreadedBench(4); )
+DEF_BENCH( return new ImageCacheThreadedBench(8); )
@@ -8,22 +8,30 @@
 #include "bench/Benchmark.h"
 #include "include/core/SkBitmap.h"
 #include "include/core/SkColorSpace.h"
+#include "include/core/SkExecutor.h"
 #include "src/core/SkMipmap.h"
 
+#include <memory>
+
 class MipmapBench: public Benchmark {
     SkBitmap fBitmap;
     SkString fName;
     const int fW, fH;
     bool fHalfFoat;
+    bool fThreaded;
+    std::unique_ptr<SkExecutor> fExecutor;
 
 public:
-    MipmapBench(int w, int h, bool halfFloat = false)
-        : fW(w), fH(h), fHalfFoat(halfFloat)
+    MipmapBench(int w, int h, bool halfFloat = false, bool threaded = false)
+        : fW(w), fH(h), fHalfFoat(halfFloat), fThreaded(threaded)
     {
         fName.printf("mipmap_build_%dx%d", w, h);
         if (halfFloat) {
             fName.append("_f16");
         }
+        if (threaded) {
+            fName.append("_threaded");
+        }
     }
 
 protected:
@@ -39,11 +47,14 @@ protected:
                                              SkColorSpace::MakeSRGB());
         fBitmap.allocPixels(info);
         fBitmap.eraseColor(SK_ColorWHITE);  // so we don't read uninitialized memory
+        if (fThreaded) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool();
+        }
     }
 
     void onDraw(int loops, SkCanvas*) override {
         for (int i = 0; i < loops * 4; i++) {
-            SkMipmap::Build(fBitmap, nullptr)->unref();
+            SkMipmap::Build(fBitmap, nullptr, fExecutor.get())->unref();
         }
     }
 
@@ -66,3 +77,10 @@ DEF_BENCH( return new MipmapBench(2048, 2048); )
 DEF_BENCH( return new MipmapBench(2047, 2047); )
 DEF_BENCH( return new MipmapBench(2048, 2047); )
 DEF_BENCH( return new MipmapBench(2047, 2048); )
+
+// Large images, as uploaded from decoded photos, built on one thread and split across a pool.
+DEF_BENCH( return new MipmapBench(8192, 8192); )
+DEF_BENCH( return new MipmapBench(8191, 8191); )
+DEF_BENCH( return new MipmapBench(8192, 8192, false, true); )
+DEF_BENCH( return new MipmapBench(8191, 8191, false, true); )
+DEF_BENCH( return new MipmapBench(4096, 4096, true, true); )
@@ -24,15 +24,20 @@
 
 using namespace skia_private;
 
+extern bool gSkUseAccumulationAA;
+
 enum Flags {
     kStroke_Flag = 1 << 0,
-    kBig_Flag    = 1 << 1
+    kBig_Flag    = 1 << 1,
+    kAccum_Flag  = 1 << 2,  // Scan convert with accumulation rather than analytic AA.
 };
 
 #define FLAGS00  Flags(0)
 #define FLAGS01  Flags(kStroke_Flag)
 #define FLAGS10  Flags(kBig_Flag)
 #define FLAGS11  Flags(kStroke_Flag | kBig_Flag)
+#define FLAGS00_ACCUM  Flags(kAccum_Flag)
+#define FLAGS10_ACCUM  Flags(kBig_Flag | kAccum_Flag)
 
 class PathBench : public Benchmark {
     SkPaint     fPaint;
@@ -56,6 +61,9 @@ protected:
                      fFlags & kStroke_Flag ? "stroke" : "fill",
                      fFlags & kBig_Flag ? "big" : "small");
         this->appendName(&fName);
+        if (fFlags & kAccum_Flag) {
+            fName.append("_accum");
+        }
         return fName.c_str();
     }
 
@@ -70,9 +78,12 @@ protected:
             path.transform(m);
         }
 
+        const bool useAccumulationAA = gSkUseAccumulationAA;
+        gSkUseAccumulationAA |= SkToBool(fFlags & kAccum_Flag);
         for (int i = 0; i < loops; i++) {
             canvas->drawPath(path, paint);
         }
+        gSkUseAccumulationAA = useAccumulationAA;
     }
 
 private:
@@ -303,6 +314,29 @@ private:
     using INHERITED = PathBench;
 };
 
+// Many short segments, like the outlines of a map or a dense chart.
+class ComplexPathBench : public PathBench {
+public:
+    ComplexPathBench(Flags flags) : INHERITED(flags) {}
+
+    void appendName(SkString* name) override {
+        name->append("complex");
+    }
+    void makePath(SkPath* path) override {
+        SkRandom rand;
+        constexpr int kSegments = 20000;
+        for (int i = 0; i < kSegments; i++) {
+            const float angle = i * 2 * SK_ScalarPI / kSegments;
+            const float radius = 20 + 3 * sinf(angle * 97) + rand.nextRangeF(0, 2);
+            path->lineTo(32 + radius * cosf(angle), 24 + radius * sinf(angle));
+        }
+        path->close();
+    }
+    int complexity() override { return 2; }
+private:
+    using INHERITED = PathBench;
+};
+
 class RandomPathBench : public Benchmark {
 public:
     bool isSuitableFor(Backend backend) override {
@@ -1198,6 +1232,18 @@ DEF_BENCH( return new LongCurvedPathBench(FLAGS00); )
 DEF_BENCH( return new LongCurvedPathBench(FLAGS01); )
 DEF_BENCH( return new LongLinePathBench(FLAGS00); )
 DEF_BENCH( return new LongLinePathBench(FLAGS01); )
+DEF_BENCH( return new ComplexPathBench(FLAGS00); )
+DEF_BENCH( return new ComplexPathBench(FLAGS10); )
+
+DEF_BENCH( return new CirclePathBench(FLAGS00_ACCUM); )
+DEF_BENCH( return new CirclePathBench(FLAGS10_ACCUM); )
+DEF_BENCH( return new AAAConcavePathBench(FLAGS10_ACCUM); )
+DEF_BENCH( return new AAAConvexPathBench(FLAGS10_ACCUM); )
+DEF_BENCH( return new SawToothPathBench(FLAGS00_ACCUM); )
+DEF_BENCH( return new LongCurvedPathBench(FLAGS00_ACCUM); )
+DEF_BENCH( return new LongLinePathBench(FLAGS00_ACCUM); )
+DEF_BENCH( return new ComplexPathBench(FLAGS00_ACCUM); )
+DEF_BENCH( return new ComplexPathBench(FLAGS10_ACCUM); )
 
 DEF_BENCH( return new PathCreateBench(); )
 DEF_BENCH( return new PathCopyBench(); )
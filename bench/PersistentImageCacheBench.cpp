@@ -0,0 +1,105 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "bench/Benchmark.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkData.h"
+#include "include/core/SkGraphics.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkPersistentImageCache.h"
+#include "include/core/SkString.h"
+#include "include/private/base/SkMutex.h"
+#include "src/core/SkTHash.h"
+#include "tools/Resources.h"
+
+#include <utility>
+#include <vector>
+
+namespace {
+// Holds entries in memory, standing in for a directory whose files are already in the page cache.
+class MemoryImageCache final : public SkPersistentImageCache {
+public:
+    sk_sp<SkData> load(const SkData& key) override {
+        SkAutoMutexExclusive lock(fMutex);
+        sk_sp<SkData>* data = fEntries.find(ToString(key));
+        return data ? *data : nullptr;
+    }
+
+    void store(const SkData& key, const SkData& data) override {
+        SkAutoMutexExclusive lock(fMutex);
+        fEntries.set(ToString(key), SkData::MakeWithCopy(data.data(), data.size()));
+    }
+
+private:
+    static SkString ToString(const SkData& key) {
+        return SkString(static_cast<const char*>(key.data()), key.size());
+    }
+
+    SkMutex fMutex;
+    skia_private::THashMap<SkString, sk_sp<SkData>> fEntries;
+};
+}  // namespace
+
+/**
+ * Reads the pixels of a few images through new lazy images each loop, the way a new process
+ * would, either without a persistent image cache (cold) or with one that already holds their
+ * pixels (warm).
+ */
+class PersistentImageCacheBench : public Benchmark {
+public:
+    explicit PersistentImageCacheBench(bool warm) : fWarm(warm) {
+        fName.printf("persistent_image_cache_%s", warm ? "warm" : "cold");
+    }
+
+    bool isSuitableFor(Backend backend) override { return Backend::kNonRendering == backend; }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        for (const char* path : {"images/mandrill_512.png", "images/mandrill_512_q075.jpg",
+                                 "images/yellow_rose.png", "images/color_wheel.jpg"}) {
+            if (sk_sp<SkData> encoded = GetResourceAsData(path)) {
+                fEncoded.push_back(std::move(encoded));
+            }
+        }
+        fBitmaps.resize(fEncoded.size());
+        for (size_t i = 0; i < fEncoded.size(); i++) {
+            fBitmaps[i].allocPixels(SkImages::DeferredFromEncodedData(fEncoded[i])->imageInfo());
+        }
+
+        if (fWarm) {
+            fCache = sk_make_sp<MemoryImageCache>();
+            this->readAll(SkImage::kAllow_CachingHint);
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; i++) {
+            this->readAll(SkImage::kDisallow_CachingHint);
+        }
+    }
+
+private:
+    void readAll(SkImage::CachingHint hint) {
+        sk_sp<SkPersistentImageCache> previous = SkGraphics::SetPersistentImageCache(fCache);
+        for (size_t i = 0; i < fEncoded.size(); i++) {
+            sk_sp<SkImage> image = SkImages::DeferredFromEncodedData(fEncoded[i]);
+            image->readPixels(nullptr, fBitmaps[i].pixmap(), 0, 0, hint);
+        }
+        SkGraphics::SetPersistentImageCache(std::move(previous));
+    }
+
+    const bool                    fWarm;
+    SkString                      fName;
+    std::vector<sk_sp<SkData>>    fEncoded;
+    std::vector<SkBitmap>         fBitmaps;
+    sk_sp<SkPersistentImageCache> fCache;
+};
+
+DEF_BENCH(return new PersistentImageCacheBench(false));
+DEF_BENCH(return new PersistentImageCacheBench(true));
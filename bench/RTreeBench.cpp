@@ -12,6 +12,8 @@
 #include "src/base/SkRandom.h"
 #include "src/core/SkRTree.h"
 
+#include <vector>
+
 using namespace skia_private;
 
 // confine rectangles to a smallish area, so queries generally hit something, and overlap occurs:
@@ -19,6 +21,9 @@ static const SkScalar GENERATE_EXTENTS = 1000.0f;
 static const int NUM_BUILD_RECTS = 500;
 static const int NUM_QUERY_RECTS = 5000;
 static const int GRID_WIDTH = 100;
+// the tiled query benches cover a larger area, split into tiles like a tiled playback would:
+static const SkScalar TILED_EXTENTS = 4000.0f;
+static const SkScalar TILE_SIZE = 256.0f;
 
 typedef SkRect (*MakeRectProc)(SkRandom&, int, int);
 
@@ -97,6 +102,63 @@ private:
     using INHERITED = Benchmark;
 };
 
+// Time how long it takes to find the ops touching each tile of a large canvas, as a tiled
+// playback of a big picture would.
+class RTreeTiledQueryBench : public Benchmark {
+public:
+    RTreeTiledQueryBench(int numRects, bool batch) : fNumRects(numRects), fBatch(batch) {
+        fName.printf("rtree_tiled_%d_%s", numRects, batch ? "batch" : "single");
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == Backend::kNonRendering;
+    }
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+    void onDelayedSetup() override {
+        // Ops laid out in rows, in drawing order, like the content of a long page.
+        static constexpr int kOpsPerRow = 400;
+        const SkScalar rowHeight = TILED_EXTENTS / (fNumRects / kOpsPerRow);
+        SkRandom rand;
+        AutoTArray<SkRect> rects(fNumRects);
+        for (int i = 0; i < fNumRects; ++i) {
+            rects[i] = SkRect::MakeXYWH((i % kOpsPerRow) * (TILED_EXTENTS / kOpsPerRow),
+                                        (i / kOpsPerRow) * rowHeight,
+                                        1 + rand.nextRangeF(0, 40),
+                                        1 + rand.nextRangeF(0, 40));
+        }
+        fTree.insert(rects.data(), fNumRects);
+
+        for (SkScalar y = 0; y < TILED_EXTENTS; y += TILE_SIZE) {
+            for (SkScalar x = 0; x < TILED_EXTENTS; x += TILE_SIZE) {
+                fTiles.push_back(SkRect::MakeXYWH(x, y, TILE_SIZE, TILE_SIZE).makeOutset(1, 1));
+            }
+        }
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        for (int i = 0; i < loops; ++i) {
+            std::vector<std::vector<int>> hits(fTiles.size());
+            if (fBatch) {
+                fTree.search(fTiles.data(), (int)fTiles.size(), hits.data());
+            } else {
+                for (size_t t = 0; t < fTiles.size(); ++t) {
+                    fTree.search(fTiles[t], &hits[t]);
+                }
+            }
+        }
+    }
+private:
+    SkRTree fTree;
+    std::vector<SkRect> fTiles;
+    int fNumRects;
+    bool fBatch;
+    SkString fName;
+    using INHERITED = Benchmark;
+};
+
 static inline SkRect make_XYordered_rects(SkRandom& rand, int index, int numRects) {
     SkRect out;
     out.fLeft   = SkIntToScalar(index % GRID_WIDTH);
@@ -138,3 +200,6 @@ DEF_BENCH(return new RTreeQueryBench("XY", &make_XYordered_rects));
 DEF_BENCH(return new RTreeQueryBench("YX", &make_YXordered_rects));
 DEF_BENCH(return new RTreeQueryBench("random", &make_random_rects));
 DEF_BENCH(return new RTreeQueryBench("concentric", &make_concentric_rects));
+
+DEF_BENCH(return new RTreeTiledQueryBench(100000, false));
+DEF_BENCH(return new RTreeTiledQueryBench(100000, true));
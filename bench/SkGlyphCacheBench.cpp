@@ -10,6 +10,7 @@
 #include "bench/Benchmark.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColorSpace.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFontMgr.h"
 #include "include/core/SkGraphics.h"
 #include "include/core/SkTypeface.h"
@@ -22,6 +23,9 @@
 #include "tools/fonts/FontToolUtils.h"
 #include "tools/text/SkTextBlobTrace.h"
 
+#include <memory>
+#include <vector>
+
 using namespace skia_private;
 
 static void do_font_stuff(SkFont* font) {
@@ -117,10 +121,65 @@ private:
     SkString fName;
 };
 
+// Looks up already cached strikes from several threads at once, which is mostly a measure of
+// contention on the strike cache.
+class SkGlyphCacheThreaded : public Benchmark {
+public:
+    explicit SkGlyphCacheThreaded(int threads) : fThreads(threads) { }
+
+protected:
+    const char* onGetName() override {
+        fName.printf("SkGlyphCacheThreaded%d", fThreads);
+        return fName.c_str();
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == Backend::kNonRendering;
+    }
+
+    void onDelayedSetup() override {
+        fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+        SkFont font = ToolUtils::DefaultFont();
+        font.setEdging(SkFont::Edging::kAntiAlias);
+        font.setTypeface(ToolUtils::CreatePortableTypeface("serif", SkFontStyle::Italic()));
+        for (SkScalar size = 8; size < 8 + kStrikeCount; size++) {
+            font.setSize(size);
+            fStrikeSpecs.push_back(SkStrikeSpec::MakeMask(
+                    font, SkPaint(), SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                    SkScalerContextFlags::kNone, SkMatrix::I()));
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkTaskGroup tg(*fExecutor);
+        tg.batch(fThreads, [&](int threadIndex) {
+            for (int work = 0; work < loops; work++) {
+                for (int i = 0; i < kStrikeCount; i++) {
+                    const SkStrikeSpec& spec = fStrikeSpecs[(i + threadIndex) % kStrikeCount];
+                    (void)spec.findOrCreateStrike();
+                }
+            }
+        });
+        tg.wait();
+    }
+
+private:
+    static constexpr int kStrikeCount = 32;
+
+    using INHERITED = Benchmark;
+    const int fThreads;
+    std::unique_ptr<SkExecutor> fExecutor;
+    std::vector<SkStrikeSpec> fStrikeSpecs;
+    SkString fName;
+};
+
 DEF_BENCH( return new SkGlyphCacheBasic(256 * 1024); )
 DEF_BENCH( return new SkGlyphCacheBasic(32 * 1024 * 1024); )
 DEF_BENCH( return new SkGlyphCacheStressTest(256 * 1024); )
 DEF_BENCH( return new SkGlyphCacheStressTest(32 * 1024 * 1024); )
+DEF_BENCH( return new SkGlyphCacheThreaded(1); )
+DEF_BENCH( return new SkGlyphCacheThreaded(4); )
+DEF_BENCH( return new SkGlyphCacheThreaded(8); )
 
 namespace {
 class DiscardableManager : public SkStrikeServer::DiscardableHandleManager,
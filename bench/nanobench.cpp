@@ -28,8 +28,10 @@
 #include "include/core/SkBBHFactory.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkGraphics.h"
 #include "include/core/SkPictureRecorder.h"
+#include "include/core/SkPixmap.h"
 #include "include/core/SkString.h"
 #include "include/core/SkSurface.h"
 #include "include/encode/SkPngEncoder.h"
@@ -86,6 +88,7 @@
 
 extern bool gSkForceRasterPipelineBlitter;
 extern bool gForceHighPrecisionRasterPipeline;
+extern bool gSkUseAccumulationAA;
 
 #ifndef SK_BUILD_FOR_WIN
 #include <unistd.h>
@@ -158,6 +161,7 @@ static DEFINE_string(benchType,  "",
 
 static DEFINE_bool(forceRasterPipeline, false, "sets gSkForceRasterPipelineBlitter");
 static DEFINE_bool(forceRasterPipelineHP, false, "sets gSkForceRasterPipelineBlitter and gForceHighPrecisionRasterPipeline");
+static DEFINE_bool(accumulationAA, false, "sets gSkUseAccumulationAA");
 
 static DEFINE_bool2(pre_log, p, false,
                     "Log before running each test. May be incomprehensible when threading");
@@ -241,6 +245,35 @@ bool Target::capturePixels(SkBitmap* bmp) {
     return true;
 }
 
+// Draws to an SkSurfaces::RasterThreaded() surface, which records the bench's draws and plays
+// them back in parallel tiles on the default executor (see --threads) when we flush it.
+struct ThreadedRasterTarget : public Target {
+    explicit ThreadedRasterTarget(const Config& c) : Target(c) {}
+
+    void endTiming() override { this->flush(); }
+    void submitWorkAndSyncCPU() override { this->flush(); }
+
+    bool init(SkImageInfo info, Benchmark*) override {
+        this->surface = SkSurfaces::RasterThreaded(info, &SkExecutor::GetDefault());
+        return this->surface != nullptr;
+    }
+
+    bool capturePixels(SkBitmap* bmp) override {
+        bmp->allocPixels(this->surface->imageInfo());
+        if (!this->surface->readPixels(*bmp, 0, 0)) {
+            SkDebugf("Can't read surface pixels.\n");
+            return false;
+        }
+        return true;
+    }
+
+private:
+    void flush() {
+        SkPixmap unused;
+        this->surface->peekPixels(&unused);
+    }
+};
+
 struct GPUTarget : public Target {
     explicit GPUTarget(const Config& c) : Target(c) {}
     ContextInfo contextInfo;
@@ -679,6 +712,8 @@ static std::optional<Config> create_config(const SkCommandLineConfig* config) {
     CPU_CONFIG("f16",   Backend::kRaster,   kRGBA_F16_SkColorType, kPremul_SkAlphaType)
     CPU_CONFIG("srgba", Backend::kRaster, kSRGBA_8888_SkColorType, kPremul_SkAlphaType)
 
+    CPU_CONFIG("8888threaded", Backend::kRaster, kN32_SkColorType, kPremul_SkAlphaType)
+
 #undef CPU_CONFIG
 
     SkDebugf("Unknown config '%s'.\n", config->getTag().c_str());
@@ -731,7 +766,11 @@ static Target* is_enabled(Benchmark* bench, const Config& config) {
         break;
 #endif
     default:
-        target = new Target(config);
+        if (config.name.equals("8888threaded")) {
+            target = new ThreadedRasterTarget(config);
+        } else {
+            target = new Target(config);
+        }
         break;
     }
 
@@ -1129,7 +1168,13 @@ public:
         }
 
         // Run AndroidCodecBenches
-        const int sampleSizes[] = { 2, 4, 8 };
+        // Sampling is compared with filtering down to the same dimensions.
+        const struct {
+            int  sampleSize;
+            bool resample;
+        } androidCodecModes[] = {
+            {2, false}, {4, false}, {8, false}, {2, true}, {3, true}, {4, true}, {8, true},
+        };
         for (; fCurrentAndroidCodec < fImages.size(); fCurrentAndroidCodec++) {
             fSourceType = "image";
             fBenchType = "skandroidcodec";
@@ -1146,16 +1191,17 @@ public:
                 continue;
             }
 
-            while (fCurrentSampleSize < (int) std::size(sampleSizes)) {
-                int sampleSize = sampleSizes[fCurrentSampleSize];
+            while (fCurrentSampleSize < (int) std::size(androidCodecModes)) {
+                const int sampleSize = androidCodecModes[fCurrentSampleSize].sampleSize;
+                const bool resample = androidCodecModes[fCurrentSampleSize].resample;
                 fCurrentSampleSize++;
                 if (10 * sampleSize > std::min(codec->getInfo().width(), codec->getInfo().height())) {
                     // Avoid benchmarking scaled decodes of already small images.
-                    break;
+                    continue;
                 }
 
                 return new AndroidCodecBench(SkOSPath::Basename(path.c_str()),
-                                             encoded.get(), sampleSize);
+                                             encoded.get(), sampleSize, resample);
             }
             fCurrentSampleSize = 0;
         }
@@ -1447,6 +1493,7 @@ int main(int argc, char** argv) {
 
     gSkForceRasterPipelineBlitter     = FLAGS_forceRasterPipelineHP || FLAGS_forceRasterPipeline;
     gForceHighPrecisionRasterPipeline = FLAGS_forceRasterPipelineHP;
+    gSkUseAccumulationAA              = FLAGS_accumulationAA;
 
     // The SkSL memory benchmark must run before any GPU painting occurs. SkSL allocates memory for
     // its modules the first time they are accessed, and this test is trying to measure the size of
@@ -14,7 +14,10 @@
 #include "include/core/SkMatrix.h"
 #include "include/core/SkRect.h"
 
+#include <memory>
+
 class SkAndroidCodec;
+class SkExecutor;
 class SkImage;
 class SkPicture;
 
@@ -110,6 +113,21 @@ public:
      */
     int getFrameCount() const { return fFrameCount; }
 
+    /**
+     *  Decode upcoming frames ahead of time on the executor's threads, so that
+     *  decodeNextFrame() usually only has to pick up a finished frame.
+     *
+     *  Up to maxCachedFrames frames following the current one are kept. Frames
+     *  that don't depend on earlier frames start new chains of dependent frames,
+     *  and separate chains are decoded in parallel, each with its own codec.
+     *
+     *  Pass a null executor to go back to decoding each frame in
+     *  decodeNextFrame(). Returns false, and leaves decoding ahead off, if the
+     *  image isn't animated or its encoded data can't be shared with more
+     *  codecs. The executor must outlive this image, or the next call to this.
+     */
+    bool setDecodeAhead(SkExecutor* executor, int maxCachedFrames);
+
 protected:
     SkRect onGetBounds() override;
     void onDraw(SkCanvas*) override;
@@ -153,12 +171,20 @@ private:
     int                             fRepetitionCount;
     int                             fRepetitionsCompleted;
 
+    class DecodeAhead;
+    std::unique_ptr<DecodeAhead>    fDecodeAhead;
+
     SkAnimatedImage(std::unique_ptr<SkAndroidCodec>, const SkImageInfo& requestedInfo,
             SkIRect cropRect, sk_sp<SkPicture> postProcess);
 
     int computeNextFrame(int current, bool* animationEnded);
     double finish();
 
+    /**
+     *  If decoding ahead, queue the frames that follow fDisplayFrame.
+     */
+    void scheduleDecodeAhead();
+
     /**
      *  True if there is no crop, orientation, or post decoding scaling.
      */
@@ -206,6 +206,7 @@ public:
         AndroidOptions()
             : SkCodec::Options()
             , fSampleSize(1)
+            , fResampleToDimensions(false)
         {}
 
         /**
@@ -216,6 +217,26 @@ public:
          *  The default is 1, representing no downscaling.
          */
         int fSampleSize;
+
+        /**
+         *  If true, the info passed to getAndroidPixels() may have any dimensions
+         *  that are no larger than the image (or fSubset), and fSampleSize is
+         *  ignored. The codec downscales natively as far as it can without going
+         *  below those dimensions, then filters the rest of the way (with a
+         *  Mitchell filter) as rows are decoded, so the full resolution image is
+         *  never held in memory. Color space conversion is done on the filtered
+         *  pixels.
+         *
+         *  GIF, WebP and DNG/RAW images, and AVIF images with a dedicated decoder,
+         *  are not filtered this way: the info is passed straight to their own
+         *  scaling. WebP scales to arbitrary dimensions, but GIF and DNG/RAW
+         *  return kInvalidScale for any dimensions other than those reported by
+         *  getSampledDimensions(). Only the first frame of an animated image can
+         *  be decoded this way.
+         *
+         *  The default is false.
+         */
+        bool fResampleToDimensions;
     };
 
     /**
@@ -30,6 +30,7 @@
 #include <vector>
 
 class SkData;
+class SkExecutor;
 class SkFrameHolder;
 class SkImage;
 class SkPngChunkReader;
@@ -324,14 +325,16 @@ public:
             , fSubset(nullptr)
             , fFrameIndex(0)
             , fPriorFrame(kNoFrame)
+            , fExecutor(nullptr)
         {}
 
         ZeroInitialized            fZeroInitialized;
         /**
          *  If not NULL, represents a subset of the original image to decode.
          *  Must be within the bounds returned by getInfo().
-         *  If the EncodedFormat is SkEncodedImageFormat::kWEBP (the only one which
-         *  currently supports subsets), the top and left values must be even.
+         *  If the EncodedFormat is SkEncodedImageFormat::kWEBP, the top and left
+         *  values must be even. JPEGs support unscaled subsets in getPixels if they
+         *  have suitable restart markers (see getValidSubset()).
          *
          *  In getPixels and incremental decode, we will attempt to decode the
          *  exact rectangular subset specified by fSubset.
@@ -367,6 +370,16 @@ public:
          *  If set to kNoFrame, the codec will decode any necessary required frame(s) first.
          */
         int                        fPriorFrame;
+
+        /**
+         *  If not NULL, getPixels may use this to decode independent parts of the image
+         *  concurrently. It still returns only once the whole decode has finished.
+         *
+         *  Currently only used for JPEGs with restart markers, whose bands of rows can be
+         *  decoded separately (which also lets them decode a subset without decoding the
+         *  rows above it).
+         */
+        SkExecutor*                fExecutor;
     };
 
     /**
@@ -1080,6 +1093,38 @@ void SK_API Register(Decoder d);
  */
 SK_API sk_sp<SkImage> DeferredImage(std::unique_ptr<SkCodec> codec,
                                     std::optional<SkAlphaType> alphaType = std::nullopt);
+
+struct SK_API ImageDecodeRequest {
+    // The encoded image, e.g. an SkFILEStream, or an SkMemoryStream for data already in memory.
+    std::unique_ptr<SkStream> fStream;
+
+    // The info to decode to, as with SkCodec::getImage(info). If the color type is unknown, the
+    // codec's own info is used instead, adjusted for its origin, as with SkCodec::getImage().
+    SkImageInfo fInfo;
+};
+
+using ImageDecodeCallback = std::function<void(size_t index, sk_sp<SkImage>, SkCodec::Result)>;
+
+/**
+ *  Decodes each of the requests into an SkImage, passing it to the callback along with its index
+ *  in requests as soon as it's done, or nullptr and the reason it failed. Images may complete in
+ *  any order. Returns once the callback has been called for every request.
+ *
+ *  If executor is non-null, reading each stream and parsing its header is one task and decoding
+ *  it is another, so the executor's threads overlap reading some images with decoding others.
+ *  The callback may then be called from any of those threads, but never from two at once.
+ *  Otherwise the images are decoded one at a time on the calling thread.
+ *
+ *  A stream that isn't already in memory is copied into memory when it's read, so at most
+ *  maxImagesInFlight images (at least 1) are read but not yet decoded at once. About twice the
+ *  executor's thread count keeps its threads busy. It's ignored if executor is null.
+ *
+ *  The streams are consumed.
+ */
+SK_API void DecodeImages(SkSpan<ImageDecodeRequest> requests,
+                         SkExecutor* executor,
+                         int maxImagesInFlight,
+                         const ImageDecodeCallback& callback);
 }
 
 #endif // SkCodec_DEFINED
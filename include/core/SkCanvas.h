@@ -2493,6 +2493,7 @@ private:
     friend class SkPictureRecord;   // predrawNotify (why does it need it? <reed>)
     friend class SkOverdrawCanvas;
     friend class SkRasterHandleAllocator;
+    friend class SkRecorder;        // predrawNotify() when recording for a threaded raster surface
     friend class SkRecords::Draw;
     template <typename Key>
     friend class SkTestCanvas;
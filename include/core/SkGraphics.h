@@ -18,6 +18,7 @@
 class SkData;
 class SkImageGenerator;
 class SkOpenTypeSVGDecoder;
+class SkPersistentImageCache;
 class SkTraceMemoryDump;
 
 class SK_API SkGraphics {
@@ -140,6 +141,16 @@ public:
      */
     static void PurgeAllCaches();
 
+    /**
+     *  Sets a cache of decoded pixels that can persist between processes. Lazily decoded images
+     *  that Skia's codecs decode from encoded data look for their pixels in it before decoding
+     *  them, and add them to it after. See SkPersistentImageCache.
+     *
+     *  Pass nullptr to stop using a persistent cache (the default). Returns the previous cache.
+     */
+    static sk_sp<SkPersistentImageCache> SetPersistentImageCache(sk_sp<SkPersistentImageCache>);
+    static sk_sp<SkPersistentImageCache> GetPersistentImageCache();
+
     typedef std::unique_ptr<SkImageGenerator>
                                             (*ImageGeneratorFromEncodedDataFactory)(sk_sp<SkData>);
 
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkPersistentImageCache_DEFINED
+#define SkPersistentImageCache_DEFINED
+
+#include "include/core/SkRefCnt.h"
+#include "include/private/base/SkAPI.h"
+
+#include <cstddef>
+
+class SkData;
+
+/**
+ *  A cache of decoded pixels that can outlive the process, installed with
+ *  SkGraphics::SetPersistentImageCache(). Lazily decoded images made by
+ *  SkImages::DeferredFromEncodedData() or SkCodecs::DeferredImage() look for their pixels here
+ *  before decoding, and store them here after decoding. Images whose generator comes from
+ *  SkGraphics::SetImageGeneratorFromEncodedDataFactory(), or from
+ *  SkImages::DeferredFromGenerator(), don't use the cache, since they may decode the same data
+ *  differently.
+ *
+ *  Keys and values are opaque to the cache. Keys are derived from a hash of the encoded data and
+ *  the image's SkImageInfo. A value is a small header followed by the pixels, which are used in
+ *  place, so load() should return data that maps the stored bytes (e.g. with
+ *  SkData::MakeFromFileName()) rather than a copy.
+ *
+ *  load() and store() may be called from several threads at once.
+ */
+class SK_API SkPersistentImageCache : public SkRefCnt {
+public:
+    /**
+     *  Returns the data stored for the key, or nullptr if there is none.
+     */
+    virtual sk_sp<SkData> load(const SkData& key) = 0;
+
+    /**
+     *  Stores data for the key, replacing anything already stored for it.
+     */
+    virtual void store(const SkData& key, const SkData& data) = 0;
+
+    /**
+     *  Returns a cache that keeps each entry in a file in the directory at path, which must
+     *  already exist. Entries are memory-mapped when they're loaded. Once the entries add up to
+     *  more than byteLimit bytes, the least recently used ones are deleted.
+     *
+     *  Entries left in the directory by an earlier process are picked up. Several processes can
+     *  share a directory, but each only counts the entries it knows about against its limit.
+     *  Where a file can't be deleted while it's mapped (e.g. on Windows), deleting it is
+     *  retried on later loads and stores.
+     */
+    static sk_sp<SkPersistentImageCache> MakeDirectory(const char path[], size_t byteLimit);
+};
+
+#endif
@@ -87,6 +87,30 @@ public:
     static sk_sp<SkPicture> MakeFromData(const void* data, size_t size,
                                          const SkDeserialProcs* procs = nullptr);
 
+    /** Recreates SkPicture that was serialized into data, like MakeFromData(), but only reads
+        the header up front. The drawing commands and resources are decoded the first time the
+        picture is played back, so opening a large SKP costs about as much as reading its cull
+        rect. Parsing is deferred, not partial: the first playback decodes the whole picture,
+        even if it only draws part of it, and then holds all of it. Pictures that were
+        serialized with a custom procs->fPictureProc are decoded immediately.
+
+        approximateOpCount() of the returned picture is only an estimate from the size of data,
+        since counting the ops would mean decoding them.
+
+        The returned SkPicture keeps a ref on data, which may wrap a memory mapped file, e.g.
+        from SkData::MakeFromFileName(); it is released once the picture has been decoded.
+        procs, and any context they point to, must remain valid until then.
+
+        Returns nullptr if data does not start with a valid header. If the rest of data turns
+        out to be invalid, the picture draws nothing.
+
+        @param data   container for serial data
+        @param procs  custom serial data decoders; may be nullptr
+        @return       SkPicture that decodes data on first playback
+    */
+    static sk_sp<SkPicture> MakeLazyFromData(sk_sp<SkData> data,
+                                             const SkDeserialProcs* procs = nullptr);
+
     /** \class SkPicture::AbortCallback
         AbortCallback is an abstract class. An implementation of AbortCallback may
         passed as a parameter to SkPicture::playback, to stop it before all drawing
@@ -252,6 +276,7 @@ private:
     SkPicture();
     friend class SkBigPicture;
     friend class SkEmptyPicture;
+    friend class SkLazyPicture;
     friend class SkPicturePriv;
 
     void serialize(SkWStream*, const SkSerialProcs*, class SkRefCntSet* typefaces,
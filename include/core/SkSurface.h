@@ -30,6 +30,7 @@ class SkBitmap;
 class SkCanvas;
 class SkCapabilities;
 class SkColorSpace;
+class SkExecutor;
 class SkPaint;
 class SkSurface;
 struct SkIRect;
@@ -82,6 +83,32 @@ inline sk_sp<SkSurface> Raster(const SkImageInfo& imageInfo,
     return Raster(imageInfo, 0, props);
 }
 
+/** Allocates raster SkSurface whose rasterization is spread across the threads of executor.
+
+    Draws issued to the SkCanvas returned by SkSurface are recorded rather than drawn
+    immediately. They are played back in parallel, into disjoint tiles of the pixels, the next
+    time the pixels are needed: by makeImageSnapshot(), peekPixels(), readPixels(),
+    writePixels() or draw(). Pixel memory is zeroed before use and deleted when SkSurface is
+    deleted.
+
+    The SkCanvas itself has no pixels: read them back through SkSurface, not SkCanvas.
+    As with Raster(), contents drawn into a saveLayer() that is still open don't appear in
+    the pixels until the layer is restored.
+    Each tile is rasterized with its own clip, so antialiased edges may differ slightly from
+    the same draws made to a Raster() surface.
+
+    @param imageInfo     width, height, SkColorType, SkAlphaType, SkColorSpace,
+                         of raster surface; width and height must be greater than zero
+    @param executor      runs tile playback; must outlive SkSurface. If nullptr,
+                         this is equivalent to Raster().
+    @param surfaceProps  LCD striping orientation and setting for device independent fonts;
+                         may be nullptr
+    @return              SkSurface if parameters are valid and memory was allocated, else nullptr.
+*/
+SK_API sk_sp<SkSurface> RasterThreaded(const SkImageInfo& imageInfo,
+                                       SkExecutor* executor,
+                                       const SkSurfaceProps* surfaceProps = nullptr);
+
 /** Allocates raster SkSurface. SkCanvas returned by SkSurface draws directly into the
     provided pixels.
 
@@ -171,10 +171,43 @@ struct Metadata {
     */
     SkExecutor* fExecutor = nullptr;
 
+    /** If true, and fExecutor is set, pages are drawn into the PDF on fExecutor,
+        several at a time. beginPage() then returns a canvas that records the
+        page, and the recording is drawn into the PDF after endPage(). To record
+        pages concurrently too, record them with SkPictureRecorders on other
+        threads and draw each SkPicture onto its page canvas.
+
+        A page only waits for the pages before it when it needs a font, image,
+        shader or other object that they might make first, so objects are
+        numbered the same as if the pages had been drawn one at a time (apart
+        from the soft masks and color profiles that image encoding adds).
+        Tagged documents and pages with named destinations wait more often.
+
+        Experimental.
+    */
+    bool fConcurrentPages = false;
+
+    /** If true, each page is written to the stream when it ends, instead of
+        being kept in memory until the document is closed, and with fExecutor
+        set only a few streams wait to be compressed at a time. The document
+        then holds on to the objects that later pages might share (like fonts)
+        and a few bytes per page, so very long documents can be written in
+        bounded memory.
+
+        Pages are grouped in the page tree as they are written, which changes
+        the numbering of objects.
+    */
+    bool fStreaming = false;
+
     /** PDF streams may be compressed to save space.
         Use this to specify the desired compression vs time tradeoff.
+
+        Fastest uses Skia's own Deflate encoder, which is faster than
+        LowButFast (several times faster on images) and compresses about as
+        well.
     */
     enum class CompressionLevel : int {
+        Fastest = -2,
         Default = -1,
         None = 0,
         LowButFast = 1,
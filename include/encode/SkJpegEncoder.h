@@ -16,6 +16,7 @@
 class SkColorSpace;
 class SkData;
 class SkEncoder;
+class SkExecutor;
 class SkPixmap;
 class SkWStream;
 class SkImage;
@@ -86,6 +87,20 @@ struct Options {
      */
     const skcms_ICCProfile* fICCProfile = nullptr;
     const char* fICCProfileDescription = nullptr;
+
+    /**
+     *  If set, rows are split into stripes that are encoded in parallel on this executor,
+     *  then stitched together into a single baseline jpeg.  Every row of MCUs is a restart
+     *  interval, so the stripes can be joined at restart markers, and the stripes share the
+     *  standard Huffman tables instead of ones optimized for the image.  The output decodes
+     *  to the same pixels as a serial encode, but is typically a few percent larger (more for
+     *  images with large flat areas).  Images that fit in one stripe are encoded serially.
+     *
+     *  Each call to SkEncoder::encodeRows() encodes the whole stripes that it completes, so
+     *  encode many rows at a time to benefit.  This is ignored when encoding SkYUVAPixmaps.
+     *  The executor must outlive the encoder.
+     */
+    SkExecutor* fExecutor = nullptr;
 };
 
 /**
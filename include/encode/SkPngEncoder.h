@@ -19,6 +19,7 @@
 
 class GrDirectContext;
 class SkData;
+class SkExecutor;
 class SkImage;
 class SkPixmap;
 class SkWStream;
@@ -80,6 +81,17 @@ struct Options {
      */
     const skcms_ICCProfile* fICCProfile = nullptr;
     const char* fICCProfileDescription = nullptr;
+
+    /**
+     *  If set, rows are split into stripes that are filtered and compressed in parallel on
+     *  this executor, then stitched together into a single zlib stream.  The output is a
+     *  standard png that decodes to the same pixels, but is typically a little larger than
+     *  a serial encode at the same fZLibLevel, and is not byte-for-byte identical to it.
+     *
+     *  Each call to SkEncoder::encodeRows() is parallelized separately, so encode many rows
+     *  at a time to benefit.  The executor must outlive the encoder.
+     */
+    SkExecutor* fExecutor = nullptr;
 };
 
 /**
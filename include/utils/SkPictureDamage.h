@@ -0,0 +1,49 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+#ifndef SkPictureDamage_DEFINED
+#define SkPictureDamage_DEFINED
+
+#include "include/core/SkRegion.h"
+#include "include/core/SkTypes.h"
+
+class SkCanvas;
+class SkPicture;
+
+/**
+ * Utilities for redrawing only the parts of a frame that changed between two recordings of it.
+ *
+ * A typical client records a new SkPicture each frame, calls Compute() with the previous frame's
+ * picture, and then calls Playback() to draw the new picture over the old frame's pixels.
+ */
+class SK_API SkPictureDamage {
+public:
+    /**
+     * Compares the ops of two pictures and returns the area, in the pictures' coordinate space,
+     * whose pixels may differ between drawing 'before' and drawing 'after'.
+     *
+     * The comparison is conservative: ops that can't be cheaply compared (e.g. drawables or
+     * meshes) are always treated as changed, and a picture that was not recorded by
+     * SkPictureRecorder damages its whole cull rect. A null picture is treated as empty.
+     */
+    static SkRegion Compute(const SkPicture* before, const SkPicture* after);
+
+    /**
+     * Draws 'picture' to 'canvas', clipped to 'damage' (in the picture's coordinate space).
+     * Pictures recorded with an SkBBHFactory only play back the ops that intersect the damage.
+     *
+     * If 'clearDamage' is true, the damaged area is first cleared to transparent, so that the
+     * picture is drawn as if onto a new, empty frame. Callers that draw the picture over other
+     * content (e.g. a background they redraw into the damage themselves) should pass false.
+     *
+     * If the canvas holds the pixels of the picture passed as 'before' to Compute(), and 'damage'
+     * is the result of that call, the canvas ends up as if 'picture' had been drawn in full.
+     */
+    static void Playback(const SkPicture* picture, const SkRegion& damage, SkCanvas* canvas,
+                         bool clearDamage = true);
+};
+
+#endif
@@ -77,6 +77,7 @@ SKIA_PUBLIC_HDRS = [
     "include/core/SkPathMeasure.h",
     "include/core/SkPathTypes.h",
     "include/core/SkPathUtils.h",
+    "include/core/SkPersistentImageCache.h",
     "include/core/SkPicture.h",
     "include/core/SkPictureRecorder.h",
     "include/core/SkPixelRef.h",
@@ -221,6 +222,7 @@ SKIA_PUBLIC_HDRS = [
     "include/utils/SkPaintFilterCanvas.h",
     "include/utils/SkParse.h",
     "include/utils/SkParsePath.h",
+    "include/utils/SkPictureDamage.h",
     "include/utils/SkShadowUtils.h",
     "include/utils/SkTextUtils.h",
     "include/utils/SkTraceEventPhase.h",
@@ -387,6 +389,7 @@ BASE_SRCS_ALL = [
     "src/core/SkBitmapDevice.h",
     "src/core/SkBitmapProcState.h",  # needed for src/opts/SkBitmapProcState_opts.h
     "src/core/SkBitmapProcState_opts.cpp",
+    "src/core/SkBitmapProcState_opts_skx.cpp",
     "src/core/SkBitmapProcState_opts_ssse3.cpp",
     "src/core/SkBlendMode.cpp",
     "src/core/SkBlendModeBlender.cpp",
@@ -401,6 +404,7 @@ BASE_SRCS_ALL = [
     "src/core/SkBlitRow_D32.cpp",
     "src/core/SkBlitRow_opts.cpp",
     "src/core/SkBlitRow_opts_hsw.cpp",
+    "src/core/SkBlitRow_opts_skx.cpp",
     "src/core/SkBlitter.cpp",
     "src/core/SkBlitter.h",
     "src/core/SkBlitter_A8.cpp",
@@ -514,6 +518,8 @@ BASE_SRCS_ALL = [
     "src/core/SkLRUCache.h",
     "src/core/SkLatticeIter.cpp",
     "src/core/SkLatticeIter.h",
+    "src/core/SkLazyPicture.cpp",
+    "src/core/SkLazyPicture.h",
     "src/core/SkLineClipper.cpp",
     "src/core/SkLineClipper.h",
     "src/core/SkLocalMatrixImageFilter.cpp",
@@ -543,6 +549,7 @@ BASE_SRCS_ALL = [
     "src/core/SkMemset_opts.cpp",
     "src/core/SkMemset_opts_avx.cpp",
     "src/core/SkMemset_opts_erms.cpp",
+    "src/core/SkMemset_opts_skx.cpp",
     "src/core/SkMesh.cpp",
     "src/core/SkMeshPriv.h",
     "src/core/SkMessageBus.h",
@@ -575,6 +582,7 @@ BASE_SRCS_ALL = [
     "src/core/SkPathPriv.h",
     "src/core/SkPathRef.cpp",
     "src/core/SkPathUtils.cpp",
+    "src/core/SkPersistentImageCache.cpp",
     "src/core/SkPath_serial.cpp",
     "src/core/SkPicture.cpp",
     "src/core/SkPictureData.cpp",
@@ -652,6 +660,7 @@ BASE_SRCS_ALL = [
     "src/core/SkScan.h",
     "src/core/SkScanPriv.h",
     "src/core/SkScan_AAAPath.cpp",
+    "src/core/SkScan_AccumPath.cpp",
     "src/core/SkScan_AntiPath.cpp",
     "src/core/SkScan_Antihair.cpp",
     "src/core/SkScan_Hairline.cpp",
@@ -681,6 +690,7 @@ BASE_SRCS_ALL = [
     "src/core/SkSwizzlePriv.h",
     "src/core/SkSwizzler_opts.cpp",
     "src/core/SkSwizzler_opts_hsw.cpp",
+    "src/core/SkSwizzler_opts_skx.cpp",
     "src/core/SkSwizzler_opts_ssse3.cpp",
     "src/core/SkTDynamicHash.h",
     "src/core/SkTHash.h",
@@ -1293,6 +1303,7 @@ BASE_SRCS_ALL = [
     "src/image/SkSurface_Null.cpp",
     "src/image/SkSurface_Raster.cpp",
     "src/image/SkSurface_Raster.h",
+    "src/image/SkSurface_RasterThreaded.cpp",
     "src/image/SkTiledImageUtils.cpp",
     "src/opts/SkBitmapProcState_opts.h",
     "src/opts/SkBlitMask_opts.h",
@@ -1757,6 +1768,7 @@ BASE_SRCS_ALL = [
     "src/utils/SkParsePath.cpp",
     "src/utils/SkPatchUtils.cpp",
     "src/utils/SkPatchUtils.h",
+    "src/utils/SkPictureDamage.cpp",
     "src/utils/SkPolyUtils.cpp",
     "src/utils/SkPolyUtils.h",
     "src/utils/SkShaderUtils.cpp",
@@ -1821,6 +1833,7 @@ CODEC_SRCS_LIMITED = [
     "src/codec/SkBmpStandardCodec.cpp",
     "src/codec/SkBmpStandardCodec.h",
     "src/codec/SkCodec.cpp",
+    "src/codec/SkCodecBatchDecode.cpp",
     "src/codec/SkCodecImageGenerator.cpp",
     "src/codec/SkCodecImageGenerator.h",
     "src/codec/SkCodecPriv.h",
@@ -1838,6 +1851,8 @@ CODEC_SRCS_LIMITED = [
     "src/codec/SkJpegMetadataDecoderImpl.cpp",
     "src/codec/SkJpegMetadataDecoderImpl.h",
     "src/codec/SkJpegPriv.h",
+    "src/codec/SkJpegRestartIndex.cpp",
+    "src/codec/SkJpegRestartIndex.h",
     "src/codec/SkJpegSourceMgr.cpp",
     "src/codec/SkJpegSourceMgr.h",
     "src/codec/SkJpegUtility.cpp",
@@ -13,12 +13,250 @@
 #include "include/core/SkPicture.h"
 #include "include/core/SkPictureRecorder.h"
 #include "include/core/SkPixelRef.h"
+#include "include/core/SkStream.h"
+#include "include/private/base/SkMutex.h"
+#include "include/private/base/SkSemaphore.h"
 #include "src/codec/SkCodecPriv.h"
 #include "src/codec/SkPixmapUtilsPriv.h"
 #include "src/core/SkImagePriv.h"
+#include "src/core/SkTHash.h"
+#include "src/core/SkTaskGroup.h"
 
 #include <limits.h>
+#include <cstring>
+#include <deque>
 #include <utility>
+#include <vector>
+
+static bool is_restore_previous(SkCodecAnimation::DisposalMethod dispose) {
+    return SkCodecAnimation::DisposalMethod::kRestorePrevious == dispose;
+}
+
+/**
+ *  Decodes upcoming frames on an executor, each chain of dependent frames in order on one thread,
+ *  and holds onto them until decodeNextFrame() takes them.
+ */
+class SkAnimatedImage::DecodeAhead {
+public:
+    DecodeAhead(SkExecutor& executor, int maxCachedFrames, std::unique_ptr<SkStream> encoded,
+                const SkImageInfo& decodeInfo, int sampleSize,
+                std::vector<SkCodec::FrameInfo> frameInfos)
+        : fMaxCachedFrames(maxCachedFrames)
+        , fDecodeInfo(decodeInfo)
+        , fSampleSize(sampleSize)
+        , fFrameInfos(std::move(frameInfos))
+        , fEncoded(std::move(encoded))
+        , fTasks(executor) {}
+
+    int maxCachedFrames() const { return fMaxCachedFrames; }
+
+    /**
+     *  If frame |index| has been decoded ahead, or is being decoded, moves it into |dst|, waiting
+     *  for it if necessary. Otherwise returns false.
+     */
+    bool take(int index, SkBitmap* dst) {
+        for (;;) {
+            fMutex.acquire();
+            if (SkBitmap* decoded = fDecoded.find(index)) {
+                *dst = std::move(*decoded);
+                fDecoded.remove(index);
+                fMutex.release();
+                return true;
+            }
+            if (!fPending.contains(index)) {
+                fMutex.release();
+                return false;
+            }
+            fWaiters++;
+            fMutex.release();
+            fFrameDone.wait();
+        }
+    }
+
+    /**
+     *  Queues the |upcoming| frames that aren't already decoded or being decoded, and drops any
+     *  decoded frames that aren't upcoming.
+     */
+    void schedule(const std::vector<int>& upcoming) {
+        std::vector<std::shared_ptr<Chain>> newChains;
+        {
+            SkAutoMutexExclusive lock(fMutex);
+            fUpcoming.reset();
+            for (int index : upcoming) {
+                fUpcoming.add(index);
+            }
+            std::vector<int> stale;
+            fDecoded.foreach([&](int index, const SkBitmap&) {
+                if (!fUpcoming.contains(index)) {
+                    stale.push_back(index);
+                }
+            });
+            for (int index : stale) {
+                fDecoded.remove(index);
+            }
+
+            for (int index : upcoming) {
+                const SkCodec::FrameInfo& info = fFrameInfos[index];
+                if (fDecoded.find(index) || fPending.contains(index) || !info.fFullyReceived) {
+                    continue;
+                }
+                // A frame that depends on the last frame queued continues its chain, so that it's
+                // decoded on top of that frame. A frame that doesn't depend on earlier frames
+                // starts a new chain, which can be decoded in parallel with the others.
+                const bool continuesChain = info.fRequiredFrame != SkCodec::kNoFrame &&
+                                            fLastChain && !fLastChain->fDone &&
+                                            fLastQueued == index - 1;
+                if (!continuesChain) {
+                    fLastChain = std::make_shared<Chain>();
+                    newChains.push_back(fLastChain);
+                }
+                fLastChain->fFrames.push_back(index);
+                fLastQueued = index;
+                fPending.add(index);
+            }
+        }
+        for (std::shared_ptr<Chain>& chain : newChains) {
+            fTasks.add([this, chain = std::move(chain)] { this->decodeChain(chain.get()); });
+        }
+    }
+
+private:
+    struct Chain {
+        std::deque<int> fFrames;  // Still to decode, in order.
+        bool            fDone = false;
+    };
+
+    void decodeChain(Chain* chain) {
+        std::unique_ptr<SkAndroidCodec> codec = this->acquireCodec();
+
+        // The last frame this chain decoded that later frames can be decoded on top of.
+        SkBitmap prior;
+        int priorIndex = SkCodec::kNoFrame;
+        for (;;) {
+            int index;
+            bool upcoming;
+            {
+                SkAutoMutexExclusive lock(fMutex);
+                if (chain->fFrames.empty()) {
+                    chain->fDone = true;
+                    break;
+                }
+                index = chain->fFrames.front();
+                chain->fFrames.pop_front();
+                upcoming = fUpcoming.contains(index);
+            }
+            if (!upcoming) {
+                // Shown, or dropped by reset(), before this chain got to it. The codec decodes
+                // any frames that later frames in the chain require itself.
+                this->finishFrame(index, SkBitmap());
+                continue;
+            }
+
+            const SkCodec::FrameInfo& info = fFrameInfos[index];
+            SkAndroidCodec::AndroidOptions options;
+            options.fSampleSize = fSampleSize;
+            options.fFrameIndex = index;
+            if (info.fRequiredFrame != SkCodec::kNoFrame &&
+                    (priorIndex == SkCodec::kNoFrame || priorIndex < info.fRequiredFrame)) {
+                priorIndex = this->findDecodedPriorFrame(index, &prior);
+            }
+
+            SkBitmap bitmap;
+            const auto alphaType = kOpaque_SkAlphaType == info.fAlphaType ? kOpaque_SkAlphaType
+                                                                          : kPremul_SkAlphaType;
+            bool success = codec && bitmap.tryAllocPixels(fDecodeInfo.makeAlphaType(alphaType));
+            if (success && info.fRequiredFrame != SkCodec::kNoFrame &&
+                    priorIndex != SkCodec::kNoFrame) {
+                memcpy(bitmap.getPixels(), prior.getPixels(), bitmap.computeByteSize());
+                options.fPriorFrame = priorIndex;
+            }
+            // Without a prior frame, the codec decodes the required frames itself.
+            success = success && codec->getAndroidPixels(bitmap.info(), bitmap.getPixels(),
+                                                         bitmap.rowBytes(), &options) ==
+                                 SkCodec::kSuccess;
+            // Not marked immutable: once taken, the bitmap becomes one of SkAnimatedImage's
+            // frames, which the synchronous path decodes into again.
+            if (success) {
+                if (!is_restore_previous(info.fDisposalMethod)) {
+                    prior = bitmap;
+                    priorIndex = index;
+                }
+            } else {
+                SkCodecPrintf("Failed to decode frame %i ahead\n", index);
+                bitmap.reset();
+            }
+            this->finishFrame(index, std::move(bitmap));
+        }
+
+        SkAutoMutexExclusive lock(fMutex);
+        if (codec) {
+            fIdleCodecs.push_back(std::move(codec));
+        }
+    }
+
+    std::unique_ptr<SkAndroidCodec> acquireCodec() {
+        SkAutoMutexExclusive lock(fMutex);
+        if (!fIdleCodecs.empty()) {
+            std::unique_ptr<SkAndroidCodec> codec = std::move(fIdleCodecs.back());
+            fIdleCodecs.pop_back();
+            return codec;
+        }
+        return SkAndroidCodec::MakeFromStream(fEncoded->duplicate());
+    }
+
+    /**
+     *  Finds the latest decoded frame that frame |index| can be decoded on top of, or returns
+     *  kNoFrame if there isn't one.
+     */
+    int findDecodedPriorFrame(int index, SkBitmap* prior) {
+        SkAutoMutexExclusive lock(fMutex);
+        for (int i = index - 1; i >= fFrameInfos[index].fRequiredFrame; i--) {
+            if (is_restore_previous(fFrameInfos[i].fDisposalMethod)) {
+                continue;
+            }
+            if (SkBitmap* decoded = fDecoded.find(i)) {
+                *prior = *decoded;
+                return i;
+            }
+        }
+        return SkCodec::kNoFrame;
+    }
+
+    void finishFrame(int index, SkBitmap bitmap) {
+        int waiters;
+        {
+            SkAutoMutexExclusive lock(fMutex);
+            fPending.remove(index);
+            if (!bitmap.isNull() && fUpcoming.contains(index)) {
+                fDecoded.set(index, std::move(bitmap));
+            }
+            waiters = std::exchange(fWaiters, 0);
+        }
+        if (waiters) {
+            fFrameDone.signal(waiters);
+        }
+    }
+
+    const int                             fMaxCachedFrames;
+    const SkImageInfo                     fDecodeInfo;
+    const int                             fSampleSize;
+    const std::vector<SkCodec::FrameInfo> fFrameInfos;
+
+    SkMutex                                      fMutex;
+    std::unique_ptr<SkStream>                    fEncoded SK_GUARDED_BY(fMutex);
+    std::vector<std::unique_ptr<SkAndroidCodec>> fIdleCodecs SK_GUARDED_BY(fMutex);
+    skia_private::THashSet<int>                  fUpcoming SK_GUARDED_BY(fMutex);
+    skia_private::THashSet<int>                  fPending SK_GUARDED_BY(fMutex);
+    skia_private::THashMap<int, SkBitmap>        fDecoded SK_GUARDED_BY(fMutex);
+    std::shared_ptr<Chain>                       fLastChain SK_GUARDED_BY(fMutex);
+    int                                          fLastQueued SK_GUARDED_BY(fMutex) =
+                                                         SkCodec::kNoFrame;
+    int                                          fWaiters SK_GUARDED_BY(fMutex) = 0;
+    SkSemaphore                                  fFrameDone;
+
+    // Last, so that it waits for tasks before anything they use is destroyed.
+    SkTaskGroup                                  fTasks;
+};
 
 sk_sp<SkAnimatedImage> SkAnimatedImage::Make(std::unique_ptr<SkAndroidCodec> codec,
         const SkImageInfo& requestedInfo, SkIRect cropRect, sk_sp<SkPicture> postProcess) {
@@ -157,10 +395,7 @@ void SkAnimatedImage::reset() {
         fDisplayFrame.fIndex = SkCodec::kNoFrame;
         this->decodeNextFrame();
     }
-}
-
-static bool is_restore_previous(SkCodecAnimation::DisposalMethod dispose) {
-    return SkCodecAnimation::DisposalMethod::kRestorePrevious == dispose;
+    this->scheduleDecodeAhead();
 }
 
 int SkAnimatedImage::computeNextFrame(int current, bool* animationEnded) {
@@ -184,6 +419,7 @@ int SkAnimatedImage::computeNextFrame(int current, bool* animationEnded) {
 double SkAnimatedImage::finish() {
     fFinished = true;
     fCurrentFrameDuration = kFinished;
+    this->scheduleDecodeAhead();
     return kFinished;
 }
 
@@ -235,10 +471,26 @@ int SkAnimatedImage::decodeNextFrame() {
             if (animationEnded) {
                 return this->finish();
             }
+            this->scheduleDecodeAhead();
             return fCurrentFrameDuration;
         }
     }
 
+    SkBitmap decodedAhead;
+    if (fDecodeAhead && fDecodeAhead->take(frameToDecode, &decodedAhead)) {
+        // Keep the previous frame around, as it would be after decoding below.
+        using std::swap;
+        swap(fDecodingFrame, fDisplayFrame);
+        fDisplayFrame.fBitmap = std::move(decodedAhead);
+        fDisplayFrame.fIndex = frameToDecode;
+        fDisplayFrame.fDisposalMethod = frameInfo.fDisposalMethod;
+        if (animationEnded) {
+            return this->finish();
+        }
+        this->scheduleDecodeAhead();
+        return fCurrentFrameDuration;
+    }
+
     // The following code makes an effort to avoid overwriting a frame that will
     // be used again. If frame |i| is_restore_previous, frame |i+1| will not
     // depend on frame |i|, so do not overwrite frame |i-1|, which may be needed
@@ -318,7 +570,9 @@ int SkAnimatedImage::decodeNextFrame() {
 
     if (animationEnded) {
         return this->finish();
-    } else if (fCodec->getEncodedFormat() == SkEncodedImageFormat::kHEIF) {
+    }
+    this->scheduleDecodeAhead();
+    if (fCodec->getEncodedFormat() == SkEncodedImageFormat::kHEIF) {
         // HEIF doesn't know the frame duration until after decoding. Update to
         // the correct value. Note that earlier returns in this method either
         // return kFinished, or fCurrentFrameDuration. If they return the
@@ -359,6 +613,57 @@ void SkAnimatedImage::onDraw(SkCanvas* canvas) {
 
 void SkAnimatedImage::setRepetitionCount(int newCount) {
     fRepetitionCount = newCount;
+    this->scheduleDecodeAhead();
+}
+
+bool SkAnimatedImage::setDecodeAhead(SkExecutor* executor, int maxCachedFrames) {
+    fDecodeAhead.reset();
+    if (!executor) {
+        return true;
+    }
+    // HEIF only knows a frame's duration after decoding it.
+    if (fFrameCount < 2 || maxCachedFrames < 1 ||
+            fCodec->getEncodedFormat() == SkEncodedImageFormat::kHEIF) {
+        return false;
+    }
+    std::unique_ptr<SkStream> encoded = fCodec->codec()->getEncodedData();
+    if (!encoded) {
+        return false;
+    }
+    fDecodeAhead = std::make_unique<DecodeAhead>(*executor, maxCachedFrames, std::move(encoded),
+                                                 fDecodeInfo, fSampleSize,
+                                                 fCodec->codec()->getFrameInfo());
+    this->scheduleDecodeAhead();
+    return true;
+}
+
+void SkAnimatedImage::scheduleDecodeAhead() {
+    if (!fDecodeAhead) {
+        return;
+    }
+
+    std::vector<int> upcoming;
+    if (!fFinished) {
+        // Whether the animation goes back to the first frame after the last, as in
+        // computeNextFrame().
+        const bool loops = fRepetitionCount == SkCodec::kRepetitionCountInfinite ||
+                           fRepetitionsCompleted < fRepetitionCount ||
+                           fDisplayFrame.fIndex == fFrameCount - 1;
+        int index = fDisplayFrame.fIndex;
+        while ((int)upcoming.size() < fDecodeAhead->maxCachedFrames()) {
+            if (++index == fFrameCount) {
+                if (!loops) {
+                    break;
+                }
+                index = 0;
+            }
+            if (index == fDisplayFrame.fIndex) {
+                break;
+            }
+            upcoming.push_back(index);
+        }
+    }
+    fDecodeAhead->schedule(upcoming);
 }
 
 sk_sp<SkImage> SkAnimatedImage::getCurrentFrameSimple() {
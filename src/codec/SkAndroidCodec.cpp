@@ -516,6 +516,18 @@ SkCodec::Result SkAndroidCodec::getAndroidPixels(const SkImageInfo& requestInfo,
         }
     }
 
+    if (options->fResampleToDimensions) {
+        const SkISize srcSize = options->fSubset ? options->fSubset->size()
+                                                 : fCodec->dimensions();
+        if (requestInfo.isEmpty() || requestInfo.width() > srcSize.width() ||
+            requestInfo.height() > srcSize.height()) {
+            return SkCodec::kInvalidScale;
+        }
+        if (options->fFrameIndex != 0) {
+            return SkCodec::kUnimplemented;
+        }
+    }
+
     // We may need to have handleFrameIndex recursively call this method
     // to resolve one frame depending on another. The recursion stops
     // when we find a frame which does not require an earlier frame
@@ -497,9 +497,11 @@ SkCodec::Result SkCodec::getPixels(const SkImageInfo& info, void* pixels, size_t
         return frameIndexResult;
     }
 
-    // FIXME: Support subsets somehow? Note that this works for SkWebpCodec
-    // because it supports arbitrary scaling/subset combinations.
-    if (!this->dimensionsSupported(info.dimensions())) {
+    // With a subset, |info| describes the (possibly scaled) subset. This works for SkWebpCodec
+    // because it supports arbitrary scaling/subset combinations. Other codecs only support
+    // unscaled subsets.
+    if (!this->dimensionsSupported(info.dimensions()) &&
+        !(options->fSubset && info.dimensions() == options->fSubset->size())) {
         return kInvalidScale;
     }
 
@@ -519,9 +521,10 @@ SkCodec::Result SkCodec::getPixels(const SkImageInfo& info, void* pixels, size_t
     if ((kIncompleteInput == result || kErrorInInput == result) && rowsDecoded != info.height()) {
         // FIXME: (skbug.com/5772) fillIncompleteImage will fill using the swizzler's width, unless
         // there is a subset. In that case, it will use the width of the subset. From here, the
-        // subset will only be non-null in the case of SkWebpCodec, but it treats the subset
-        // differenty from the other codecs, and it needs to use the width specified by the info.
-        // Set the subset to null so SkWebpCodec uses the correct width.
+        // subset will only be non-null for codecs that decode subsets in getPixels():
+        // SkWebpCodec, which treats the subset differently from the other codecs, and
+        // SkJpegCodec's band decodes, where the subset is the same size as the info. Both need
+        // the width specified by the info, so set the subset to null.
         fOptions.fSubset = nullptr;
         this->fillIncompleteImage(info, pixels, rowBytes, options->fZeroInitialized, info.height(),
                 rowsDecoded);
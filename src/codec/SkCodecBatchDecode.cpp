@@ -0,0 +1,111 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/codec/SkCodec.h"
+#include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkStream.h"
+#include "include/private/base/SkMutex.h"
+#include "include/private/base/SkSemaphore.h"
+#include "src/core/SkStreamPriv.h"
+#include "src/core/SkTaskGroup.h"
+
+#include <algorithm>
+#include <memory>
+#include <tuple>
+#include <utility>
+
+namespace {
+
+// Reads the whole stream, so that decoding doesn't wait on I/O, and parses the header.
+std::unique_ptr<SkCodec> read_and_parse(std::unique_ptr<SkStream> stream,
+                                        SkCodec::Result* result) {
+    if (!stream) {
+        *result = SkCodec::kInvalidInput;
+        return nullptr;
+    }
+    if (!stream->getMemoryBase()) {
+        sk_sp<SkData> data = SkCopyStreamToData(stream.get());
+        if (!data) {
+            *result = SkCodec::kIncompleteInput;
+            return nullptr;
+        }
+        stream = SkMemoryStream::Make(std::move(data));
+    }
+    return SkCodec::MakeFromStream(std::move(stream), result);
+}
+
+std::tuple<sk_sp<SkImage>, SkCodec::Result> decode(SkCodec* codec, const SkImageInfo& info) {
+    if (info.colorType() == kUnknown_SkColorType) {
+        return codec->getImage();
+    }
+    return codec->getImage(info, nullptr);
+}
+
+}  // namespace
+
+namespace SkCodecs {
+
+void DecodeImages(SkSpan<ImageDecodeRequest> requests,
+                  SkExecutor* executor,
+                  int maxImagesInFlight,
+                  const ImageDecodeCallback& callback) {
+    if (!executor) {
+        for (size_t i = 0; i < requests.size(); i++) {
+            SkCodec::Result result;
+            std::unique_ptr<SkCodec> codec = read_and_parse(std::move(requests[i].fStream),
+                                                            &result);
+            if (!codec) {
+                callback(i, nullptr, result);
+                continue;
+            }
+            auto [image, decodeResult] = decode(codec.get(), requests[i].fInfo);
+            callback(i, std::move(image), decodeResult);
+        }
+        return;
+    }
+
+    SkMutex callbackMutex;
+    auto report = [&](size_t i, sk_sp<SkImage> image, SkCodec::Result result) {
+        SkAutoMutexExclusive lock(callbackMutex);
+        callback(i, std::move(image), result);
+    };
+
+    // Each image's encoded data is held in memory from the start of its read until its decode
+    // finishes. Only maxImagesInFlight are let in at once, so that peak memory doesn't grow with
+    // the number of requests, and the next read starts as each decode finishes. Each decode is
+    // queued as soon as its header has been parsed.
+    SkSemaphore slots(std::max(1, maxImagesInFlight));
+    SkTaskGroup tasks(*executor);
+    for (size_t i = 0; i < requests.size(); i++) {
+        // As in SkTaskGroup::wait(), help the executor rather than block.
+        while (!slots.try_wait()) {
+            executor->borrow();
+        }
+        tasks.add([&, i] {
+            SkCodec::Result result;
+            std::shared_ptr<SkCodec> codec = read_and_parse(std::move(requests[i].fStream),
+                                                            &result);
+            if (!codec) {
+                report(i, nullptr, result);
+                slots.signal();
+                return;
+            }
+            tasks.add([&, i, codec = std::move(codec)]() mutable {
+                auto [image, decodeResult] = decode(codec.get(), requests[i].fInfo);
+                codec.reset();
+                report(i, std::move(image), decodeResult);
+                slots.signal();
+            });
+        });
+    }
+    tasks.wait();
+}
+
+}  // namespace SkCodecs
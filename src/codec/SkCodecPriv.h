@@ -10,10 +10,12 @@
 
 #include "include/codec/SkEncodedOrigin.h"
 #include "include/core/SkImageInfo.h"
+#include "include/core/SkStream.h"
 #include "include/core/SkTypes.h"
 #include "include/private/SkColorData.h"
 #include "include/private/SkEncodedInfo.h"
 #include "src/codec/SkColorPalette.h"
+#include "src/core/SkOSFile.h"
 
 #include <string_view>
 
@@ -255,6 +257,25 @@ static inline PackColorProc choose_pack_color_proc(bool isPremul, SkColorType co
     }
 }
 
+/*
+ * If the stream's data is in memory, e.g. a memory-mapped file, hints that the
+ * bytes from its current position to its end are about to be decoded, so the OS
+ * can read them in ahead of the decoder instead of one page fault at a time.
+ */
+static inline void prefetch_remaining(SkStream* stream) {
+    // Smaller ranges are covered by the kernel's own readahead.
+    constexpr size_t kMinPrefetchBytes = 64 * 1024;
+    const void* base = stream->getMemoryBase();
+    if (!base || !stream->hasPosition() || !stream->hasLength()) {
+        return;
+    }
+    const size_t position = stream->getPosition();
+    const size_t length = stream->getLength();
+    if (position < length && length - position >= kMinPrefetchBytes) {
+        sk_fmprefetch(static_cast<const char*>(base) + position, length - position);
+    }
+}
+
 namespace SkCodecs {
 bool HasDecoder(std::string_view id);
 }
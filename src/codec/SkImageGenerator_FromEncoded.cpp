@@ -30,10 +30,12 @@ SkGraphics::SetImageGeneratorFromEncodedDataFactory(ImageGeneratorFromEncodedDat
     return prev;
 }
 
-namespace SkImageGenerators {
-
-std::unique_ptr<SkImageGenerator> MakeFromEncoded(sk_sp<SkData> data,
-                                                  std::optional<SkAlphaType> at) {
+// Sets *isCodecGenerator to whether the returned generator is an SkCodecImageGenerator, rather
+// than one from the client's factory.
+static std::unique_ptr<SkImageGenerator> make_from_encoded(sk_sp<SkData> data,
+                                                           std::optional<SkAlphaType> at,
+                                                           bool* isCodecGenerator) {
+    *isCodecGenerator = false;
     if (!data || at == kOpaque_SkAlphaType) {
         return nullptr;
     }
@@ -42,9 +44,18 @@ std::unique_ptr<SkImageGenerator> MakeFromEncoded(sk_sp<SkData> data,
             return generator;
         }
     }
+    *isCodecGenerator = true;
     return SkCodecImageGenerator::MakeFromEncodedCodec(std::move(data), at);
 }
 
+namespace SkImageGenerators {
+
+std::unique_ptr<SkImageGenerator> MakeFromEncoded(sk_sp<SkData> data,
+                                                  std::optional<SkAlphaType> at) {
+    bool isCodecGenerator;
+    return make_from_encoded(std::move(data), at, &isCodecGenerator);
+}
+
 }  // namespace SkImageGenerators
 
 namespace SkImages {
@@ -54,7 +65,11 @@ sk_sp<SkImage> DeferredFromEncodedData(sk_sp<SkData> encoded,
     if (nullptr == encoded || encoded->isEmpty()) {
         return nullptr;
     }
-    return DeferredFromGenerator(SkImageGenerators::MakeFromEncoded(std::move(encoded), alphaType));
+    bool isCodecGenerator;
+    std::unique_ptr<SkImageGenerator> generator =
+            make_from_encoded(std::move(encoded), alphaType, &isCodecGenerator);
+    return isCodecGenerator ? DeferredFromCodecGenerator(std::move(generator))
+                            : DeferredFromGenerator(std::move(generator));
 }
 
 }  // namespace SkImages
@@ -62,7 +77,7 @@ sk_sp<SkImage> DeferredFromEncodedData(sk_sp<SkData> encoded,
 namespace SkCodecs {
 
 sk_sp<SkImage> DeferredImage(std::unique_ptr<SkCodec> codec, std::optional<SkAlphaType> alphaType) {
-    return SkImages::DeferredFromGenerator(
+    return SkImages::DeferredFromCodecGenerator(
             SkCodecImageGenerator::MakeFromCodec(std::move(codec), alphaType));
 }
 
@@ -27,17 +27,21 @@
 #include "src/codec/SkJpegDecoderMgr.h"
 #include "src/codec/SkJpegMetadataDecoderImpl.h"
 #include "src/codec/SkJpegPriv.h"
+#include "src/codec/SkJpegRestartIndex.h"
 #include "src/codec/SkParseEncodedOrigin.h"
 #include "src/codec/SkSwizzler.h"
+#include "src/core/SkTaskGroup.h"
 
 #ifdef SK_CODEC_DECODES_JPEG_GAINMAPS
 #include "include/private/SkGainmapInfo.h"
 #endif  // SK_CODEC_DECODES_JPEG_GAINMAPS
 
+#include <algorithm>
 #include <array>
 #include <csetjmp>
 #include <cstring>
 #include <utility>
+#include <vector>
 
 using namespace skia_private;
 
@@ -53,6 +57,9 @@ extern "C" {
     #include "jpeglib.h"  // NO_G3_REWRITE
 }
 
+// When decoding bands in parallel, each task decodes at least this many rows.
+static constexpr int kMinRowsPerBandTask = 256;
+
 bool SkJpegCodec::IsJpeg(const void* buffer, size_t bytesRead) {
     return bytesRead >= sizeof(kJpegSig) && !memcmp(buffer, kJpegSig, sizeof(kJpegSig));
 }
@@ -473,8 +480,17 @@ SkCodec::Result SkJpegCodec::onGetPixels(const SkImageInfo& dstInfo,
                                          void* dst, size_t dstRowBytes,
                                          const Options& options,
                                          int* rowsDecoded) {
+    // Subsets, and decoding in parallel, need the image to be split into bands. The bands
+    // are only worth the extra work for a full decode if there are several to decode at once.
+    const SkIRect subset = options.fSubset ? *options.fSubset : this->bounds();
+    if ((options.fSubset || options.fExecutor) && dstInfo.dimensions() == subset.size() &&
+        this->restartIndex() &&
+        (options.fSubset || this->dimensions().height() >= 2 * kMinRowsPerBandTask)) {
+        return this->decodeBands(dstInfo, dst, dstRowBytes, subset, options.fExecutor,
+                                 rowsDecoded);
+    }
     if (options.fSubset) {
-        // Subsets are not supported.
+        // Scaled subsets are not supported.
         return kUnimplemented;
     }
 
@@ -487,6 +503,7 @@ SkCodec::Result SkJpegCodec::onGetPixels(const SkImageInfo& dstInfo,
         return fDecoderMgr->returnFailure("setjmp", kInvalidInput);
     }
 
+    prefetch_remaining(this->stream());
     if (!jpeg_start_decompress(dinfo)) {
         return fDecoderMgr->returnFailure("startDecompress", kInvalidInput);
     }
@@ -513,6 +530,103 @@ SkCodec::Result SkJpegCodec::onGetPixels(const SkImageInfo& dstInfo,
     return kSuccess;
 }
 
+bool SkJpegCodec::onGetValidSubset(SkIRect* desiredSubset) const {
+    if (!desiredSubset || !this->bounds().contains(*desiredSubset)) {
+        return false;
+    }
+    // Building the index doesn't change the result of any decode.
+    return const_cast<SkJpegCodec*>(this)->restartIndex() != nullptr;
+}
+
+const SkJpegRestartIndex* SkJpegCodec::restartIndex() {
+    if (!fTriedRestartIndex) {
+        fTriedRestartIndex = true;
+        SkStream* stream = this->stream();
+        if (stream->hasLength() && stream->getMemoryBase()) {
+            fRestartIndex = SkJpegRestartIndex::Make(stream->getMemoryBase(), stream->getLength());
+        }
+    }
+    return fRestartIndex.get();
+}
+
+SkCodec::Result SkJpegCodec::decodeBands(const SkImageInfo& dstInfo, void* dst,
+                                         size_t dstRowBytes, const SkIRect& subset,
+                                         SkExecutor* executor, int* rowsDecoded) {
+    const SkJpegRestartIndex& index = *fRestartIndex;
+    const int bandHeight = index.bandHeight();
+    const int mcuHeight = index.mcuHeight();
+
+    // Each band also decodes the MCU rows around the rows that are kept, and as much as a
+    // band's height before them to reach a restart marker. Split the rows into tasks that are
+    // large enough for that to be a small part of the work. Without an executor, decode the
+    // subset in one go.
+    int rowsPerTask = index.height();
+    if (executor) {
+        rowsPerTask = std::max(kMinRowsPerBandTask, 4 * bandHeight);
+        rowsPerTask = (rowsPerTask + bandHeight - 1) / bandHeight * bandHeight;
+    }
+    const int firstTask = subset.top() / rowsPerTask;
+    const int numTasks = (subset.bottom() - 1) / rowsPerTask - firstTask + 1;
+    // Start reading in the data for every band at once, rather than as each band is copied.
+    index.prefetch(std::max(0, subset.top() - mcuHeight),
+                   std::min(index.height(), subset.bottom() + 2 * mcuHeight));
+
+    const skcms_ICCProfile* profile = this->getEncodedInfo().profile();
+    std::vector<int> tasksRowsDecoded(numTasks, 0);
+    auto decodeTask = [&](int task) {
+        const int top = std::max(subset.top(), (firstTask + task) * rowsPerTask);
+        const int bottom = std::min(subset.bottom(), (firstTask + task + 1) * rowsPerTask);
+
+        const int bandTop = top >= mcuHeight ? (top - mcuHeight) / bandHeight * bandHeight : 0;
+        const int bandBottom = std::min(index.height(),
+                                        (bottom + 2 * mcuHeight - 1) / mcuHeight * mcuHeight);
+        Result result;
+        // SkRawCodec may have supplied a profile that isn't in the JPEG's header.
+        std::unique_ptr<SkCodec> band = MakeFromStream(
+                SkMemoryStream::Make(index.makeBand(bandTop, bandBottom)), &result,
+                profile ? SkEncodedInfo::ICCProfile::Make(*profile) : nullptr);
+        if (!band) {
+            return;
+        }
+
+        const SkIRect columns = SkIRect::MakeLTRB(subset.left(), 0, subset.right(),
+                                                  bandBottom - bandTop);
+        Options bandOptions;
+        bandOptions.fSubset = &columns;
+        if (band->startScanlineDecode(dstInfo.makeDimensions(band->dimensions()),
+                                      &bandOptions) != kSuccess ||
+            !band->skipScanlines(top - bandTop)) {
+            return;
+        }
+        tasksRowsDecoded[task] = band->getScanlines(
+                SkTAddOffset<void>(dst, (top - subset.top()) * dstRowBytes), bottom - top,
+                dstRowBytes);
+    };
+
+    if (executor && numTasks > 1) {
+        SkTaskGroup(*executor).batch(numTasks, decodeTask);
+    } else {
+        for (int task = 0; task < numTasks; task++) {
+            decodeTask(task);
+        }
+    }
+
+    // The index found every restart marker and the end of the image, so any band that
+    // doesn't decode completely has invalid data. Report the rows up to the first one.
+    fSwizzler.reset();
+    int rows = 0;
+    for (int task = 0; task < numTasks; task++) {
+        const int top = std::max(subset.top(), (firstTask + task) * rowsPerTask);
+        const int bottom = std::min(subset.bottom(), (firstTask + task + 1) * rowsPerTask);
+        rows += tasksRowsDecoded[task];
+        if (tasksRowsDecoded[task] != bottom - top) {
+            *rowsDecoded = rows;
+            return kErrorInInput;
+        }
+    }
+    return kSuccess;
+}
+
 bool SkJpegCodec::allocateStorage(const SkImageInfo& dstInfo) {
     int dstWidth = dstInfo.width();
 
@@ -613,6 +727,7 @@ SkCodec::Result SkJpegCodec::onStartScanlineDecode(const SkImageInfo& dstInfo,
         return kInvalidInput;
     }
 
+    prefetch_remaining(this->stream());
     if (!jpeg_start_decompress(fDecoderMgr->dinfo())) {
         SkCodecPrintf("start decompress failed\n");
         return kInvalidInput;
@@ -802,6 +917,7 @@ SkCodec::Result SkJpegCodec::onGetYUVAPlanes(const SkYUVAPixmaps& yuvaPixmaps) {
     }
 
     dinfo->raw_data_out = TRUE;
+    prefetch_remaining(this->stream());
     if (!jpeg_start_decompress(dinfo)) {
         return fDecoderMgr->returnFailure("startDecompress", kInvalidInput);
     }
@@ -23,6 +23,8 @@
 #include <memory>
 
 class JpegDecoderMgr;
+class SkExecutor;
+class SkJpegRestartIndex;
 class SkSampler;
 class SkStream;
 class SkSwizzler;
@@ -72,6 +74,12 @@ protected:
 
     bool onDimensionsSupported(const SkISize&) override;
 
+    /*
+     * Unscaled subsets are supported if the image has restart markers that allow it to be
+     * decoded in bands (see SkJpegRestartIndex).
+     */
+    bool onGetValidSubset(SkIRect* desiredSubset) const override;
+
     bool conversionSupported(const SkImageInfo&, bool, bool) override;
 
     bool onGetGainmapInfo(SkGainmapInfo* info,
@@ -131,6 +139,19 @@ private:
     [[nodiscard]] bool allocateStorage(const SkImageInfo& dstInfo);
     int readRows(const SkImageInfo& dstInfo, void* dst, size_t rowBytes, int count, const Options&);
 
+    /*
+     * Returns the index of the image's restart markers, or nullptr if it can't be decoded in
+     * bands. The index is built on the first call.
+     */
+    const SkJpegRestartIndex* restartIndex();
+
+    /*
+     * Decodes |subset| of the image, unscaled, by decoding bands of its rows separately. The
+     * bands are decoded in parallel if |executor| is not nullptr.
+     */
+    Result decodeBands(const SkImageInfo& dstInfo, void* dst, size_t dstRowBytes,
+                       const SkIRect& subset, SkExecutor* executor, int* rowsDecoded);
+
     /*
      * Scanline decoding.
      */
@@ -158,6 +179,10 @@ private:
 
     std::unique_ptr<SkSwizzler>        fSwizzler;
 
+    // Built by restartIndex(). It refers to the stream's memory.
+    bool                                fTriedRestartIndex = false;
+    std::unique_ptr<SkJpegRestartIndex> fRestartIndex;
+
     friend class SkRawCodec;
 
     using INHERITED = SkCodec;
@@ -0,0 +1,237 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/codec/SkJpegRestartIndex.h"
+
+#include "include/core/SkData.h"
+#include "include/private/base/SkAssert.h"
+#include "include/private/base/SkTo.h"
+#include "src/codec/SkJpegConstants.h"
+#include "src/core/SkOSFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace {
+// See section B.1.1.3, Marker assignments.
+constexpr uint8_t kMarkerSOF0 = 0xC0;  // Baseline DCT
+constexpr uint8_t kMarkerSOF1 = 0xC1;  // Extended sequential DCT, Huffman coding
+constexpr uint8_t kMarkerDHT = 0xC4;
+constexpr uint8_t kMarkerDAC = 0xCC;
+constexpr uint8_t kMarkerRST0 = 0xD0;
+constexpr uint8_t kMarkerDNL = 0xDC;
+constexpr uint8_t kMarkerDRI = 0xDD;
+
+uint16_t read_u16(const uint8_t* p) { return (p[0] << 8) | p[1]; }
+
+int div_round_up(int n, int d) { return (n + d - 1) / d; }
+
+bool is_start_of_frame(uint8_t marker) {
+    return marker >= 0xC0 && marker <= 0xCF && marker != kMarkerDHT && marker != kMarkerDAC &&
+           marker != 0xC8;  // JPG, reserved for extensions.
+}
+}  // namespace
+
+std::unique_ptr<SkJpegRestartIndex> SkJpegRestartIndex::Make(const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    if (!bytes || size < sizeof(kJpegSig) || memcmp(bytes, kJpegSig, sizeof(kJpegSig)) != 0) {
+        return nullptr;
+    }
+
+    std::unique_ptr<SkJpegRestartIndex> index(new SkJpegRestartIndex);
+    index->fData = bytes;
+
+    // Walk the marker segments up to the StartOfScan.
+    size_t sofOffset = 0;
+    size_t sosOffset = 0;
+    int restartInterval = 0;
+    size_t offset = kJpegMarkerCodeSize;
+    for (;;) {
+        // Any marker may be preceded by 0xFF fill bytes.
+        if (offset >= size || bytes[offset] != 0xFF) {
+            return nullptr;
+        }
+        while (offset < size && bytes[offset] == 0xFF) {
+            offset++;
+        }
+        if (offset + 1 + kJpegSegmentParameterLengthSize > size) {
+            return nullptr;
+        }
+        const uint8_t marker = bytes[offset];
+        const size_t paramOffset = offset + 1;
+        const uint16_t paramLength = read_u16(bytes + paramOffset);
+        if (paramLength < kJpegSegmentParameterLengthSize || paramLength > size - paramOffset) {
+            return nullptr;
+        }
+
+        if (is_start_of_frame(marker)) {
+            if ((marker != kMarkerSOF0 && marker != kMarkerSOF1) || sofOffset) {
+                // Progressive and arithmetic-coded JPEGs don't reset all of their state at
+                // restart markers.
+                return nullptr;
+            }
+            sofOffset = paramOffset;
+        } else if (marker == kMarkerDRI) {
+            if (paramLength != 4) {
+                return nullptr;
+            }
+            restartInterval = read_u16(bytes + paramOffset + 2);
+        } else if (marker == kJpegMarkerStartOfScan) {
+            sosOffset = paramOffset;
+            offset = paramOffset + paramLength;
+            break;
+        } else if ((marker >= kMarkerRST0 && marker <= kJpegMarkerEndOfImage) ||
+                   marker == kMarkerDNL) {
+            return nullptr;
+        }
+        offset = paramOffset + paramLength;
+    }
+    if (!sofOffset || restartInterval == 0) {
+        return nullptr;
+    }
+
+    // The StartOfFrame parameters are the length, the sample precision, the height, the width,
+    // the number of components, and three bytes per component. See section B.2.2.
+    const uint8_t* sof = bytes + sofOffset;
+    const int numComponents = sof[7];
+    if (read_u16(sof) != 8 + 3 * numComponents || sof[2] != 8 || numComponents == 0) {
+        return nullptr;
+    }
+    index->fHeightOffset = sofOffset + 3;
+    index->fHeight = read_u16(sof + 3);
+    index->fWidth = read_u16(sof + 5);
+    if (index->fHeight == 0 || index->fWidth == 0) {
+        // The height is defined by a DefineNumberOfLines marker after the first scan.
+        return nullptr;
+    }
+
+    // A scan of a single component has one block per MCU. Otherwise the MCU covers the area of
+    // the component with the largest sampling factors. See section A.2.
+    int mcuWidth = 8, mcuHeight = 8;
+    if (numComponents > 1) {
+        for (int i = 0; i < numComponents; i++) {
+            const uint8_t sampling = sof[8 + 3 * i + 1];
+            mcuWidth = std::max(mcuWidth, 8 * (sampling >> 4));
+            mcuHeight = std::max(mcuHeight, 8 * (sampling & 0xF));
+        }
+    }
+
+    // The StartOfScan must cover every component, so that it's the only scan. Its parameters
+    // start with the length and the number of components. See section B.2.3.
+    if (read_u16(bytes + sosOffset) < 3 || bytes[sosOffset + 2] != numComponents) {
+        return nullptr;
+    }
+    index->fHeaderSize = offset;
+
+    index->fMCUHeight = mcuHeight;
+    index->fMCUsPerRow = div_round_up(index->fWidth, mcuWidth);
+    index->fRestartInterval = restartInterval;
+    const int mcuRows = div_round_up(index->fHeight, mcuHeight);
+    const int64_t numMCUs = SkToS64(index->fMCUsPerRow) * mcuRows;
+    const int64_t numIntervals = (numMCUs + restartInterval - 1) / restartInterval;
+    SkASSERT(numIntervals > 0);
+
+    // Bands start on the MCU rows that start a restart interval.
+    const int rowsPerBand = restartInterval / std::gcd(restartInterval, index->fMCUsPerRow);
+    if (rowsPerBand >= mcuRows) {
+        return nullptr;
+    }
+    index->fBandHeight = rowsPerBand * mcuHeight;
+
+    // Find the restart markers, which must count up modulo 8, followed by the EndOfImage.
+    // Nothing else may interrupt the entropy-coded data.
+    index->fIntervalStarts.reserve(numIntervals);
+    index->fIntervalStarts.push_back(offset);
+    for (;;) {
+        const void* sentinel = memchr(bytes + offset, 0xFF, size - offset);
+        if (!sentinel) {
+            return nullptr;
+        }
+        size_t markerOffset = static_cast<const uint8_t*>(sentinel) - bytes;
+        offset = markerOffset + 1;
+        while (offset < size && bytes[offset] == 0xFF) {
+            markerOffset = offset++;
+        }
+        if (offset >= size) {
+            return nullptr;
+        }
+
+        const uint8_t marker = bytes[offset++];
+        if (marker == 0x00) {
+            // A stuffed 0xFF byte within the entropy-coded data.
+            continue;
+        }
+        const size_t numRestarts = index->fIntervalStarts.size() - 1;
+        if (marker == kJpegMarkerEndOfImage) {
+            index->fEndOfImage = markerOffset;
+            break;
+        }
+        if (marker != kMarkerRST0 + (numRestarts & 7) ||
+            SkToS64(index->fIntervalStarts.size()) == numIntervals) {
+            return nullptr;
+        }
+        index->fIntervalStarts.push_back(offset);
+    }
+    if (SkToS64(index->fIntervalStarts.size()) != numIntervals) {
+        return nullptr;
+    }
+    return index;
+}
+
+size_t SkJpegRestartIndex::intervalEnd(size_t index) const {
+    SkASSERT(index < fIntervalStarts.size());
+    return index + 1 < fIntervalStarts.size() ? fIntervalStarts[index + 1] - kJpegMarkerCodeSize
+                                              : fEndOfImage;
+}
+
+void SkJpegRestartIndex::intervalsFor(int top, int bottom, size_t* firstInterval,
+                                      size_t* lastInterval) const {
+    const int64_t firstMCU = SkToS64(top / fMCUHeight) * fMCUsPerRow;
+    const int64_t lastMCU = SkToS64(div_round_up(bottom, fMCUHeight)) * fMCUsPerRow - 1;
+    *firstInterval = SkToSizeT(firstMCU / fRestartInterval);
+    *lastInterval = SkToSizeT(lastMCU / fRestartInterval);
+}
+
+void SkJpegRestartIndex::prefetch(int top, int bottom) const {
+    SkASSERT(0 <= top && top < bottom && bottom <= fHeight);
+    size_t firstInterval, lastInterval;
+    this->intervalsFor(top / fBandHeight * fBandHeight, bottom, &firstInterval, &lastInterval);
+    const size_t entropyStart = fIntervalStarts[firstInterval];
+    sk_fmprefetch(fData + entropyStart, this->intervalEnd(lastInterval) - entropyStart);
+}
+
+sk_sp<SkData> SkJpegRestartIndex::makeBand(int top, int bottom) const {
+    SkASSERT(top % fBandHeight == 0 && 0 <= top && top < bottom && bottom <= fHeight);
+
+    // The band holds whole MCU rows, from the intervals that cover them.
+    size_t firstInterval, lastInterval;
+    this->intervalsFor(top, bottom, &firstInterval, &lastInterval);
+    SkASSERT(SkToS64(top / fMCUHeight) * fMCUsPerRow % fRestartInterval == 0);
+
+    const size_t entropyStart = fIntervalStarts[firstInterval];
+    const size_t entropySize = this->intervalEnd(lastInterval) - entropyStart;
+    sk_sp<SkData> band = SkData::MakeUninitialized(fHeaderSize + entropySize + kJpegMarkerCodeSize);
+    uint8_t* dst = static_cast<uint8_t*>(band->writable_data());
+
+    memcpy(dst, fData, fHeaderSize);
+    const int height = bottom - top;
+    dst[fHeightOffset + 0] = height >> 8;
+    dst[fHeightOffset + 1] = height & 0xFF;
+
+    // The decoder expects the restart markers to count up from RST0 again.
+    uint8_t* entropy = dst + fHeaderSize;
+    memcpy(entropy, fData + entropyStart, entropySize);
+    for (size_t i = firstInterval + 1; i <= lastInterval; i++) {
+        const size_t restart = i - firstInterval - 1;
+        entropy[fIntervalStarts[i] - 1 - entropyStart] = kMarkerRST0 + (restart & 7);
+    }
+
+    entropy[entropySize + 0] = 0xFF;
+    entropy[entropySize + 1] = kJpegMarkerEndOfImage;
+    return band;
+}
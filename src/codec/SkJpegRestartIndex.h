@@ -0,0 +1,92 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkJpegRestartIndex_codec_DEFINED
+#define SkJpegRestartIndex_codec_DEFINED
+
+#include "include/core/SkRefCnt.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class SkData;
+
+/*
+ * An index of the restart markers in a sequential JPEG's entropy-coded data.
+ *
+ * Every restart interval starts with its DC predictions reset, so the intervals from one that
+ * starts at the beginning of an MCU row onwards can be decoded without anything before them but
+ * the JPEG's header. makeBand() uses this to build a small JPEG holding just some rows of the
+ * image, so that bands of rows can be decoded independently of each other.
+ */
+class SkJpegRestartIndex {
+public:
+    /*
+     * Returns nullptr unless |data| is a complete, single-scan, Huffman-coded JPEG with
+     * restart intervals, some of which start on an MCU row other than the first one.
+     *
+     * The index refers to |data| rather than copying it, so it must outlive the index.
+     */
+    static std::unique_ptr<SkJpegRestartIndex> Make(const void* data, size_t size);
+
+    int width() const { return fWidth; }
+    int height() const { return fHeight; }
+
+    // A band may start at any multiple of this many rows.
+    int bandHeight() const { return fBandHeight; }
+
+    // The height of a row of MCUs. Chroma upsampling makes each row depend on its neighbours, so
+    // the rows within this distance of a band's edges (other than the image's edges) won't match
+    // the same rows decoded from the whole image.
+    int mcuHeight() const { return fMCUHeight; }
+
+    /*
+     * Returns a JPEG holding rows [top, bottom) of the image. |top| must be a multiple of
+     * bandHeight(), and |bottom| must be greater than |top| and no more than height().
+     */
+    sk_sp<SkData> makeBand(int top, int bottom) const;
+
+    /*
+     * Hints that the bands covering rows [top, bottom) are about to be made, so that the OS can
+     * read in their data (e.g. from a memory-mapped file) ahead of makeBand() copying it.
+     */
+    void prefetch(int top, int bottom) const;
+
+private:
+    SkJpegRestartIndex() = default;
+
+    // The restart intervals holding the MCU rows that cover rows [top, bottom).
+    void intervalsFor(int top, int bottom, size_t* firstInterval, size_t* lastInterval) const;
+
+    // The end of the interval at |index|, where the marker that follows it starts.
+    size_t intervalEnd(size_t index) const;
+
+    const uint8_t* fData = nullptr;
+
+    // The bytes from StartOfImage to the end of the StartOfScan segment.
+    size_t fHeaderSize = 0;
+
+    // Where the image height is stored in the StartOfFrame segment.
+    size_t fHeightOffset = 0;
+
+    // The offset of the first byte of each restart interval's entropy-coded data.
+    std::vector<size_t> fIntervalStarts;
+
+    // Where the EndOfImage marker starts.
+    size_t fEndOfImage = 0;
+
+    int fWidth = 0;
+    int fHeight = 0;
+    int fMCUHeight = 0;
+    int fMCUsPerRow = 0;
+    int fRestartInterval = 0;
+    int fBandHeight = 0;
+};
+
+#endif
@@ -13,8 +13,62 @@
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkRect.h"
 #include "include/private/SkColorData.h"
+#include "src/base/SkVx.h"
 #include "src/codec/SkCodecPriv.h"
 #include "src/core/SkMasks.h"
+#include "src/core/SkSwizzlePriv.h"
+
+namespace {
+enum class MaskAlpha { kOpaque, kUnpremul, kPremul };
+
+// The factor that scales a component of info.size bits to 8 bits. Rounding c * scale to nearest
+// gives the same results as the lookup table in SkMasks.cpp.
+float scale_to_8(const SkMasks::MaskInfo& info) {
+    return info.size ? 255.0f / ((1 << info.size) - 1) : 0.0f;
+}
+
+template <int N>
+skvx::Vec<N, uint32_t> component_to_8(const skvx::Vec<N, uint32_t>& pixels,
+                                      const SkMasks::MaskInfo& info, float scale) {
+    const auto component = skvx::cast<float>((pixels & info.mask) >> info.shift);
+    return skvx::cast<uint32_t>(component * scale + 0.5f);
+}
+
+// Swizzles unsampled rows of 16 or 32 bit pixels to 8888, 8 pixels at a time, and returns how
+// many pixels it swizzled. The rest of the row, and sampled rows, are left to the callers'
+// per-pixel loops.
+template <typename T>
+int swizzle_masks_to_8888(SkPMColor* dst, const T* src, int width, const SkMasks& masks,
+                          uint32_t sampleX, bool bgra, MaskAlpha alpha) {
+    if (1 != sampleX) {
+        return 0;
+    }
+
+    using U32 = skvx::Vec<8, uint32_t>;
+    const float redScale   = scale_to_8(masks.red()),
+                greenScale = scale_to_8(masks.green()),
+                blueScale  = scale_to_8(masks.blue()),
+                alphaScale = scale_to_8(masks.alpha());
+    const int redShift  = bgra ? 16 : 0,
+              blueShift = bgra ? 0 : 16;
+    int i = 0;
+    for (; i + 8 <= width; i += 8) {
+        const U32 p = skvx::cast<uint32_t>(skvx::Vec<8, T>::Load(src + i));
+        const U32 a = alpha == MaskAlpha::kOpaque ? U32(0xFF)
+                                                  : component_to_8(p, masks.alpha(), alphaScale);
+        const U32 px = component_to_8(p, masks.red(),   redScale)   << redShift |
+                       component_to_8(p, masks.green(), greenScale) << 8        |
+                       component_to_8(p, masks.blue(),  blueScale)  << blueShift |
+                       a << 24;
+        px.store(dst + i);
+    }
+    if (alpha == MaskAlpha::kPremul) {
+        // Premultiplying doesn't depend on the order of the color components.
+        SkOpts::RGBA_to_rgbA(dst, dst, i);
+    }
+    return i;
+}
+}  // namespace
 
 static void swizzle_mask16_to_rgba_opaque(
         void* dstRow, const uint8_t* srcRow, int width, SkMasks* masks,
@@ -23,7 +77,10 @@ static void swizzle_mask16_to_rgba_opaque(
     // Use the masks to decode to the destination
     const uint16_t* srcPtr = ((const uint16_t*) srcRow) + startX;
     SkPMColor* dstPtr = (SkPMColor*) dstRow;
-    for (int i = 0; i < width; i++) {
+    const int done = swizzle_masks_to_8888(dstPtr, srcPtr, width, *masks, sampleX,
+                                           /*bgra=*/false, MaskAlpha::kOpaque);
+    srcPtr += done;
+    for (int i = done; i < width; i++) {
         uint16_t p = srcPtr[0];
         uint8_t red = masks->getRed(p);
         uint8_t green = masks->getGreen(p);
@@ -40,7 +97,10 @@ static void swizzle_mask16_to_bgra_opaque(
     // Use the masks to decode to the destination
     const uint16_t* srcPtr = ((const uint16_t*) srcRow) + startX;
     SkPMColor* dstPtr = (SkPMColor*) dstRow;
-    for (int i = 0; i < width; i++) {
+    const int done = swizzle_masks_to_8888(dstPtr, srcPtr, width, *masks, sampleX,
+                                           /*bgra=*/true, MaskAlpha::kOpaque);
+    srcPtr += done;
+    for (int i = done; i < width; i++) {
         uint16_t p = srcPtr[0];
         uint8_t red = masks->getRed(p);
         uint8_t green = masks->getGreen(p);
@@ -57,7 +117,10 @@ static void swizzle_mask16_to_rgba_unpremul(
     // Use the masks to decode to the destination
     const uint16_t* srcPtr = ((const uint16_t*) srcRow) + startX;
     SkPMColor* dstPtr = (SkPMColor*) dstRow;
-    for (int i = 0; i < width; i++) {
+    const int done = swizzle_masks_to_8888(dstPtr, srcPtr, width, *masks, sampleX,
+                                           /*bgra=*/false, MaskAlpha::kUnpremul);
+    srcPtr += done;
+    for (int i = done; i < width; i++) {
         uint16_t p = srcPtr[0];
         uint8_t red = masks->getRed(p);
         uint8_t green = masks->getGreen(p);
@@ -75,7 +138,10 @@ static void swizzle_mask16_to_bgra_unpremul(
     // Use the masks to decode to the destination
     const uint16_t* srcPtr = ((const uint16_t*) srcRow) + startX;
     SkPMColor* dstPtr = (SkPMColor*) dstRow;
-    for (int i = 0; i < width; i++) {
+    const int done = swizzle_masks_to_8888(dstPtr, srcPtr, width, *masks, sampleX,
+                                           /*bgra=*/true, MaskAlpha::kUnpremul);
+    srcPtr += done;
+    for (int i = done; i < width; i++) {
         uint16_t p = srcPtr[0];
         uint8_t red = masks->getRed(p);
         uint8_t green = masks->getGreen(p);
@@ -93,7 +159,10 @@ static void swizzle_mask16_to_rgba_premul(
     // Use the masks to decode to the destination
     const uint16_t* srcPtr = ((const uint16_t*) srcRow) + startX;
     SkPMColor* dstPtr = (SkPMColor*) dstRow;
-    for (int i = 0; i < width; i++) {
+    const int done = swizzle_masks_to_8888(dstPtr, srcPtr, width, *masks, sampleX,
+                                           /*bgra=*/false, MaskAlpha::kPremul);
+    srcPtr += done;
+    for (int i = done; i < width; i++) {
         uint16_t p = srcPtr[0];
         uint8_t red = masks->getRed(p);
         uint8_t green = masks->getGreen(p);
@@ -111,7 +180,10 @@ static void swizzle_mask16_to_bgra_premul(
     // Use the masks to decode to the destination
     const uint16_t* srcPtr = ((const uint16_t*) srcRow) + startX;
     SkPMColor* dstPtr = (SkPMColor*) dstRow;
-    for (int i = 0; i < width; i++) {
+    const int done = swizzle_masks_to_8888(dstPtr, srcPtr, width, *masks, sampleX,
+                                           /*bgra=*/true, MaskAlpha::kPremul);
+    srcPtr += done;
+    for (int i = done; i < width; i++) {
         uint16_t p = srcPtr[0];
         uint8_t red = masks->getRed(p);
         uint8_t green = masks->getGreen(p);
@@ -271,7 +343,10 @@ static void swizzle_mask32_to_rgba_opaque(
     // Use the masks to decode to the destination
     const uint32_t* srcPtr = ((const uint32_t*) srcRow) + startX;
     SkPMColor* dstPtr = (SkPMColor*) dstRow;
-    for (int i = 0; i < width; i++) {
+    const int done = swizzle_masks_to_8888(dstPtr, srcPtr, width, *masks, sampleX,
+                                           /*bgra=*/false, MaskAlpha::kOpaque);
+    srcPtr += done;
+    for (int i = done; i < width; i++) {
         uint32_t p = srcPtr[0];
         uint8_t red = masks->getRed(p);
         uint8_t green = masks->getGreen(p);
@@ -288,7 +363,10 @@ static void swizzle_mask32_to_bgra_opaque(
     // Use the masks to decode to the destination
     const uint32_t* srcPtr = ((const uint32_t*) srcRow) + startX;
     SkPMColor* dstPtr = (SkPMColor*) dstRow;
-    for (int i = 0; i < width; i++) {
+    const int done = swizzle_masks_to_8888(dstPtr, srcPtr, width, *masks, sampleX,
+                                           /*bgra=*/true, MaskAlpha::kOpaque);
+    srcPtr += done;
+    for (int i = done; i < width; i++) {
         uint32_t p = srcPtr[0];
         uint8_t red = masks->getRed(p);
         uint8_t green = masks->getGreen(p);
@@ -305,7 +383,10 @@ static void swizzle_mask32_to_rgba_unpremul(
     // Use the masks to decode to the destination
     const uint32_t* srcPtr = ((const uint32_t*) srcRow) + startX;
     SkPMColor* dstPtr = (SkPMColor*) dstRow;
-    for (int i = 0; i < width; i++) {
+    const int done = swizzle_masks_to_8888(dstPtr, srcPtr, width, *masks, sampleX,
+                                           /*bgra=*/false, MaskAlpha::kUnpremul);
+    srcPtr += done;
+    for (int i = done; i < width; i++) {
         uint32_t p = srcPtr[0];
         uint8_t red = masks->getRed(p);
         uint8_t green = masks->getGreen(p);
@@ -323,7 +404,10 @@ static void swizzle_mask32_to_bgra_unpremul(
     // Use the masks to decode to the destination
     const uint32_t* srcPtr = ((const uint32_t*) srcRow) + startX;
     SkPMColor* dstPtr = (SkPMColor*) dstRow;
-    for (int i = 0; i < width; i++) {
+    const int done = swizzle_masks_to_8888(dstPtr, srcPtr, width, *masks, sampleX,
+                                           /*bgra=*/true, MaskAlpha::kUnpremul);
+    srcPtr += done;
+    for (int i = done; i < width; i++) {
         uint32_t p = srcPtr[0];
         uint8_t red = masks->getRed(p);
         uint8_t green = masks->getGreen(p);
@@ -341,7 +425,10 @@ static void swizzle_mask32_to_rgba_premul(
     // Use the masks to decode to the destination
     const uint32_t* srcPtr = ((const uint32_t*) srcRow) + startX;
     SkPMColor* dstPtr = (SkPMColor*) dstRow;
-    for (int i = 0; i < width; i++) {
+    const int done = swizzle_masks_to_8888(dstPtr, srcPtr, width, *masks, sampleX,
+                                           /*bgra=*/false, MaskAlpha::kPremul);
+    srcPtr += done;
+    for (int i = done; i < width; i++) {
         uint32_t p = srcPtr[0];
         uint8_t red = masks->getRed(p);
         uint8_t green = masks->getGreen(p);
@@ -359,7 +446,10 @@ static void swizzle_mask32_to_bgra_premul(
     // Use the masks to decode to the destination
     const uint32_t* srcPtr = ((const uint32_t*) srcRow) + startX;
     SkPMColor* dstPtr = (SkPMColor*) dstRow;
-    for (int i = 0; i < width; i++) {
+    const int done = swizzle_masks_to_8888(dstPtr, srcPtr, width, *masks, sampleX,
+                                           /*bgra=*/true, MaskAlpha::kPremul);
+    srcPtr += done;
+    for (int i = done; i < width; i++) {
         uint32_t p = srcPtr[0];
         uint8_t red = masks->getRed(p);
         uint8_t green = masks->getGreen(p);
@@ -150,6 +150,22 @@ static inline bool is_chunk(const png_byte* chunk, const char* tag) {
 
 static inline bool process_data(png_structp png_ptr, png_infop info_ptr,
         SkStream* stream, void* buffer, size_t bufferSize, size_t length) {
+    // If the data is already in memory (e.g. a memory-mapped file), hand it to libpng in place
+    // rather than copying it through |buffer|.
+    const void* memoryBase = stream->getMemoryBase();
+    if (memoryBase && stream->hasPosition() && stream->hasLength()) {
+        const size_t position = stream->getPosition();
+        const size_t available = stream->getLength() - std::min(position, stream->getLength());
+        const size_t bytesToProcess = std::min(length, available);
+        // Like read(), move past the data before libpng sees it, since it may longjmp out.
+        stream->skip(bytesToProcess);
+        // libpng does not write to the data it is given.
+        png_process_data(png_ptr, info_ptr,
+                         (png_bytep) (static_cast<const char*>(memoryBase) + position),
+                         bytesToProcess);
+        return bytesToProcess == length;
+    }
+
     while (length > 0) {
         const size_t bytesToProcess = std::min(bufferSize, length);
         const size_t bytesRead = stream->read(buffer, bytesToProcess);
@@ -248,6 +264,7 @@ bool SkPngCodec::processData() {
 
             length = png_get_uint_32(chunk);
         } else {
+            prefetch_remaining(this->stream());
             length = fIdatLength;
             png_byte idat[] = {0, 0, 0, 0, 'I', 'D', 'A', 'T'};
             png_save_uint_32(idat, length);
@@ -12,11 +12,20 @@
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkTypes.h"
+#include "include/core/SkColorSpace.h"
 #include "include/private/base/SkTemplates.h"
+#include "include/private/base/SkTo.h"
+#include "modules/skcms/skcms.h"
 #include "src/base/SkMathPriv.h"
+#include "src/base/SkVx.h"
 #include "src/codec/SkCodecPriv.h"
 #include "src/codec/SkSampler.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
 SkSampledCodec::SkSampledCodec(SkCodec* codec)
     : INHERITED(codec)
 {}
@@ -77,6 +86,10 @@ SkISize SkSampledCodec::onGetSampledDimensions(int sampleSize) const {
 
 SkCodec::Result SkSampledCodec::onGetAndroidPixels(const SkImageInfo& info, void* pixels,
         size_t rowBytes, const AndroidOptions& options) {
+    if (options.fResampleToDimensions) {
+        return this->resampledDecode(info, pixels, rowBytes, options);
+    }
+
     const SkIRect* subset = options.fSubset;
     if (!subset || subset->size() == this->codec()->dimensions()) {
         if (this->codec()->dimensionsSupported(info.dimensions())) {
@@ -95,6 +108,15 @@ SkCodec::Result SkSampledCodec::onGetAndroidPixels(const SkImageInfo& info, void
         return this->sampledDecode(info, pixels, rowBytes, options);
     }
 
+    if (sampleSize == 1) {
+        // Some codecs can decode a subset without decoding the rows above it (e.g. JPEGs with
+        // restart markers).
+        const SkCodec::Result result = this->codec()->getPixels(info, pixels, rowBytes, &options);
+        if (result != SkCodec::kUnimplemented) {
+            return result;
+        }
+    }
+
     // Calculate the scaled subset bounds.
     int scaledSubsetX = subset->x() / sampleSize;
     int scaledSubsetY = subset->y() / sampleSize;
@@ -351,3 +373,288 @@ SkCodec::Result SkSampledCodec::sampledDecode(const SkImageInfo& info, void* pix
             return SkCodec::kUnimplemented;
     }
 }
+
+namespace {
+// The Mitchell-Netravali cubic with B = C = 1/3, which is zero outside of (-2, 2).
+float mitchell(float x) {
+    x = std::fabs(x);
+    if (x < 1) {
+        return ((7 * x - 12) * x * x + 16.f / 3) / 6;
+    }
+    if (x < 2) {
+        return (((-7.f / 3 * x + 12) * x - 20) * x + 32.f / 3) / 6;
+    }
+    return 0;
+}
+
+// The source pixels that are filtered to make each destination pixel, and their weights, when
+// scaling a row or column of srcLength pixels down to dstLength pixels.
+class FilterTaps {
+public:
+    FilterTaps(int srcLength, int dstLength);
+
+    int first(int i) const { return fFirst[i]; }
+    int count(int i) const { return fCount[i]; }
+    const float* weights(int i) const { return fWeights.data() + fOffset[i]; }
+
+    // The most source pixels that contribute to any destination pixel.
+    int maxCount() const { return fMaxCount; }
+
+private:
+    std::vector<int>   fFirst;
+    std::vector<int>   fCount;
+    std::vector<int>   fOffset;
+    std::vector<float> fWeights;
+    int                fMaxCount = 1;
+};
+
+FilterTaps::FilterTaps(int srcLength, int dstLength)
+        : fFirst(dstLength), fCount(dstLength), fOffset(dstLength) {
+    SkASSERT(0 < dstLength && dstLength <= srcLength);
+    if (srcLength == dstLength) {
+        fWeights.assign(dstLength, 1.f);
+        for (int i = 0; i < dstLength; i++) {
+            fFirst[i] = fOffset[i] = i;
+            fCount[i] = 1;
+        }
+        return;
+    }
+
+    // The filter is stretched to cover the source pixels under each destination pixel, so that
+    // it doesn't alias.
+    const float scale = (float)srcLength / dstLength;
+    const float radius = 2 * scale;
+    for (int i = 0; i < dstLength; i++) {
+        const float center = (i + 0.5f) * scale;
+        const int first = std::max(0, (int)std::floor(center - radius - 0.5f) + 1);
+        const int end = std::min(srcLength, (int)std::ceil(center + radius - 0.5f));
+
+        fFirst[i] = first;
+        fOffset[i] = SkToInt(fWeights.size());
+        float sum = 0;
+        for (int j = first; j < end; j++) {
+            const float weight = mitchell((j + 0.5f - center) / scale);
+            fWeights.push_back(weight);
+            sum += weight;
+        }
+        SkASSERT(sum > 0);
+        for (size_t j = fOffset[i]; j < fWeights.size(); j++) {
+            fWeights[j] /= sum;
+        }
+        fCount[i] = end - first;
+        fMaxCount = std::max(fMaxCount, fCount[i]);
+    }
+}
+
+// Converts a row of RGBA_8888 or RGBA_F16 pixels to floats, premultiplying them unless they
+// are opaque, so that transparent pixels don't bleed their color into their neighbours.
+void load_row(const void* src, bool isF16, bool opaque, int width, skvx::float4* dst) {
+    for (int x = 0; x < width; x++) {
+        skvx::float4 px;
+        if (isF16) {
+            px = skvx::from_half(skvx::half4::Load(static_cast<const uint16_t*>(src) + 4 * x));
+        } else {
+            px = skvx::cast<float>(skvx::byte4::Load(static_cast<const uint8_t*>(src) + 4 * x)) *
+                 (1 / 255.f);
+        }
+        if (!opaque) {
+            px = skvx::float4(px[0] * px[3], px[1] * px[3], px[2] * px[3], px[3]);
+        }
+        dst[x] = px;
+    }
+}
+}  // namespace
+
+SkCodec::Result SkSampledCodec::resampledDecode(const SkImageInfo& info, void* pixels,
+        size_t rowBytes, const AndroidOptions& options) {
+    SkASSERT(options.fResampleToDimensions);
+    SkCodec* codec = this->codec();
+    const SkIRect subset = options.fSubset ? *options.fSubset
+                                           : SkIRect::MakeSize(codec->dimensions());
+    SkASSERT(info.width() <= subset.width() && info.height() <= subset.height());
+
+    if (info.dimensions() == subset.size()) {
+        // There is nothing to filter.
+        AndroidOptions unscaledOptions = options;
+        unscaledOptions.fResampleToDimensions = false;
+        unscaledOptions.fSampleSize = 1;
+        return this->onGetAndroidPixels(info, pixels, rowBytes, unscaledOptions);
+    }
+
+    // Let the codec do as much of the downscaling as it can without going below the requested
+    // dimensions. Only JPEG supports native downscaling.
+    SkISize nativeSize = codec->dimensions();
+    SkIRect src = subset;
+    if (codec->getEncodedFormat() == SkEncodedImageFormat::kJPEG) {
+        for (int sampleSize : {8, 4, 2}) {
+            const SkISize scaledSize =
+                    codec->getScaledDimensions(get_scale_from_sample_size(sampleSize));
+            SkIRect scaledSubset = SkIRect::MakeXYWH(
+                    subset.x() / sampleSize, subset.y() / sampleSize,
+                    get_scaled_dimension(subset.width(), sampleSize),
+                    get_scaled_dimension(subset.height(), sampleSize));
+            if (scaledSubset.intersect(SkIRect::MakeSize(scaledSize)) &&
+                scaledSubset.width() >= info.width() && scaledSubset.height() >= info.height()) {
+                nativeSize = scaledSize;
+                src = scaledSubset;
+                break;
+            }
+        }
+    }
+
+    // Filter before converting to the destination color space, so that the conversion only
+    // touches the destination pixels. The codec only converts to a working color space itself
+    // if the encoded pixels aren't RGB (e.g. CMYK).
+    const SkEncodedInfo& encodedInfo = codec->getEncodedInfo();
+    const skcms_ICCProfile* encodedProfile = encodedInfo.profile();
+    sk_sp<SkColorSpace> workingSpace;
+    skcms_ICCProfile srcProfile;
+    if (!encodedProfile) {
+        srcProfile = *skcms_sRGB_profile();
+    } else if (encodedProfile->data_color_space == skcms_Signature_RGB) {
+        srcProfile = *encodedProfile;
+    } else {
+        workingSpace = info.refColorSpace() ? info.refColorSpace() : SkColorSpace::MakeSRGB();
+        workingSpace->toProfile(&srcProfile);
+    }
+    skcms_ICCProfile dstProfile = srcProfile;
+    if (info.colorSpace()) {
+        info.colorSpace()->toProfile(&dstProfile);
+    }
+
+    skcms_PixelFormat dstFormat;
+    if (!sk_select_xform_format(info.colorType(), false, &dstFormat)) {
+        return SkCodec::kInvalidConversion;
+    }
+    skcms_AlphaFormat dstAlphaFormat;
+    switch (info.alphaType()) {
+        case kOpaque_SkAlphaType:   dstAlphaFormat = skcms_AlphaFormat_Opaque;          break;
+        case kPremul_SkAlphaType:   dstAlphaFormat = skcms_AlphaFormat_PremulAsEncoded; break;
+        case kUnpremul_SkAlphaType: dstAlphaFormat = skcms_AlphaFormat_Unpremul;        break;
+        default:
+            return SkCodec::kInvalidConversion;
+    }
+
+    const bool opaque = encodedInfo.opaque();
+    const bool isF16 = encodedInfo.bitsPerComponent() > 8;
+    const SkImageInfo nativeInfo = SkImageInfo::Make(
+            nativeSize, isF16 ? kRGBA_F16_SkColorType : kRGBA_8888_SkColorType,
+            opaque ? kOpaque_SkAlphaType : kUnpremul_SkAlphaType, workingSpace);
+    const SkImageInfo srcInfo = nativeInfo.makeDimensions(src.size());
+
+    // Prefer to read the rows one at a time. Codecs that can't do that (e.g. interlaced or
+    // bottom-up images) decode the whole subset first.
+    std::vector<uint8_t> srcStorage;
+    size_t srcRowBytes = srcInfo.minRowBytes();
+    bool scanlines = false;
+    {
+        const SkIRect columns = SkIRect::MakeLTRB(src.left(), 0, src.right(), nativeSize.height());
+        SkCodec::Options scanlineOptions;
+        scanlineOptions.fSubset = &columns;
+        const SkCodec::Result result = codec->startScanlineDecode(nativeInfo, &scanlineOptions);
+        if (result == SkCodec::kSuccess &&
+            codec->getScanlineOrder() == SkCodec::kTopDown_SkScanlineOrder) {
+            scanlines = true;
+        } else if (result != SkCodec::kSuccess && result != SkCodec::kUnimplemented) {
+            return result;
+        }
+    }
+
+    SkCodec::Result result = SkCodec::kSuccess;
+    if (scanlines) {
+        srcStorage.resize(srcRowBytes);
+        if (!codec->skipScanlines(src.top())) {
+            SkSampler::Fill(info, pixels, rowBytes, options.fZeroInitialized);
+            return SkCodec::kIncompleteInput;
+        }
+    } else {
+        // Only JPEG scales natively, and it decodes scanlines top-down.
+        SkASSERT(nativeSize == codec->dimensions());
+        AndroidOptions subsetOptions = options;
+        subsetOptions.fResampleToDimensions = false;
+        subsetOptions.fSampleSize = 1;
+        subsetOptions.fSubset = options.fSubset ? &subset : nullptr;
+        srcStorage.resize(srcInfo.computeByteSize(srcRowBytes));
+        result = this->onGetAndroidPixels(srcInfo, srcStorage.data(), srcRowBytes, subsetOptions);
+        if (result != SkCodec::kSuccess && result != SkCodec::kIncompleteInput &&
+            result != SkCodec::kErrorInInput) {
+            return result;
+        }
+    }
+
+    const FilterTaps xTaps(src.width(), info.width());
+    const FilterTaps yTaps(src.height(), info.height());
+
+    // A ring of horizontally filtered rows, holding the source rows under the current
+    // destination row.
+    const int ringSize = yTaps.maxCount();
+    std::vector<skvx::float4> srcRow(src.width());
+    std::vector<skvx::float4> ring(SkToSizeT(ringSize) * info.width());
+    std::vector<skvx::float4> dstRow(info.width());
+    int nextSrcY = 0;
+    auto readRow = [&]() {
+        const void* row;
+        if (scanlines) {
+            // Once the input runs out, the codec fills the row it couldn't decode, which is
+            // then reused for the rest of the image.
+            if (result == SkCodec::kSuccess && codec->getScanlines(srcStorage.data(), 1,
+                                                                   srcRowBytes) != 1) {
+                result = SkCodec::kIncompleteInput;
+            }
+            row = srcStorage.data();
+        } else {
+            row = srcStorage.data() + nextSrcY * srcRowBytes;
+        }
+        load_row(row, isF16, opaque, src.width(), srcRow.data());
+
+        skvx::float4* filtered = ring.data() + SkToSizeT(nextSrcY % ringSize) * info.width();
+        for (int x = 0; x < info.width(); x++) {
+            const float* weights = xTaps.weights(x);
+            const skvx::float4* taps = srcRow.data() + xTaps.first(x);
+            skvx::float4 sum = 0;
+            for (int i = 0; i < xTaps.count(x); i++) {
+                sum += taps[i] * weights[i];
+            }
+            filtered[x] = sum;
+        }
+        nextSrcY++;
+    };
+
+    const skvx::float4 kMaxRGBA = 1;
+    for (int y = 0; y < info.height(); y++) {
+        const int first = yTaps.first(y);
+        const int count = yTaps.count(y);
+        while (nextSrcY < first + count) {
+            readRow();
+        }
+
+        std::fill(dstRow.begin(), dstRow.end(), skvx::float4(0));
+        const float* weights = yTaps.weights(y);
+        for (int i = 0; i < count; i++) {
+            const skvx::float4* filtered =
+                    ring.data() + SkToSizeT((first + i) % ringSize) * info.width();
+            for (int x = 0; x < info.width(); x++) {
+                dstRow[x] += filtered[x] * weights[i];
+            }
+        }
+
+        // The filter's negative lobes can overshoot, so clamp to valid (premultiplied) colors.
+        for (int x = 0; x < info.width(); x++) {
+            skvx::float4 px = skvx::pin(dstRow[x], skvx::float4(0), kMaxRGBA);
+            if (!opaque) {
+                px = skvx::min(px, skvx::float4(px[3], px[3], px[3], 1));
+            }
+            dstRow[x] = px;
+        }
+
+        void* dst = SkTAddOffset<void>(pixels, rowBytes * y);
+        if (!skcms_Transform(dstRow.data(), skcms_PixelFormat_RGBA_ffff,
+                             opaque ? skcms_AlphaFormat_Opaque
+                                    : skcms_AlphaFormat_PremulAsEncoded,
+                             &srcProfile, dst, dstFormat, dstAlphaFormat, &dstProfile,
+                             info.width())) {
+            return SkCodec::kInvalidConversion;
+        }
+    }
+    return result;
+}
@@ -60,6 +60,17 @@ private:
     SkCodec::Result sampledDecode(const SkImageInfo& info, void* pixels, size_t rowBytes,
             const AndroidOptions& options);
 
+    /**
+     *  This fulfills the same contract as onGetAndroidPixels().
+     *
+     *  We call this function from onGetAndroidPixels() if the client asked for
+     *  fResampleToDimensions. fCodec decodes at the closest native scale without color
+     *  space conversion, and the rows are filtered to the requested dimensions and then
+     *  converted to the destination format and color space.
+     */
+    SkCodec::Result resampledDecode(const SkImageInfo& info, void* pixels, size_t rowBytes,
+            const AndroidOptions& options);
+
     using INHERITED = SkAndroidCodec;
 };
 #endif // SkSampledCodec_DEFINED
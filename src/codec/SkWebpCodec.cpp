@@ -14,6 +14,7 @@
 #include "include/core/SkBitmap.h"
 #include "include/core/SkColorType.h"
 #include "include/core/SkImageInfo.h"
+#include "include/core/SkPixmap.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkSize.h"
 #include "include/core/SkStream.h"
@@ -33,6 +34,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <cstring>
+#include <memory>
 #include <utility>
 
 // A WebP decoder on top of (subset of) libwebp
@@ -367,6 +369,9 @@ static void blend_line(SkColorType dstCT, void* dst,
 
 SkCodec::Result SkWebpCodec::onGetPixels(const SkImageInfo& dstInfo, void* dst, size_t rowBytes,
                                          const Options& options, int* rowsDecodedPtr) {
+    // A full decode interrupts any scanline decode.
+    fScanlineDecoder.reset();
+
     const int index = options.fFrameIndex;
     SkASSERT(0 == index || index < fFrameHolder.size());
     SkASSERT(0 == index || !options.fSubset);
@@ -569,6 +574,164 @@ SkCodec::Result SkWebpCodec::onGetPixels(const SkImageInfo& dstInfo, void* dst,
     return result;
 }
 
+class SkWebpCodec::ScanlineDecoder {
+public:
+    WebPDecoderConfig fConfig;
+    // Declared after fConfig, which it points into, so that it is deleted first.
+    SkAutoTCallVProc<WebPIDecoder, WebPIDelete> fIDec;
+
+    // libwebp has no API to decode a band of rows at a time, so the frame is decoded into
+    // fFrame, in the format that libwebp outputs. Rows are converted to the dst format as they
+    // are requested. fSrcX is the first column of fFrame to copy out.
+    SkBitmap fFrame;
+    int fSrcX = 0;
+
+    // The frame's encoded data, which is given to libwebp as far as the requested rows need.
+    const uint8_t* fData = nullptr;
+    size_t fSize = 0;
+    size_t fBytesFed = 0;
+    int fRowsDecoded = 0;
+};
+
+SkCodec::Result SkWebpCodec::onStartScanlineDecode(const SkImageInfo& dstInfo,
+                                                   const Options& options) {
+    fScanlineDecoder.reset();
+
+    WebPIterator frame;
+    SkAutoTCallVProc<WebPIterator, WebPDemuxReleaseIterator> autoFrame(&frame);
+    // This succeeded when the codec was created.
+    SkAssertResult(WebPDemuxGetFrame(fDemux, 1, &frame));
+    if (SkIRect::MakeXYWH(frame.x_offset, frame.y_offset, frame.width, frame.height) !=
+        this->bounds()) {
+        // The first frame of an animation may cover only part of the canvas.
+        return kUnimplemented;
+    }
+
+    auto decoder = std::make_unique<ScanlineDecoder>();
+    WebPDecoderConfig& config = decoder->fConfig;
+    if (0 == WebPInitDecoderConfig(&config)) {
+        // ABI mismatch.
+        return kInvalidInput;
+    }
+
+    int frameWidth = dstInfo.width();
+    if (options.fSubset) {
+        if (dstInfo.dimensions() != this->dimensions()) {
+            // libwebp crops before it scales.
+            return kUnimplemented;
+        }
+        // libwebp snaps the left edge of a crop to an even column, so start from there and
+        // skip the extra column when copying rows out.
+        const int cropLeft = options.fSubset->left() & ~1;
+        decoder->fSrcX = options.fSubset->left() - cropLeft;
+        frameWidth = options.fSubset->right() - cropLeft;
+
+        config.options.use_cropping = 1;
+        config.options.crop_left = cropLeft;
+        config.options.crop_top = 0;
+        config.options.crop_width = frameWidth;
+        config.options.crop_height = dstInfo.height();
+    } else if (dstInfo.dimensions() != this->dimensions()) {
+        config.options.use_scaling = 1;
+        config.options.scaled_width = dstInfo.width();
+        config.options.scaled_height = dstInfo.height();
+    }
+
+    auto webpInfo = dstInfo.makeWH(frameWidth, dstInfo.height());
+    if (!frame.has_alpha) {
+        webpInfo = webpInfo.makeAlphaType(kOpaque_SkAlphaType);
+    } else if (this->colorXform()) {
+        // The colorXform expects unpremul.
+        webpInfo = webpInfo.makeAlphaType(kUnpremul_SkAlphaType);
+    }
+    if (this->colorXform()) {
+        // As in onGetPixels(), BGRA is the cheapest for libwebp, and the color transform can
+        // swizzle for free.
+        webpInfo = webpInfo.makeColorType(kBGRA_8888_SkColorType);
+    }
+    if (!decoder->fFrame.tryAllocPixels(webpInfo)) {
+        return kInternalError;
+    }
+
+    config.output.colorspace = webp_decode_mode(webpInfo.colorType(),
+            webpInfo.alphaType() == kPremul_SkAlphaType);
+    config.output.is_external_memory = 1;
+    config.output.u.RGBA.rgba = reinterpret_cast<uint8_t*>(decoder->fFrame.getPixels());
+    config.output.u.RGBA.stride = static_cast<int>(decoder->fFrame.rowBytes());
+    config.output.u.RGBA.size = decoder->fFrame.computeByteSize();
+
+    decoder->fIDec.reset(WebPIDecode(nullptr, 0, &config));
+    if (!decoder->fIDec) {
+        return kInvalidInput;
+    }
+    decoder->fData = frame.fragment.bytes;
+    decoder->fSize = frame.fragment.size;
+    fScanlineDecoder = std::move(decoder);
+    return kSuccess;
+}
+
+int SkWebpCodec::decodeScanlinesThrough(int row) {
+    // Give libwebp the data a piece at a time, so that the first rows are ready without
+    // decoding the whole frame.
+    constexpr size_t kChunkSize = 32 * 1024;
+
+    ScanlineDecoder* decoder = fScanlineDecoder.get();
+    while (decoder->fRowsDecoded < row && decoder->fBytesFed < decoder->fSize) {
+        decoder->fBytesFed = std::min(decoder->fSize, decoder->fBytesFed + kChunkSize);
+        const VP8StatusCode status =
+                WebPIUpdate(decoder->fIDec, decoder->fData, decoder->fBytesFed);
+        if (status != VP8_STATUS_OK && status != VP8_STATUS_SUSPENDED) {
+            break;
+        }
+        int lastY = 0;
+        if (WebPIDecGetRGB(decoder->fIDec, &lastY, nullptr, nullptr, nullptr)) {
+            decoder->fRowsDecoded = lastY;
+        }
+    }
+    return decoder->fRowsDecoded;
+}
+
+int SkWebpCodec::onGetScanlines(void* dst, int count, size_t rowBytes) {
+    if (!fScanlineDecoder) {
+        return 0;
+    }
+
+    const int top = this->currScanline();
+    const int rows = std::max(0, std::min(count, this->decodeScanlinesThrough(top + count) - top));
+    const SkPixmap& frame = fScanlineDecoder->fFrame.pixmap();
+    const int srcX = fScanlineDecoder->fSrcX;
+    const int width = frame.width() - srcX;
+    for (int y = 0; y < rows; y++) {
+        const void* src = frame.addr(srcX, top + y);
+        if (this->colorXform()) {
+            this->applyColorXform(dst, src, width);
+        } else {
+            memcpy(dst, src, width * frame.info().bytesPerPixel());
+        }
+        dst = SkTAddOffset<void>(dst, rowBytes);
+    }
+
+    if (top + count == this->dstInfo().height()) {
+        // Free the frame as soon as it has been read.
+        fScanlineDecoder.reset();
+    }
+    return rows;
+}
+
+bool SkWebpCodec::onSkipScanlines(int count) {
+    if (!fScanlineDecoder) {
+        return false;
+    }
+
+    // Rows are decoded in order, so the skipped rows are decoded anyway.
+    const int end = this->currScanline() + count;
+    const bool success = this->decodeScanlinesThrough(end) >= end;
+    if (end == this->dstInfo().height()) {
+        fScanlineDecoder.reset();
+    }
+    return success;
+}
+
 SkWebpCodec::SkWebpCodec(SkEncodedInfo&& info, std::unique_ptr<SkStream> stream,
                          WebPDemuxer* demux, sk_sp<SkData> data, SkEncodedOrigin origin)
     : INHERITED(std::move(info), skcms_PixelFormat_BGRA_8888, std::move(stream),
@@ -581,6 +744,8 @@ SkWebpCodec::SkWebpCodec(SkEncodedInfo&& info, std::unique_ptr<SkStream> stream,
     fFrameHolder.setScreenSize(eInfo.width(), eInfo.height());
 }
 
+SkWebpCodec::~SkWebpCodec() = default;
+
 namespace SkWebpDecoder {
 bool IsWebp(const void* data, size_t len) {
     return SkWebpCodec::IsWebp(data, len);
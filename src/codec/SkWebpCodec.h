@@ -37,8 +37,14 @@ public:
     // Assumes IsWebp was called and returned true.
     static std::unique_ptr<SkCodec> MakeFromStream(std::unique_ptr<SkStream>, Result*);
     static bool IsWebp(const void*, size_t);
+
+    ~SkWebpCodec() override;
+
 protected:
     Result onGetPixels(const SkImageInfo&, void*, size_t, const Options&, int*) override;
+    Result onStartScanlineDecode(const SkImageInfo& dstInfo, const Options& options) override;
+    int onGetScanlines(void* dst, int count, size_t rowBytes) override;
+    bool onSkipScanlines(int count) override;
     SkEncodedImageFormat onGetEncodedFormat() const override { return SkEncodedImageFormat::kWEBP; }
 
     bool onGetValidSubset(SkIRect* /* desiredSubset */) const override;
@@ -102,6 +108,15 @@ private:
         std::vector<Frame> fFrames;
     };
 
+    // Decodes the first frame incrementally, as scanlines are requested.
+    class ScanlineDecoder;
+
+    // Returns the number of rows of the first frame that fScanlineDecoder has decoded, after
+    // decoding through |row| if it can.
+    int decodeScanlinesThrough(int row);
+
+    std::unique_ptr<ScanlineDecoder> fScanlineDecoder;
+
     FrameHolder fFrameHolder;
     // Set to true if WebPDemuxGetFrame fails. This only means
     // that we will cap the frame count to the frames that
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkLazyPicture.h"
+
+#include "include/core/SkCanvas.h"
+#include "include/core/SkStream.h"
+#include "include/private/base/SkAssert.h"
+#include "include/private/base/SkTo.h"
+#include "src/core/SkCanvasPriv.h"
+#include "src/core/SkPicturePlayback.h"
+
+#include <algorithm>
+#include <climits>
+#include <utility>
+
+SkLazyPicture::SkLazyPicture(const SkPictInfo& info,
+                             sk_sp<SkData> data,
+                             size_t offset,
+                             const SkDeserialProcs& procs,
+                             int recursionLimit)
+    : fInfo(info)
+    , fSerializedSize(data->size())
+    , fProcs(procs)
+    , fRecursionLimit(recursionLimit)
+    , fData(std::move(data))
+    , fOffset(offset) {
+    SkASSERT(fOffset <= fSerializedSize);
+}
+
+SkLazyPicture::~SkLazyPicture() = default;
+
+const SkPictureData* SkLazyPicture::pictureData() const {
+    fParseOnce([this] {
+        SkMemoryStream stream(fData);
+        if (stream.skip(fOffset) == fOffset) {
+            fPictureData.reset(SkPictureData::CreateFromStream(&stream, fInfo, fProcs, nullptr,
+                                                               fRecursionLimit));
+            if (fPictureData) {
+                fPictureData->initForPlayback();
+            }
+        }
+        // Every section is copied out of the stream as it's parsed, so the serialized bytes
+        // (and the file mapping behind them, if any) are no longer needed.
+        fData = nullptr;
+    });
+    return fPictureData.get();
+}
+
+void SkLazyPicture::playback(SkCanvas* canvas, AbortCallback* callback) const {
+    SkASSERT(canvas);
+
+    if (const SkPictureData* data = this->pictureData()) {
+        SkPicturePlayback(data).draw(canvas, callback, nullptr);
+    }
+}
+
+SkRect SkLazyPicture::cullRect() const { return fInfo.fCullRect; }
+
+int SkLazyPicture::approximateOpCount(bool) const {
+    // Counting the ops would mean parsing them, which is what we're putting off. Most ops
+    // serialize to a few dozen bytes, so estimate from the size of the serialized picture.
+    // This is never below the number of ops SkCanvas::drawPicture() would unroll instead of
+    // playing back, so drawing this picture doesn't parse it early.
+    constexpr size_t kApproxBytesPerOp = 32;
+    return SkToInt(std::clamp<size_t>(fSerializedSize / kApproxBytesPerOp,
+                                      kMaxPictureOpsToUnrollInsteadOfRef + 1,
+                                      INT_MAX));
+}
+
+size_t SkLazyPicture::approximateBytesUsed() const {
+    return sizeof(*this) + fSerializedSize;
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkLazyPicture_DEFINED
+#define SkLazyPicture_DEFINED
+
+#include "include/core/SkData.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkSerialProcs.h"
+#include "include/private/base/SkOnce.h"
+#include "src/core/SkPictureData.h"
+
+#include <cstddef>
+#include <memory>
+
+class SkCanvas;
+
+// A serialized picture that isn't parsed until it is first played back, for
+// SkPicture::MakeLazyFromData(). The first playback parses all of it, however little it draws.
+// Rather than being converted to an SkRecord, its drawing commands are played straight from the
+// SkPictureData each time.
+class SkLazyPicture final : public SkPicture {
+public:
+    // 'offset' is where the serialized SkPictureData starts in 'data', just after the header.
+    SkLazyPicture(const SkPictInfo&, sk_sp<SkData> data, size_t offset, const SkDeserialProcs&,
+                  int recursionLimit);
+    ~SkLazyPicture() override;
+
+// SkPicture overrides
+    void playback(SkCanvas*, AbortCallback*) const override;
+    SkRect cullRect() const override;
+    // Only an estimate from the serialized size, whether or not the picture has been parsed.
+    int approximateOpCount(bool nested) const override;
+    size_t approximateBytesUsed() const override;
+
+private:
+    // Parses the picture on the first call. Returns null if the data turned out to be invalid.
+    const SkPictureData* pictureData() const;
+
+    const SkPictInfo      fInfo;
+    const size_t          fSerializedSize;
+    const SkDeserialProcs fProcs;
+    const int             fRecursionLimit;
+
+    mutable SkOnce                         fParseOnce;
+    mutable sk_sp<SkData>                  fData;  // Released once parsed.
+    const size_t                           fOffset;
+    mutable std::unique_ptr<SkPictureData> fPictureData;
+};
+
+#endif
@@ -8,6 +8,7 @@
 #ifndef SkMessageBus_DEFINED
 #define SkMessageBus_DEFINED
 
+#include <atomic>
 #include <type_traits>
 
 #include "include/core/SkRefCnt.h"
@@ -55,6 +56,7 @@ public:
     private:
         skia_private::TArray<Message> fMessages;
         SkMutex                       fMessagesMutex;
+        std::atomic<bool>             fHasMessages{false};  // Lets poll() skip the mutex.
         const IDType                  fUniqueID;
 
         friend class SkMessageBus;
@@ -110,6 +112,7 @@ template <typename Message, typename IDType, bool AllowCopyableMessage>
 void SkMessageBus<Message, IDType, AllowCopyableMessage>::Inbox::receive(Message m) {
     SkAutoMutexExclusive lock(fMessagesMutex);
     fMessages.push_back(std::move(m));
+    fHasMessages.store(true, std::memory_order_release);
 }
 
 template <typename Message, typename IDType, bool AllowCopyableMessage>
@@ -117,8 +120,14 @@ void SkMessageBus<Message, IDType, AllowCopyableMessage>::Inbox::poll(
         skia_private::TArray<Message>* messages) {
     SkASSERT(messages);
     messages->clear();
+    // Inboxes are polled far more often than they receive messages (e.g. on every resource cache
+    // lookup), so don't contend for the mutex when there's nothing to pick up.
+    if (!fHasMessages.load(std::memory_order_acquire)) {
+        return;
+    }
     SkAutoMutexExclusive lock(fMessagesMutex);
     fMessages.swap(*messages);
+    fHasMessages.store(false, std::memory_order_relaxed);
 }
 
 //   ----------------------- Implementation of SkMessageBus -----------------------
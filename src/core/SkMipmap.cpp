@@ -43,7 +43,7 @@ size_t SkMipmap::AllocLevelsSize(int levelCount, size_t pixelSize) {
 }
 
 SkMipmap* SkMipmap::Build(const SkPixmap& src, SkDiscardableFactoryProc fact,
-                          bool computeContents) {
+                          bool computeContents, SkExecutor* executor) {
     if (src.width() <= 1 && src.height() <= 1) {
         return nullptr;
     }
@@ -100,7 +100,7 @@ SkMipmap* SkMipmap::Build(const SkPixmap& src, SkDiscardableFactoryProc fact,
 
     std::unique_ptr<SkMipmapDownSampler> downsampler;
     if (computeContents) {
-        downsampler = MakeDownSampler(src);
+        downsampler = MakeDownSampler(src, executor);
         if (!downsampler) {
             return nullptr;
         }
@@ -265,12 +265,13 @@ bool SkMipmap::validForRootLevel(const SkImageInfo& root) const {
 
 // Helper which extracts a pixmap from the src bitmap
 //
-SkMipmap* SkMipmap::Build(const SkBitmap& src, SkDiscardableFactoryProc fact) {
+SkMipmap* SkMipmap::Build(const SkBitmap& src, SkDiscardableFactoryProc fact,
+                          SkExecutor* executor) {
     SkPixmap srcPixmap;
     if (!src.peekPixels(&srcPixmap)) {
         return nullptr;
     }
-    return Build(srcPixmap, fact);
+    return Build(srcPixmap, fact, /* computeContents= */ true, executor);
 }
 
 int SkMipmap::countLevels() const {
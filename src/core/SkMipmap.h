@@ -19,6 +19,7 @@
 class SkBitmap;
 class SkData;
 class SkDiscardableMemory;
+class SkExecutor;
 class SkMipmapBuilder;
 
 typedef SkDiscardableMemory* (*SkDiscardableFactoryProc)(size_t bytes);
@@ -41,10 +42,13 @@ public:
     ~SkMipmap() override;
     // Allocate and fill-in a mipmap. If computeContents is false, we just allocated
     // and compute the sizes/rowbytes, but leave the pixel-data uninitialized.
+    // If an executor is given, large levels are filtered in bands of rows on its threads
+    // (the levels themselves are still built one after the other). The result is identical.
     static SkMipmap* Build(const SkPixmap& src, SkDiscardableFactoryProc,
-                           bool computeContents = true);
+                           bool computeContents = true, SkExecutor* = nullptr);
 
-    static SkMipmap* Build(const SkBitmap& src, SkDiscardableFactoryProc);
+    static SkMipmap* Build(const SkBitmap& src, SkDiscardableFactoryProc,
+                           SkExecutor* = nullptr);
 
     // Determines how many levels a SkMipmap will have without creating that mipmap.
     // This does not include the base mipmap level that the user provided when
@@ -84,7 +88,9 @@ public:
 
     bool validForRootLevel(const SkImageInfo&) const;
 
-    static std::unique_ptr<SkMipmapDownSampler> MakeDownSampler(const SkPixmap&);
+    // The executor, if any, may be used by the downsampler to split up each level.
+    static std::unique_ptr<SkMipmapDownSampler> MakeDownSampler(const SkPixmap&,
+                                                                SkExecutor* = nullptr);
 
 protected:
     void onDataChange(void* oldData, void* newData) override {
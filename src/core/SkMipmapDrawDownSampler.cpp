@@ -64,7 +64,8 @@ void DrawDownSampler::buildLevel(const SkPixmap& dst, const SkPixmap& src) {
 
 } // namespace
 
-std::unique_ptr<SkMipmapDownSampler> SkMipmap::MakeDownSampler(const SkPixmap& root) {
+std::unique_ptr<SkMipmapDownSampler> SkMipmap::MakeDownSampler(const SkPixmap& root,
+                                                               SkExecutor*) {
     return std::make_unique<DrawDownSampler>();
 }
 
@@ -9,10 +9,14 @@
 
 #ifndef SK_USE_DRAWING_MIPMAP_DOWNSAMPLER
 
+#include "include/core/SkExecutor.h"
 #include "include/private/SkColorData.h"
 #include "src/base/SkHalf.h"
 #include "src/base/SkVx.h"
 #include "src/core/SkMipmap.h"
+#include "src/core/SkTaskGroup.h"
+
+#include <algorithm>
 
 namespace {
 
@@ -377,6 +381,66 @@ template <typename F> void downsample_3_3(void* dst, const void* src, size_t src
 
 typedef void FilterProc(void*, const void* srcPtr, size_t srcRB, int count);
 
+// 8888 is by far the most common format we build mips for, so its isotropic filters also have a
+// version that makes 4 dst pixels at a time. The 8 src pixels they start on are widened to one
+// 16-bit lane per channel, and the columns are summed first, then the pairs of columns. Every sum
+// is an exact integer, so the result matches the one-pixel-at-a-time templates bit for bit; those
+// also finish off each row.
+
+using U16x16 = skvx::Vec<16, uint16_t>;  // 4 pixels
+using U16x32 = skvx::Vec<32, uint16_t>;  // 8 pixels
+
+template <int kRows> U16x32 sum_columns_8888(const uint32_t* p, size_t srcRB) {
+    auto row = [p, srcRB](int y) {
+        return skvx::cast<uint16_t>(skvx::Vec<32, uint8_t>::Load((const char*)p + y * srcRB));
+    };
+    if constexpr (kRows == 2) {
+        return row(0) + row(1);
+    } else {
+        return add_121(row(0), row(1), row(2));
+    }
+}
+
+U16x16 even_pixels(const U16x32& x) {
+    return skvx::shuffle<0,1,2,3, 8,9,10,11, 16,17,18,19, 24,25,26,27>(x);
+}
+
+U16x16 odd_pixels(const U16x32& x) {
+    return skvx::shuffle<4,5,6,7, 12,13,14,15, 20,21,22,23, 28,29,30,31>(x);
+}
+
+template <int kCols, int kRows>
+void downsample_8888(void* dst, const void* src, size_t srcRB, int count) {
+    SkASSERT(count > 0);
+    auto p = static_cast<const uint32_t*>(src);
+    auto d = static_cast<uint32_t*>(dst);
+
+    // The 3-column filters also load the 8 pixels starting at p+2, of which the last is only
+    // in bounds if there's at least one more dst pixel after these 4.
+    const int vectorCount = kCols == 2 ? count : count - 1;
+    constexpr int kShift = (kCols == 2 ? 1 : 2) + (kRows == 2 ? 1 : 2);
+
+    int i = 0;
+    for (; i + 4 <= vectorCount; i += 4) {
+        const U16x32 sums = sum_columns_8888<kRows>(p, srcRB);
+        U16x16 c;
+        if constexpr (kCols == 2) {
+            c = even_pixels(sums) + odd_pixels(sums);
+        } else {
+            c = add_121(even_pixels(sums), odd_pixels(sums),
+                        even_pixels(sum_columns_8888<kRows>(p + 2, srcRB)));
+        }
+        skvx::cast<uint8_t>(c >> kShift).store(d + i);
+        p += 8;
+    }
+    if (i < count) {
+        using F = ColorTypeFilter_8888;
+        FilterProc* tail = kCols == 2 ? (kRows == 2 ? downsample_2_2<F> : downsample_2_3<F>)
+                                      : (kRows == 2 ? downsample_3_2<F> : downsample_3_3<F>);
+        tail(d + i, p, srcRB, count - i);
+    }
+}
+
 struct HQDownSampler : SkMipmapDownSampler {
     FilterProc* proc_1_2 = nullptr;
     FilterProc* proc_1_3 = nullptr;
@@ -387,6 +451,8 @@ struct HQDownSampler : SkMipmapDownSampler {
     FilterProc* proc_3_2 = nullptr;
     FilterProc* proc_3_3 = nullptr;
 
+    SkExecutor* fExecutor = nullptr;
+
     void buildLevel(const SkPixmap& dst, const SkPixmap& src) override;
 };
 
@@ -425,20 +491,40 @@ void HQDownSampler::buildLevel(const SkPixmap& dst, const SkPixmap& src) {
         }
     }
 
-    const void* srcBasePtr = src.addr();
     const size_t srcRB = src.rowBytes();
-    void* dstBasePtr = dst.writable_addr();
-
-    for (int y = 0; y < dst.height(); y++) {
-        proc(dstBasePtr, srcBasePtr, srcRB, dst.width());
-        srcBasePtr = (const char*)srcBasePtr + srcRB * 2; // jump two rows
-        dstBasePtr = (      char*)dstBasePtr + dst.rowBytes();
-    }
+    auto buildRows = [&](int top, int bottom) {
+        const void* srcBasePtr = (const char*)src.addr() + srcRB * 2 * top;
+        void* dstBasePtr = dst.writable_addr(0, top);
+
+        for (int y = top; y < bottom; y++) {
+            proc(dstBasePtr, srcBasePtr, srcRB, dst.width());
+            srcBasePtr = (const char*)srcBasePtr + srcRB * 2; // jump two rows
+            dstBasePtr = (      char*)dstBasePtr + dst.rowBytes();
+        }
+    };
+
+    // Each dst row only reads from src, so bands of rows can be filtered in parallel. Bands are
+    // sized so that a task is worth handing off; smaller levels aren't split at all.
+    constexpr int kPixelsPerBand = 1 << 16;
+    const int rowsPerBand = std::max(1, kPixelsPerBand / dst.width());
+    const int bands = (dst.height() + rowsPerBand - 1) / rowsPerBand;
+    if (!fExecutor || bands < 2) {
+        buildRows(0, dst.height());
+        return;
+    }
+
+    SkTaskGroup tg(*fExecutor);
+    tg.batch(bands, [&](int band) {
+        const int top = band * rowsPerBand;
+        buildRows(top, std::min(top + rowsPerBand, dst.height()));
+    });
+    tg.wait();
 }
 
 } // namespace
 
-std::unique_ptr<SkMipmapDownSampler> SkMipmap::MakeDownSampler(const SkPixmap& root) {
+std::unique_ptr<SkMipmapDownSampler> SkMipmap::MakeDownSampler(const SkPixmap& root,
+                                                               SkExecutor* executor) {
     FilterProc* proc_1_2 = nullptr;
     FilterProc* proc_1_3 = nullptr;
     FilterProc* proc_2_1 = nullptr;
@@ -454,11 +540,11 @@ std::unique_ptr<SkMipmapDownSampler> SkMipmap::MakeDownSampler(const SkPixmap& r
             proc_1_2 = downsample_1_2<ColorTypeFilter_8888>;
             proc_1_3 = downsample_1_3<ColorTypeFilter_8888>;
             proc_2_1 = downsample_2_1<ColorTypeFilter_8888>;
-            proc_2_2 = downsample_2_2<ColorTypeFilter_8888>;
-            proc_2_3 = downsample_2_3<ColorTypeFilter_8888>;
+            proc_2_2 = downsample_8888<2, 2>;
+            proc_2_3 = downsample_8888<2, 3>;
             proc_3_1 = downsample_3_1<ColorTypeFilter_8888>;
-            proc_3_2 = downsample_3_2<ColorTypeFilter_8888>;
-            proc_3_3 = downsample_3_3<ColorTypeFilter_8888>;
+            proc_3_2 = downsample_8888<3, 2>;
+            proc_3_3 = downsample_8888<3, 3>;
             break;
         case kRGB_565_SkColorType:
             proc_1_2 = downsample_1_2<ColorTypeFilter_565>;
@@ -598,6 +684,7 @@ std::unique_ptr<SkMipmapDownSampler> SkMipmap::MakeDownSampler(const SkPixmap& r
     sampler->proc_3_1 = proc_3_1;
     sampler->proc_3_2 = proc_3_2;
     sampler->proc_3_3 = proc_3_3;
+    sampler->fExecutor = executor;
     return sampler;
 }
 
@@ -50,6 +50,12 @@ void*   sk_fdmmap(int fd, size_t* length);
  */
 void    sk_fmunmap(const void* addr, size_t length);
 
+/** Hints that [addr, addr + length) will be read soon, so that the pages of a file mapping can be
+ *  read in ahead of the first access to them. addr need not be page aligned, and need not be
+ *  part of a mapping from sk_fmmap or sk_fdmmap, in which case the hint is ignored.
+ */
+void    sk_fmprefetch(const void* addr, size_t length);
+
 /** Returns true if the two point at the exact same filesystem object. */
 bool    sk_fidentical(FILE* a, FILE* b);
 
@@ -0,0 +1,213 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkPersistentImageCache.h"
+
+#include "include/core/SkData.h"
+#include "include/core/SkGraphics.h"
+#include "include/core/SkString.h"
+#include "include/private/base/SkMutex.h"
+#include "include/private/base/SkTArray.h"
+#include "src/base/SkTime.h"
+#include "src/core/SkMD5.h"
+#include "src/core/SkOSFile.h"
+#include "src/core/SkTHash.h"
+
+#include <atomic>
+#include <cstdio>
+#include <list>
+#include <utility>
+
+using namespace skia_private;
+
+static SkMutex& persistent_image_cache_mutex() {
+    static SkMutex& mutex = *(new SkMutex);
+    return mutex;
+}
+
+static sk_sp<SkPersistentImageCache>& persistent_image_cache() {
+    static sk_sp<SkPersistentImageCache>& cache = *(new sk_sp<SkPersistentImageCache>);
+    return cache;
+}
+
+namespace {
+
+constexpr char kSuffix[] = ".skimg";
+
+class DirectoryImageCache final : public SkPersistentImageCache {
+public:
+    DirectoryImageCache(const char path[], size_t byteLimit);
+
+    sk_sp<SkData> load(const SkData& key) override;
+    void store(const SkData& key, const SkData& data) override;
+
+private:
+    struct Entry {
+        SkString fName;
+        size_t   fSize;
+    };
+
+    // Keys may be any length, so files are named after a hash of them.
+    static SkString NameFor(const SkData& key);
+
+    SkString pathFor(const char name[]) const;
+
+    // Records an entry as the most recently used, replacing any entry with the same name.
+    void touch(const SkString& name, size_t size) SK_REQUIRES(fMutex);
+    void forget(const SkString& name) SK_REQUIRES(fMutex);
+    void purgeAsNeeded() SK_REQUIRES(fMutex);
+    // Deletes the file, or remembers it to try again later if it's still in use.
+    void deleteFile(const SkString& name) SK_REQUIRES(fMutex);
+
+    const SkString fDir;
+    const size_t   fByteLimit;
+
+    SkMutex fMutex;
+    // The most recently used entry is at the front.
+    std::list<Entry> fEntries SK_GUARDED_BY(fMutex);
+    THashMap<SkString, std::list<Entry>::iterator> fIndex SK_GUARDED_BY(fMutex);
+    size_t fTotalBytes SK_GUARDED_BY(fMutex) = 0;
+    // Files that are no longer entries, but couldn't be deleted yet.
+    TArray<SkString> fUndeleted SK_GUARDED_BY(fMutex);
+};
+
+DirectoryImageCache::DirectoryImageCache(const char path[], size_t byteLimit)
+        : fDir(path), fByteLimit(byteLimit) {
+    SkAutoMutexExclusive lock(fMutex);
+    SkOSFile::Iter iter(path, kSuffix);
+    SkString name;
+    while (iter.next(&name)) {
+        if (FILE* file = sk_fopen(this->pathFor(name.c_str()).c_str(), kRead_SkFILE_Flag)) {
+            this->touch(name, sk_fgetsize(file));
+            sk_fclose(file);
+        }
+    }
+    this->purgeAsNeeded();
+}
+
+SkString DirectoryImageCache::NameFor(const SkData& key) {
+    SkMD5 md5;
+    md5.write(key.data(), key.size());
+    SkString name = md5.finish().toLowercaseHexString();
+    name.append(kSuffix);
+    return name;
+}
+
+SkString DirectoryImageCache::pathFor(const char name[]) const {
+    return SkStringPrintf("%s/%s", fDir.c_str(), name);
+}
+
+void DirectoryImageCache::touch(const SkString& name, size_t size) {
+    this->forget(name);
+    fEntries.push_front({name, size});
+    fIndex.set(name, fEntries.begin());
+    fTotalBytes += size;
+}
+
+void DirectoryImageCache::forget(const SkString& name) {
+    if (auto* entry = fIndex.find(name)) {
+        fTotalBytes -= (*entry)->fSize;
+        fEntries.erase(*entry);
+        fIndex.remove(name);
+    }
+}
+
+void DirectoryImageCache::deleteFile(const SkString& name) {
+    // On POSIX, anyone who has the file mapped keeps its pages until they unmap it. Windows
+    // refuses to delete a file that is mapped, and the pixels may still be in use by images.
+    const SkString path = this->pathFor(name.c_str());
+    if (std::remove(path.c_str()) != 0 && sk_exists(path.c_str())) {
+        fUndeleted.push_back(name);
+    }
+}
+
+void DirectoryImageCache::purgeAsNeeded() {
+    for (int i = fUndeleted.size(); i-- > 0;) {
+        const SkString name = fUndeleted[i];
+        fUndeleted.removeShuffle(i);
+        // The file may have become an entry again, if it was loaded before it could be deleted.
+        if (!fIndex.find(name)) {
+            this->deleteFile(name);
+        }
+    }
+    while (fTotalBytes > fByteLimit && !fEntries.empty()) {
+        const SkString name = fEntries.back().fName;
+        this->forget(name);
+        this->deleteFile(name);
+    }
+}
+
+sk_sp<SkData> DirectoryImageCache::load(const SkData& key) {
+    const SkString name = NameFor(key);
+    sk_sp<SkData> data = SkData::MakeFromFileName(this->pathFor(name.c_str()).c_str());
+
+    SkAutoMutexExclusive lock(fMutex);
+    if (data) {
+        // The entry may have been stored by another process.
+        this->touch(name, data->size());
+        this->purgeAsNeeded();
+    } else {
+        // Or deleted by one.
+        this->forget(name);
+    }
+    return data;
+}
+
+void DirectoryImageCache::store(const SkData& key, const SkData& data) {
+    if (data.size() > fByteLimit) {
+        return;
+    }
+
+    // Write to a temporary file first, so that nobody can load a partially written entry.
+    static std::atomic<uint32_t> gNextTempID{0};
+    const SkString name = NameFor(key);
+    const SkString path = this->pathFor(name.c_str());
+    const SkString tempPath = SkStringPrintf("%s.%p.%u.%.0f.tmp", path.c_str(), this,
+                                             gNextTempID++, SkTime::GetNSecs());
+    FILE* file = sk_fopen(tempPath.c_str(), kWrite_SkFILE_Flag);
+    if (!file) {
+        return;
+    }
+    const bool written = sk_fwrite(data.data(), data.size(), file) == data.size();
+    sk_fclose(file);
+    bool renamed = written && std::rename(tempPath.c_str(), path.c_str()) == 0;
+    if (written && !renamed) {
+        // rename() fails on some platforms when the destination already exists.
+        renamed = std::remove(path.c_str()) == 0 &&
+                  std::rename(tempPath.c_str(), path.c_str()) == 0;
+    }
+    if (!renamed) {
+        std::remove(tempPath.c_str());
+        return;
+    }
+
+    SkAutoMutexExclusive lock(fMutex);
+    this->touch(name, data.size());
+    this->purgeAsNeeded();
+}
+
+}  // namespace
+
+sk_sp<SkPersistentImageCache> SkPersistentImageCache::MakeDirectory(const char path[],
+                                                                    size_t byteLimit) {
+    if (!path || !sk_isdir(path)) {
+        return nullptr;
+    }
+    return sk_make_sp<DirectoryImageCache>(path, byteLimit);
+}
+
+sk_sp<SkPersistentImageCache> SkGraphics::SetPersistentImageCache(
+        sk_sp<SkPersistentImageCache> cache) {
+    SkAutoMutexExclusive lock(persistent_image_cache_mutex());
+    std::swap(persistent_image_cache(), cache);
+    return cache;
+}
+
+sk_sp<SkPersistentImageCache> SkGraphics::GetPersistentImageCache() {
+    SkAutoMutexExclusive lock(persistent_image_cache_mutex());
+    return persistent_image_cache();
+}
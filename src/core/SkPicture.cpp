@@ -15,6 +15,7 @@
 #include "include/private/base/SkTo.h"
 #include "src/base/SkMathPriv.h"
 #include "src/core/SkCanvasPriv.h"
+#include "src/core/SkLazyPicture.h"
 #include "src/core/SkPictureData.h"
 #include "src/core/SkPicturePlayback.h"
 #include "src/core/SkPicturePriv.h"
@@ -27,6 +28,7 @@
 #include <atomic>
 #include <cstring>
 #include <memory>
+#include <utility>
 
 // When we read/write the SkPictInfo via a stream, we have a sentinel byte right after the info.
 // Note: in the read/write buffer versions, we have a slightly different convention:
@@ -165,6 +167,25 @@ sk_sp<SkPicture> SkPicture::MakeFromData(const SkData* data, const SkDeserialPro
     return MakeFromStreamPriv(&stream, procs, nullptr, kNestedSKPLimit);
 }
 
+sk_sp<SkPicture> SkPicture::MakeLazyFromData(sk_sp<SkData> data, const SkDeserialProcs* procs) {
+    if (!data) {
+        return nullptr;
+    }
+    SkMemoryStream stream(data);
+    SkPictInfo info;
+    uint8_t trailingStreamByteAfterPictInfo;
+    if (!StreamIsSKP(&stream, &info) || !stream.readU8(&trailingStreamByteAfterPictInfo)) {
+        return nullptr;
+    }
+    if (trailingStreamByteAfterPictInfo != kPictureData_TrailingStreamByteAfterPictInfo) {
+        // Custom pictures are already opaque blobs; leave them to their proc.
+        return MakeFromData(data.get(), procs);
+    }
+    size_t offset = stream.getPosition();
+    return sk_make_sp<SkLazyPicture>(info, std::move(data), offset,
+                                     procs ? *procs : SkDeserialProcs(), kNestedSKPLimit);
+}
+
 sk_sp<SkPicture> SkPicture::MakeFromStreamPriv(SkStream* stream, const SkDeserialProcs* procsPtr,
                                                SkTypefacePlayback* typefaces, int recursionLimit) {
     if (recursionLimit <= 0) {
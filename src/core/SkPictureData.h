@@ -102,6 +102,9 @@ public:
 
     const sk_sp<SkData>& opData() const { return fOpData; }
 
+    // Precomputes path bounds so the data can be played back from several threads at once.
+    void initForPlayback() const;
+
 protected:
     explicit SkPictureData(const SkPictInfo& info);
 
@@ -181,8 +184,6 @@ private:
 
     static void WriteFactories(SkWStream* stream, const SkFactorySet& rec);
     static void WriteTypefaces(SkWStream* stream, const SkRefCntSet& rec, const SkSerialProcs&);
-
-    void initForPlayback() const;
 };
 
 #endif
@@ -9,8 +9,11 @@
 
 #include "include/private/base/SkAssert.h"
 #include "include/private/base/SkDebug.h"
+#include "include/private/base/SkFloatingPoint.h"
+#include "src/base/SkMathPriv.h"
+#include "src/base/SkVx.h"
 
-SkRTree::SkRTree() : fCount(0) {}
+SkRTree::SkRTree() : fCount(0), fRootBounds(SkRect::MakeEmpty()), fRoot(-1) {}
 
 void SkRTree::insert(const SkRect boundsArray[], int N) {
     SkASSERT(0 == fCount);
@@ -24,36 +27,49 @@ void SkRTree::insert(const SkRect boundsArray[], int N) {
             continue;
         }
 
-        Branch b;
-        b.fBounds = bounds;
-        b.fOpIndex = i;
-        branches.push_back(b);
+        branches.push_back({bounds, i});
     }
 
     fCount = (int)branches.size();
     if (fCount) {
         if (1 == fCount) {
             fNodes.reserve(1);
-            Node* n = this->allocateNodeAtLevel(0);
-            n->fNumChildren = 1;
-            n->fChildren[0] = branches[0];
-            fRoot.fSubtree = n;
-            fRoot.fBounds  = branches[0].fBounds;
+            fRoot = this->allocateNodeAtLevel(0);
+            this->addChild(fRoot, branches[0]);
+            fRootBounds = branches[0].fBounds;
         } else {
             fNodes.reserve(CountNodes(fCount));
-            fRoot = this->bulkLoad(&branches);
+            Branch root = this->bulkLoad(&branches);
+            fRoot       = root.fIndex;
+            fRootBounds = root.fBounds;
         }
     }
 }
 
-SkRTree::Node* SkRTree::allocateNodeAtLevel(uint16_t level) {
+int SkRTree::allocateNodeAtLevel(uint16_t level) {
     SkDEBUGCODE(Node* p = fNodes.data());
     fNodes.push_back(Node{});
     Node& out = fNodes.back();
     SkASSERT(fNodes.data() == p);  // If this fails, we didn't reserve() enough.
+    for (int i = 0; i < kChildSlots; i++) {
+        out.fLeft  [i] = out.fTop   [i] = +SK_FloatInfinity;
+        out.fRight [i] = out.fBottom[i] = -SK_FloatInfinity;
+        out.fChildren[i] = -1;
+    }
     out.fNumChildren = 0;
     out.fLevel = level;
-    return &out;
+    return (int)fNodes.size() - 1;
+}
+
+void SkRTree::addChild(int node, const Branch& branch) {
+    Node& n = fNodes[node];
+    SkASSERT(n.fNumChildren < kMaxChildren);
+    const int i = n.fNumChildren++;
+    n.fLeft    [i] = branch.fBounds.fLeft;
+    n.fTop     [i] = branch.fBounds.fTop;
+    n.fRight   [i] = branch.fBounds.fRight;
+    n.fBottom  [i] = branch.fBounds.fBottom;
+    n.fChildren[i] = branch.fIndex;
 }
 
 // This function parallels bulkLoad, but just counts how many nodes bulkLoad would allocate.
@@ -124,17 +140,13 @@ SkRTree::Branch SkRTree::bulkLoad(std::vector<Branch>* branches, int level) {
                 remainder -= kMaxChildren - kMinChildren;
             }
         }
-        Node* n = allocateNodeAtLevel(level);
-        n->fNumChildren = 1;
-        n->fChildren[0] = (*branches)[currentBranch];
-        Branch b;
-        b.fBounds = (*branches)[currentBranch].fBounds;
-        b.fSubtree = n;
+        const int n = this->allocateNodeAtLevel(level);
+        this->addChild(n, (*branches)[currentBranch]);
+        Branch b = {(*branches)[currentBranch].fBounds, n};
         ++currentBranch;
         for (int k = 1; k < incrementBy && currentBranch < (int)branches->size(); ++k) {
             b.fBounds.join((*branches)[currentBranch].fBounds);
-            n->fChildren[k] = (*branches)[currentBranch];
-            ++n->fNumChildren;
+            this->addChild(n, (*branches)[currentBranch]);
             ++currentBranch;
         }
         (*branches)[newBranches] = b;
@@ -144,21 +156,109 @@ SkRTree::Branch SkRTree::bulkLoad(std::vector<Branch>* branches, int level) {
     return this->bulkLoad(branches, level + 1);
 }
 
+// Every rect in the tree is non-empty, so once we know the query is too, testing the four
+// edges against each other is the same as SkRect::Intersects().
+static bool is_valid_query(const SkRect& query) {
+    return query.fLeft < query.fRight && query.fTop < query.fBottom;
+}
+
+uint32_t SkRTree::IntersectingChildren(const Node& node, const SkRect& query) {
+    using float4 = skvx::Vec<4, float>;
+    using int4   = skvx::Vec<4, int32_t>;
+
+    const float4 l(query.fLeft), t(query.fTop), r(query.fRight), b(query.fBottom);
+    uint32_t mask = 0;
+    for (int i = 0; i < kChildSlots; i += 4) {
+        const int4 hit = (float4::Load(node.fLeft   + i) < r) &
+                         (float4::Load(node.fTop    + i) < b) &
+                         (float4::Load(node.fRight  + i) > l) &
+                         (float4::Load(node.fBottom + i) > t);
+        const int4 bits = hit & int4{1, 2, 4, 8};
+        mask |= (uint32_t)(bits[0] | bits[1] | bits[2] | bits[3]) << i;
+    }
+    return mask;
+}
+
 void SkRTree::search(const SkRect& query, std::vector<int>* results) const {
-    if (fCount > 0 && SkRect::Intersects(fRoot.fBounds, query)) {
-        this->search(fRoot.fSubtree, query, results);
+    if (fCount > 0 && is_valid_query(query) && SkRect::Intersects(fRootBounds, query)) {
+        this->search(fRoot, query, results);
     }
 }
 
-void SkRTree::search(Node* node, const SkRect& query, std::vector<int>* results) const {
-    for (int i = 0; i < node->fNumChildren; ++i) {
-        if (SkRect::Intersects(node->fChildren[i].fBounds, query)) {
-            if (0 == node->fLevel) {
-                results->push_back(node->fChildren[i].fOpIndex);
-            } else {
-                this->search(node->fChildren[i].fSubtree, query, results);
+void SkRTree::search(int node, const SkRect& query, std::vector<int>* results) const {
+    const Node& n = fNodes[node];
+    // Children are visited in order, so the results come out in the order they were inserted.
+    for (uint32_t mask = IntersectingChildren(n, query); mask; mask &= mask - 1) {
+        const int child = n.fChildren[SkCTZ(mask)];
+        if (0 == n.fLevel) {
+            results->push_back(child);
+        } else {
+            this->search(child, query, results);
+        }
+    }
+}
+
+void SkRTree::search(const SkRect queries[], int N, std::vector<int> results[]) const {
+    if (fCount == 0) {
+        return;
+    }
+    // 'active' is a stack of query indices: each node pushes the queries that reach the child
+    // it's about to visit, and pops them when it's done. 'masks' runs parallel to it, holding the
+    // children of the current node that each active query intersects.
+    std::vector<int> active;
+    std::vector<uint32_t> masks;
+    for (int i = 0; i < N; i++) {
+        if (is_valid_query(queries[i]) && SkRect::Intersects(fRootBounds, queries[i])) {
+            active.push_back(i);
+        }
+    }
+    if (!active.empty()) {
+        this->search(fRoot, queries, &active, &masks, 0, results);
+    }
+}
+
+void SkRTree::search(int node,
+                     const SkRect queries[],
+                     std::vector<int>* active,
+                     std::vector<uint32_t>* masks,
+                     size_t activeStart,
+                     std::vector<int> results[]) const {
+    const size_t activeEnd = active->size();
+    if (activeEnd - activeStart == 1) {
+        // Usually only one query reaches the nodes near the bottom of the tree.
+        const int q = (*active)[activeStart];
+        this->search(node, queries[q], &results[q]);
+        return;
+    }
+
+    const Node& n = fNodes[node];
+    masks->resize(activeEnd);
+
+    uint32_t reached = 0;  // Children intersected by any of the queries.
+    for (size_t q = activeStart; q < activeEnd; q++) {
+        (*masks)[q] = IntersectingChildren(n, queries[(*active)[q]]);
+        reached |= (*masks)[q];
+    }
+
+    if (0 == n.fLevel) {
+        for (size_t q = activeStart; q < activeEnd; q++) {
+            std::vector<int>& out = results[(*active)[q]];
+            for (uint32_t mask = (*masks)[q]; mask; mask &= mask - 1) {
+                out.push_back(n.fChildren[SkCTZ(mask)]);
+            }
+        }
+        return;
+    }
+
+    for (; reached; reached &= reached - 1) {
+        const int child = SkCTZ(reached);
+        for (size_t q = activeStart; q < activeEnd; q++) {
+            if ((*masks)[q] & (1u << child)) {
+                active->push_back((*active)[q]);
             }
         }
+        this->search(n.fChildren[child], queries, active, masks, activeEnd, results);
+        active->resize(activeEnd);
     }
 }
 
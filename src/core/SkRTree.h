@@ -39,10 +39,15 @@ public:
     void search(const SkRect& query, std::vector<int>* results) const override;
     size_t bytesUsed() const override;
 
+    // Answers N queries (e.g. the tiles of a canvas) in a single traversal of the tree, appending
+    // the ops intersecting queries[i] to results[i]. Each node is loaded once for all the queries
+    // that reach it, rather than once per query.
+    void search(const SkRect queries[], int N, std::vector<int> results[]) const;
+
     // Methods and constants below here are only public for tests.
 
     // Return the depth of the tree structure.
-    int getDepth() const { return fCount ? fRoot.fSubtree->fLevel + 1 : 0; }
+    int getDepth() const { return fCount ? fNodes[fRoot].fLevel + 1 : 0; }
     // Insertion count (not overall node count, which may be greater).
     int getCount() const { return fCount; }
 
@@ -51,23 +56,36 @@ public:
                      kMaxChildren = 11;
 
 private:
-    struct Node;
+    // Each node has room for kMaxChildren rounded up to a whole number of SIMD vectors.
+    static constexpr int kChildSlots = (kMaxChildren + 3) & ~3;
 
     struct Branch {
-        union {
-            Node* fSubtree;
-            int fOpIndex;
-        };
         SkRect fBounds;
+        int    fIndex;  // An op index at level 0, otherwise the index of a node in fNodes.
     };
 
+    // The children's bounds are stored one edge per array, so that search() can test a query
+    // against every child at once. Unused slots have bounds that never intersect anything.
     struct Node {
+        float    fLeft  [kChildSlots],
+                 fTop   [kChildSlots],
+                 fRight [kChildSlots],
+                 fBottom[kChildSlots];
+        int      fChildren[kChildSlots];
         uint16_t fNumChildren;
         uint16_t fLevel;
-        Branch fChildren[kMaxChildren];
     };
 
-    void search(Node* root, const SkRect& query, std::vector<int>* results) const;
+    // Returns a bit for each child of 'node' whose bounds intersect 'query'.
+    static uint32_t IntersectingChildren(const Node& node, const SkRect& query);
+
+    void search(int node, const SkRect& query, std::vector<int>* results) const;
+    void search(int node,
+                const SkRect queries[],
+                std::vector<int>* active,
+                std::vector<uint32_t>* masks,
+                size_t activeStart,
+                std::vector<int> results[]) const;
 
     // Consumes the input array.
     Branch bulkLoad(std::vector<Branch>* branches, int level = 0);
@@ -75,11 +93,13 @@ private:
     // How many times will bulkLoad() call allocateNodeAtLevel()?
     static int CountNodes(int branches);
 
-    Node* allocateNodeAtLevel(uint16_t level);
+    int allocateNodeAtLevel(uint16_t level);
+    void addChild(int node, const Branch&);
 
     // This is the count of data elements (rather than total nodes in the tree)
     int fCount;
-    Branch fRoot;
+    SkRect fRootBounds;
+    int fRoot;
     std::vector<Node> fNodes;
 };
 
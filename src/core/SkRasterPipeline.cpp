@@ -550,9 +550,9 @@ static void prepend_to_pipeline(SkRasterPipelineStage*& ip, SkOpts::StageFn stag
     ip->ctx = ctx;
 }
 
-bool SkRasterPipeline::buildLowpPipeline(SkRasterPipelineStage* ip) const {
+SkRasterPipelineStage* SkRasterPipeline::buildLowpPipeline(SkRasterPipelineStage* ip) const {
     if (gForceHighPrecisionRasterPipeline || fRewindCtx) {
-        return false;
+        return nullptr;
     }
     // Stages are stored backwards in fStages; to compensate, we assemble the pipeline in reverse
     // here, back to front.
@@ -561,17 +561,62 @@ bool SkRasterPipeline::buildLowpPipeline(SkRasterPipelineStage* ip) const {
         int opIndex = (int)st->stage;
         if (opIndex >= kNumRasterPipelineLowpOps || !SkOpts::ops_lowp[opIndex]) {
             // This program contains a stage that doesn't exist in lowp.
-            return false;
+            return nullptr;
         }
         prepend_to_pipeline(ip, SkOpts::ops_lowp[opIndex], st->ctx);
     }
-    return true;
+    return ip;
 }
 
-void SkRasterPipeline::buildHighpPipeline(SkRasterPipelineStage* ip) const {
+// Looks for a program ending in
+//     load_8888_dst, [swap_rb_dst,] srcover, [swap_rb,] store_8888
+// (remember, we're walking the stages backwards) loading and storing the same pixels. In highp,
+// srcover_rgba_8888 does all that in one stage, with the same math. It leaves the dst registers
+// holding the unswapped dst, so it's only used when nothing follows the store. Returns the
+// load_8888_dst stage if we find a match, or null if not.
+//
+// Lowp's srcover_rgba_8888 doesn't round quite like its srcover, so we leave lowp alone.
+static const SkRasterPipeline::StageList* match_srcover_8888(const SkRasterPipeline::StageList* st,
+                                                             bool* swapRB) {
+    if (st->stage != Op::store_8888) {
+        return nullptr;
+    }
+    void* dstCtx = st->ctx;
+    st = st->prev;
+
+    *swapRB = st && st->stage == Op::swap_rb;
+    if (*swapRB) {
+        st = st->prev;
+    }
+    if (!st || st->stage != Op::srcover) {
+        return nullptr;
+    }
+    st = st->prev;
+    if (*swapRB) {
+        if (!st || st->stage != Op::swap_rb_dst) {
+            return nullptr;
+        }
+        st = st->prev;
+    }
+    if (!st || st->stage != Op::load_8888_dst || st->ctx != dstCtx) {
+        return nullptr;
+    }
+    return st;
+}
+
+SkRasterPipelineStage* SkRasterPipeline::buildHighpPipeline(SkRasterPipelineStage* ip) const {
     // We assemble the pipeline in reverse, since the stage list is stored backwards.
     prepend_to_pipeline(ip, SkOpts::just_return_highp, /*ctx=*/nullptr);
-    for (const StageList* st = fStages; st; st = st->prev) {
+    const StageList* st = fStages;
+    bool swapRB;
+    if (const StageList* load = st ? match_srcover_8888(st, &swapRB) : nullptr) {
+        prepend_to_pipeline(ip, SkOpts::ops_highp[(int)Op::srcover_rgba_8888], load->ctx);
+        if (swapRB) {
+            prepend_to_pipeline(ip, SkOpts::ops_highp[(int)Op::swap_rb], /*ctx=*/nullptr);
+        }
+        st = load->prev;
+    }
+    for (; st; st = st->prev) {
         int opIndex = (int)st->stage;
         prepend_to_pipeline(ip, SkOpts::ops_highp[opIndex], st->ctx);
     }
@@ -584,15 +629,18 @@ void SkRasterPipeline::buildHighpPipeline(SkRasterPipelineStage* ip) const {
         const int rewindIndex = (int)Op::stack_checkpoint;
         prepend_to_pipeline(ip, SkOpts::ops_highp[rewindIndex], fRewindCtx);
     }
+    return ip;
 }
 
-SkRasterPipeline::StartPipelineFn SkRasterPipeline::buildPipeline(SkRasterPipelineStage* ip) const {
+SkRasterPipeline::StartPipelineFn SkRasterPipeline::buildPipeline(
+        SkRasterPipelineStage** program) const {
     // We try to build a lowp pipeline first; if that fails, we fall back to a highp float pipeline.
-    if (this->buildLowpPipeline(ip)) {
+    if (SkRasterPipelineStage* start = this->buildLowpPipeline(*program)) {
+        *program = start;
         return SkOpts::start_pipeline_lowp;
     }
 
-    this->buildHighpPipeline(ip);
+    *program = this->buildHighpPipeline(*program);
     return SkOpts::start_pipeline_highp;
 }
 
@@ -625,8 +673,9 @@ void SkRasterPipeline::run(size_t x, size_t y, size_t w, size_t h) const {
         memset(patches[i].scratch, 0, sizeof(patches[i].scratch));
     }
 
-    auto start_pipeline = this->buildPipeline(program.get() + stagesNeeded);
-    start_pipeline(x, y, x + w, y + h, program.get(),
+    SkRasterPipelineStage* start = program.get() + stagesNeeded;
+    auto start_pipeline = this->buildPipeline(&start);
+    start_pipeline(x, y, x + w, y + h, start,
                    SkSpan{patches.data(), numMemoryCtxs},
                    fTailPointer);
 }
@@ -650,9 +699,10 @@ std::function<void(size_t, size_t, size_t, size_t)> SkRasterPipeline::compile()
     }
     uint8_t* tailPointer = fTailPointer;
 
-    auto start_pipeline = this->buildPipeline(program + stagesNeeded);
+    SkRasterPipelineStage* start = program + stagesNeeded;
+    auto start_pipeline = this->buildPipeline(&start);
     return [=](size_t x, size_t y, size_t w, size_t h) {
-        start_pipeline(x, y, x + w, y + h, program,
+        start_pipeline(x, y, x + w, y + h, start,
                        SkSpan{patches, numMemoryCtxs},
                        tailPointer);
     };
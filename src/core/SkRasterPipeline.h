@@ -136,14 +136,19 @@ public:
     bool empty() const { return fStages == nullptr; }
 
 private:
-    bool buildLowpPipeline(SkRasterPipelineStage* ip) const;
-    void buildHighpPipeline(SkRasterPipelineStage* ip) const;
+    // These assemble the program backwards from ip, which points just past the end of its
+    // storage, and return where the program starts. That may be past the start of the storage,
+    // as highp fuses some runs of stages into one. buildLowpPipeline() returns null if the
+    // program can't run in lowp.
+    SkRasterPipelineStage* buildLowpPipeline(SkRasterPipelineStage* ip) const;
+    SkRasterPipelineStage* buildHighpPipeline(SkRasterPipelineStage* ip) const;
 
     using StartPipelineFn = void (*)(size_t, size_t, size_t, size_t,
                                      SkRasterPipelineStage* program,
                                      SkSpan<SkRasterPipeline_MemoryCtxPatch>,
                                      uint8_t*);
-    StartPipelineFn buildPipeline(SkRasterPipelineStage*) const;
+    // Takes the end of the program's storage, and updates it to the start of the program.
+    StartPipelineFn buildPipeline(SkRasterPipelineStage** program) const;
 
     void uncheckedAppend(SkRasterPipelineOp, void*);
     int stagesNeeded() const;
@@ -121,6 +121,13 @@ void SkRecorder::forgetRecord() {
 // To make appending to fRecord a little less verbose.
 template<typename T, typename... Args>
 void SkRecorder::append(Args&&... args) {
+    if constexpr ((T::kTags & SkRecords::kDraw_Tag) != 0) {
+        // When we record on behalf of a surface (SkSurfaces::RasterThreaded), let it fork its
+        // pixels away from any outstanding snapshot before we queue up a draw into them.
+        if (this->getSurfaceBase() && !this->predrawNotify()) {
+            return;
+        }
+    }
     new (fRecord->append<T>()) T{std::forward<Args>(args)...};
 }
 
@@ -16,6 +16,7 @@
 #include "include/private/base/SkMalloc.h"
 #include "include/private/base/SkMath.h"
 #include "include/private/base/SkMutex.h"
+#include "include/private/base/SkOnce.h"
 #include "include/private/base/SkTArray.h"
 #include "include/private/base/SkTo.h"
 #include "src/core/SkCachedData.h"
@@ -29,6 +30,7 @@
 #endif
 
 #include <algorithm>
+#include <limits>
 
 using namespace skia_private;
 
@@ -86,15 +88,22 @@ namespace {
 class SkResourceCache::Hash :
     public THashTable<SkResourceCache::Rec*, SkResourceCache::Key, HashTraits> {};
 
+// Each shard is an LRU list of its recs (most recently used at the head) and a hash of them.
+// The lists are ordered by Rec::fLastUse, so the oldest rec in the cache is one of their tails.
+struct SkResourceCache::Shard {
+    SkMutex fMutex;
+    Rec*    fHead = nullptr;
+    Rec*    fTail = nullptr;
+    Hash    fHash;
+};
 
 ///////////////////////////////////////////////////////////////////////////////
 
 void SkResourceCache::init() {
-    fHead = nullptr;
-    fTail = nullptr;
-    fHash = new Hash;
+    fShards = std::make_unique<Shard[]>(kShardCount);
     fTotalBytesUsed = 0;
     fCount = 0;
+    fUseCounter = 0;
     fSingleAllocationByteLimit = 0;
 
     // One of these should be explicit set by the caller after we return.
@@ -115,13 +124,19 @@ SkResourceCache::SkResourceCache(size_t byteLimit)
 }
 
 SkResourceCache::~SkResourceCache() {
-    Rec* rec = fHead;
-    while (rec) {
-        Rec* next = rec->fNext;
-        delete rec;
-        rec = next;
+    for (int i = 0; i < kShardCount; ++i) {
+        Rec* rec = fShards[i].fHead;
+        while (rec) {
+            Rec* next = rec->fNext;
+            delete rec;
+            rec = next;
+        }
     }
-    delete fHash;
+}
+
+SkResourceCache::Shard& SkResourceCache::shardFor(uint32_t hash) const {
+    // Hash tables index by the low bits of the hash, so use the high ones here.
+    return fShards[hash >> (32 - kShardBits)];
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -129,13 +144,15 @@ SkResourceCache::~SkResourceCache() {
 bool SkResourceCache::find(const Key& key, FindVisitor visitor, void* context) {
     this->checkMessages();
 
-    if (auto found = fHash->find(key)) {
+    Shard& shard = this->shardFor(key.hash());
+    SkAutoMutexExclusive lock(shard.fMutex);
+    if (auto found = shard.fHash.find(key)) {
         Rec* rec = *found;
         if (visitor(*rec, context)) {
-            this->moveToHead(rec);  // for our LRU
+            this->moveToHead(&shard, rec);  // for our LRU
             return true;
         } else {
-            this->remove(rec);  // stale
+            this->remove(&shard, rec);  // stale
             return false;
         }
     }
@@ -158,43 +175,48 @@ void SkResourceCache::add(Rec* rec, void* payload) {
     this->checkMessages();
 
     SkASSERT(rec);
-    // See if we already have this key (racy inserts, etc.)
-    if (Rec** preexisting = fHash->find(rec->getKey())) {
-        Rec* prev = *preexisting;
-        if (prev->canBePurged()) {
-            // if it can be purged, the install may fail, so we have to remove it
-            this->remove(prev);
-        } else {
-            // if it cannot be purged, we reuse it and delete the new one
-            prev->postAddInstall(payload);
-            delete rec;
-            return;
+    {
+        Shard& shard = this->shardFor(rec->getHash());
+        SkAutoMutexExclusive lock(shard.fMutex);
+
+        // See if we already have this key (racy inserts, etc.)
+        if (Rec** preexisting = shard.fHash.find(rec->getKey())) {
+            Rec* prev = *preexisting;
+            if (prev->canBePurged()) {
+                // if it can be purged, the install may fail, so we have to remove it
+                this->remove(&shard, prev);
+            } else {
+                // if it cannot be purged, we reuse it and delete the new one
+                prev->postAddInstall(payload);
+                delete rec;
+                return;
+            }
         }
-    }
 
-    this->addToHead(rec);
-    fHash->set(rec);
-    rec->postAddInstall(payload);
+        this->addToHead(&shard, rec);
+        shard.fHash.set(rec);
+        rec->postAddInstall(payload);
 
-    if (gDumpCacheTransactions) {
-        SkString bytesStr, totalStr;
-        make_size_str(rec->bytesUsed(), &bytesStr);
-        make_size_str(fTotalBytesUsed, &totalStr);
-        SkDebugf("RC:    add %5s %12p key %08x -- total %5s, count %d\n",
-                 bytesStr.c_str(), rec, rec->getHash(), totalStr.c_str(), fCount);
+        if (gDumpCacheTransactions) {
+            SkString bytesStr, totalStr;
+            make_size_str(rec->bytesUsed(), &bytesStr);
+            make_size_str(fTotalBytesUsed, &totalStr);
+            SkDebugf("RC:    add %5s %12p key %08x -- total %5s, count %d\n",
+                     bytesStr.c_str(), rec, rec->getHash(), totalStr.c_str(), fCount.load());
+        }
     }
 
     // since the new rec may push us over-budget, we perform a purge check now
     this->purgeAsNeeded();
 }
 
-void SkResourceCache::remove(Rec* rec) {
+void SkResourceCache::remove(Shard* shard, Rec* rec) {
     SkASSERT(rec->canBePurged());
     size_t used = rec->bytesUsed();
     SkASSERT(used <= fTotalBytesUsed);
 
-    this->release(rec);
-    fHash->remove(rec->getKey());
+    this->release(shard, rec);
+    shard->fHash.remove(rec->getKey());
 
     fTotalBytesUsed -= used;
     fCount -= 1;
@@ -206,7 +228,7 @@ void SkResourceCache::remove(Rec* rec) {
         make_size_str(used, &bytesStr);
         make_size_str(fTotalBytesUsed, &totalStr);
         SkDebugf("RC: remove %5s %12p key %08x -- total %5s, count %d\n",
-                 bytesStr.c_str(), rec, rec->getHash(), totalStr.c_str(), fCount);
+                 bytesStr.c_str(), rec, rec->getHash(), totalStr.c_str(), fCount.load());
     }
 
     delete rec;
@@ -223,18 +245,52 @@ void SkResourceCache::purgeAsNeeded(bool forcePurge) {
         countLimit = SK_MaxS32; // no limit based on count
         byteLimit = fTotalByteLimit;
     }
+    auto overBudget = [&] {
+        return forcePurge || fTotalBytesUsed >= byteLimit || fCount >= countLimit;
+    };
+    // Returns the least recently used rec that can be purged, starting from rec and going
+    // towards the head of its shard.
+    auto oldest_purgeable = [](Rec* rec) {
+        while (rec && !rec->canBePurged()) {
+            rec = rec->fPrev;
+        }
+        return rec;
+    };
 
-    Rec* rec = fTail;
-    while (rec) {
-        if (!forcePurge && fTotalBytesUsed < byteLimit && fCount < countLimit) {
-            break;
+    SkAutoMutexExclusive purgeLock(fPurgeMutex);
+    while (overBudget()) {
+        // The oldest purgeable rec in the cache is the oldest of those at the end of each shard.
+        // We purge from that shard until its recs are newer than the runner up's.
+        Shard* oldest = nullptr;
+        uint64_t oldestUse = std::numeric_limits<uint64_t>::max(),
+                 runnerUpUse = std::numeric_limits<uint64_t>::max();
+        for (int i = 0; i < kShardCount; ++i) {
+            SkAutoMutexExclusive lock(fShards[i].fMutex);
+            if (Rec* rec = oldest_purgeable(fShards[i].fTail)) {
+                if (rec->fLastUse < oldestUse) {
+                    runnerUpUse = oldestUse;
+                    oldestUse = rec->fLastUse;
+                    oldest = &fShards[i];
+                } else {
+                    runnerUpUse = std::min(runnerUpUse, rec->fLastUse);
+                }
+            }
+        }
+        if (!oldest) {
+            break;  // nothing left that can be purged
         }
 
-        Rec* prev = rec->fPrev;
-        if (rec->canBePurged()) {
-            this->remove(rec);
+        // Another thread may have found or removed these recs since we looked; if so, look again.
+        SkAutoMutexExclusive lock(oldest->fMutex);
+        Rec* rec = oldest_purgeable(oldest->fTail);
+        while (rec && rec->fLastUse <= runnerUpUse) {
+            Rec* prev = rec->fPrev;
+            this->remove(oldest, rec);
+            if (!overBudget()) {
+                break;
+            }
+            rec = oldest_purgeable(prev);
         }
-        rec = prev;
     }
 }
 
@@ -254,22 +310,27 @@ void SkResourceCache::purgeSharedID(uint64_t sharedID) {
     gPurgeCallCounter += 1;
     bool found = false;
 #endif
-    // go backwards, just like purgeAsNeeded, just to make the code similar.
-    // could iterate either direction and still be correct.
-    Rec* rec = fTail;
-    while (rec) {
-        Rec* prev = rec->fPrev;
-        if (rec->getKey().getSharedID() == sharedID) {
-            // even though the "src" is now dead, caches could still be in-flight, so
-            // we have to check if it can be removed.
-            if (rec->canBePurged()) {
-                this->remove(rec);
-            }
+    for (int i = 0; i < kShardCount; ++i) {
+        Shard* shard = &fShards[i];
+        SkAutoMutexExclusive lock(shard->fMutex);
+
+        // go backwards, just like purgeAsNeeded, just to make the code similar.
+        // could iterate either direction and still be correct.
+        Rec* rec = shard->fTail;
+        while (rec) {
+            Rec* prev = rec->fPrev;
+            if (rec->getKey().getSharedID() == sharedID) {
+                // even though the "src" is now dead, caches could still be in-flight, so
+                // we have to check if it can be removed.
+                if (rec->canBePurged()) {
+                    this->remove(shard, rec);
+                }
 #ifdef SK_TRACK_PURGE_SHAREDID_HITRATE
-            found = true;
+                found = true;
 #endif
+            }
+            rec = prev;
         }
-        rec = prev;
     }
 
 #ifdef SK_TRACK_PURGE_SHAREDID_HITRATE
@@ -283,20 +344,23 @@ void SkResourceCache::purgeSharedID(uint64_t sharedID) {
 }
 
 void SkResourceCache::visitAll(Visitor visitor, void* context) {
-    // go backwards, just like purgeAsNeeded, just to make the code similar.
-    // could iterate either direction and still be correct.
-    Rec* rec = fTail;
-    while (rec) {
-        visitor(*rec, context);
-        rec = rec->fPrev;
+    for (int i = 0; i < kShardCount; ++i) {
+        SkAutoMutexExclusive lock(fShards[i].fMutex);
+
+        // go backwards, just like purgeAsNeeded, just to make the code similar.
+        // could iterate either direction and still be correct.
+        Rec* rec = fShards[i].fTail;
+        while (rec) {
+            visitor(*rec, context);
+            rec = rec->fPrev;
+        }
     }
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
 size_t SkResourceCache::setTotalByteLimit(size_t newLimit) {
-    size_t prevLimit = fTotalByteLimit;
-    fTotalByteLimit = newLimit;
+    size_t prevLimit = fTotalByteLimit.exchange(newLimit);
     if (newLimit < prevLimit) {
         this->purgeAsNeeded();
     }
@@ -316,19 +380,19 @@ SkCachedData* SkResourceCache::newCachedData(size_t bytes) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-void SkResourceCache::release(Rec* rec) {
+void SkResourceCache::release(Shard* shard, Rec* rec) {
     Rec* prev = rec->fPrev;
     Rec* next = rec->fNext;
 
     if (!prev) {
-        SkASSERT(fHead == rec);
-        fHead = next;
+        SkASSERT(shard->fHead == rec);
+        shard->fHead = next;
     } else {
         prev->fNext = next;
     }
 
     if (!next) {
-        fTail = prev;
+        shard->fTail = prev;
     } else {
         next->fPrev = prev;
     }
@@ -336,101 +400,76 @@ void SkResourceCache::release(Rec* rec) {
     rec->fNext = rec->fPrev = nullptr;
 }
 
-void SkResourceCache::moveToHead(Rec* rec) {
-    if (fHead == rec) {
+void SkResourceCache::moveToHead(Shard* shard, Rec* rec) {
+    if (shard->fHead == rec) {
+        rec->fLastUse = fUseCounter.fetch_add(1, std::memory_order_relaxed);
         return;
     }
 
-    SkASSERT(fHead);
-    SkASSERT(fTail);
+    SkASSERT(shard->fHead);
+    SkASSERT(shard->fTail);
 
-    this->validate();
+    this->validate(*shard);
 
-    this->release(rec);
+    this->release(shard, rec);
 
-    fHead->fPrev = rec;
-    rec->fNext = fHead;
-    fHead = rec;
+    shard->fHead->fPrev = rec;
+    rec->fNext = shard->fHead;
+    rec->fLastUse = fUseCounter.fetch_add(1, std::memory_order_relaxed);
+    shard->fHead = rec;
 
-    this->validate();
+    this->validate(*shard);
 }
 
-void SkResourceCache::addToHead(Rec* rec) {
-    this->validate();
+void SkResourceCache::addToHead(Shard* shard, Rec* rec) {
+    this->validate(*shard);
 
+    rec->fLastUse = fUseCounter.fetch_add(1, std::memory_order_relaxed);
     rec->fPrev = nullptr;
-    rec->fNext = fHead;
-    if (fHead) {
-        fHead->fPrev = rec;
+    rec->fNext = shard->fHead;
+    if (shard->fHead) {
+        shard->fHead->fPrev = rec;
     }
-    fHead = rec;
-    if (!fTail) {
-        fTail = rec;
+    shard->fHead = rec;
+    if (!shard->fTail) {
+        shard->fTail = rec;
     }
     fTotalBytesUsed += rec->bytesUsed();
     fCount += 1;
 
-    this->validate();
+    this->validate(*shard);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 #ifdef SK_DEBUG
-void SkResourceCache::validate() const {
-    if (nullptr == fHead) {
-        SkASSERT(nullptr == fTail);
-        SkASSERT(0 == fTotalBytesUsed);
-        return;
-    }
-
-    if (fHead == fTail) {
-        SkASSERT(nullptr == fHead->fPrev);
-        SkASSERT(nullptr == fHead->fNext);
-        SkASSERT(fHead->bytesUsed() == fTotalBytesUsed);
+// Other shards may be changing the totals, so we can only check this shard's list.
+void SkResourceCache::validate(const Shard& shard) const {
+    if (nullptr == shard.fHead) {
+        SkASSERT(nullptr == shard.fTail);
         return;
     }
 
-    SkASSERT(nullptr == fHead->fPrev);
-    SkASSERT(fHead->fNext);
-    SkASSERT(nullptr == fTail->fNext);
-    SkASSERT(fTail->fPrev);
+    SkASSERT(nullptr == shard.fHead->fPrev);
+    SkASSERT(nullptr == shard.fTail->fNext);
 
-    size_t used = 0;
-    int count = 0;
-    const Rec* rec = fHead;
+    const Rec* rec = shard.fHead;
     while (rec) {
-        count += 1;
-        used += rec->bytesUsed();
-        SkASSERT(used <= fTotalBytesUsed);
+        SkASSERT(!rec->fNext || rec->fNext->fPrev == rec);
+        SkASSERT(!rec->fNext || rec->fNext->fLastUse < rec->fLastUse);
+        SkASSERT(rec->fNext || rec == shard.fTail);
         rec = rec->fNext;
     }
-    SkASSERT(fCount == count);
-
-    rec = fTail;
-    while (rec) {
-        SkASSERT(count > 0);
-        count -= 1;
-        SkASSERT(used >= rec->bytesUsed());
-        used -= rec->bytesUsed();
-        rec = rec->fPrev;
-    }
-
-    SkASSERT(0 == count);
-    SkASSERT(0 == used);
 }
 #endif
 
 void SkResourceCache::dump() const {
-    this->validate();
-
     SkDebugf("SkResourceCache: count=%d bytes=%zu %s\n",
-             fCount, fTotalBytesUsed, fDiscardableFactory ? "discardable" : "malloc");
+             fCount.load(), fTotalBytesUsed.load(), fDiscardableFactory ? "discardable" : "malloc");
 }
 
 size_t SkResourceCache::setSingleAllocationByteLimit(size_t newLimit) {
-    size_t oldLimit = fSingleAllocationByteLimit;
-    fSingleAllocationByteLimit = newLimit;
-    return oldLimit;
+    return fSingleAllocationByteLimit.exchange(newLimit);
 }
 
 size_t SkResourceCache::getSingleAllocationByteLimit() const {
@@ -447,7 +486,7 @@ size_t SkResourceCache::getEffectiveSingleAllocationByteLimit() const {
         if (0 == limit) {
             limit = fTotalByteLimit;
         } else {
-            limit = std::min(limit, fTotalByteLimit);
+            limit = std::min(limit, fTotalByteLimit.load());
         }
     }
     return limit;
@@ -463,93 +502,72 @@ void SkResourceCache::checkMessages() {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-static SkResourceCache* gResourceCache = nullptr;
-static SkMutex& resource_cache_mutex() {
-    static SkMutex& mutex = *(new SkMutex);
-    return mutex;
-}
-
-/** Must hold resource_cache_mutex() when calling. */
 static SkResourceCache* get_cache() {
-    // resource_cache_mutex() is always held when this is called, so we don't need to be fancy in here.
-    resource_cache_mutex().assertHeld();
-    if (nullptr == gResourceCache) {
+    static SkOnce once;
+    static SkResourceCache* cache;
+    once([] {
 #ifdef SK_USE_DISCARDABLE_SCALEDIMAGECACHE
-        gResourceCache = new SkResourceCache(SkDiscardableMemory::Create);
+        cache = new SkResourceCache(SkDiscardableMemory::Create);
 #else
-        gResourceCache = new SkResourceCache(SK_DEFAULT_IMAGE_CACHE_LIMIT);
+        cache = new SkResourceCache(SK_DEFAULT_IMAGE_CACHE_LIMIT);
 #endif
-    }
-    return gResourceCache;
+    });
+    return cache;
 }
 
 size_t SkResourceCache::GetTotalBytesUsed() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->getTotalBytesUsed();
 }
 
 size_t SkResourceCache::GetTotalByteLimit() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->getTotalByteLimit();
 }
 
 size_t SkResourceCache::SetTotalByteLimit(size_t newLimit) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->setTotalByteLimit(newLimit);
 }
 
 SkResourceCache::DiscardableFactory SkResourceCache::GetDiscardableFactory() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->discardableFactory();
 }
 
 SkCachedData* SkResourceCache::NewCachedData(size_t bytes) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->newCachedData(bytes);
 }
 
 void SkResourceCache::Dump() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     get_cache()->dump();
 }
 
 size_t SkResourceCache::SetSingleAllocationByteLimit(size_t size) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->setSingleAllocationByteLimit(size);
 }
 
 size_t SkResourceCache::GetSingleAllocationByteLimit() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->getSingleAllocationByteLimit();
 }
 
 size_t SkResourceCache::GetEffectiveSingleAllocationByteLimit() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->getEffectiveSingleAllocationByteLimit();
 }
 
 void SkResourceCache::PurgeAll() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->purgeAll();
 }
 
 void SkResourceCache::CheckMessages() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->checkMessages();
 }
 
 bool SkResourceCache::Find(const Key& key, FindVisitor visitor, void* context) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     return get_cache()->find(key, visitor, context);
 }
 
 void SkResourceCache::Add(Rec* rec, void* payload) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     get_cache()->add(rec, payload);
 }
 
 void SkResourceCache::VisitAll(Visitor visitor, void* context) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
     get_cache()->visitAll(visitor, context);
 }
 
@@ -9,10 +9,13 @@
 #define SkResourceCache_DEFINED
 
 #include "include/private/base/SkDebug.h"
+#include "include/private/base/SkMutex.h"
 #include "src/core/SkMessageBus.h"
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 
 class SkCachedData;
 class SkDiscardableMemory;
@@ -21,12 +24,13 @@ class SkTraceMemoryDump;
 /**
  *  Cache object for bitmaps (with possible scale in X Y as part of the key).
  *
- *  Multiple caches can be instantiated, but each instance is not implicitly
- *  thread-safe, so if a given instance is to be shared across threads, the
- *  caller must manage the access itself (e.g. via a mutex).
+ *  Multiple caches can be instantiated, and each instance is thread-safe. The recs are split
+ *  into shards by the hash of their key, each with its own lock, so that finds and adds from
+ *  different threads rarely contend. The budget and the LRU purge order are still shared by the
+ *  whole cache.
  *
- *  As a convenience, a global instance is also defined, which can be safely
- *  access across threads via the static methods (e.g. FindAndLock, etc.).
+ *  As a convenience, a global instance is also defined, which can be
+ *  accessed via the static methods (e.g. FindAndLock, etc.).
  */
 class SkResourceCache {
 public:
@@ -105,8 +109,9 @@ public:
         virtual SkDiscardableMemory* diagnostic_only_getDiscardable() const { return nullptr; }
 
     private:
-        Rec*    fNext;
-        Rec*    fPrev;
+        Rec*     fNext;
+        Rec*     fPrev;
+        uint64_t fLastUse;  // When this was last added or found, for LRU order across shards.
 
         friend class SkResourceCache;
     };
@@ -223,8 +228,8 @@ public:
     void add(Rec*, void* payload = nullptr);
     void visitAll(Visitor, void* context);
 
-    size_t getTotalBytesUsed() const { return fTotalBytesUsed; }
-    size_t getTotalByteLimit() const { return fTotalByteLimit; }
+    size_t getTotalBytesUsed() const { return fTotalBytesUsed.load(std::memory_order_relaxed); }
+    size_t getTotalByteLimit() const { return fTotalByteLimit.load(std::memory_order_relaxed); }
 
     /**
      *  This is respected by SkBitmapProcState::possiblyScaleImage.
@@ -260,36 +265,44 @@ public:
     void dump() const;
 
 private:
-    Rec*    fHead;
-    Rec*    fTail;
-
     class Hash;
-    Hash*   fHash;
+    struct Shard;
+
+    // A power of 2; shards are picked by the top bits of the key hash.
+    static constexpr int kShardBits  = 4;
+    static constexpr int kShardCount = 1 << kShardBits;
+    std::unique_ptr<Shard[]> fShards;
 
     DiscardableFactory  fDiscardableFactory;
 
-    size_t  fTotalBytesUsed;
-    size_t  fTotalByteLimit;
-    size_t  fSingleAllocationByteLimit;
-    int     fCount;
+    std::atomic<size_t>   fTotalBytesUsed;
+    std::atomic<size_t>   fTotalByteLimit;
+    std::atomic<size_t>   fSingleAllocationByteLimit;
+    std::atomic<int>      fCount;
+    std::atomic<uint64_t> fUseCounter;
+
+    // Held while purging, so only one thread at a time picks recs to evict.
+    SkMutex fPurgeMutex;
 
     SkMessageBus<PurgeSharedIDMessage, uint32_t>::Inbox fPurgeSharedIDInbox;
 
+    Shard& shardFor(uint32_t hash) const;
+
     void checkMessages();
     void purgeAsNeeded(bool forcePurge = false);
 
-    // linklist management
-    void moveToHead(Rec*);
-    void addToHead(Rec*);
-    void release(Rec*);
-    void remove(Rec*);
+    // linklist management, each called with the shard's mutex held
+    void moveToHead(Shard*, Rec*);
+    void addToHead(Shard*, Rec*);
+    void release(Shard*, Rec*);
+    void remove(Shard*, Rec*);
 
     void init();    // called by constructors
 
 #ifdef SK_DEBUG
-    void validate() const;
+    void validate(const Shard&) const;
 #else
-    void validate() const {}
+    void validate(const Shard&) const {}
 #endif
 };
 #endif
@@ -42,6 +42,13 @@ public:
     // SkRegions together.
     static bool PathRequiresTiling(const SkIRect& bounds);
 
+    // Antialiased fill using an accumulation buffer rather than analytic AA, which is faster for
+    // paths made of many small segments. AntiFillPath() uses it when gSkUseAccumulationAA is set.
+    // Draws only within the intersection of clipBounds and pathIR (the rounded out path bounds),
+    // except that inverse fills span the whole width of clipBounds.
+    static void AccumFillPath(const SkPath&, SkBlitter*, const SkIRect& pathIR,
+                              const SkIRect& clipBounds);
+
     ///////////////////////////////////////////////////////////////////////////
     // rasterclip
 
@@ -0,0 +1,396 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkPath.h"
+#include "include/core/SkPathTypes.h"
+#include "include/core/SkPoint.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkScalar.h"
+#include "include/core/SkTypes.h"
+#include "include/private/base/SkAlign.h"
+#include "include/private/base/SkMalloc.h"
+#include "include/private/base/SkTArray.h"
+#include "include/private/base/SkTPin.h"
+#include "include/private/base/SkTemplates.h"
+#include "include/private/base/SkTo.h"
+#include "src/base/SkUtils.h"
+#include "src/base/SkVx.h"
+#include "src/core/SkBlitter.h"
+#include "src/core/SkGeometry.h"
+#include "src/core/SkPathPriv.h"
+#include "src/core/SkScan.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+using namespace skia_private;
+
+// An accumulation-buffer scan converter. Each line segment of the path adds the signed area it
+// covers in each pixel to a buffer, along with the coverage it carries over to the pixels on its
+// right; a prefix sum along each row then gives every pixel's (winding-weighted) coverage. There
+// is no edge list to sort and walk, so the cost is linear in the number of segments plus the
+// pixels they cross, which pays off for paths made of very many short segments.
+//
+// The path is rasterized one band of kBandHeight rows at a time. The prefix sums and the
+// conversion to alpha run on skvx vectors across each row of the band.
+
+namespace {
+
+constexpr int kBandHeight = 16;
+constexpr int kLanes = 8;
+using F = skvx::Vec<kLanes, float>;
+
+// Curves are flattened to lines that stray no more than this far from the curve (in pixels).
+constexpr float kFlattenTolerance = 1 / 32.0f;
+constexpr float kMaxCurveSegments = 256;
+
+struct Line {
+    float fX0, fY0, fX1, fY1;  // fY0 < fY1
+    float fWinding;            // +1 if the segment points down, -1 if it points up.
+};
+
+// Flattens a path into lines, dropping the horizontal ones and those outside [top, bottom).
+class LineBuilder {
+public:
+    LineBuilder(int top, int bottom) : fTop(top), fBottom(bottom) {}
+
+    void addPath(const SkPath& path) {
+        SkAutoConicToQuads quadder;
+        SkPathEdgeIter iter(path);
+        while (auto e = iter.next()) {
+            switch (e.fEdge) {
+                case SkPathEdgeIter::Edge::kLine:
+                    this->addLine(e.fPts[0], e.fPts[1]);
+                    break;
+                case SkPathEdgeIter::Edge::kQuad:
+                    this->addQuad(e.fPts);
+                    break;
+                case SkPathEdgeIter::Edge::kConic: {
+                    const SkPoint* quadPts =
+                            quadder.computeQuads(e.fPts, iter.conicWeight(), kFlattenTolerance);
+                    for (int i = 0; i < quadder.countQuads(); ++i) {
+                        this->addQuad(quadPts + 2 * i);
+                    }
+                } break;
+                case SkPathEdgeIter::Edge::kCubic:
+                    this->addCubic(e.fPts);
+                    break;
+            }
+        }
+    }
+
+    TArray<Line>& lines() { return fLines; }
+
+private:
+    void addLine(SkPoint p0, SkPoint p1) {
+        float winding = 1;
+        if (p0.fY > p1.fY) {
+            std::swap(p0, p1);
+            winding = -1;
+        }
+        if (p0.fY == p1.fY || p1.fY <= fTop || p0.fY >= fBottom) {
+            return;
+        }
+        fLines.push_back({p0.fX, p0.fY, p1.fX, p1.fY, winding});
+    }
+
+    // Flattening a curve into n equal steps of t strays at most errorScale / n^2 from the curve.
+    static int SegmentCount(float errorScale) {
+        const float n = std::ceil(std::sqrt(errorScale / kFlattenTolerance));
+        return std::max(1, (int)std::min(n, kMaxCurveSegments));
+    }
+
+    template <typename Coeff>
+    void addCurve(const SkPoint pts[], int last, Coeff coeff, int n) {
+        SkPoint prev = pts[0];
+        for (int i = 1; i < n; ++i) {
+            const skvx::float2 p = coeff.eval(skvx::float2(i / (float)n));
+            const SkPoint next = {p[0], p[1]};
+            this->addLine(prev, next);
+            prev = next;
+        }
+        this->addLine(prev, pts[last]);
+    }
+
+    void addQuad(const SkPoint pts[3]) {
+        const float dd = (pts[0] - pts[1] + (pts[2] - pts[1])).length();
+        this->addCurve(pts, 2, SkQuadCoeff(pts), SegmentCount(dd / 4));
+    }
+
+    void addCubic(const SkPoint pts[4]) {
+        const float dd = std::max((pts[0] - pts[1] + (pts[2] - pts[1])).length(),
+                                  (pts[1] - pts[2] + (pts[3] - pts[2])).length());
+        this->addCurve(pts, 3, SkCubicCoeff(pts), SegmentCount(dd * 3 / 4));
+    }
+
+    const float  fTop, fBottom;
+    TArray<Line> fLines;
+};
+
+// Shifts the lanes of v up, filling the vacated low lanes with zero. Ix picks the lanes of
+// {0,...,0, v[0],...,v[7]}, so <7,8,...,14> shifts up by one.
+template <int... Ix>
+static F shift_up(const F& v) {
+    return skvx::shuffle<Ix...>(skvx::join(F(0), v));
+}
+
+class Accumulator {
+public:
+    Accumulator(const SkIRect& bounds, SkPathFillType fillType)
+            : fBounds(bounds)
+            , fWidth(bounds.width())
+            // Lines write up to two slots past the right edge, and vectors may read a whole
+            // vector past the last dirty slot.
+            , fStride(SkAlign8(fWidth + 2) + kLanes)
+            , fEvenOdd(SkPathFillType_IsEvenOdd(fillType))
+            , fInverse(SkPathFillType_IsInverse(fillType))
+            , fAcc(fStride * kBandHeight)
+            , fAlpha(fStride)
+            , fRuns(fWidth + 1) {
+        static_assert(kLanes == 8, "shift_up() calls below assume 8 lanes.");
+        SkASSERT(fWidth <= SK_MaxS16);
+        sk_bzero(fAcc.get(), fStride * kBandHeight * sizeof(float));
+        this->resetDirty();
+    }
+
+    void accumulate(const Line& l, int bandTop, int bandBottom) {
+        float top = std::max(l.fY0, (float)bandTop);
+        const float bottom = std::min(l.fY1, (float)bandBottom);
+        if (top >= bottom) {
+            return;
+        }
+        const float dxdy = (l.fX1 - l.fX0) / (l.fY1 - l.fY0);
+        const float x0 = l.fX0 - fBounds.fLeft;
+        float xTop = x0 + (top - l.fY0) * dxdy;
+        for (int y = (int)top, yEnd = (int)std::ceil(bottom); y < yEnd; ++y) {
+            const float rowBottom = std::min(bottom, y + 1.0f);
+            const float xBottom = x0 + (rowBottom - l.fY0) * dxdy;
+            this->accumulateRow(y - bandTop, xTop, xBottom, (rowBottom - top) * l.fWinding);
+            top = rowBottom;
+            xTop = xBottom;
+        }
+    }
+
+    void blitBand(SkBlitter* blitter, int bandTop, int bandBottom) {
+        for (int y = bandTop; y < bandBottom; ++y) {
+            const int row = y - bandTop;
+            int start = fDirtyLeft[row],
+                stop = fDirtyRight[row] + 1;
+            if (fInverse) {
+                start = 0;
+                stop = std::max(stop, fWidth);
+            } else if (start >= stop) {
+                continue;
+            }
+            this->resolveRow(fAcc.get() + row * fStride, start, stop);
+            this->blitRow(blitter, y, start, std::min(stop, fWidth));
+        }
+        this->resetDirty();
+    }
+
+private:
+    void resetDirty() {
+        std::fill_n(fDirtyLeft, kBandHeight, fWidth + 2);
+        std::fill_n(fDirtyRight, kBandHeight, -1);
+    }
+
+    // Adds a line crossing one row, from xTop at its top to xBottom at its bottom, with d being
+    // the height of the crossing times its winding.
+    void accumulateRow(int row, float xTop, float xBottom, float d) {
+        // Lines left of the bounds still carry their coverage across the row, as if they ran
+        // down its left edge; lines right of it don't matter. So lines can be clamped to the
+        // bounds, but only once split where they cross its left or right edge.
+        for (float edge : {0.0f, (float)fWidth}) {
+            if ((xTop < edge && xBottom > edge) || (xTop > edge && xBottom < edge)) {
+                const float t = (edge - xTop) / (xBottom - xTop);
+                this->accumulateRow(row, xTop, edge, d * t);
+                this->accumulateRow(row, edge, xBottom, d - d * t);
+                return;
+            }
+        }
+        float* acc = fAcc.get() + row * fStride;
+        xTop    = SkTPin(xTop,    0.0f, (float)fWidth);
+        xBottom = SkTPin(xBottom, 0.0f, (float)fWidth);
+        const float x0 = std::min(xTop, xBottom),
+                    x1 = std::max(xTop, xBottom);
+        const int x0i = (int)x0,
+                  x1i = (int)std::ceil(x1);
+        int right;
+        if (x1i <= x0i + 1) {
+            // The line stays within one pixel: it covers the part right of its mean x.
+            const float xm = 0.5f * (xTop + xBottom) - x0i;
+            acc[x0i]     += d - d * xm;
+            acc[x0i + 1] += d * xm;
+            right = x0i + 1;
+        } else {
+            // The covered area grows quadratically across the first pixel, linearly across the
+            // middle ones, and then tapers off quadratically across the last.
+            const float s   = 1 / (x1 - x0),
+                        x0f = x0 - x0i,
+                        x1f = x1 - x1i + 1,
+                        a0  = 0.5f * s * (1 - x0f) * (1 - x0f),
+                        am  = 0.5f * s * x1f * x1f;
+            acc[x0i] += d * a0;
+            if (x1i == x0i + 2) {
+                acc[x0i + 1] += d * (1 - a0 - am);
+            } else {
+                const float a1 = s * (1.5f - x0f);
+                acc[x0i + 1] += d * (a1 - a0);
+                for (int x = x0i + 2; x < x1i - 1; ++x) {
+                    acc[x] += d * s;
+                }
+                const float a2 = a1 + (x1i - x0i - 3) * s;
+                acc[x1i - 1] += d * (1 - a2 - am);
+            }
+            acc[x1i] += d * am;
+            right = x1i;
+        }
+        fDirtyLeft[row]  = std::min(fDirtyLeft[row], x0i);
+        fDirtyRight[row] = std::max(fDirtyRight[row], right);
+    }
+
+    // Prefix sums acc[start, stop) into coverage, written to fAlpha, and clears acc as it goes.
+    // Past the last dirty slot of a row the sum is zero again, so everything right of 'stop' is
+    // either uncovered or (for inverse fills) fully covered.
+    void resolveRow(float* acc, int start, int stop) {
+        SkAlpha* alpha = fAlpha.get();
+        F carry = 0;
+        uint64_t carryAlpha = fInverse ? 0xFF : 0;
+        for (int x = start; x < stop; x += kLanes) {
+            // If no lines cross these pixels (as in the interior of a shape), they all have the
+            // coverage carried in from the left. Checking the bits is cheaper than comparing.
+            static_assert(kLanes * sizeof(float) == 4 * sizeof(uint64_t));
+            const char* bits = reinterpret_cast<const char*>(acc + x);
+            if ((sk_unaligned_load<uint64_t>(bits +  0) | sk_unaligned_load<uint64_t>(bits +  8) |
+                 sk_unaligned_load<uint64_t>(bits + 16) | sk_unaligned_load<uint64_t>(bits + 24))
+                == 0) {
+                sk_unaligned_store(alpha + x, carryAlpha * 0x0101010101010101ull);
+                continue;
+            }
+            F v = F::Load(acc + x);
+            F(0).store(acc + x);
+
+            v += shift_up<7, 8, 9, 10, 11, 12, 13, 14>(v);
+            v += shift_up<6, 7, 8, 9, 10, 11, 12, 13>(v);
+            v += shift_up<4, 5, 6, 7, 8, 9, 10, 11>(v);
+            v += carry;
+            carry = v[kLanes - 1];
+
+            F coverage = abs(v);
+            if (fEvenOdd) {
+                coverage -= 2.0f * floor(coverage * 0.5f);
+                coverage = min(coverage, 2.0f - coverage);
+            } else {
+                coverage = min(coverage, 1.0f);
+            }
+            if (fInverse) {
+                coverage = 1.0f - coverage;
+            }
+            skvx::cast<uint8_t>(coverage * 255 + 0.5f).store(alpha + x);
+            carryAlpha = alpha[x + kLanes - 1];
+        }
+    }
+
+    // Blits fAlpha[start, stop) for this row as runs of equal alpha, trimming uncovered ends.
+    void blitRow(SkBlitter* blitter, int y, int start, int stop) {
+        const SkAlpha* alpha = fAlpha.get();
+        while (start < stop && alpha[start] == 0) {
+            start++;
+        }
+        while (stop > start && alpha[stop - 1] == 0) {
+            stop--;
+        }
+        if (start == stop) {
+            return;
+        }
+        // blitAntiH() reads the alpha of each run from its first pixel, so fAlpha can be passed
+        // as is; only the run lengths need filling in.
+        int16_t* runs = fRuns.get() - start;
+        for (int x = start; x < stop;) {
+            // Long runs are common (e.g. across the interior of a shape), so look 8 at a time.
+            const uint64_t run = alpha[x] * 0x0101010101010101ull;
+            int end = x + 1;
+            while (end + 8 <= stop && sk_unaligned_load<uint64_t>(alpha + end) == run) {
+                end += 8;
+            }
+            while (end < stop && alpha[end] == alpha[x]) {
+                end++;
+            }
+            runs[x] = SkToS16(end - x);
+            x = end;
+        }
+        runs[stop] = 0;
+        blitter->blitAntiH(fBounds.fLeft + start, y, alpha + start, runs + start);
+    }
+
+    const SkIRect      fBounds;
+    const int          fWidth;
+    const int          fStride;
+    const bool         fEvenOdd;
+    const bool         fInverse;
+    AutoTMalloc<float> fAcc;    // kBandHeight rows of fStride signed areas.
+    AutoTMalloc<SkAlpha> fAlpha;
+    AutoTMalloc<int16_t> fRuns;
+    // The range of slots of each row in the band that lines have written to.
+    int fDirtyLeft[kBandHeight];
+    int fDirtyRight[kBandHeight];
+};
+
+}  // namespace
+
+void SkScan::AccumFillPath(const SkPath& path,
+                           SkBlitter* blitter,
+                           const SkIRect& ir,
+                           const SkIRect& clipBounds) {
+    // Inverse fills cover the whole width of the clip; the rows above and below ir are left to
+    // the caller.
+    SkIRect bounds;
+    if (path.isInverseFillType()) {
+        bounds = {clipBounds.fLeft,
+                  std::max(ir.fTop, clipBounds.fTop),
+                  clipBounds.fRight,
+                  std::min(ir.fBottom, clipBounds.fBottom)};
+        if (bounds.isEmpty()) {
+            return;
+        }
+    } else if (!bounds.intersect(ir, clipBounds)) {
+        return;
+    }
+
+    LineBuilder builder(bounds.fTop, bounds.fBottom);
+    builder.addPath(path);
+    TArray<Line>& lines = builder.lines();
+    std::sort(lines.begin(), lines.end(), [](const Line& a, const Line& b) {
+        return a.fY0 < b.fY0;
+    });
+
+    Accumulator accumulator(bounds, path.getFillType());
+    TArray<Line> active;
+    int next = 0;
+    for (int top = bounds.fTop; top < bounds.fBottom; top += kBandHeight) {
+        const int bottom = std::min(top + kBandHeight, bounds.fBottom);
+
+        // Drop the lines that ended above this band, and pick up the ones that start in it.
+        int kept = 0;
+        for (const Line& l : active) {
+            if (l.fY1 > top) {
+                active[kept++] = l;
+            }
+        }
+        active.resize_back(kept);
+        for (; next < lines.size() && lines[next].fY0 < bottom; ++next) {
+            active.push_back(lines[next]);
+        }
+
+        for (const Line& l : active) {
+            accumulator.accumulate(l, top, bottom);
+        }
+        accumulator.blitBand(blitter, top, bottom);
+    }
+}
@@ -19,6 +19,10 @@
 
 #include <cstdint>
 
+// Set by tools (e.g. --accumulationAA in dm and nanobench) to scan convert antialiased path fills
+// with SkScan::AccumFillPath() instead of analytic AA.
+bool gSkUseAccumulationAA{false};
+
 static SkIRect safeRoundOut(const SkRect& src) {
     // roundOut will pin huge floats to max/min int
     SkIRect dst = src.roundOut();
@@ -126,7 +130,11 @@ void SkScan::AntiFillPath(const SkPath& path, const SkRegion& origClip,
         sk_blit_above(blitter, ir, *clipRgn);
     }
 
-    SkScan::AAAFillPath(path, blitter, ir, clipRgn->getBounds(), forceRLE);
+    if (gSkUseAccumulationAA) {
+        SkScan::AccumFillPath(path, blitter, ir, clipRgn->getBounds());
+    } else {
+        SkScan::AAAFillPath(path, blitter, ir, clipRgn->getBounds(), forceRLE);
+    }
 
     if (isInverse) {
         sk_blit_below(blitter, ir, *clipRgn);
@@ -445,9 +445,9 @@ SkSpan<const SkGlyph*> SkStrike::internalPrepare(
 
 void SkStrike::updateMemoryUsage(size_t increase) {
     if (increase > 0) {
-        // fRemoved and the cache's total memory are managed under the cache's lock. This allows
-        // them to be accessed under LRU operation.
-        SkAutoMutexExclusive lock{fStrikeCache->fLock};
+        // fRemoved is managed under the lock of the cache's shard for this strike. This allows
+        // it to be accessed under LRU operation.
+        SkAutoMutexExclusive lock{fStrikeCache->shardFor(this->getDescriptor()).fLock};
         fMemoryUsed += increase;
         if (!fRemoved) {
             fStrikeCache->fTotalMemoryUsed += increase;
@@ -29,7 +29,15 @@ namespace SkOpts {
                            RGB_to_BGR1,     // i.e. swap RB and insert an opaque alpha
                            gray_to_RGB1,    // i.e. expand to color channels + an opaque alpha
                            grayA_to_RGBA,   // i.e. expand to color channels
-                           grayA_to_rgbA;   // i.e. expand to color channels and premultiply
+                           grayA_to_rgbA,   // i.e. expand to color channels and premultiply
+                           RGB16_to_RGB1,   // i.e. keep the high byte of big-endian channels
+                           RGB16_to_BGR1,   //      ... and swap RB
+                           RGBA16_to_RGBA,  //      ... and keep alpha
+                           RGBA16_to_BGRA;  //      ... and keep alpha, swap RB
+
+    // Look up 8-bit indices in a 256-entry table of 8888 pixels, e.g. a PNG palette.
+    using Lookup_8888_u8 = void (*)(uint32_t*, const uint8_t*, int, const uint32_t table[256]);
+    extern Lookup_8888_u8 index_to_8888;
 
     void Init_Swizzler();
 }  // namespace SkOpts
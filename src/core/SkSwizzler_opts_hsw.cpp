@@ -31,11 +31,16 @@ namespace SkOpts {
         RGBA_to_BGRA          = hsw::RGBA_to_BGRA;
         RGBA_to_rgbA          = hsw::RGBA_to_rgbA;
         RGBA_to_bgrA          = hsw::RGBA_to_bgrA;
+        rgbA_to_RGBA          = hsw::rgbA_to_RGBA;
+        rgbA_to_BGRA          = hsw::rgbA_to_BGRA;
         gray_to_RGB1          = hsw::gray_to_RGB1;
         grayA_to_RGBA         = hsw::grayA_to_RGBA;
         grayA_to_rgbA         = hsw::grayA_to_rgbA;
         inverted_CMYK_to_RGB1 = hsw::inverted_CMYK_to_RGB1;
         inverted_CMYK_to_BGR1 = hsw::inverted_CMYK_to_BGR1;
+        RGBA16_to_RGBA        = hsw::RGBA16_to_RGBA;
+        RGBA16_to_BGRA        = hsw::RGBA16_to_BGRA;
+        index_to_8888         = hsw::index_to_8888;
     }
 }  // namespace SkOpts
 
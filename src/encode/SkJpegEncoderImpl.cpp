@@ -25,19 +25,23 @@
 #include "src/base/SkMSAN.h"
 #include "src/codec/SkJpegConstants.h"
 #include "src/codec/SkJpegPriv.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/encode/SkImageEncoderFns.h"
 #include "src/encode/SkImageEncoderPriv.h"
 #include "src/encode/SkJPEGWriteUtility.h"
 #include "src/image/SkImage_Base.h"
 
+#include <algorithm>
 #include <csetjmp>
 #include <cstdint>
 #include <cstring>
 #include <memory>
 #include <utility>
+#include <vector>
 
 class GrDirectContext;
 class SkColorSpace;
+class SkExecutor;
 class SkImage;
 
 extern "C" {
@@ -67,6 +71,10 @@ public:
 
     transform_scanline_proc proc() const { return fProc; }
 
+    // Writes rows [top, top + numRows) of |src|, converting them into |storage| if there is a
+    // proc().
+    void writeRows(const SkPixmap& src, int top, int numRows, uint8_t* storage);
+
     ~SkJpegEncoderMgr() { jpeg_destroy_compress(&fCInfo); }
 
 private:
@@ -84,9 +92,13 @@ private:
     transform_scanline_proc fProc;
 };
 
-bool SkJpegEncoderMgr::initializeRGB(const SkImageInfo& srcInfo,
-                                     const SkJpegEncoder::Options& options,
-                                     const SkJpegMetadataEncoder::SegmentList& metadataSegments) {
+// Chooses how the rows of |srcInfo| are passed to libjpeg, or returns false if they can't be
+// encoded.
+static bool choose_rgb_input(const SkImageInfo& srcInfo,
+                             const SkJpegEncoder::Options& options,
+                             transform_scanline_proc* proc,
+                             J_COLOR_SPACE* jpegColorType,
+                             int* numComponents) {
     auto chooseProc8888 = [&]() {
         if (kUnpremul_SkAlphaType == srcInfo.alphaType() &&
             options.fAlphaOption == SkJpegEncoder::AlphaOption::kBlendOnBlack) {
@@ -95,52 +107,62 @@ bool SkJpegEncoderMgr::initializeRGB(const SkImageInfo& srcInfo,
         return (transform_scanline_proc) nullptr;
     };
 
-    J_COLOR_SPACE jpegColorType = JCS_EXT_RGBA;
-    int numComponents = 0;
+    *proc = nullptr;
     switch (srcInfo.colorType()) {
         case kRGBA_8888_SkColorType:
-            fProc = chooseProc8888();
-            jpegColorType = JCS_EXT_RGBA;
-            numComponents = 4;
+            *proc = chooseProc8888();
+            *jpegColorType = JCS_EXT_RGBA;
+            *numComponents = 4;
             break;
         case kBGRA_8888_SkColorType:
-            fProc = chooseProc8888();
-            jpegColorType = JCS_EXT_BGRA;
-            numComponents = 4;
+            *proc = chooseProc8888();
+            *jpegColorType = JCS_EXT_BGRA;
+            *numComponents = 4;
             break;
         case kRGB_565_SkColorType:
-            fProc = transform_scanline_565;
-            jpegColorType = JCS_RGB;
-            numComponents = 3;
+            *proc = transform_scanline_565;
+            *jpegColorType = JCS_RGB;
+            *numComponents = 3;
             break;
         case kARGB_4444_SkColorType:
             if (SkJpegEncoder::AlphaOption::kBlendOnBlack == options.fAlphaOption) {
                 return false;
             }
 
-            fProc = transform_scanline_444;
-            jpegColorType = JCS_RGB;
-            numComponents = 3;
+            *proc = transform_scanline_444;
+            *jpegColorType = JCS_RGB;
+            *numComponents = 3;
             break;
         case kGray_8_SkColorType:
         case kAlpha_8_SkColorType:
         case kR8_unorm_SkColorType:
-            jpegColorType = JCS_GRAYSCALE;
-            numComponents = 1;
+            *jpegColorType = JCS_GRAYSCALE;
+            *numComponents = 1;
             break;
         case kRGBA_F16_SkColorType:
             if (kUnpremul_SkAlphaType == srcInfo.alphaType() &&
                 options.fAlphaOption == SkJpegEncoder::AlphaOption::kBlendOnBlack) {
-                fProc = transform_scanline_F16_to_premul_8888;
+                *proc = transform_scanline_F16_to_premul_8888;
             } else {
-                fProc = transform_scanline_F16_to_8888;
+                *proc = transform_scanline_F16_to_8888;
             }
-            jpegColorType = JCS_EXT_RGBA;
-            numComponents = 4;
+            *jpegColorType = JCS_EXT_RGBA;
+            *numComponents = 4;
             break;
         default:
             return false;
     }
+    return true;
+}
+
+bool SkJpegEncoderMgr::initializeRGB(const SkImageInfo& srcInfo,
+                                     const SkJpegEncoder::Options& options,
+                                     const SkJpegMetadataEncoder::SegmentList& metadataSegments) {
+    J_COLOR_SPACE jpegColorType;
+    int numComponents;
+    if (!choose_rgb_input(srcInfo, options, &fProc, &jpegColorType, &numComponents)) {
+        return false;
+    }
 
     fCInfo.image_width = srcInfo.width();
     fCInfo.image_height = srcInfo.height();
@@ -263,10 +285,17 @@ bool SkJpegEncoderMgr::initializeYUV(const SkYUVAPixmapInfo& srcInfo,
 void SkJpegEncoderMgr::initializeCommon(
         const SkJpegEncoder::Options& options,
         const SkJpegMetadataEncoder::SegmentList& metadataSegments) {
-    // Tells libjpeg-turbo to compute optimal Huffman coding tables
-    // for the image.  This improves compression at the cost of
-    // slower encode performance.
-    fCInfo.optimize_coding = TRUE;
+    if (options.fExecutor) {
+        // Stripes that are encoded in parallel must share their Huffman tables, and start at
+        // restart markers, to be joined into one image.
+        fCInfo.optimize_coding = FALSE;
+        fCInfo.restart_in_rows = 1;
+    } else {
+        // Tells libjpeg-turbo to compute optimal Huffman coding tables
+        // for the image.  This improves compression at the cost of
+        // slower encode performance.
+        fCInfo.optimize_coding = TRUE;
+    }
 
     jpeg_set_quality(&fCInfo, options.fQuality, TRUE);
     jpeg_start_compress(&fCInfo, TRUE);
@@ -279,6 +308,89 @@ void SkJpegEncoderMgr::initializeCommon(
     }
 }
 
+void SkJpegEncoderMgr::writeRows(const SkPixmap& src, int top, int numRows, uint8_t* storage) {
+    const size_t srcBytes = SkColorTypeBytesPerPixel(src.colorType()) * src.width();
+    const size_t jpegSrcBytes = fCInfo.input_components * src.width();
+    const void* srcRow = src.addr(0, top);
+    for (int i = 0; i < numRows; i++) {
+        JSAMPLE* jpegSrcRow = (JSAMPLE*)(const_cast<void*>(srcRow));
+        if (fProc) {
+            sk_msan_assert_initialized(srcRow, SkTAddOffset<const void>(srcRow, srcBytes));
+            fProc((char*)storage, (const char*)srcRow, src.width(), fCInfo.input_components);
+            jpegSrcRow = storage;
+            sk_msan_assert_initialized(jpegSrcRow,
+                                       SkTAddOffset<const void>(jpegSrcRow, jpegSrcBytes));
+        } else {
+            // Same as above, but this repetition allows determining whether a
+            // proc was used when msan asserts.
+            sk_msan_assert_initialized(jpegSrcRow,
+                                       SkTAddOffset<const void>(jpegSrcRow, jpegSrcBytes));
+        }
+
+        jpeg_write_scanlines(&fCInfo, &jpegSrcRow, 1);
+        srcRow = SkTAddOffset<const void>(srcRow, src.rowBytes());
+    }
+}
+
+namespace {
+// See section B.1.1.3, Marker assignments.
+constexpr uint8_t kMarkerSOF0 = 0xC0;  // Baseline DCT
+constexpr uint8_t kMarkerRST0 = 0xD0;
+
+// Aim for stripes with at least this many bytes of pixels, so that each task has plenty of
+// work to do.
+constexpr size_t kMinStripeBytes = 512 * 1024;
+
+// Encodes rows [top, top + height) of |src| as a JPEG of their own. Returns nullptr on failure.
+sk_sp<SkData> encode_stripe(const SkPixmap& src,
+                            int top,
+                            int height,
+                            const SkJpegEncoder::Options& options,
+                            const SkJpegMetadataEncoder::SegmentList& metadata) {
+    SkDynamicMemoryWStream stream;
+    std::unique_ptr<SkJpegEncoderMgr> encoderMgr = SkJpegEncoderMgr::Make(&stream);
+    // Big enough for any proc's output.
+    skia_private::AutoTMalloc<uint8_t> storage(4 * src.width());
+    skjpeg_error_mgr::AutoPushJmpBuf jmp(encoderMgr->errorMgr());
+    if (setjmp(jmp)) {
+        return nullptr;
+    }
+
+    if (!encoderMgr->initializeRGB(src.info().makeWH(src.width(), height), options, metadata)) {
+        return nullptr;
+    }
+    encoderMgr->writeRows(src, top, height, storage.get());
+    jpeg_finish_compress(encoderMgr->cinfo());
+    return stream.detachAsData();
+}
+
+// Finds the StartOfFrame parameters, and the entropy-coded data that follows the StartOfScan
+// segment, in a JPEG written by libjpeg-turbo.
+bool find_frame_and_scan(const SkData& jpeg, size_t* sofParamsOffset, size_t* scanOffset) {
+    const uint8_t* bytes = jpeg.bytes();
+    const size_t size = jpeg.size();
+    *sofParamsOffset = 0;
+    size_t offset = kJpegMarkerCodeSize;
+    while (offset + kJpegMarkerCodeSize + kJpegSegmentParameterLengthSize <= size &&
+           bytes[offset] == 0xFF) {
+        const uint8_t marker = bytes[offset + 1];
+        const size_t paramsOffset = offset + kJpegMarkerCodeSize;
+        const size_t paramsLength = (bytes[paramsOffset] << 8) | bytes[paramsOffset + 1];
+        if (marker == kMarkerSOF0) {
+            *sofParamsOffset = paramsOffset;
+        }
+        offset = paramsOffset + paramsLength;
+        if (marker == kJpegMarkerStartOfScan) {
+            *scanOffset = offset;
+            // The entropy-coded data runs up to the EndOfImage marker.
+            return *sofParamsOffset && offset + kJpegMarkerCodeSize <= size &&
+                   bytes[size - 2] == 0xFF && bytes[size - 1] == kJpegMarkerEndOfImage;
+        }
+    }
+    return false;
+}
+}  // namespace
+
 std::unique_ptr<SkEncoder> SkJpegEncoderImpl::MakeYUV(
         SkWStream* dst,
         const SkYUVAPixmaps& srcYUVA,
@@ -294,7 +406,10 @@ std::unique_ptr<SkEncoder> SkJpegEncoderImpl::MakeYUV(
         return nullptr;
     }
 
-    if (!encoderMgr->initializeYUV(srcYUVA.pixmapsInfo(), options, metadataSegments)) {
+    // The planes are always encoded serially, so keep the optimized Huffman tables.
+    SkJpegEncoder::Options serialOptions = options;
+    serialOptions.fExecutor = nullptr;
+    if (!encoderMgr->initializeYUV(srcYUVA.pixmapsInfo(), serialOptions, metadataSegments)) {
         return nullptr;
     }
     return std::unique_ptr<SkJpegEncoderImpl>(
@@ -309,6 +424,35 @@ std::unique_ptr<SkEncoder> SkJpegEncoderImpl::MakeRGB(
     if (!SkPixmapIsValid(src)) {
         return nullptr;
     }
+    if (options.fExecutor) {
+        // The stripes are written to |dst| as they are encoded.
+        transform_scanline_proc proc;
+        J_COLOR_SPACE jpegColorType;
+        int numComponents;
+        if (!choose_rgb_input(src.info(), options, &proc, &jpegColorType, &numComponents)) {
+            return nullptr;
+        }
+        // Only 4:2:0 subsamples the chroma vertically, which makes the MCU rows twice as tall
+        // (see SkJpegEncoderMgr::initializeRGB).
+        const bool subsampledRows = numComponents != 1 &&
+                                    options.fDownsample == SkJpegEncoder::Downsample::k420;
+        const int mcuRowHeight = subsampledRows ? 2 * DCTSIZE : DCTSIZE;
+        // Stripes hold a multiple of eight MCU rows, so that the restart markers in each one
+        // (RST0 to RST7, repeating) match the ones for those rows in the whole image.
+        const int stripeUnit = 8 * mcuRowHeight;
+        const size_t unitBytes = stripeUnit * src.info().minRowBytes();
+        const int stripeHeight = stripeUnit * (int)std::max<size_t>(
+                1, (kMinStripeBytes + unitBytes - 1) / unitBytes);
+        if (src.height() > stripeHeight) {
+            return std::unique_ptr<SkJpegEncoderImpl>(
+                    new SkJpegEncoderImpl(dst, src, options, metadataSegments, stripeHeight));
+        }
+        // There's nothing to split, so keep the optimized Huffman tables.
+        SkJpegEncoder::Options serialOptions = options;
+        serialOptions.fExecutor = nullptr;
+        return MakeRGB(dst, src, serialOptions, metadataSegments);
+    }
+
     std::unique_ptr<SkJpegEncoderMgr> encoderMgr = SkJpegEncoderMgr::Make(dst);
     skjpeg_error_mgr::AutoPushJmpBuf jmp(encoderMgr->errorMgr());
     if (setjmp(jmp)) {
@@ -333,9 +477,24 @@ SkJpegEncoderImpl::SkJpegEncoderImpl(std::unique_ptr<SkJpegEncoderMgr> encoderMg
         , fEncoderMgr(std::move(encoderMgr))
         , fSrcYUVA(src) {}
 
+SkJpegEncoderImpl::SkJpegEncoderImpl(SkWStream* dst,
+                                     const SkPixmap& src,
+                                     const SkJpegEncoder::Options& options,
+                                     const SkJpegMetadataEncoder::SegmentList& metadata,
+                                     int stripeHeight)
+        : SkEncoder(src, 0)
+        , fDst(dst)
+        , fOptions(options)
+        , fMetadata(metadata)
+        , fStripeHeight(stripeHeight) {}
+
 SkJpegEncoderImpl::~SkJpegEncoderImpl() {}
 
 bool SkJpegEncoderImpl::onEncodeRows(int numRows) {
+    if (!fEncoderMgr) {
+        return this->encodeStripes(numRows);
+    }
+
     skjpeg_error_mgr::AutoPushJmpBuf jmp(fEncoderMgr->errorMgr());
     if (setjmp(jmp)) {
         return false;
@@ -349,30 +508,7 @@ bool SkJpegEncoderImpl::onEncodeRows(int numRows) {
             jpeg_write_scanlines(fEncoderMgr->cinfo(), &jpegSrcRow, 1);
         }
     } else {
-        const size_t srcBytes = SkColorTypeBytesPerPixel(fSrc.colorType()) * fSrc.width();
-        const size_t jpegSrcBytes = fEncoderMgr->cinfo()->input_components * fSrc.width();
-        const void* srcRow = fSrc.addr(0, fCurrRow);
-        for (int i = 0; i < numRows; i++) {
-            JSAMPLE* jpegSrcRow = (JSAMPLE*)(const_cast<void*>(srcRow));
-            if (fEncoderMgr->proc()) {
-                sk_msan_assert_initialized(srcRow, SkTAddOffset<const void>(srcRow, srcBytes));
-                fEncoderMgr->proc()((char*)fStorage.get(),
-                                    (const char*)srcRow,
-                                    fSrc.width(),
-                                    fEncoderMgr->cinfo()->input_components);
-                jpegSrcRow = fStorage.get();
-                sk_msan_assert_initialized(jpegSrcRow,
-                                           SkTAddOffset<const void>(jpegSrcRow, jpegSrcBytes));
-            } else {
-                // Same as above, but this repetition allows determining whether a
-                // proc was used when msan asserts.
-                sk_msan_assert_initialized(jpegSrcRow,
-                                           SkTAddOffset<const void>(jpegSrcRow, jpegSrcBytes));
-            }
-
-            jpeg_write_scanlines(fEncoderMgr->cinfo(), &jpegSrcRow, 1);
-            srcRow = SkTAddOffset<const void>(srcRow, fSrc.rowBytes());
-        }
+        fEncoderMgr->writeRows(fSrc, fCurrRow, numRows, fStorage.get());
     }
 
     fCurrRow += numRows;
@@ -383,6 +519,66 @@ bool SkJpegEncoderImpl::onEncodeRows(int numRows) {
     return true;
 }
 
+bool SkJpegEncoderImpl::encodeStripes(int numRows) {
+    const int height = fSrc.height();
+    const int rowsAvailable = fCurrRow + numRows;
+    const int end = rowsAvailable == height ? height
+                                            : rowsAvailable / fStripeHeight * fStripeHeight;
+    const int firstStripe = fStripedRows / fStripeHeight;
+    const int numStripes = (end - fStripedRows + fStripeHeight - 1) / fStripeHeight;
+
+    std::vector<sk_sp<SkData>> stripes(numStripes);
+    auto encode = [&](int i) {
+        const int top = fStripedRows + i * fStripeHeight;
+        // Only the first stripe's header is kept, so only it needs the metadata.
+        stripes[i] = encode_stripe(fSrc, top, std::min(fStripeHeight, height - top), fOptions,
+                                   firstStripe + i == 0 ? fMetadata
+                                                        : SkJpegMetadataEncoder::SegmentList());
+    };
+    if (numStripes > 1) {
+        SkTaskGroup(*fOptions.fExecutor).batch(numStripes, encode);
+    } else if (numStripes == 1) {
+        encode(0);
+    }
+
+    for (int i = 0; i < numStripes; i++) {
+        size_t sofParamsOffset, scanOffset;
+        if (!stripes[i] || !find_frame_and_scan(*stripes[i], &sofParamsOffset, &scanOffset)) {
+            return false;
+        }
+        const uint8_t* bytes = stripes[i]->bytes();
+        if (firstStripe + i == 0) {
+            // Use the first stripe's header for the whole image, with the image's height. The
+            // StartOfFrame parameters are the length, the sample precision, then the height.
+            skia_private::AutoTMalloc<uint8_t> header(scanOffset);
+            memcpy(header.get(), bytes, scanOffset);
+            header[sofParamsOffset + 3] = height >> 8;
+            header[sofParamsOffset + 4] = height & 0xFF;
+            if (!fDst->write(header.get(), scanOffset)) {
+                return false;
+            }
+        } else {
+            // The stripe before this one ended after an eighth restart interval.
+            const uint8_t restart[] = {0xFF, kMarkerRST0 + 7};
+            if (!fDst->write(restart, sizeof(restart))) {
+                return false;
+            }
+        }
+        const size_t scanSize = stripes[i]->size() - scanOffset - kJpegMarkerCodeSize;
+        if (!fDst->write(bytes + scanOffset, scanSize)) {
+            return false;
+        }
+    }
+
+    fStripedRows = end;
+    fCurrRow += numRows;
+    if (fCurrRow == height) {
+        const uint8_t endOfImage[] = {0xFF, kJpegMarkerEndOfImage};
+        return fDst->write(endOfImage, sizeof(endOfImage));
+    }
+    return true;
+}
+
 namespace SkJpegEncoder {
 
 bool Encode(SkWStream* dst, const SkPixmap& src, const Options& options) {
@@ -12,6 +12,7 @@
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkYUVAPixmaps.h"
 #include "include/encode/SkEncoder.h"
+#include "include/encode/SkJpegEncoder.h"
 
 #include <cstdint>
 #include <memory>
@@ -24,10 +25,6 @@ class SkJpegEncoderMgr;
 class SkPixmap;
 class SkWStream;
 
-namespace SkJpegEncoder {
-struct Options;
-}  // namespace SkJpegEncoder
-
 // JPEG metadata is included in marker-based segments in the header of the image (the part before
 // the first StartOfScan marker). These functions append these parameters to an SkJpegMarkerList.
 namespace SkJpegMetadataEncoder {
@@ -77,9 +74,25 @@ protected:
 private:
     SkJpegEncoderImpl(std::unique_ptr<SkJpegEncoderMgr>, const SkPixmap& src);
     SkJpegEncoderImpl(std::unique_ptr<SkJpegEncoderMgr>, const SkYUVAPixmaps& srcYUVA);
+    SkJpegEncoderImpl(SkWStream* dst,
+                      const SkPixmap& src,
+                      const SkJpegEncoder::Options& options,
+                      const SkJpegMetadataEncoder::SegmentList& metadata,
+                      int stripeHeight);
+
+    // Encodes the stripes that the next |numRows| rows complete, in parallel.
+    bool encodeStripes(int numRows);
 
     std::unique_ptr<SkJpegEncoderMgr> fEncoderMgr;
     std::optional<SkYUVAPixmaps> fSrcYUVA;
+
+    // With an executor, there is no fEncoderMgr. Instead, stripes of fStripeHeight rows are
+    // each encoded as a JPEG of their own, and joined into one as they are written to fDst.
+    SkWStream* fDst = nullptr;
+    SkJpegEncoder::Options fOptions;
+    SkJpegMetadataEncoder::SegmentList fMetadata;
+    int fStripeHeight = 0;
+    int fStripedRows = 0;
 };
 
 #endif
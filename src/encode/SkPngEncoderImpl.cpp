@@ -13,6 +13,7 @@
 #include "include/core/SkColorType.h"
 #include "include/core/SkData.h"
 #include "include/core/SkDataTable.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkPixmap.h"
 #include "include/core/SkRefCnt.h"
@@ -20,13 +21,16 @@
 #include "include/core/SkString.h"
 #include "include/encode/SkEncoder.h"
 #include "include/encode/SkPngEncoder.h"
+#include "include/private/base/SkAlign.h"
 #include "include/private/base/SkAssert.h"
 #include "include/private/base/SkDebug.h"
 #include "include/private/base/SkNoncopyable.h"
 #include "include/private/base/SkTemplates.h"
+#include "include/private/base/SkTo.h"
 #include "modules/skcms/skcms.h"
 #include "src/base/SkMSAN.h"
 #include "src/codec/SkPngPriv.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/encode/SkImageEncoderFns.h"
 #include "src/encode/SkImageEncoderPriv.h"
 #include "src/image/SkImage_Base.h"
@@ -34,6 +38,7 @@
 #include <algorithm>
 #include <csetjmp>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
 #include <memory>
 #include <utility>
@@ -41,6 +46,7 @@
 
 #include <png.h>
 #include <pngconf.h>
+#include <zlib.h>
 
 class GrDirectContext;
 class SkImage;
@@ -82,6 +88,11 @@ public:
     bool writeInfo(const SkImageInfo& srcInfo);
     void chooseProc(const SkImageInfo& srcInfo);
 
+    // When an executor was supplied, rows are filtered and deflated here in parallel stripes,
+    // bypassing libpng's row writing. Otherwise this returns null and rows go to libpng.
+    SkExecutor* executor() const { return fExecutor; }
+    bool writeStripes(const SkPixmap& src, int top, int numRows);
+
     png_structp pngPtr() { return fPngPtr; }
     png_infop infoPtr() { return fInfoPtr; }
     int pngBytesPerPixel() const { return fPngBytesPerPixel; }
@@ -96,6 +107,11 @@ private:
     png_infop fInfoPtr;
     int fPngBytesPerPixel;
     transform_scanline_proc fProc;
+
+    SkExecutor* fExecutor = nullptr;
+    int fFilters = 0;
+    int fZLibLevel = 0;
+    uLong fAdler = 0;  // Checksum of all the filtered rows deflated so far.
 };
 
 std::unique_ptr<SkPngEncoderMgr> SkPngEncoderMgr::Make(SkWStream* stream) {
@@ -225,6 +241,11 @@ bool SkPngEncoderMgr::setHeader(const SkImageInfo& srcInfo, const SkPngEncoder::
     SkASSERT(zlibLevel == options.fZLibLevel);
     png_set_compression_level(fPngPtr, zlibLevel);
 
+    fExecutor = options.fExecutor;
+    fFilters = filters ? filters : PNG_FILTER_NONE;  // libpng treats no filters as kNone
+    fZLibLevel = zlibLevel;
+    fAdler = adler32(0, nullptr, 0);
+
     // Set comments in tEXt chunk
     const sk_sp<SkDataTable>& comments = options.fComments;
     if (comments != nullptr) {
@@ -427,6 +448,8 @@ bool SkPngEncoderMgr::writeInfo(const SkImageInfo& srcInfo) {
         // For kOpaque, kRGBA_F16, we will keep the row as RGBA and tell libpng
         // to skip the alpha channel.
         png_set_filler(fPngPtr, 0, PNG_FILLER_AFTER);
+        // Stripes are written without libpng's transformations, so let libpng handle it.
+        fExecutor = nullptr;
     }
 
     return true;
@@ -434,6 +457,245 @@ bool SkPngEncoderMgr::writeInfo(const SkImageInfo& srcInfo) {
 
 void SkPngEncoderMgr::chooseProc(const SkImageInfo& srcInfo) { fProc = choose_proc(srcInfo); }
 
+// Parallel encoding works like pigz: the rows are split into stripes that are each filtered and
+// raw-deflated on their own, ending in a sync flush so the pieces can simply be concatenated
+// into one zlib stream. Each stripe primes its window with the filtered rows just before it,
+// so the compression ratio stays close to that of a serial encode. Those rows are filtered
+// again by every stripe, so stripes are large enough to keep that extra work small.
+static constexpr size_t kStripeBytes = 512 * 1024;
+static constexpr size_t kWindowBytes = 32 * 1024;
+
+static uint8_t paeth_predictor(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = std::abs(p - a),
+        pb = std::abs(p - b),
+        pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+// libpng's heuristic for how well a filtered byte will compress: its magnitude as a signed value.
+static inline int filtered_cost(uint8_t v) { return v < 128 ? v : 256 - v; }
+
+// Writes row[i] - predict(left, above, upperLeft) for each byte of 'row' to 'out', returning the
+// summed filtered_cost() of the bytes. Like libpng, this gives up early (returning a cost of at
+// least 'limit') once the row can't beat 'limit'. Bytes in the first pixel have no left or upper
+// left neighbors, which png treats as zero.
+template <typename Predictor>
+static size_t filter_bytes(Predictor predict, int bpp, const uint8_t* row, const uint8_t* prev,
+                           size_t rowBytes, uint8_t* out, size_t limit) {
+    const size_t first = std::min<size_t>(bpp, rowBytes);
+    size_t cost = 0;
+    for (size_t i = 0; i < first; i++) {
+        out[i] = row[i] - predict(0, prev[i], 0);
+        cost += filtered_cost(out[i]);
+    }
+    // Check the limit once per chunk of bytes to keep the inner loop simple.
+    constexpr size_t kChunk = 256;
+    for (size_t i = first; i < rowBytes && cost < limit; ) {
+        const size_t end = std::min(i + kChunk, rowBytes);
+        for (; i < end; i++) {
+            out[i] = row[i] - predict(row[i - bpp], prev[i], prev[i - bpp]);
+            cost += filtered_cost(out[i]);
+        }
+    }
+    return cost;
+}
+
+// Applies one png filter to 'row', writing the filter type and filtered bytes to 'dst'.
+// Returns the cost of the filtered row, or a cost of at least 'limit' if it was abandoned.
+static size_t apply_filter(int filter, int bpp, const uint8_t* row, const uint8_t* prev,
+                           size_t rowBytes, uint8_t* dst, size_t limit = SIZE_MAX) {
+    uint8_t* out = dst + 1;
+    switch (filter) {
+        case PNG_FILTER_NONE:
+            dst[0] = PNG_FILTER_VALUE_NONE;
+            return filter_bytes([](int, int, int) { return 0; },
+                                bpp, row, prev, rowBytes, out, limit);
+        case PNG_FILTER_SUB:
+            dst[0] = PNG_FILTER_VALUE_SUB;
+            return filter_bytes([](int a, int, int) { return a; },
+                                bpp, row, prev, rowBytes, out, limit);
+        case PNG_FILTER_UP:
+            dst[0] = PNG_FILTER_VALUE_UP;
+            return filter_bytes([](int, int b, int) { return b; },
+                                bpp, row, prev, rowBytes, out, limit);
+        case PNG_FILTER_AVG:
+            dst[0] = PNG_FILTER_VALUE_AVG;
+            return filter_bytes([](int a, int b, int) { return (a + b) >> 1; },
+                                bpp, row, prev, rowBytes, out, limit);
+        case PNG_FILTER_PAETH:
+            dst[0] = PNG_FILTER_VALUE_PAETH;
+            return filter_bytes(paeth_predictor, bpp, row, prev, rowBytes, out, limit);
+    }
+    SkUNREACHABLE;
+}
+
+// Filters 'row' among 'filters' the way libpng does, picking the cheapest by its heuristic.
+// 'prev' holds the previous png row, or zeros for the first. Both 'a' and 'b' must have room
+// for 1 + rowBytes bytes; returns whichever of them holds the chosen filtered row.
+static const uint8_t* filter_row(int filters, int bpp, const uint8_t* row, const uint8_t* prev,
+                                 size_t rowBytes, uint8_t* a, uint8_t* b) {
+    constexpr int kFilters[] = {
+        PNG_FILTER_NONE, PNG_FILTER_SUB, PNG_FILTER_UP, PNG_FILTER_AVG, PNG_FILTER_PAETH,
+    };
+    uint8_t* best = a;
+    uint8_t* next = b;
+    size_t bestCost = SIZE_MAX;
+    for (int filter : kFilters) {
+        if (filters & filter) {
+            uint8_t* dst = bestCost == SIZE_MAX ? best : next;
+            size_t cost = apply_filter(filter, bpp, row, prev, rowBytes, dst, bestCost);
+            if (cost < bestCost) {
+                bestCost = cost;
+                best = dst;
+                next = dst == a ? b : a;
+            }
+        }
+    }
+    return best;
+}
+
+namespace {
+struct Stripe {
+    int                  fTop, fBottom;  // Source rows [fTop, fBottom).
+    bool                 fLast;          // Ends the zlib stream.
+    std::vector<uint8_t> fDeflated;
+    uLong                fAdler = 0;
+    size_t               fFilteredBytes = 0;
+    bool                 fSuccess = false;
+};
+}  // namespace
+
+// Feeds deflate() with 'flush' until it stops producing output, appending that to 'dst'.
+static bool deflate_into(z_stream* z, int flush, std::vector<uint8_t>* dst) {
+    uint8_t buffer[16384];
+    do {
+        z->next_out = buffer;
+        z->avail_out = sizeof(buffer);
+        if (deflate(z, flush) == Z_STREAM_ERROR) {
+            return false;
+        }
+        dst->insert(dst->end(), buffer, buffer + sizeof(buffer) - z->avail_out);
+    } while (z->avail_out == 0);
+    return true;
+}
+
+static void deflate_stripe(const SkPixmap& src, transform_scanline_proc proc, int filters,
+                           int zlibLevel, int bpp, size_t rowBytes, Stripe* stripe) {
+    // Each png row is filtered against the row above it, so start from the row above the
+    // stripe, and before that, the rows whose filtered bytes fill the compression window.
+    const int windowRows = zlibLevel > 0 ? SkToInt((kWindowBytes + rowBytes) / (rowBytes + 1))
+                                         : 0;
+    const int firstFiltered = std::max(0, stripe->fTop - windowRows);
+    const int first = std::max(0, firstFiltered - 1);
+
+    z_stream z = {};
+    const int strategy = filters == PNG_FILTER_NONE ? Z_DEFAULT_STRATEGY : Z_FILTERED;
+    if (deflateInit2(&z, zlibLevel, Z_DEFLATED, -MAX_WBITS, 8, strategy) != Z_OK) {
+        return;
+    }
+
+    // Some transform procs store 16-bit channels, so keep the unfiltered rows aligned.
+    const size_t stride = SkAlign8(rowBytes + 1);
+    skia_private::AutoTMalloc<uint8_t> storage(4 * stride);
+    uint8_t* curr = storage.get();
+    uint8_t* prev = curr + stride;
+    uint8_t* filteredA = prev + stride;
+    uint8_t* filteredB = filteredA + stride;
+    memset(prev, 0, rowBytes);
+
+    std::vector<uint8_t> window;
+    uLong adler = adler32(0, nullptr, 0);
+    bool success = true;
+    for (int y = first; success && y < stripe->fBottom; y++) {
+        proc((char*)curr,
+             (const char*)src.addr(0, y),
+             src.width(),
+             SkColorTypeBytesPerPixel(src.colorType()));
+        if (y >= firstFiltered) {
+            const uint8_t* filtered =
+                    filter_row(filters, bpp, curr, prev, rowBytes, filteredA, filteredB);
+            if (y < stripe->fTop) {
+                window.insert(window.end(), filtered, filtered + rowBytes + 1);
+            } else {
+                if (y == stripe->fTop && !window.empty()) {
+                    size_t size = std::min(window.size(), kWindowBytes);
+                    deflateSetDictionary(&z, window.data() + window.size() - size, size);
+                }
+                z.next_in = const_cast<uint8_t*>(filtered);
+                z.avail_in = rowBytes + 1;
+                success = deflate_into(&z, Z_NO_FLUSH, &stripe->fDeflated);
+                adler = adler32(adler, filtered, rowBytes + 1);
+            }
+        }
+        std::swap(curr, prev);
+    }
+    success = success &&
+              deflate_into(&z, stripe->fLast ? Z_FINISH : Z_SYNC_FLUSH, &stripe->fDeflated);
+    deflateEnd(&z);
+
+    stripe->fAdler = adler;
+    stripe->fFilteredBytes = (rowBytes + 1) * (stripe->fBottom - stripe->fTop);
+    stripe->fSuccess = success;
+}
+
+static bool write_chunk(png_structp pngPtr, const char* name, const uint8_t* data, size_t size) {
+    if (setjmp(png_jmpbuf(pngPtr))) {
+        return false;
+    }
+    png_write_chunk(pngPtr, (png_const_bytep)name, data, size);
+    return true;
+}
+
+bool SkPngEncoderMgr::writeStripes(const SkPixmap& src, int top, int numRows) {
+    SkASSERT(fExecutor);
+    const size_t rowBytes = fPngBytesPerPixel * src.width();
+    const int stripeRows = std::max(1, SkToInt(kStripeBytes / (rowBytes + 1)));
+
+    std::vector<Stripe> stripes;
+    for (int y = top; y < top + numRows; y += stripeRows) {
+        int bottom = std::min(y + stripeRows, top + numRows);
+        stripes.push_back({y, bottom, bottom == src.height()});
+    }
+    if (top == 0 && !stripes.empty()) {
+        // The zlib header: deflate with a 32K window, and a hint of the compression level.
+        const uint8_t cmf = 0x78;
+        const int level = fZLibLevel < 2 ? 0 : fZLibLevel < 6 ? 1 : fZLibLevel == 6 ? 2 : 3;
+        uint8_t flg = level << 6;
+        flg += (31 - (cmf * 256 + flg) % 31) % 31;
+        stripes.front().fDeflated = {cmf, flg};
+    }
+
+    SkTaskGroup tasks(*fExecutor);
+    tasks.batch(SkToInt(stripes.size()), [&](int i) {
+        deflate_stripe(src, fProc, fFilters, fZLibLevel, fPngBytesPerPixel, rowBytes, &stripes[i]);
+    });
+    tasks.wait();
+
+    for (Stripe& stripe : stripes) {
+        if (!stripe.fSuccess) {
+            return false;
+        }
+        fAdler = adler32_combine(fAdler, stripe.fAdler, stripe.fFilteredBytes);
+        if (stripe.fLast) {
+            stripe.fDeflated.insert(stripe.fDeflated.end(), {
+                (uint8_t)(fAdler >> 24), (uint8_t)(fAdler >> 16),
+                (uint8_t)(fAdler >>  8), (uint8_t)(fAdler >>  0),
+            });
+        }
+        if (!write_chunk(fPngPtr, "IDAT", stripe.fDeflated.data(), stripe.fDeflated.size())) {
+            return false;
+        }
+        if (stripe.fLast && !write_chunk(fPngPtr, "IEND", nullptr, 0)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 SkPngEncoderImpl::SkPngEncoderImpl(std::unique_ptr<SkPngEncoderMgr> encoderMgr, const SkPixmap& src)
         : SkEncoder(src, encoderMgr->pngBytesPerPixel() * src.width())
         , fEncoderMgr(std::move(encoderMgr)) {}
@@ -441,6 +703,14 @@ SkPngEncoderImpl::SkPngEncoderImpl(std::unique_ptr<SkPngEncoderMgr> encoderMgr,
 SkPngEncoderImpl::~SkPngEncoderImpl() {}
 
 bool SkPngEncoderImpl::onEncodeRows(int numRows) {
+    if (fEncoderMgr->executor()) {
+        if (!fEncoderMgr->writeStripes(fSrc, fCurrRow, numRows)) {
+            return false;
+        }
+        fCurrRow += numRows;
+        return true;
+    }
+
     if (setjmp(png_jmpbuf(fEncoderMgr->pngPtr()))) {
         return false;
     }
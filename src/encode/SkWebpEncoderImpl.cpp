@@ -23,8 +23,10 @@
 #include "src/encode/SkImageEncoderPriv.h"
 #include "src/image/SkImage_Base.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 
 class GrDirectContext;
@@ -51,6 +53,87 @@ static int stream_writer(const uint8_t* data, size_t data_size, const WebPPictur
 
 using WebPPictureImportProc = int (*)(WebPPicture* picture, const uint8_t* pixels, int stride);
 
+static void copy_plane(uint8_t* dst, int dstStride, const uint8_t* src, int srcStride,
+                       size_t rowBytes, int rows) {
+    for (int y = 0; y < rows; y++) {
+        memcpy(dst + (size_t)y * dstStride, src + (size_t)y * srcStride, rowBytes);
+    }
+}
+
+// Converts |pixmap| to unpremultiplied RGBA and imports it into |pic| a stripe of rows at a
+// time, so that the conversion needs memory for a stripe rather than a copy of the image.
+static bool import_in_stripes(WebPPicture* pic, const SkPixmap& pixmap) {
+    const int width = pixmap.width();
+    const int height = pixmap.height();
+    // About 256KB of RGBA per stripe. Stripes have an even number of rows, so that the
+    // subsampled chroma of each stripe is the same as it would be for the whole image.
+    const int stripeHeight = std::max(2, (int)(256 * 1024 / (4 * (size_t)width)) & ~1);
+
+    SkBitmap tmpBm;
+    if (!tmpBm.tryAllocPixels(SkImageInfo::Make(width, std::min(stripeHeight, height),
+                                                kRGBA_8888_SkColorType,
+                                                kUnpremul_SkAlphaType))) {
+        return false;
+    }
+
+    WebPPicture stripe;
+    if (!WebPPictureInit(&stripe)) {
+        return false;
+    }
+    SkAutoTCallVProc<WebPPicture, WebPPictureFree> autoStripe(&stripe);
+    stripe.use_argb = pic->use_argb;
+    stripe.width = width;
+
+    // libwebp only adds an alpha plane to a stripe that isn't opaque, so |pic| needs one if
+    // |pixmap| might not be. An alpha plane that turns out to be opaque is dropped by WebPEncode.
+    if (!pic->use_argb && !pixmap.isOpaque()) {
+        pic->colorspace = WEBP_YUV420A;
+    }
+    if (!WebPPictureAlloc(pic)) {
+        return false;
+    }
+
+    for (int top = 0; top < height; top += stripeHeight) {
+        const int rows = std::min(stripeHeight, height - top);
+        if (!pixmap.readPixels(tmpBm.info().makeWH(width, rows), tmpBm.getPixels(),
+                               tmpBm.rowBytes(), 0, top)) {
+            return false;
+        }
+        stripe.height = rows;
+        if (!WebPPictureImportRGBA(&stripe, reinterpret_cast<const uint8_t*>(tmpBm.getPixels()),
+                                   tmpBm.rowBytes())) {
+            return false;
+        }
+
+        if (pic->use_argb) {
+            copy_plane(reinterpret_cast<uint8_t*>(pic->argb + (size_t)top * pic->argb_stride),
+                       4 * pic->argb_stride, reinterpret_cast<const uint8_t*>(stripe.argb),
+                       4 * stripe.argb_stride, 4 * (size_t)width, rows);
+            continue;
+        }
+        copy_plane(pic->y + (size_t)top * pic->y_stride, pic->y_stride,
+                   stripe.y, stripe.y_stride, width, rows);
+        const int uvTop = top / 2;
+        const int uvWidth = (width + 1) / 2;
+        const int uvRows = (rows + 1) / 2;
+        copy_plane(pic->u + (size_t)uvTop * pic->uv_stride, pic->uv_stride,
+                   stripe.u, stripe.uv_stride, uvWidth, uvRows);
+        copy_plane(pic->v + (size_t)uvTop * pic->uv_stride, pic->uv_stride,
+                   stripe.v, stripe.uv_stride, uvWidth, uvRows);
+        if (pic->a) {
+            uint8_t* dstA = pic->a + (size_t)top * pic->a_stride;
+            if (stripe.a) {
+                copy_plane(dstA, pic->a_stride, stripe.a, stripe.a_stride, width, rows);
+            } else {
+                for (int y = 0; y < rows; y++) {
+                    memset(dstA + (size_t)y * pic->a_stride, 0xFF, width);
+                }
+            }
+        }
+    }
+    return true;
+}
+
 static bool preprocess_webp_picture(WebPPicture* pic,
                                     WebPConfig* webp_config,
                                     const SkPixmap& pixmap,
@@ -92,9 +175,7 @@ static bool preprocess_webp_picture(WebPPicture* pic,
         const SkColorType ct = pixmap.colorType();
         const bool premul = pixmap.alphaType() == kPremul_SkAlphaType;
 
-        SkBitmap tmpBm;
         WebPPictureImportProc importProc = nullptr;
-        const SkPixmap* src = &pixmap;
         if (ct == kRGB_888x_SkColorType) {
             importProc = WebPPictureImportRGBX;
         } else if (!premul && ct == kRGBA_8888_SkColorType) {
@@ -106,18 +187,10 @@ static bool preprocess_webp_picture(WebPPicture* pic,
         }
 #endif
         else {
-            importProc = WebPPictureImportRGBA;
-            auto info = pixmap.info()
-                                .makeColorType(kRGBA_8888_SkColorType)
-                                .makeAlphaType(kUnpremul_SkAlphaType);
-            if (!tmpBm.tryAllocPixels(info) ||
-                !pixmap.readPixels(tmpBm.info(), tmpBm.getPixels(), tmpBm.rowBytes())) {
-                return false;
-            }
-            src = &tmpBm.pixmap();
+            return import_in_stripes(pic, pixmap);
         }
 
-        if (!importProc(pic, reinterpret_cast<const uint8_t*>(src->addr()), src->rowBytes())) {
+        if (!importProc(pic, reinterpret_cast<const uint8_t*>(pixmap.addr()), pixmap.rowBytes())) {
             return false;
         }
     }
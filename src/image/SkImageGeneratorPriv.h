@@ -15,6 +15,7 @@
 
 class SkColorSpace;
 class SkData;
+class SkImage;
 class SkImageGenerator;
 class SkMatrix;
 class SkPaint;
@@ -57,4 +58,12 @@ std::unique_ptr<SkImageGenerator> MakeFromEncoded(sk_sp<SkData>,
                                                   std::optional<SkAlphaType> = std::nullopt);
 }
 
+namespace SkImages {
+/**
+ *  Like DeferredFromGenerator(), for a generator that is an SkCodecImageGenerator. Its pixels
+ *  can be shared with other images of the same encoded data through the SkPersistentImageCache.
+ */
+sk_sp<SkImage> DeferredFromCodecGenerator(std::unique_ptr<SkImageGenerator>);
+}
+
 #endif
@@ -10,26 +10,35 @@
 #include "include/core/SkBitmap.h"
 #include "include/core/SkColorSpace.h"
 #include "include/core/SkData.h"
+#include "include/core/SkGraphics.h"
 #include "include/core/SkImageGenerator.h"
+#include "include/core/SkPersistentImageCache.h"
 #include "include/core/SkPixmap.h"
 #include "include/core/SkSize.h"
 #include "include/core/SkYUVAInfo.h"
+#include "modules/skcms/skcms.h"
+#include "src/base/SkRectMemcpy.h"
 #include "src/core/SkBitmapCache.h"
 #include "src/core/SkCachedData.h"
+#include "src/core/SkMD5.h"
 #include "src/core/SkNextID.h"
 #include "src/core/SkResourceCache.h"
 #include "src/core/SkYUVPlanesCache.h"
 
+#include <cstdint>
+#include <cstring>
 #include <utility>
 
 enum SkColorType : int;
 
-sk_sp<SharedGenerator> SharedGenerator::Make(std::unique_ptr<SkImageGenerator> gen) {
-    return gen ? sk_sp<SharedGenerator>(new SharedGenerator(std::move(gen))) : nullptr;
+sk_sp<SharedGenerator> SharedGenerator::Make(std::unique_ptr<SkImageGenerator> gen,
+                                             bool isCodecGenerator) {
+    return gen ? sk_sp<SharedGenerator>(new SharedGenerator(std::move(gen), isCodecGenerator))
+               : nullptr;
 }
 
-SharedGenerator::SharedGenerator(std::unique_ptr<SkImageGenerator> gen)
-        : fGenerator(std::move(gen)) {
+SharedGenerator::SharedGenerator(std::unique_ptr<SkImageGenerator> gen, bool isCodecGenerator)
+        : fGenerator(std::move(gen)), fIsCodecGenerator(isCodecGenerator) {
     SkASSERT(fGenerator);
 }
 
@@ -104,6 +113,102 @@ SkImage_Lazy::SkImage_Lazy(Validator* validator)
     SkASSERT(fSharedGenerator);
 }
 
+namespace {
+// An entry in the SkPersistentImageCache is this header followed by the pixels, with rows of
+// minRowBytes(). The header is padded so that the pixels are aligned for any color type.
+struct PersistentPixelsHeader {
+    static constexpr uint32_t kMagic = SkSetFourByteTag('s', 'k', 'i', 'm');
+    static constexpr uint32_t kVersion = 2;
+
+    uint32_t fMagic;
+    uint32_t fVersion;
+    int32_t  fWidth;
+    int32_t  fHeight;
+    int32_t  fColorType;
+    int32_t  fAlphaType;
+    uint64_t fRowBytes;
+    uint8_t  fPadding[32];
+};
+static_assert(sizeof(PersistentPixelsHeader) == 64);
+
+// Finds the pixels in an entry from the SkPersistentImageCache, if it holds pixels for info.
+bool find_persistent_pixels(const SkData& data, const SkImageInfo& info, SkPixmap* pixmap) {
+    PersistentPixelsHeader header;
+    if (data.size() < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, data.data(), sizeof(header));
+    const size_t rowBytes = info.minRowBytes();
+    if (header.fMagic != PersistentPixelsHeader::kMagic ||
+        header.fVersion != PersistentPixelsHeader::kVersion ||
+        header.fWidth != info.width() || header.fHeight != info.height() ||
+        header.fColorType != info.colorType() || header.fAlphaType != info.alphaType() ||
+        header.fRowBytes != rowBytes ||
+        data.size() - sizeof(header) != info.computeByteSize(rowBytes)) {
+        return false;
+    }
+    pixmap->reset(info, data.bytes() + sizeof(header), rowBytes);
+    return true;
+}
+
+void store_persistent_pixels(SkPersistentImageCache* cache, const SkData& key,
+                             const SkPixmap& pixmap) {
+    const SkImageInfo& info = pixmap.info();
+    const size_t rowBytes = info.minRowBytes();
+    const size_t size = info.computeByteSize(rowBytes);
+    if (SkImageInfo::ByteSizeOverflowed(size) || size > SIZE_MAX - sizeof(PersistentPixelsHeader)) {
+        return;
+    }
+
+    sk_sp<SkData> data = SkData::MakeUninitialized(sizeof(PersistentPixelsHeader) + size);
+    PersistentPixelsHeader header = {};
+    header.fMagic = PersistentPixelsHeader::kMagic;
+    header.fVersion = PersistentPixelsHeader::kVersion;
+    header.fWidth = info.width();
+    header.fHeight = info.height();
+    header.fColorType = info.colorType();
+    header.fAlphaType = info.alphaType();
+    header.fRowBytes = rowBytes;
+    memcpy(data->writable_data(), &header, sizeof(header));
+    SkRectMemcpy(static_cast<uint8_t*>(data->writable_data()) + sizeof(header), rowBytes,
+                 pixmap.addr(), pixmap.rowBytes(), rowBytes, info.height());
+    cache->store(key, *data);
+}
+}  // namespace
+
+sk_sp<SkData> SkImage_Lazy::persistentCacheKey() const {
+    fPersistentCacheKeyOnce([this] {
+        // Other generators may decode the same data differently (e.g. without applying the
+        // EXIF orientation), so their pixels can't be shared through the encoded data.
+        if (!fSharedGenerator->fIsCodecGenerator) {
+            return;
+        }
+        sk_sp<SkData> encoded = ScopedGenerator(fSharedGenerator)->refEncodedData();
+        if (!encoded) {
+            return;
+        }
+
+        // The same encoded data can make images with different color types and spaces.
+        const SkImageInfo& info = this->imageInfo();
+        SkMD5 md5;
+        md5.write(encoded->data(), encoded->size());
+        const int32_t layout[] = {PersistentPixelsHeader::kVersion, info.width(), info.height(),
+                                  info.colorType(), info.alphaType()};
+        md5.write(layout, sizeof(layout));
+        if (SkColorSpace* colorSpace = info.colorSpace()) {
+            skcms_TransferFunction transferFn;
+            skcms_Matrix3x3 toXYZD50;
+            colorSpace->transferFn(&transferFn);
+            colorSpace->toXYZD50(&toXYZD50);
+            md5.write(&transferFn, sizeof(transferFn));
+            md5.write(&toXYZD50, sizeof(toXYZD50));
+        }
+        const SkMD5::Digest digest = md5.finish();
+        fPersistentCacheKey = SkData::MakeWithCopy(digest.data, sizeof(digest.data));
+    });
+    return fPersistentCacheKey;
+}
+
 bool SkImage_Lazy::getROPixels(GrDirectContext* ctx, SkBitmap* bitmap,
                                SkImage::CachingHint chint) const {
     auto check_output_bitmap = [bitmap]() {
@@ -118,21 +223,49 @@ bool SkImage_Lazy::getROPixels(GrDirectContext* ctx, SkBitmap* bitmap,
         return true;
     }
 
+    // The pixels may have been decoded before, possibly by another process.
+    sk_sp<SkPersistentImageCache> persistentCache = SkGraphics::GetPersistentImageCache();
+    sk_sp<SkData> persistentKey = persistentCache ? this->persistentCacheKey() : nullptr;
+    sk_sp<SkData> persistentData = persistentKey ? persistentCache->load(*persistentKey) : nullptr;
+    SkPixmap persistentPixels;
+    if (persistentData &&
+        !find_persistent_pixels(*persistentData, this->imageInfo(), &persistentPixels)) {
+        persistentData = nullptr;
+    }
+
     if (SkImage::kAllow_CachingHint == chint) {
         SkPixmap pmap;
         SkBitmapCache::RecPtr cacheRec = SkBitmapCache::Alloc(desc, this->imageInfo(), &pmap);
         if (!cacheRec) {
             return false;
         }
-        bool success = false;
-        {   // make sure ScopedGenerator goes out of scope before we try readPixelsProxy
-            success = ScopedGenerator(fSharedGenerator)->getPixels(pmap);
-        }
-        if (!success && !this->readPixelsProxy(ctx, pmap)) {
-            return false;
+        if (persistentData) {
+            SkRectMemcpy(pmap.writable_addr(), pmap.rowBytes(), persistentPixels.addr(),
+                         persistentPixels.rowBytes(), pmap.info().minRowBytes(), pmap.height());
+        } else {
+            bool success = false;
+            {   // make sure ScopedGenerator goes out of scope before we try readPixelsProxy
+                success = ScopedGenerator(fSharedGenerator)->getPixels(pmap);
+            }
+            if (!success && !this->readPixelsProxy(ctx, pmap)) {
+                return false;
+            }
+            if (persistentKey) {
+                store_persistent_pixels(persistentCache.get(), *persistentKey, pmap);
+            }
         }
         SkBitmapCache::Add(std::move(cacheRec), bitmap);
         this->notifyAddedToRasterCache();
+    } else if (persistentData) {
+        // Use the (likely memory-mapped) pixels in place.
+        const SkImageInfo& info = persistentPixels.info();
+        if (!bitmap->installPixels(info, const_cast<void*>(persistentPixels.addr()),
+                                   persistentPixels.rowBytes(),
+                                   [](void*, void* data) { static_cast<SkData*>(data)->unref(); },
+                                   persistentData.release())) {
+            return false;
+        }
+        bitmap->setImmutable();
     } else {
         if (!bitmap->tryAllocPixels(this->imageInfo())) {
             return false;
@@ -144,6 +277,9 @@ bool SkImage_Lazy::getROPixels(GrDirectContext* ctx, SkBitmap* bitmap,
         if (!success && !this->readPixelsProxy(ctx, bitmap->pixmap())) {
             return false;
         }
+        if (persistentKey) {
+            store_persistent_pixels(persistentCache.get(), *persistentKey, bitmap->pixmap());
+        }
         bitmap->setImmutable();
     }
     check_output_bitmap();
@@ -286,4 +422,12 @@ sk_sp<SkImage> DeferredFromGenerator(std::unique_ptr<SkImageGenerator> generator
     return validator ? sk_make_sp<SkImage_Lazy>(&validator) : nullptr;
 }
 
+sk_sp<SkImage> DeferredFromCodecGenerator(std::unique_ptr<SkImageGenerator> generator) {
+    SkImage_Lazy::Validator validator(
+            SharedGenerator::Make(std::move(generator), /*isCodecGenerator=*/true), nullptr,
+            nullptr);
+
+    return validator ? sk_make_sp<SkImage_Lazy>(&validator) : nullptr;
+}
+
 }  // namespace SkImages
@@ -17,6 +17,7 @@
 #include "include/core/SkYUVAPixmaps.h"
 #include "include/private/SkIDChangeListener.h"
 #include "include/private/base/SkMutex.h"
+#include "include/private/base/SkOnce.h"
 #include "src/image/SkImage_Base.h"
 
 #include <cstddef>
@@ -90,6 +91,10 @@ private:
 
     class ScopedGenerator;
 
+    // Returns the key for this image's pixels in the SkPersistentImageCache, or nullptr if they
+    // can't be stored there because the image isn't decoded from encoded data by an SkCodec.
+    sk_sp<SkData> persistentCacheKey() const;
+
     // Note that this->imageInfo() is not necessarily the info from the generator. It may be
     // cropped by onMakeSubset and its color type/space may be changed by
     // onMakeColorTypeAndColorSpace.
@@ -102,12 +107,16 @@ private:
     // When the SkImage_Lazy goes away, we will iterate over all the listeners to inform them
     // of the unique ID's demise. This is used to remove cached textures from GrContext.
     mutable SkIDChangeListener::List fUniqueIDListeners;
+
+    mutable SkOnce        fPersistentCacheKeyOnce;
+    mutable sk_sp<SkData> fPersistentCacheKey;
 };
 
 // Ref-counted tuple(SkImageGenerator, SkMutex) which allows sharing one generator among N images
 class SharedGenerator final : public SkNVRefCnt<SharedGenerator> {
 public:
-    static sk_sp<SharedGenerator> Make(std::unique_ptr<SkImageGenerator> gen);
+    static sk_sp<SharedGenerator> Make(std::unique_ptr<SkImageGenerator> gen,
+                                       bool isCodecGenerator = false);
 
     // This is thread safe.  It is a const field set in the constructor.
     const SkImageInfo& getInfo() const;
@@ -117,8 +126,12 @@ public:
     std::unique_ptr<SkImageGenerator> fGenerator;
     SkMutex                           fMutex;
 
+    // True if fGenerator is an SkCodecImageGenerator. Its pixels depend only on the encoded data
+    // and the requested info, so only these images use the SkPersistentImageCache.
+    const bool fIsCodecGenerator;
+
 private:
-    explicit SharedGenerator(std::unique_ptr<SkImageGenerator> gen);
+    SharedGenerator(std::unique_ptr<SkImageGenerator> gen, bool isCodecGenerator);
 };
 
 #endif
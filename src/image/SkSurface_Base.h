@@ -95,6 +95,13 @@ public:
 
     virtual void onWritePixels(const SkPixmap&, int x, int y) = 0;
 
+    /**
+     *  Called by SkSurface::peekPixels() and SkSurface::readPixels(). The default
+     *  implementations forward to the surface's canvas.
+     */
+    virtual bool onPeekPixels(SkPixmap*);
+    virtual bool onReadPixels(const SkPixmap& dst, int srcX, int srcY);
+
     /**
      * Default implementation does a rescale/read and then calls the callback.
      */
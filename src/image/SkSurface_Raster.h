@@ -49,10 +49,16 @@ public:
     void onRestoreBackingMutability() override;
     sk_sp<const SkCapabilities> onCapabilities() override;
 
-private:
+protected:
+    // Called by onCopyOnWrite() once fBitmap has been given pixels that are no longer shared
+    // with the cached image snapshot. The default retargets the cached canvas at fBitmap.
+    virtual void onBackingBitmapReplaced();
+
     SkBitmap    fBitmap;
     bool        fWeOwnThePixels;
 
+private:
+
     using INHERITED = SkSurface_Base;
 };
 
@@ -0,0 +1,280 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkBBHFactory.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkMallocPixelRef.h"
+#include "include/core/SkPixelRef.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkSamplingOptions.h"
+#include "include/core/SkScalar.h"
+#include "include/core/SkSurface.h"
+#include "include/private/base/SkTemplates.h"
+#include "include/private/base/SkTo.h"
+#include "src/core/SkBigPicture.h"
+#include "src/core/SkRecord.h"
+#include "src/core/SkRecordDraw.h"
+#include "src/core/SkRecorder.h"
+#include "src/core/SkRecords.h"
+#include "src/core/SkSurfacePriv.h"
+#include "src/core/SkTaskGroup.h"
+#include "src/image/SkSurface_Raster.h"
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+class SkPaint;
+class SkSurfaceProps;
+
+using namespace skia_private;
+
+namespace {
+
+// Tiles are square and this many pixels on a side (smaller at the right and bottom edges).
+constexpr int kTileSize = 256;
+
+// Visits the first ops of an SkRecord to find the ops that still shape the canvas state after
+// them: every Save, SaveLayer, matrix change and clip that hasn't been undone by a later Restore.
+// Replaying just these ops onto a fresh canvas leaves it in the same state as playing back all of
+// the visited ops.
+class LiveStateOps {
+public:
+    LiveStateOps(const SkRecord& record, int opCount) {
+        for (fCurrentOp = 0; fCurrentOp < opCount; fCurrentOp++) {
+            record.visit(fCurrentOp, *this);
+        }
+    }
+
+    const std::vector<int>& ops() const { return fOps; }
+
+    // The first SaveLayer or SaveBehind that is still open, or the number of visited ops if none
+    // are. A layer is only drawn into the pixels below it when it's restored.
+    int firstOpenLayer() const {
+        for (const OpenSave& save : fSaves) {
+            if (save.fIsLayer) {
+                return fOps[save.fLiveOps];
+            }
+        }
+        return fCurrentOp;
+    }
+
+    // Draws (and anything else that doesn't change the canvas state) don't need replaying.
+    template <typename T> void operator()(const T&) {}
+
+    void operator()(const SkRecords::Save&)       { this->pushSave(false); }
+    void operator()(const SkRecords::SaveLayer&)  { this->pushSave(true); }
+    void operator()(const SkRecords::SaveBehind&) { this->pushSave(true); }
+    void operator()(const SkRecords::Restore&) {
+        if (!fSaves.empty()) {
+            fOps.resize(fSaves.back().fLiveOps);
+            fSaves.pop_back();
+        }
+    }
+
+    void operator()(const SkRecords::SetMatrix&)  { this->keep(); }
+    void operator()(const SkRecords::SetM44&)     { this->keep(); }
+    void operator()(const SkRecords::Concat&)     { this->keep(); }
+    void operator()(const SkRecords::Concat44&)   { this->keep(); }
+    void operator()(const SkRecords::Scale&)      { this->keep(); }
+    void operator()(const SkRecords::Translate&)  { this->keep(); }
+    void operator()(const SkRecords::ClipRect&)   { this->keep(); }
+    void operator()(const SkRecords::ClipRRect&)  { this->keep(); }
+    void operator()(const SkRecords::ClipPath&)   { this->keep(); }
+    void operator()(const SkRecords::ClipRegion&) { this->keep(); }
+    void operator()(const SkRecords::ClipShader&) { this->keep(); }
+    void operator()(const SkRecords::ResetClip&)  { this->keep(); }
+
+private:
+    struct OpenSave {
+        size_t fLiveOps;  // The size of fOps just before the save.
+        bool   fIsLayer;
+    };
+
+    void pushSave(bool isLayer) {
+        fSaves.push_back({fOps.size(), isLayer});
+        this->keep();
+    }
+    void keep() { fOps.push_back(fCurrentOp); }
+
+    std::vector<int>      fOps;    // Indices of the live ops, in record order.
+    std::vector<OpenSave> fSaves;
+    int                   fCurrentOp = 0;
+};
+
+// A raster surface that records its draws and plays them back on an SkExecutor, one tile of
+// the surface per task. Each task draws into a bitmap of just its own tile, so the tasks never
+// write to the same pixels, even when a recorded ResetClip drops the clip.
+class SkSurface_RasterThreaded final : public SkSurface_Raster {
+public:
+    SkSurface_RasterThreaded(const SkImageInfo& info,
+                             sk_sp<SkPixelRef> pr,
+                             SkExecutor* executor,
+                             const SkSurfaceProps* props)
+            : SkSurface_Raster(info, std::move(pr), props)
+            , fExecutor(executor)
+            , fRecord(sk_make_sp<SkRecord>()) {
+        SkASSERT(fExecutor);
+    }
+
+    SkCanvas* onNewCanvas() override {
+        return new SkRecorder(fRecord.get(), SkRect::Make(this->imageInfo().bounds()));
+    }
+
+    sk_sp<SkSurface> onNewSurface(const SkImageInfo& info) override {
+        return SkSurfaces::RasterThreaded(info, fExecutor, &this->props());
+    }
+
+    sk_sp<SkImage> onNewImageSnapshot(const SkIRect* subset) override {
+        this->playbackRecordedDraws();
+        return this->INHERITED::onNewImageSnapshot(subset);
+    }
+
+    void onWritePixels(const SkPixmap& src, int x, int y) override {
+        this->playbackRecordedDraws();
+        this->INHERITED::onWritePixels(src, x, y);
+    }
+
+    void onDraw(SkCanvas* canvas, SkScalar x, SkScalar y,
+                const SkSamplingOptions& sampling, const SkPaint* paint) override {
+        this->playbackRecordedDraws();
+        this->INHERITED::onDraw(canvas, x, y, sampling, paint);
+    }
+
+    bool onPeekPixels(SkPixmap* pmap) override {
+        this->playbackRecordedDraws();
+        return fBitmap.peekPixels(pmap);
+    }
+
+    bool onReadPixels(const SkPixmap& dst, int srcX, int srcY) override {
+        this->playbackRecordedDraws();
+        return fBitmap.readPixels(dst, srcX, srcY);
+    }
+
+private:
+    // Our canvas only records; each playback draws into whatever fBitmap is at the time.
+    void onBackingBitmapReplaced() override {}
+
+    void playbackRecordedDraws();
+
+    SkExecutor*     fExecutor;
+    sk_sp<SkRecord> fRecord;
+
+    using INHERITED = SkSurface_Raster;
+};
+
+void SkSurface_RasterThreaded::playbackRecordedDraws() {
+    if (fRecord->count() == 0) {
+        return;
+    }
+    // Any ops in fRecord were recorded by our cached canvas, so it must already exist.
+    auto recorder = static_cast<SkRecorder*>(this->getCachedCanvas());
+    const SkRect cullRect = SkRect::Make(this->imageInfo().bounds());
+
+    sk_sp<SkRecord> record = std::move(fRecord);
+    const int opCount = record->count();
+
+    // Draws into a layer that is still open don't reach our pixels until the layer is restored,
+    // so we only play back the ops before the first open layer and keep the rest for later.
+    const int playbackCount = LiveStateOps(*record, opCount).firstOpenLayer();
+
+    // Drawables are snapshotted so that the tiles don't call into them concurrently.
+    std::unique_ptr<SkDrawableList> drawableList = recorder->detachDrawableList();
+    std::unique_ptr<SkBigPicture::SnapshotArray> drawables{
+        drawableList ? drawableList->newDrawableSnapshot() : nullptr
+    };
+
+    sk_sp<SkBBoxHierarchy> bbh = SkRTreeFactory()();
+    SkRect drawBounds = SkRect::MakeEmpty();
+    {
+        AutoTArray<SkRect> bounds(opCount);
+        AutoTMalloc<SkBBoxHierarchy::Metadata> meta(opCount);
+        SkRecordFillBounds(cullRect, *record, bounds.data(), meta);
+        bbh->insert(bounds.data(), meta, playbackCount);
+        for (int i = 0; i < playbackCount; i++) {
+            if (meta[i].isDraw) {
+                drawBounds.join(bounds[i]);
+            }
+        }
+    }
+
+    // Only tiles that something might draw into are worth a task.
+    const SkIRect dirty = drawBounds.roundOut();
+    std::vector<SkIRect> tiles;
+    for (int y = dirty.fTop / kTileSize * kTileSize; y < dirty.fBottom; y += kTileSize) {
+        for (int x = dirty.fLeft / kTileSize * kTileSize; x < dirty.fRight; x += kTileSize) {
+            SkIRect tile = SkIRect::MakeXYWH(x, y, kTileSize, kTileSize);
+            if (tile.intersect(fBitmap.bounds())) {
+                tiles.push_back(tile);
+            }
+        }
+    }
+
+    SkTaskGroup tg(*fExecutor);
+    tg.batch(SkToInt(tiles.size()), [&](int i) {
+        SkBitmap tile;
+        SkAssertResult(fBitmap.extractSubset(&tile, tiles[i]));
+        SkCanvas canvas(tile, this->props());
+        canvas.translate(-tiles[i].fLeft, -tiles[i].fTop);
+        SkRecordDraw(*record, &canvas,
+                     drawables ? drawables->begin() : nullptr, nullptr,
+                     drawables ? drawables->count() : 0,
+                     bbh.get(), nullptr);
+    });
+    tg.wait();
+
+    // Start over with a record of just the ops we didn't play back, but leave the canvas exactly
+    // as the client left it: replaying the live state ops before them restores its save stack,
+    // matrix and clip. Saves the canvas hasn't needed to perform yet aren't in the record, so we
+    // re-issue those last.
+    const LiveStateOps live(*record, playbackCount);
+    const int saveCount = recorder->getSaveCount();
+    fRecord = sk_make_sp<SkRecord>();
+    recorder->reset(fRecord.get(), cullRect);
+    SkRecords::Draw replay(recorder, nullptr,
+                           drawableList ? drawableList->begin() : nullptr,
+                           drawableList ? drawableList->count() : 0);
+    for (int i : live.ops()) {
+        record->visit(i, replay);
+    }
+    for (int i = playbackCount; i < opCount; i++) {
+        record->visit(i, replay);
+    }
+    while (recorder->getSaveCount() < saveCount) {
+        recorder->save();
+    }
+}
+
+}  // namespace
+
+namespace SkSurfaces {
+
+sk_sp<SkSurface> RasterThreaded(const SkImageInfo& info,
+                                SkExecutor* executor,
+                                const SkSurfaceProps* props) {
+    if (!executor) {
+        return Raster(info, props);
+    }
+    if (!SkSurfaceValidateRasterInfo(info)) {
+        return nullptr;
+    }
+
+    sk_sp<SkPixelRef> pr = SkMallocPixelRef::MakeAllocate(info, 0);
+    if (!pr) {
+        return nullptr;
+    }
+    return sk_make_sp<SkSurface_RasterThreaded>(info, std::move(pr), executor, props);
+}
+
+}  // namespace SkSurfaces
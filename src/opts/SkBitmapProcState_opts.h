@@ -41,7 +41,78 @@ static void decode_packed_coordinates_and_weight(U32 packed, Out* v0, Out* v1, O
     *w  = (packed >> 14) & 0xf; // Lerp weight for v1; weight for v0 is 16-w.
 }
 
-#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSSE3
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SKX
+
+    /*not static*/ inline
+    void S32_alpha_D32_filter_DX(const SkBitmapProcState& s,
+                                 const uint32_t* xy, int count, uint32_t* colors) {
+        SkASSERT(count > 0 && colors != nullptr);
+        SkASSERT(s.fBilerp);
+        SkASSERT(kN32_SkColorType == s.fPixmap.colorType());
+        SkASSERT(s.fAlphaScale <= 256);
+
+        // This is the same math as the SSSE3 code below, but working on eight output pixels at a
+        // time: we gather their 2x2 source pixels and widen each to 16-bit channels in a __m512i.
+        int y0, y1, wy;
+        decode_packed_coordinates_and_weight(*xy++, &y0, &y1, &wy);
+
+        auto row0 = (const int*)((const uint8_t*)s.fPixmap.addr() + y0 * s.fPixmap.rowBytes()),
+             row1 = (const int*)((const uint8_t*)s.fPixmap.addr() + y1 * s.fPixmap.rowBytes());
+
+        const __m512i wy_x32    = _mm512_set1_epi16(wy),
+                      alpha_x32 = _mm512_set1_epi16(s.fAlphaScale);
+
+        while (count > 0) {
+            // Masking lets the last [1,8) pixels take the same path, without reading past xy
+            // or writing past colors.
+            const __mmask8 mask = count >= 8 ? (__mmask8)0xff : (__mmask8)((1u << count) - 1);
+
+            // decode_packed_coordinates_and_weight(), 8x.
+            __m256i packed = _mm256_maskz_loadu_epi32(mask, xy),
+                    x0 = _mm256_srli_epi32(packed, 18),
+                    x1 = _mm256_and_si256 (packed, _mm256_set1_epi32(0x3fff)),
+                    wx = _mm256_and_si256 (_mm256_srli_epi32(packed, 14), _mm256_set1_epi32(0xf));
+
+            // Gather the 2x2 grid of pixels for each output pixel:
+            //    | tl  tr |
+            //    | bl  br |
+            auto gather = [&](const int* row, __m256i x) {
+                return _mm512_cvtepu8_epi16(
+                        _mm256_mmask_i32gather_epi32(_mm256_setzero_si256(), mask, x, row, 4));
+            };
+            __m512i tl = gather(row0, x0), tr = gather(row0, x1),
+                    bl = gather(row1, x0), br = gather(row1, x1);
+
+            // Splat each pixel's x weight to its four 16-bit channels.
+            __m512i wx_x4 = _mm512_mullo_epi64(_mm512_cvtepu32_epi64(wx),
+                                               _mm512_set1_epi64(0x0001000100010001));
+
+            // As in SSSE3, l*(16-w) + r*w == 16*l + (r-l)*w, first in x, then in y.
+            // Intermediates may wrap around 16 bits, but the final sum fits in [0,255*256].
+            __m512i top = _mm512_add_epi16(_mm512_slli_epi16(tl, 4),
+                                           _mm512_mullo_epi16(_mm512_sub_epi16(tr, tl), wx_x4)),
+                    bot = _mm512_add_epi16(_mm512_slli_epi16(bl, 4),
+                                           _mm512_mullo_epi16(_mm512_sub_epi16(br, bl), wx_x4));
+            __m512i px = _mm512_add_epi16(_mm512_slli_epi16(top, 4),
+                                          _mm512_mullo_epi16(_mm512_sub_epi16(bot, top), wy_x32));
+
+            // Scale down by total max weight 16x16 = 256.
+            px = _mm512_srli_epi16(px, 8);
+
+            // Scale by alpha if needed.
+            if (s.fAlphaScale < 256) {
+                px = _mm512_srli_epi16(_mm512_mullo_epi16(px, alpha_x32), 8);
+            }
+
+            // Every channel is in [0,255], so truncating back to 8 bits is exact.
+            _mm256_mask_storeu_epi32(colors, mask, _mm512_cvtepi16_epi8(px));
+            xy     += 8;
+            colors += 8;
+            count  -= 8;
+        }
+    }
+
+#elif SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSSE3
 
     /*not static*/ inline
     void S32_alpha_D32_filter_DX(const SkBitmapProcState& s,
@@ -2347,25 +2347,20 @@ STAGE(luminosity, NoCtx) {
 STAGE(srcover_rgba_8888, const SkRasterPipeline_MemoryCtx* ctx) {
     auto ptr = ptr_at_xy<uint32_t>(ctx, dx,dy);
 
-    U32 dst = load<U32>(ptr);
-    dr = cast((dst      ) & 0xff);
-    dg = cast((dst >>  8) & 0xff);
-    db = cast((dst >> 16) & 0xff);
-    da = cast((dst >> 24)       );
-    // {dr,dg,db,da} are in [0,255]
-    // { r, g, b, a} are in [0,  1] (but may be out of gamut)
-
-    r = mad(dr, inv(a), r*255.0f);
-    g = mad(dg, inv(a), g*255.0f);
-    b = mad(db, inv(a), b*255.0f);
-    a = mad(da, inv(a), a*255.0f);
-    // { r, g, b, a} are now in [0,255]  (but may be out of gamut)
-
-    // to_unorm() clamps back to gamut.  Scaling by 1 since we're already 255-biased.
-    dst = to_unorm(r, 1, 255)
-        | to_unorm(g, 1, 255) <<  8
-        | to_unorm(b, 1, 255) << 16
-        | to_unorm(a, 1, 255) << 24;
+    // The same math as load_8888_dst, srcover, store_8888, so that SkRasterPipeline can fuse
+    // those stages into this one without changing any pixels.
+    from_8888(load<U32>(ptr), &dr,&dg,&db,&da);
+
+    r = mad(dr, inv(a), r);
+    g = mad(dg, inv(a), g);
+    b = mad(db, inv(a), b);
+    a = mad(da, inv(a), a);
+
+    // to_unorm() clamps back to gamut.
+    U32 dst = to_unorm(r, 255)
+            | to_unorm(g, 255) <<  8
+            | to_unorm(b, 255) << 16
+            | to_unorm(a, 255) << 24;
     store(ptr, dst);
 }
 
@@ -11,11 +11,13 @@
 #include "include/private/base/SkDebug.h"
 #include "include/private/base/SkMalloc.h"
 #include "include/private/base/SkTo.h"
+#include "src/base/SkMathPriv.h"
 #include "src/core/SkTraceEvent.h"
 
 #include <algorithm>
 #include <cstdint>
 #include <cstring>
+#include <memory>
 
 #include "zlib.h"  // NO_G3_REWRITE
 
@@ -29,6 +31,494 @@ template <typename T> void* skia_alloc_func(void*, T items, T size) {
 
 void skia_free_func(void*, void* address) { sk_free(address); }
 
+// DEFLATE parameters and tables, from RFC 1951.
+constexpr int kWindowSize = 32768;
+constexpr int kMinMatch = 4;  // DEFLATE allows 3, but 4 bytes hash better.
+constexpr int kMaxMatch = 258;
+constexpr int kLitLenSymbols = 286;
+constexpr int kDistSymbols = 30;
+constexpr int kCodeLengthSymbols = 19;
+constexpr int kEndOfBlock = 256;
+constexpr int kMaxCodeLength = 15;
+constexpr int kMaxCodeLengthCodeLength = 7;
+
+constexpr uint16_t kLengthBase[29] = {3,  4,  5,  6,  7,  8,  9,  10,  11,  13,
+                                      15, 17, 19, 23, 27, 31, 35, 43,  51,  59,
+                                      67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr uint8_t kLengthExtraBits[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                          2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr uint8_t kCodeLengthOrder[kCodeLengthSymbols] = {16, 17, 18, 0, 8,  7, 9,  6, 10, 5,
+                                                          11, 4,  12, 3, 13, 2, 14, 1, 15};
+
+// Maps a match length to its length symbol, less 257.
+struct LengthSymbols {
+    uint8_t fSymbol[kMaxMatch + 1];
+    constexpr LengthSymbols() : fSymbol{} {
+        for (int symbol = 0; symbol < 28; ++symbol) {
+            for (int length = kLengthBase[symbol]; length < kLengthBase[symbol + 1]; ++length) {
+                fSymbol[length] = symbol;
+            }
+        }
+        fSymbol[kMaxMatch] = 28;
+    }
+};
+constexpr LengthSymbols kLengthSymbols;
+
+int length_symbol(int length) { return 257 + kLengthSymbols.fSymbol[length]; }
+
+int distance_symbol(uint32_t distance, uint32_t* extra, int* extraBits) {
+    uint32_t d = distance - 1;
+    if (d < 4) {
+        *extra = 0;
+        *extraBits = 0;
+        return d;
+    }
+    int log2 = 31 - SkCLZ(d);
+    *extraBits = log2 - 1;
+    *extra = d & ((1u << *extraBits) - 1);
+    return 2 * log2 + ((d >> *extraBits) & 1);
+}
+
+// Computes the lengths of a Huffman code for `freq`, at most `maxLength` bits long.
+void build_code_lengths(const uint32_t* freq, int count, int maxLength, uint8_t* lengths) {
+    struct Symbol {
+        uint32_t fFreq;
+        uint16_t fSymbol;
+    };
+    Symbol symbols[kLitLenSymbols];
+    int used = 0;
+    for (int i = 0; i < count; ++i) {
+        lengths[i] = 0;
+        if (freq[i]) {
+            symbols[used++] = {freq[i], SkToU16(i)};
+        }
+    }
+    if (used <= 1) {
+        if (used == 1) {
+            lengths[symbols[0].fSymbol] = 1;
+        }
+        return;
+    }
+    std::sort(symbols, symbols + used, [](const Symbol& a, const Symbol& b) {
+        return a.fFreq < b.fFreq || (a.fFreq == b.fFreq && a.fSymbol < b.fSymbol);
+    });
+
+    // Moffat and Katajainen's in-place calculation of minimum-redundancy code lengths, which
+    // replaces the sorted weights with the depth of each symbol.
+    uint32_t a[kLitLenSymbols];
+    for (int i = 0; i < used; ++i) {
+        a[i] = symbols[i].fFreq;
+    }
+    a[0] += a[1];
+    int root = 0, leaf = 2, next;
+    for (next = 1; next < used - 1; ++next) {
+        if (leaf >= used || a[root] < a[leaf]) {
+            a[next] = a[root];
+            a[root++] = next;
+        } else {
+            a[next] = a[leaf++];
+        }
+        if (leaf >= used || (root < next && a[root] < a[leaf])) {
+            a[next] += a[root];
+            a[root++] = next;
+        } else {
+            a[next] += a[leaf++];
+        }
+    }
+    a[used - 2] = 0;
+    for (next = used - 3; next >= 0; --next) {
+        a[next] = a[a[next]] + 1;
+    }
+    int available = 1, internal = 0;
+    uint32_t depth = 0;
+    root = used - 2;
+    next = used - 1;
+    while (available > 0) {
+        while (root >= 0 && a[root] == depth) {
+            internal++;
+            root--;
+        }
+        while (available > internal) {
+            a[next--] = depth;
+            available--;
+        }
+        available = 2 * internal;
+        depth++;
+        internal = 0;
+    }
+
+    // Limit the lengths, then lengthen the shortest codes that are too long to keep the code
+    // complete. The least frequent symbols get the longest codes.
+    int lengthCounts[33] = {};
+    for (int i = 0; i < used; ++i) {
+        lengthCounts[std::min(a[i], 32u)]++;
+    }
+    for (int length = maxLength + 1; length <= 32; ++length) {
+        lengthCounts[maxLength] += lengthCounts[length];
+    }
+    uint32_t kraft = 0;
+    for (int length = 1; length <= maxLength; ++length) {
+        kraft += SkToU32(lengthCounts[length]) << (maxLength - length);
+    }
+    for (; kraft > (1u << maxLength); --kraft) {
+        lengthCounts[maxLength]--;
+        for (int length = maxLength - 1; length > 0; --length) {
+            if (lengthCounts[length]) {
+                lengthCounts[length]--;
+                lengthCounts[length + 1] += 2;
+                break;
+            }
+        }
+    }
+    int i = 0;
+    for (int length = maxLength; length > 0; --length) {
+        for (int n = lengthCounts[length]; n > 0; --n) {
+            lengths[symbols[i++].fSymbol] = length;
+        }
+    }
+}
+
+// Assigns the canonical Huffman codes for `lengths`, bit-reversed to be written LSB first.
+void build_codes(const uint8_t* lengths, int count, uint16_t* codes) {
+    int lengthCounts[kMaxCodeLength + 1] = {};
+    for (int i = 0; i < count; ++i) {
+        lengthCounts[lengths[i]]++;
+    }
+    lengthCounts[0] = 0;
+    uint32_t nextCode[kMaxCodeLength + 1] = {};
+    uint32_t code = 0;
+    for (int length = 1; length <= kMaxCodeLength; ++length) {
+        code = (code + lengthCounts[length - 1]) << 1;
+        nextCode[length] = code;
+    }
+    for (int i = 0; i < count; ++i) {
+        if (int length = lengths[i]) {
+            uint32_t c = nextCode[length]++;
+            uint32_t reversed = 0;
+            for (int bit = 0; bit < length; ++bit, c >>= 1) {
+                reversed = (reversed << 1) | (c & 1);
+            }
+            codes[i] = SkToU16(reversed);
+        }
+    }
+}
+
+uint32_t load32(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+uint64_t load64(const uint8_t* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/**
+ *  SkDeflateWStream's own DEFLATE encoder, for kFastestCompressionLevel. It looks for each
+ *  match with a single hash table probe, like LZ4, instead of following zlib's hash chains,
+ *  and codes each block with its own Huffman codes. Blocks that wouldn't shrink are stored.
+ */
+class FastDeflate {
+public:
+    FastDeflate(SkWStream* out, bool gzip) : fOut(out), fGzip(gzip) {
+        if (gzip) {
+            static constexpr uint8_t kHeader[] = {0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 0, 0xFF};
+            fOut->write(kHeader, sizeof(kHeader));
+            fCheck = crc32(0, nullptr, 0);
+        } else {
+            // CMF: deflate with a 32K window, FLG: fastest, with the check bits.
+            static constexpr uint8_t kHeader[] = {0x78, 0x01};
+            fOut->write(kHeader, sizeof(kHeader));
+            fCheck = adler32(0, nullptr, 0);
+        }
+        memset(fHashTable, 0, sizeof(fHashTable));
+    }
+
+    void write(const void* buffer, size_t len) {
+        const uint8_t* src = static_cast<const uint8_t*>(buffer);
+        fTotalIn += len;
+        while (len > 0) {
+            size_t count = std::min(len, SkToSizeT(fBlockStart + kBlockSize - fFill));
+            memcpy(fBuffer + fFill, src, count);
+            fFill += count;
+            src += count;
+            len -= count;
+            if (fFill == fBlockStart + kBlockSize) {
+                this->compressBlock(false);
+            }
+        }
+    }
+
+    void finalize() {
+        this->compressBlock(true);
+        if (fBitCount % 8) {
+            this->writeBits(0, 8 - fBitCount % 8);
+        }
+        this->flushBytes();
+        uint8_t trailer[8];
+        if (fGzip) {
+            for (int i = 0; i < 4; ++i) {
+                trailer[i] = SkToU8((fCheck >> (8 * i)) & 0xFF);
+                trailer[4 + i] = SkToU8((fTotalIn >> (8 * i)) & 0xFF);
+            }
+            this->writeOutput(trailer, 8);
+        } else {
+            for (int i = 0; i < 4; ++i) {
+                trailer[i] = SkToU8((fCheck >> (24 - 8 * i)) & 0xFF);
+            }
+            this->writeOutput(trailer, 4);
+        }
+        this->flushOutput();
+    }
+
+    size_t bytesWritten() const { return SkToSizeT(fTotalIn); }
+
+private:
+    static constexpr int kBlockSize = 32768;  // Small enough to store.
+    static constexpr int kHashBits = 14;
+
+    void writeBits(uint32_t bits, int count) {
+        fBits |= static_cast<uint64_t>(bits) << fBitCount;
+        fBitCount += count;
+        if (fBitCount >= 32) {
+            uint32_t word = static_cast<uint32_t>(fBits);
+            this->writeOutput(&word, sizeof(word));
+            fBits >>= 32;
+            fBitCount -= 32;
+        }
+    }
+
+    // Moves whole bytes from fBits to fOutput.
+    void flushBytes() {
+        for (; fBitCount >= 8; fBitCount -= 8, fBits >>= 8) {
+            fOutput[fOutputSize++] = static_cast<uint8_t>(fBits);
+        }
+    }
+
+    void writeOutput(const void* data, size_t size) {
+        SkASSERT(fOutputSize + size <= sizeof(fOutput));
+        memcpy(fOutput + fOutputSize, data, size);
+        fOutputSize += size;
+    }
+
+    void flushOutput() {
+        fOut->write(fOutput, fOutputSize);
+        fOutputSize = 0;
+    }
+
+    void compressBlock(bool final);
+
+    SkWStream* fOut;
+    const bool fGzip;
+    uint32_t fCheck;
+    uint64_t fTotalIn = 0;
+    uint64_t fBufferOffset = 0;  // Stream offset of fBuffer[0], modulo 2^32 in fHashTable.
+    int fBlockStart = 0;         // Bytes of history before the next block in fBuffer.
+    int fFill = 0;
+    uint64_t fBits = 0;
+    int fBitCount = 0;
+    size_t fOutputSize = 0;
+    uint32_t fHashTable[1 << kHashBits];
+    uint32_t fSymbols[kBlockSize];  // A literal byte, or a match's length << 16 | distance.
+    uint8_t fBuffer[kWindowSize + kBlockSize];
+    // Big enough for a block of 15-bit literals, its code lengths, and the trailer.
+    uint8_t fOutput[kBlockSize * 2 + 1024];
+};
+
+void FastDeflate::compressBlock(bool final) {
+    TRACE_EVENT0("skia", TRACE_FUNC);
+    const int start = fBlockStart, end = fFill;
+    const uint8_t* buffer = fBuffer;
+    uint32_t litLenFreq[kLitLenSymbols] = {};
+    uint32_t distFreq[kDistSymbols] = {};
+    int symbolCount = 0;
+    int i = start;
+    while (i + kMinMatch <= end) {
+        const uint32_t bytes = load32(buffer + i);
+        const uint32_t hash = (bytes * 2654435761u) >> (32 - kHashBits);
+        const uint32_t position = static_cast<uint32_t>(fBufferOffset + i);
+        const uint32_t distance = position - fHashTable[hash];
+        fHashTable[hash] = position;
+        // Stale entries are harmless, since the bytes are compared.
+        if (distance - 1 < kWindowSize && distance <= SkToU32(i) &&
+            load32(buffer + i - distance) == bytes) {
+            const uint8_t* current = buffer + i;
+            const uint8_t* previous = current - distance;
+            const int maxLength = std::min(kMaxMatch, end - i);
+            int length = kMinMatch;
+            while (length + 8 <= maxLength &&
+                   load64(current + length) == load64(previous + length)) {
+                length += 8;
+            }
+            while (length < maxLength && current[length] == previous[length]) {
+                length++;
+            }
+            fSymbols[symbolCount++] = SkToU32(length) << 16 | distance;
+            litLenFreq[length_symbol(length)]++;
+            uint32_t extra;
+            int extraBits;
+            distFreq[distance_symbol(distance, &extra, &extraBits)]++;
+            i += length;
+        } else {
+            fSymbols[symbolCount++] = buffer[i];
+            litLenFreq[buffer[i]]++;
+            i++;
+        }
+    }
+    for (; i < end; ++i) {
+        fSymbols[symbolCount++] = buffer[i];
+        litLenFreq[buffer[i]]++;
+    }
+    litLenFreq[kEndOfBlock] = 1;
+
+    // The literal/length and distance code lengths are sent as one sequence.
+    uint8_t lengths[kLitLenSymbols + kDistSymbols];
+    uint8_t litLenLengths[kLitLenSymbols], distLengths[kDistSymbols];
+    build_code_lengths(litLenFreq, kLitLenSymbols, kMaxCodeLength, litLenLengths);
+    build_code_lengths(distFreq, kDistSymbols, kMaxCodeLength, distLengths);
+    int litLenCount = kLitLenSymbols;
+    while (litLenCount > 257 && !litLenLengths[litLenCount - 1]) {
+        litLenCount--;
+    }
+    int distCount = kDistSymbols;
+    while (distCount > 1 && !distLengths[distCount - 1]) {
+        distCount--;
+    }
+    if (!distLengths[0] && distCount == 1) {
+        distLengths[0] = 1;  // Some inflaters want at least one distance code.
+    }
+    memcpy(lengths, litLenLengths, litLenCount);
+    memcpy(lengths + litLenCount, distLengths, distCount);
+    const int lengthCount = litLenCount + distCount;
+
+    // Run-length code the code lengths: 16 repeats the previous length 3-6 times, and 17 and
+    // 18 are runs of 3-10 and 11-138 zeros. Each entry is the symbol | its extra bits << 5.
+    uint16_t codeLengthSymbols[kLitLenSymbols + kDistSymbols];
+    int codeLengthSymbolCount = 0;
+    uint32_t codeLengthFreq[kCodeLengthSymbols] = {};
+    auto addCodeLengthSymbol = [&](int symbol, int extra) {
+        codeLengthSymbols[codeLengthSymbolCount++] = SkToU16(symbol | extra << 5);
+        codeLengthFreq[symbol]++;
+    };
+    for (int j = 0; j < lengthCount;) {
+        const int length = lengths[j];
+        int run = 1;
+        while (j + run < lengthCount && lengths[j + run] == length) {
+            run++;
+        }
+        j += run;
+        if (length == 0) {
+            for (; run >= 11; run -= std::min(run, 138)) {
+                addCodeLengthSymbol(18, std::min(run, 138) - 11);
+            }
+            if (run >= 3) {
+                addCodeLengthSymbol(17, run - 3);
+                run = 0;
+            }
+        } else {
+            addCodeLengthSymbol(length, 0);
+            for (run--; run >= 3; run -= std::min(run, 6)) {
+                addCodeLengthSymbol(16, std::min(run, 6) - 3);
+            }
+        }
+        for (; run > 0; run--) {
+            addCodeLengthSymbol(length, 0);
+        }
+    }
+    uint8_t codeLengthLengths[kCodeLengthSymbols];
+    build_code_lengths(codeLengthFreq, kCodeLengthSymbols, kMaxCodeLengthCodeLength,
+                       codeLengthLengths);
+    int codeLengthCount = kCodeLengthSymbols;
+    while (codeLengthCount > 4 && !codeLengthLengths[kCodeLengthOrder[codeLengthCount - 1]]) {
+        codeLengthCount--;
+    }
+
+    uint16_t litLenCodes[kLitLenSymbols], distCodes[kDistSymbols];
+    uint16_t codeLengthCodes[kCodeLengthSymbols];
+    build_codes(litLenLengths, kLitLenSymbols, litLenCodes);
+    build_codes(distLengths, kDistSymbols, distCodes);
+    build_codes(codeLengthLengths, kCodeLengthSymbols, codeLengthCodes);
+    static constexpr int kCodeLengthExtraBits[kCodeLengthSymbols] = {
+            0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 3, 7};
+
+    // Store the block instead if coding it wouldn't save anything.
+    uint64_t codedBits = 3 + 5 + 5 + 4 + 3 * codeLengthCount;
+    for (int j = 0; j < codeLengthSymbolCount; ++j) {
+        const int symbol = codeLengthSymbols[j] & 31;
+        codedBits += codeLengthLengths[symbol] + kCodeLengthExtraBits[symbol];
+    }
+    for (int symbol = 0; symbol < kLitLenSymbols; ++symbol) {
+        int extraBits = symbol > kEndOfBlock ? kLengthExtraBits[symbol - 257] : 0;
+        codedBits += static_cast<uint64_t>(litLenFreq[symbol]) * (litLenLengths[symbol] + extraBits);
+    }
+    for (int symbol = 0; symbol < kDistSymbols; ++symbol) {
+        int extraBits = symbol < 4 ? 0 : symbol / 2 - 1;
+        codedBits += static_cast<uint64_t>(distFreq[symbol]) * (distLengths[symbol] + extraBits);
+    }
+    const uint64_t storedBits = 3 + 7 + 32 + 8 * static_cast<uint64_t>(end - start);
+
+    this->writeBits(final, 1);
+    if (codedBits >= storedBits) {
+        this->writeBits(0, 2);
+        if (fBitCount % 8) {
+            this->writeBits(0, 8 - fBitCount % 8);
+        }
+        this->flushBytes();
+        const uint16_t size = SkToU16(end - start);
+        const uint8_t header[4] = {SkToU8(size & 0xFF), SkToU8(size >> 8),
+                                   SkToU8(~size & 0xFF), SkToU8((~size >> 8) & 0xFF)};
+        this->writeOutput(header, sizeof(header));
+        this->flushOutput();
+        fOut->write(buffer + start, end - start);
+    } else {
+        this->writeBits(2, 2);
+        this->writeBits(litLenCount - 257, 5);
+        this->writeBits(distCount - 1, 5);
+        this->writeBits(codeLengthCount - 4, 4);
+        for (int j = 0; j < codeLengthCount; ++j) {
+            this->writeBits(codeLengthLengths[kCodeLengthOrder[j]], 3);
+        }
+        for (int j = 0; j < codeLengthSymbolCount; ++j) {
+            const int symbol = codeLengthSymbols[j] & 31;
+            this->writeBits(codeLengthCodes[symbol], codeLengthLengths[symbol]);
+            this->writeBits(codeLengthSymbols[j] >> 5, kCodeLengthExtraBits[symbol]);
+        }
+        for (int j = 0; j < symbolCount; ++j) {
+            const uint32_t entry = fSymbols[j];
+            if (entry < 256) {
+                this->writeBits(litLenCodes[entry], litLenLengths[entry]);
+                continue;
+            }
+            const int length = entry >> 16;
+            const int lengthSymbol = length_symbol(length);
+            const int lengthBits = litLenLengths[lengthSymbol];
+            this->writeBits(litLenCodes[lengthSymbol] |
+                                    (length - kLengthBase[lengthSymbol - 257]) << lengthBits,
+                            lengthBits + kLengthExtraBits[lengthSymbol - 257]);
+            uint32_t extra;
+            int extraBits;
+            const int distSymbol = distance_symbol(entry & 0xFFFF, &extra, &extraBits);
+            const int distBits = distLengths[distSymbol];
+            this->writeBits(distCodes[distSymbol] | extra << distBits, distBits + extraBits);
+        }
+        this->writeBits(litLenCodes[kEndOfBlock], litLenLengths[kEndOfBlock]);
+        this->flushOutput();
+    }
+
+    const uInt size = SkToUInt(end - start);
+    fCheck = fGzip ? crc32(fCheck, buffer + start, size) : adler32(fCheck, buffer + start, size);
+
+    // Keep the last window of input as history for the next block.
+    if (end > kWindowSize) {
+        memmove(fBuffer, fBuffer + end - kWindowSize, kWindowSize);
+        fBufferOffset += end - kWindowSize;
+        fFill = kWindowSize;
+    }
+    fBlockStart = fFill;
+}
+
 }  // namespace
 
 #define SKDEFLATEWSTREAM_INPUT_BUFFER_SIZE 4096
@@ -65,6 +555,7 @@ struct SkDeflateWStream::Impl {
     unsigned char fInBuffer[SKDEFLATEWSTREAM_INPUT_BUFFER_SIZE];
     size_t fInBufferIndex;
     z_stream fZStream;
+    std::unique_ptr<FastDeflate> fFast;  // Used instead of zlib, at kFastestCompressionLevel.
 };
 
 SkDeflateWStream::SkDeflateWStream(SkWStream* out,
@@ -83,6 +574,10 @@ SkDeflateWStream::SkDeflateWStream(SkWStream* out,
     if (!fImpl->fOut) {
         return;
     }
+    if (compressionLevel == kFastestCompressionLevel) {
+        fImpl->fFast = std::make_unique<FastDeflate>(out, gzip);
+        return;
+    }
     fImpl->fZStream.next_in = nullptr;
     fImpl->fZStream.zalloc = &skia_alloc_func;
     fImpl->fZStream.zfree = &skia_free_func;
@@ -101,9 +596,13 @@ void SkDeflateWStream::finalize() {
     if (!fImpl->fOut) {
         return;
     }
-    do_deflate(Z_FINISH, &fImpl->fZStream, fImpl->fOut, fImpl->fInBuffer,
-               fImpl->fInBufferIndex);
-    (void)deflateEnd(&fImpl->fZStream);
+    if (fImpl->fFast) {
+        fImpl->fFast->finalize();
+    } else {
+        do_deflate(Z_FINISH, &fImpl->fZStream, fImpl->fOut, fImpl->fInBuffer,
+                   fImpl->fInBufferIndex);
+        (void)deflateEnd(&fImpl->fZStream);
+    }
     fImpl->fOut = nullptr;
 }
 
@@ -112,6 +611,10 @@ bool SkDeflateWStream::write(const void* void_buffer, size_t len) {
     if (!fImpl->fOut) {
         return false;
     }
+    if (fImpl->fFast) {
+        fImpl->fFast->write(void_buffer, len);
+        return true;
+    }
     const char* buffer = (const char*)void_buffer;
     while (len > 0) {
         size_t tocopy =
@@ -133,5 +636,8 @@ bool SkDeflateWStream::write(const void* void_buffer, size_t len) {
 }
 
 size_t SkDeflateWStream::bytesWritten() const {
+    if (fImpl->fFast) {
+        return fImpl->fFast->bytesWritten();
+    }
     return fImpl->fZStream.total_in + fImpl->fInBufferIndex;
 }
@@ -36,6 +36,7 @@
 #include "src/pdf/SkPDFDocumentPriv.h"
 #include "src/pdf/SkPDFTypes.h"
 #include "src/pdf/SkPDFUnion.h"
+#include "src/pdf/SkPDFUtils.h"
 
 #include <algorithm>
 #include <array>
@@ -414,3 +415,35 @@ SkPDFIndirectReference SkPDFSerializeImage(const SkImage* img,
     serialize_image(img, encodingQuality, doc, ref);
     return ref;
 }
+
+bool SkPDFDigestImage(const SkImage* img, SkPDFDigestWStream::Digest* digest) {
+    SkASSERT(img);
+    SkASSERT(digest);
+    SkPDFDigestWStream stream;
+    // Serialization depends on the color space and dimensions as well as the pixels, and encoded
+    // data doesn't include any color space the image was tagged with.
+    const SkColorSpace* colorSpace = img->colorSpace();
+    const uint64_t header[] = {
+        static_cast<uint64_t>(img->width()) << 32 | static_cast<uint32_t>(img->height()),
+        static_cast<uint64_t>(img->colorType()) << 32 | static_cast<uint32_t>(img->alphaType()),
+        colorSpace ? colorSpace->hash() : 0,
+    };
+    stream.write(header, sizeof(header));
+    if (sk_sp<SkData> data = img->refEncodedData()) {
+        stream.write8('E');
+        stream.write(data->data(), data->size());
+    } else {
+        SkBitmap bm;
+        if (!SkPDFUtils::ToBitmap(img, &bm)) {
+            return false;
+        }
+        stream.write8('P');
+        const SkPixmap& pm = bm.pixmap();
+        const size_t rowBytes = pm.info().minRowBytes();
+        for (int y = 0; y < pm.height(); ++y) {
+            stream.write(pm.addr(0, y), rowBytes);
+        }
+    }
+    *digest = stream.digest();
+    return true;
+}
@@ -10,6 +10,7 @@
 #include "include/core/SkData.h"
 #include "include/core/SkRefCnt.h"
 #include "src/core/SkChecksum.h"
+#include "src/pdf/SkPDFUtils.h"
 
 #include <cstdint>
 
@@ -27,6 +28,16 @@ SkPDFIndirectReference SkPDFSerializeImage(const SkImage* img,
                                            SkPDFDocument* doc,
                                            int encodingQuality = 101);
 
+/**
+ * Digest the content of an image, so that identical images drawn from different SkImages can
+ * share an Image XObject.  Returns false if the image's pixels can't be read.
+ *
+ * Images with encoded data are digested from it.  Otherwise this reads (decoding or
+ * rasterizing, if need be) and hashes every pixel on the calling thread, even when the
+ * document has an executor, and SkPDFSerializeImage then reads them again.
+ */
+bool SkPDFDigestImage(const SkImage* img, SkPDFDigestWStream::Digest* digest);
+
 class SkPDFBitmap {
 public:
     static const SkEncodedInfo& GetEncodedInfo(SkCodec&);
@@ -416,7 +416,7 @@ void SkPDFDevice::drawAnnotation(const SkRect& rect, const char key[], SkData* v
     if (linkType != SkPDFLink::Type::kNone) {
         std::unique_ptr<SkPDFLink> link = std::make_unique<SkPDFLink>(
             linkType, value, transformedRect, fNodeId);
-        fDocument->fCurrentPageLinks.push_back(std::move(link));
+        fDocument->currentPageLinks().push_back(std::move(link));
     }
 }
 
@@ -590,11 +590,12 @@ void SkPDFDevice::setGraphicState(SkPDFIndirectReference gs, SkDynamicMemoryWStr
 
 void SkPDFDevice::clearMaskOnGraphicState(SkDynamicMemoryWStream* contentStream) {
     // The no-softmask graphic state is used to "turn off" the mask for later draw calls.
-    SkPDFIndirectReference& noSMaskGS = fDocument->fNoSmaskGraphicState;
-    if (!noSMaskGS) {
+    SkPDFIndirectReference noSMaskGS;
+    if (!fDocument->findCanonical(fDocument->fNoSmaskGraphicState, &noSMaskGS)) {
         SkPDFDict tmp("ExtGState");
         tmp.insertName("SMask", "None");
         noSMaskGS = fDocument->emit(tmp);
+        fDocument->setCanonical(&fDocument->fNoSmaskGraphicState, noSMaskGS);
     }
     this->setGraphicState(noSMaskGS, contentStream);
 }
@@ -772,7 +773,7 @@ private:
 };
 }  // namespace
 
-static SkUnichar map_glyph(const std::vector<SkUnichar>& glyphToUnicode, SkGlyphID glyph) {
+static SkUnichar map_glyph(SkSpan<const SkUnichar> glyphToUnicode, SkGlyphID glyph) {
     return glyph < glyphToUnicode.size() ? glyphToUnicode[SkToInt(glyph)] : -1;
 }
 
@@ -884,7 +885,7 @@ void SkPDFDevice::internalDrawGlyphRun(
     }
     SkAdvancedTypefaceMetrics::FontType fontType = SkPDFFont::FontType(*typeface, *metrics);
 
-    const std::vector<SkUnichar>& glyphToUnicode = SkPDFFont::GetUnicodeMap(typeface, fDocument);
+    SkSpan<const SkUnichar> glyphToUnicode = SkPDFFont::GetUnicodeMap(typeface, fDocument);
 
     SkClusterator clusterator(glyphRun);
 
@@ -1727,19 +1728,26 @@ void SkPDFDevice::internalDrawImageRect(SkKeyedImage imageSubset,
         if (!imageSubset) {
             return;
         }
-        // TODO(halcanary): de-dupe this by caching filtered images.
-        // (maybe in the resource cache?)
+        // TODO(halcanary): cache filtered images, so they aren't filtered again.
+        // (maybe in the resource cache?) The content digest below only de-dupes the output.
     }
 
     SkBitmapKey key = imageSubset.key();
-    SkPDFIndirectReference* pdfimagePtr = fDocument->fPDFBitmapMap.find(key);
-    SkPDFIndirectReference pdfimage = pdfimagePtr ? *pdfimagePtr : SkPDFIndirectReference();
-    if (!pdfimagePtr) {
+    SkPDFIndirectReference pdfimage;
+    if (!fDocument->findCanonical(fDocument->fPDFBitmapMap, key, &pdfimage)) {
         SkASSERT(imageSubset);
-        pdfimage = SkPDFSerializeImage(imageSubset.image().get(), fDocument,
-                                       fDocument->metadata().fEncodingQuality);
+        // The same pixels often arrive in different SkImages, e.g. a logo decoded once per page.
+        SkPDFDigestWStream::Digest digest;
+        bool hasDigest = SkPDFDigestImage(imageSubset.image().get(), &digest);
+        if (!hasDigest || !fDocument->findCanonical(fDocument->fImageDigestMap, digest, &pdfimage)) {
+            pdfimage = SkPDFSerializeImage(imageSubset.image().get(), fDocument,
+                                           fDocument->metadata().fEncodingQuality);
+            if (hasDigest) {
+                fDocument->setCanonical(fDocument->fImageDigestMap, digest, pdfimage);
+            }
+        }
         SkASSERT((key != SkBitmapKey{{0, 0, 0, 0}, 0}));
-        fDocument->fPDFBitmapMap.set(key, pdfimage);
+        fDocument->setCanonical(fDocument->fPDFBitmapMap, key, pdfimage);
     }
     SkASSERT(pdfimage != SkPDFIndirectReference());
     this->drawFormXObject(pdfimage, content.stream(), &shape);
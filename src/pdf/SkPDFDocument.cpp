@@ -10,7 +10,9 @@
 #include "include/core/SkCanvas.h"
 #include "include/core/SkData.h"
 #include "include/core/SkImageInfo.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkMatrix.h"
+#include "include/core/SkPicture.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkSize.h"
 #include "include/core/SkStream.h"
@@ -158,18 +160,24 @@ static void serialize_footer(const SkPDFOffsetMap& offsetMap,
     wStream->writeText("\n%%EOF\n");
 }
 
+// The most children a node of the page tree has.
+static constexpr size_t kPageTreeNodeSize = 8;
+
 static SkPDFIndirectReference generate_page_tree(
         SkPDFDocument* doc,
         std::vector<std::unique_ptr<SkPDFDict>> pages,
-        const std::vector<SkPDFIndirectReference>& pageRefs) {
+        const std::vector<SkPDFIndirectReference>& pageRefs,
+        const std::vector<SkPDFIndirectReference>& pageParents) {
     // PDF wants a tree describing all the pages in the document.  We arbitrary
-    // choose 8 (kNodeSize) as the number of allowed children.  The internal
+    // choose 8 (kPageTreeNodeSize) as the number of allowed children.  The internal
     // nodes have type "Pages" with an array of children, a parent pointer, and
     // the number of leaves below the node as "Count."  The leaves are passed
     // into the method, have type "Page" and need a parent pointer. This method
     // builds the tree bottom up, skipping internal nodes that would have only
     // one child.
-    SkASSERT(!pages.empty());
+    // Streamed pages have been written already, with one of pageParents for each
+    // group of kPageTreeNodeSize pages, so the tree is built up from those parents.
+    SkASSERT(!pageRefs.empty());
     struct PageTreeNode {
         std::unique_ptr<SkPDFDict> fNode;
         SkPDFIndirectReference fReservedRef;
@@ -177,10 +185,9 @@ static SkPDFIndirectReference generate_page_tree(
 
         static std::vector<PageTreeNode> Layer(std::vector<PageTreeNode> vec, SkPDFDocument* doc) {
             std::vector<PageTreeNode> result;
-            static constexpr size_t kMaxNodeSize = 8;
             const size_t n = vec.size();
             SkASSERT(n >= 1);
-            const size_t result_len = (n - 1) / kMaxNodeSize + 1;
+            const size_t result_len = (n - 1) / kPageTreeNodeSize + 1;
             SkASSERT(result_len >= 1);
             SkASSERT(n == 1 || result_len < n);
             result.reserve(result_len);
@@ -193,7 +200,7 @@ static SkPDFIndirectReference generate_page_tree(
                 SkPDFIndirectReference parent = doc->reserveRef();
                 auto kids_list = SkPDFMakeArray();
                 int descendantCount = 0;
-                for (size_t j = 0; j < kMaxNodeSize && index < n; ++j) {
+                for (size_t j = 0; j < kPageTreeNodeSize && index < n; ++j) {
                     PageTreeNode& node = vec[index++];
                     node.fNode->insertRef("Parent", parent);
                     kids_list->appendRef(doc->emit(*node.fNode, node.fReservedRef));
@@ -208,12 +215,32 @@ static SkPDFIndirectReference generate_page_tree(
         }
     };
     std::vector<PageTreeNode> currentLayer;
-    currentLayer.reserve(pages.size());
-    SkASSERT(pages.size() == pageRefs.size());
-    for (size_t i = 0; i < pages.size(); ++i) {
-        currentLayer.push_back(PageTreeNode{std::move(pages[i]), pageRefs[i], 1});
+    if (pageParents.empty()) {
+        currentLayer.reserve(pages.size());
+        SkASSERT(pages.size() == pageRefs.size());
+        for (size_t i = 0; i < pages.size(); ++i) {
+            currentLayer.push_back(PageTreeNode{std::move(pages[i]), pageRefs[i], 1});
+        }
+        currentLayer = PageTreeNode::Layer(std::move(currentLayer), doc);
+    } else {
+        currentLayer.reserve(pageParents.size());
+        SkASSERT(pages.empty());
+        SkASSERT(pageParents.size() == (pageRefs.size() - 1) / kPageTreeNodeSize + 1);
+        for (size_t i = 0; i < pageParents.size(); ++i) {
+            const size_t first = i * kPageTreeNodeSize;
+            const size_t end = std::min(first + kPageTreeNodeSize, pageRefs.size());
+            auto kids_list = SkPDFMakeArray();
+            kids_list->reserve(SkToInt(end - first));
+            for (size_t j = first; j < end; ++j) {
+                kids_list->appendRef(pageRefs[j]);
+            }
+            auto node = SkPDFMakeDict("Pages");
+            node->insertInt("Count", SkToInt(end - first));
+            node->insertObject("Kids", std::move(kids_list));
+            currentLayer.push_back(PageTreeNode{std::move(node), pageParents[i],
+                                                SkToInt(end - first)});
+        }
     }
-    currentLayer = PageTreeNode::Layer(std::move(currentLayer), doc);
     while (currentLayer.size() > 1) {
         currentLayer = PageTreeNode::Layer(std::move(currentLayer), doc);
     }
@@ -228,6 +255,33 @@ static void reset_object(T* dst, Args&&... args) {
     new (dst) T(std::forward<Args>(args)...);
 }
 
+// Each page draws on its own thread, and then finishes in page order: it numbers objects only
+// after the page before it has finished. Any page may claim and draw an earlier page that
+// hasn't started, so a page never waits for a page that isn't being drawn.
+struct SkPDFDocument::PageJob {
+    const SkPDFDocument* fDocument;
+    PageJob* fPrevious;
+    size_t fIndex;
+    SkISize fPageSize;
+    SkMatrix fInitialTransform;
+    sk_sp<SkPicture> fPicture;
+
+    sk_sp<SkPDFDevice> fDevice;
+    std::vector<std::unique_ptr<SkPDFLink>> fLinks;
+    bool fInOrder = false;
+    SkPDFIndirectReference fRef;
+    std::unique_ptr<SkPDFDict> fPage;
+
+    std::atomic<bool> fClaimed = {false};
+    SkSemaphore fFinished;
+};
+
+// At most this many pages are recorded but not yet finished.
+static constexpr size_t kMaxUnfinishedPages = 16;
+
+// When streaming, at most this many jobs are left running at the end of a page.
+static constexpr int kMaxStreamingJobs = 16;
+
 ////////////////////////////////////////////////////////////////////////////////
 
 SkPDFDocument::SkPDFDocument(SkWStream* stream,
@@ -243,6 +297,7 @@ SkPDFDocument::SkPDFDocument(SkWStream* stream,
         fTagTree.init(fMetadata.fStructureElementTreeRoot, fMetadata.fOutline);
     }
     fExecutor = fMetadata.fExecutor;
+    fConcurrentPages = fExecutor && fMetadata.fConcurrentPages;
 }
 
 SkPDFDocument::~SkPDFDocument() {
@@ -271,7 +326,7 @@ static SkSize operator*(SkSize u, SkScalar s) { return SkSize{u.width() * s, u.h
 
 SkCanvas* SkPDFDocument::onBeginPage(SkScalar width, SkScalar height) {
     SkASSERT(fCanvas.imageInfo().dimensions().isZero());
-    if (fPages.empty()) {
+    if (fPageRefs.empty() && fPageJobs.empty()) {
         // if this is the first page if the document.
         {
             SkAutoMutexExclusive autoMutexAcquire(fMutex);
@@ -300,6 +355,16 @@ SkCanvas* SkPDFDocument::onBeginPage(SkScalar width, SkScalar height) {
     // bottom left. This matrix corrects for that, as well as the raster scale.
     initialTransform.setScaleTranslate(fInverseRasterScale, -fInverseRasterScale,
                                        0, fInverseRasterScale * pageSize.height());
+    if (fConcurrentPages) {
+        auto job = std::make_shared<PageJob>();
+        job->fDocument = this;
+        job->fPrevious = fPageJobs.empty() ? nullptr : fPageJobs.back().get();
+        job->fIndex = fPageRefs.size() + fPageJobs.size();
+        job->fPageSize = pageSize;
+        job->fInitialTransform = initialTransform;
+        fPageJobs.push_back(std::move(job));
+        return fRecorder.beginRecording(width, height);
+    }
     fPageDevice = sk_make_sp<SkPDFDevice>(pageSize, this, initialTransform);
     reset_object(&fCanvas, fPageDevice);
     fCanvas.scale(fRasterScale, fRasterScale);
@@ -337,13 +402,14 @@ static SkPDFIndirectReference append_destinations(
 
 std::unique_ptr<SkPDFArray> SkPDFDocument::getAnnotations() {
     std::unique_ptr<SkPDFArray> array;
-    size_t count = fCurrentPageLinks.size();
+    const std::vector<std::unique_ptr<SkPDFLink>>& links = this->currentPageLinks();
+    size_t count = links.size();
     if (0 == count) {
         return array;  // is nullptr
     }
     array = SkPDFMakeArray();
     array->reserve(count);
-    for (const auto& link : fCurrentPageLinks) {
+    for (const auto& link : links) {
         SkPDFDict annotation("Annot");
         populate_link_annotation(&annotation, link->fRect);
         if (link->fType == SkPDFLink::Type::kUrl) {
@@ -374,36 +440,172 @@ std::unique_ptr<SkPDFArray> SkPDFDocument::getAnnotations() {
     return array;
 }
 
-void SkPDFDocument::onEndPage() {
-    SkASSERT(!fCanvas.imageInfo().dimensions().isZero());
-    reset_object(&fCanvas);
-    SkASSERT(fPageDevice);
-
+std::unique_ptr<SkPDFDict> SkPDFDocument::makePage(sk_sp<SkPDFDevice>* device) {
     auto page = SkPDFMakeDict("Page");
 
-    SkSize mediaSize = fPageDevice->imageInfo().dimensions() * fInverseRasterScale;
-    std::unique_ptr<SkStreamAsset> pageContent = fPageDevice->content();
-    auto resourceDict = fPageDevice->makeResourceDict();
-    SkASSERT(!fPageRefs.empty());
-    fPageDevice = nullptr;
+    SkSize mediaSize = (*device)->imageInfo().dimensions() * fInverseRasterScale;
+    std::unique_ptr<SkStreamAsset> pageContent = (*device)->content();
+    auto resourceDict = (*device)->makeResourceDict();
+    *device = nullptr;
 
     page->insertObject("Resources", std::move(resourceDict));
     page->insertObject("MediaBox", SkPDFUtils::RectToArray(SkRect::MakeSize(mediaSize)));
 
     if (std::unique_ptr<SkPDFArray> annotations = getAnnotations()) {
         page->insertObject("Annots", std::move(annotations));
-        fCurrentPageLinks.clear();
+        this->currentPageLinks().clear();
     }
 
     page->insertRef("Contents", SkPDFStreamOut(nullptr, std::move(pageContent), this));
     // The StructParents unique identifier for each page is just its
     // 0-based page index.
     page->insertInt("StructParents", SkToInt(this->currentPageIndex()));
-    fPages.emplace_back(std::move(page));
+    return page;
+}
+
+void SkPDFDocument::onEndPage() {
+    if (fConcurrentPages) {
+        std::shared_ptr<PageJob> job = fPageJobs.back();
+        job->fPicture = fRecorder.finishRecordingAsPicture();
+        this->incrementJobCount();
+        // The task keeps its job alive, since the page may be finished and released first.
+        fExecutor->add([this, job = std::move(job)]() {
+            if (!job->fClaimed.exchange(true)) {
+                this->drawPageJob(job.get());
+            }
+            this->signalJobComplete();
+        });
+        if (fPageJobs.size() > kMaxUnfinishedPages) {
+            const size_t finished = fPageJobs.size() - 1 - kMaxUnfinishedPages;
+            this->finishPageJob(fPageJobs[finished].get());
+            // The pages before it have finished, and no page waits for them any more.
+            this->releasePageJobs(finished);
+        }
+    } else {
+        SkASSERT(!fCanvas.imageInfo().dimensions().isZero());
+        reset_object(&fCanvas);
+        SkASSERT(fPageDevice);
+        SkASSERT(!fPageRefs.empty());
+        std::unique_ptr<SkPDFDict> page = this->makePage(&fPageDevice);
+        if (fMetadata.fStreaming) {
+            this->streamPage(std::move(page), fPageRefs.back(), fPageRefs.size() - 1);
+        } else {
+            fPages.push_back(std::move(page));
+        }
+    }
+    if (fMetadata.fStreaming) {
+        this->waitForJobs(kMaxStreamingJobs);
+    }
+}
+
+void SkPDFDocument::streamPage(std::unique_ptr<SkPDFDict> page,
+                               SkPDFIndirectReference ref,
+                               size_t index) {
+    // The first page of each group numbers the group's parent, which is written at close.
+    if (index % kPageTreeNodeSize == 0) {
+        fPageTreeParents.push_back(this->reserveRef());
+    }
+    page->insertRef("Parent", fPageTreeParents.back());
+    this->emit(*page, ref);
+}
+
+SkPDFDocument::PageJob*& SkPDFDocument::ThreadPageJob() {
+    static thread_local PageJob* gPageJob = nullptr;
+    return gPageJob;
+}
+
+SkPDFDocument::PageJob* SkPDFDocument::currentPageJob() const {
+    if (!fConcurrentPages) {
+        return nullptr;
+    }
+    PageJob* job = ThreadPageJob();
+    return job && job->fDocument == this ? job : nullptr;
+}
+
+void SkPDFDocument::drawPageJob(PageJob* job) {
+    PageJob* outerJob = ThreadPageJob();
+    ThreadPageJob() = job;
+
+    job->fDevice = sk_make_sp<SkPDFDevice>(job->fPageSize, this, job->fInitialTransform);
+    {
+        SkCanvas canvas(job->fDevice);
+        canvas.scale(fRasterScale, fRasterScale);
+        job->fPicture->playback(&canvas);
+    }
+    job->fPicture = nullptr;
+    job->fPage = this->makePage(&job->fDevice);
+    SkASSERT(job->fInOrder);
+    if (fMetadata.fStreaming) {
+        this->streamPage(std::move(job->fPage), job->fRef, job->fIndex);
+    }
+
+    ThreadPageJob() = outerJob;
+    job->fFinished.signal();
+}
+
+void SkPDFDocument::finishPageJob(PageJob* job) {
+    if (!job->fClaimed.exchange(true)) {
+        this->drawPageJob(job);
+        return;
+    }
+    // Let any other thread waiting for this page through too.
+    job->fFinished.wait();
+    job->fFinished.signal();
+}
+
+void SkPDFDocument::finishPageJobs() {
+    if (fPageJobs.empty()) {
+        return;
+    }
+    // Pages finish in order, so the last page finishes after all the others.
+    this->finishPageJob(fPageJobs.back().get());
+    this->releasePageJobs(fPageJobs.size());
+}
+
+void SkPDFDocument::releasePageJobs(size_t count) {
+    SkASSERT(count <= fPageJobs.size());
+    for (; count > 0; --count) {
+        const std::shared_ptr<PageJob>& job = fPageJobs.front();
+        fPageRefs.push_back(job->fRef);
+        if (job->fPage) {
+            fPages.push_back(std::move(job->fPage));
+        }
+        fPageJobs.pop_front();
+    }
+}
+
+bool SkPDFDocument::waitForPageOrder() {
+    PageJob* job = this->currentPageJob();
+    if (!job || job->fInOrder) {
+        return false;
+    }
+    if (job->fPrevious) {
+        this->finishPageJob(job->fPrevious);
+    }
+    job->fInOrder = true;
+    // A page drawn one at a time numbers itself before anything on it.
+    job->fRef = SkPDFIndirectReference{fNextObjectNumber++};
+    return true;
+}
+
+bool SkPDFDocument::findCanonical(const SkPDFIndirectReference& object,
+                                  SkPDFIndirectReference* value) {
+    auto lookUp = [&]() {
+        SkAutoMutexExclusive lock(fCanonicalMutex);
+        *value = object;
+        return bool(object);
+    };
+    return lookUp() || (this->waitForPageOrder() && lookUp());
+}
+
+void SkPDFDocument::setCanonical(SkPDFIndirectReference* object, SkPDFIndirectReference value) {
+    SkAutoMutexExclusive lock(fCanonicalMutex);
+    *object = value;
 }
 
 void SkPDFDocument::onAbort() {
     this->waitForJobs();
+    fPageJobs.clear();
 }
 
 static sk_sp<SkData> SkSrgbIcm() {
@@ -546,12 +748,45 @@ SkPDFIndirectReference SkPDFDocument::getPage(size_t pageIndex) const {
     return fPageRefs[pageIndex];
 }
 
+bool SkPDFDocument::hasCurrentPage() const {
+    if (const PageJob* job = this->currentPageJob()) {
+        return bool(job->fDevice);
+    }
+    return bool(fPageDevice);
+}
+
+SkPDFIndirectReference SkPDFDocument::currentPage() {
+    SkASSERT(this->hasCurrentPage());
+    if (PageJob* job = this->currentPageJob()) {
+        this->waitForPageOrder();
+        return job->fRef;
+    }
+    return SkASSERT(!fPageRefs.empty()), fPageRefs.back();
+}
+
+size_t SkPDFDocument::currentPageIndex() {
+    if (const PageJob* job = this->currentPageJob()) {
+        return job->fIndex;
+    }
+    return SkASSERT(!fPageRefs.empty()), fPageRefs.size() - 1;
+}
+
+std::vector<std::unique_ptr<SkPDFLink>>& SkPDFDocument::currentPageLinks() {
+    if (PageJob* job = this->currentPageJob()) {
+        return job->fLinks;
+    }
+    return fCurrentPageLinks;
+}
+
 const SkMatrix& SkPDFDocument::currentPageTransform() const {
     static constexpr const SkMatrix gIdentity;
     // If not on a page (like when emitting a Type3 glyph) return identity.
     if (!this->hasCurrentPage()) {
         return gIdentity;
     }
+    if (const PageJob* job = this->currentPageJob()) {
+        return job->fInitialTransform;
+    }
     return fPageDevice->initialTransform();
 }
 
@@ -561,10 +796,16 @@ SkPDFTagTree::Mark SkPDFDocument::createMarkIdForNodeId(int nodeId, SkPoint p) {
     if (!this->hasCurrentPage()) {
         return SkPDFTagTree::Mark();
     }
+    if (fMetadata.fStructureElementTreeRoot) {
+        this->waitForPageOrder();
+    }
     return fTagTree.createMarkIdForNodeId(nodeId, SkToUInt(this->currentPageIndex()), p);
 }
 
 void SkPDFDocument::addNodeTitle(int nodeId, SkSpan<const char> title) {
+    if (fMetadata.fStructureElementTreeRoot) {
+        this->waitForPageOrder();
+    }
     fTagTree.addNodeTitle(nodeId, std::move(title));
 }
 
@@ -573,6 +814,9 @@ int SkPDFDocument::createStructParentKeyForNodeId(int nodeId) {
     if (!this->hasCurrentPage()) {
         return -1;
     }
+    if (fMetadata.fStructureElementTreeRoot) {
+        this->waitForPageOrder();
+    }
     return fTagTree.createStructParentKeyForNodeId(nodeId, SkToUInt(this->currentPageIndex()));
 }
 
@@ -581,7 +825,7 @@ static std::vector<const SkPDFFont*> get_fonts(const SkPDFDocument& canon) {
     fonts.reserve(canon.fFontMap.count());
     // Sort so the output PDF is reproducible.
     for (const auto& [unused, font] : canon.fFontMap) {
-        fonts.push_back(&font);
+        fonts.push_back(font.get());
     }
     std::sort(fonts.begin(), fonts.end(), [](const SkPDFFont* u, const SkPDFFont* v) {
         return u->indirectReference().fValue < v->indirectReference().fValue;
@@ -608,7 +852,8 @@ SkString SkPDFDocument::nextFontSubsetTag() {
 
 void SkPDFDocument::onClose(SkWStream* stream) {
     SkASSERT(fCanvas.imageInfo().dimensions().isZero());
-    if (fPages.empty()) {
+    this->finishPageJobs();
+    if (fPageRefs.empty()) {
         this->waitForJobs();
         return;
     }
@@ -621,7 +866,8 @@ void SkPDFDocument::onClose(SkWStream* stream) {
         docCatalog->insertObject("OutputIntents", make_srgb_output_intents(this));
     }
 
-    docCatalog->insertRef("Pages", generate_page_tree(this, std::move(fPages), fPageRefs));
+    docCatalog->insertRef("Pages",
+                          generate_page_tree(this, std::move(fPages), fPageRefs, fPageTreeParents));
 
     if (!fNamedDestinations.empty()) {
         docCatalog->insertRef("Dests", append_destinations(this, fNamedDestinations));
@@ -663,6 +909,7 @@ void SkPDFDocument::onClose(SkWStream* stream) {
     }
 
     this->waitForJobs();
+    fPageJobs.clear();
     {
         SkAutoMutexExclusive autoMutexAcquire(fMutex);
         serialize_footer(fOffsetMap, this->getStream(), fInfoDict, docCatalogRef, fUUID);
@@ -673,9 +920,9 @@ void SkPDFDocument::incrementJobCount() { fJobCount++; }
 
 void SkPDFDocument::signalJobComplete() { fSemaphore.signal(); }
 
-void SkPDFDocument::waitForJobs() {
+void SkPDFDocument::waitForJobs(int maxJobs) {
      // fJobCount can increase while we wait.
-     while (fJobCount > 0) {
+     while (fJobCount > maxJobs) {
          fSemaphore.wait();
          --fJobCount;
      }
@@ -10,6 +10,7 @@
 #include "include/core/SkCanvas.h"
 #include "include/core/SkData.h"
 #include "include/core/SkDocument.h"
+#include "include/core/SkPictureRecorder.h"
 #include "include/core/SkPoint.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
@@ -27,13 +28,16 @@
 #include "src/pdf/SkPDFShader.h"
 #include "src/pdf/SkPDFTag.h"
 #include "src/pdf/SkPDFTypes.h"
+#include "src/pdf/SkPDFUtils.h"
 #include "src/pdf/SkUUID.h"
 
 #include <cstddef>
 #include <cstdint>
 #include <atomic>
+#include <deque>
 #include <vector>
 #include <memory>
+#include <utility>
 
 class SkExecutor;
 class SkPDFDevice;
@@ -127,10 +131,8 @@ public:
     const SkPDF::Metadata& metadata() const { return fMetadata; }
 
     SkPDFIndirectReference getPage(size_t pageIndex) const;
-    bool hasCurrentPage() const { return bool(fPageDevice); }
-    SkPDFIndirectReference currentPage() const {
-        return SkASSERT(this->hasCurrentPage() && !fPageRefs.empty()), fPageRefs.back();
-    }
+    bool hasCurrentPage() const;
+    SkPDFIndirectReference currentPage();
     // Used to allow marked content to refer to its corresponding structure
     // tree node, via a page entry in the parent tree. Returns -1 if no
     // mark ID.
@@ -143,8 +145,35 @@ public:
     void addNodeTitle(int nodeId, SkSpan<const char>);
 
     std::unique_ptr<SkPDFArray> getAnnotations();
+    std::vector<std::unique_ptr<SkPDFLink>>& currentPageLinks();
+
+    SkPDFIndirectReference reserveRef() {
+        this->waitForPageOrder();
+        return SkPDFIndirectReference{fNextObjectNumber++};
+    }
+
+    // When pages are drawn concurrently, a page waits for the pages before it to finish
+    // before it numbers any object, so that objects are numbered as if the pages were drawn
+    // one at a time. Returns true if the current page was not in order before this call.
+    bool waitForPageOrder();
+
+    // Finds the canonical object for `key` and copies it (or, for owned values, a pointer
+    // to it) to `value`. A page that doesn't find `key` waits for the earlier pages, which
+    // might still make the object, and looks again.
+    template <typename K, typename V, typename H, typename T>
+    bool findCanonical(skia_private::THashMap<K, V, H>& map, const K& key, T* value) {
+        return this->lookUpCanonical(map, key, value) ||
+               (this->waitForPageOrder() && this->lookUpCanonical(map, key, value));
+    }
+    bool findCanonical(const SkPDFIndirectReference& object, SkPDFIndirectReference* value);
 
-    SkPDFIndirectReference reserveRef() { return SkPDFIndirectReference{fNextObjectNumber++}; }
+    // Adds a new canonical object. Only the page that is in order may call this.
+    template <typename K, typename V, typename H, typename Key, typename Value>
+    auto setCanonical(skia_private::THashMap<K, V, H>& map, Key&& key, Value&& value) {
+        SkAutoMutexExclusive lock(fCanonicalMutex);
+        return CanonicalValue(*map.set(std::forward<Key>(key), std::forward<Value>(value)));
+    }
+    void setCanonical(SkPDFIndirectReference* object, SkPDFIndirectReference value);
 
     // Returns a tag to prepend to a PostScript name of a subset font. Includes the '+'.
     SkString nextFontSubsetTag();
@@ -152,7 +181,7 @@ public:
     SkExecutor* executor() const { return fExecutor; }
     void incrementJobCount();
     void signalJobComplete();
-    size_t currentPageIndex() { return fPages.size(); }
+    size_t currentPageIndex();
     size_t pageCount() { return fPageRefs.size(); }
 
     const SkMatrix& currentPageTransform() const;
@@ -165,15 +194,22 @@ public:
                            SkPDFIndirectReference,
                            SkPDFGradientShader::KeyHash> fGradientPatternMap;
     skia_private::THashMap<SkBitmapKey, SkPDFIndirectReference> fPDFBitmapMap;
+    // Images and form XObjects by content, for identical content drawn from different sources.
+    skia_private::THashMap<SkPDFDigestWStream::Digest,
+                           SkPDFIndirectReference,
+                           SkPDFDigestWStream::Digest::Hash> fImageDigestMap;
+    skia_private::THashMap<SkPDFDigestWStream::Digest,
+                           SkPDFIndirectReference,
+                           SkPDFDigestWStream::Digest::Hash> fFormXObjectDigestMap;
     skia_private::THashMap<SkPDFIccProfileKey,
                            SkPDFIndirectReference,
                            SkPDFIccProfileKey::Hash> fICCProfileMap;
     skia_private::THashMap<uint32_t, std::unique_ptr<SkAdvancedTypefaceMetrics>> fTypefaceMetrics;
     skia_private::THashMap<uint32_t, std::vector<SkString>> fType1GlyphNames;
-    skia_private::THashMap<uint32_t, std::vector<SkUnichar>> fToUnicodeMap;
+    skia_private::THashMap<uint32_t, sk_sp<SkData>> fToUnicodeMap;
     skia_private::THashMap<uint32_t, SkPDFIndirectReference> fFontDescriptors;
     skia_private::THashMap<uint32_t, SkPDFIndirectReference> fType3FontDescriptors;
-    skia_private::THashMap<uint64_t, SkPDFFont> fFontMap;
+    skia_private::THashMap<uint64_t, std::unique_ptr<SkPDFFont>> fFontMap;
     skia_private::THashMap<SkPDFStrokeGraphicState,
                            SkPDFIndirectReference,
                            SkPDFStrokeGraphicState::Hash> fStrokeGSMap;
@@ -182,16 +218,21 @@ public:
                            SkPDFFillGraphicState::Hash> fFillGSMap;
     SkPDFIndirectReference fInvertFunction;
     SkPDFIndirectReference fNoSmaskGraphicState;
-    std::vector<std::unique_ptr<SkPDFLink>> fCurrentPageLinks;
     std::vector<SkPDFNamedDestination> fNamedDestinations;
 
 private:
+    // A page drawn on fExecutor, when fMetadata.fConcurrentPages is set.
+    struct PageJob;
+
     SkPDFOffsetMap fOffsetMap;
     SkCanvas fCanvas;
     std::vector<std::unique_ptr<SkPDFDict>> fPages;
     std::vector<SkPDFIndirectReference> fPageRefs;
+    // When streaming, the parent in the page tree of each group of pages already written.
+    std::vector<SkPDFIndirectReference> fPageTreeParents;
 
     sk_sp<SkPDFDevice> fPageDevice;
+    std::vector<std::unique_ptr<SkPDFLink>> fCurrentPageLinks;
     std::atomic<int> fNextObjectNumber = {1};
     std::atomic<int> fJobCount = {0};
     uint32_t fNextFontSubsetTag = {0};
@@ -209,9 +250,44 @@ private:
     SkMutex fMutex;
     SkSemaphore fSemaphore;
 
-    void waitForJobs();
+    // Guards the canonical maps, which pages drawn concurrently may read at any time.
+    SkMutex fCanonicalMutex;
+
+    bool fConcurrentPages = false;
+    SkPictureRecorder fRecorder;
+    // The pages that may still be drawing, or that such a page may still wait for. Finished pages
+    // are released to fPageRefs (and fPages, when not streaming).
+    std::deque<std::shared_ptr<PageJob>> fPageJobs;
+
+    // Waits until at most `maxJobs` jobs are left running.
+    void waitForJobs(int maxJobs = 0);
     SkWStream* beginObject(SkPDFIndirectReference);
     void endObject();
+
+    std::unique_ptr<SkPDFDict> makePage(sk_sp<SkPDFDevice>* device);
+    void streamPage(std::unique_ptr<SkPDFDict> page, SkPDFIndirectReference ref, size_t index);
+
+    static PageJob*& ThreadPageJob();
+    PageJob* currentPageJob() const;
+    void drawPageJob(PageJob*);
+    void finishPageJob(PageJob*);
+    void finishPageJobs();
+    // Moves the first `count` jobs, which must have finished, to fPageRefs and fPages.
+    void releasePageJobs(size_t count);
+
+    template <typename K, typename V, typename H, typename T>
+    bool lookUpCanonical(skia_private::THashMap<K, V, H>& map, const K& key, T* value) {
+        SkAutoMutexExclusive lock(fCanonicalMutex);
+        if (const V* found = map.find(key)) {
+            *value = CanonicalValue(*found);
+            return true;
+        }
+        return false;
+    }
+    template <typename V> static V CanonicalValue(const V& value) { return value; }
+    template <typename V> static V* CanonicalValue(const std::unique_ptr<V>& value) {
+        return value.get();
+    }
 };
 
 #endif  // SkPDFDocumentPriv_DEFINED
@@ -35,6 +35,7 @@
 #include "src/core/SkDevice.h"
 #include "src/core/SkGlyph.h"
 #include "src/core/SkMask.h"
+#include "src/core/SkResourceCache.h"
 #include "src/core/SkScalerContext.h"
 #include "src/core/SkStrike.h"
 #include "src/core/SkStrikeSpec.h"
@@ -103,25 +104,75 @@ void setGlyphWidthAndBoundingBox(SkScalar width, SkIRect box,
 
 SkPDFFont::~SkPDFFont() = default;
 
-SkPDFFont::SkPDFFont(SkPDFFont&&) = default;
-
-SkPDFFont& SkPDFFont::operator=(SkPDFFont&&) = default;
-
 static bool can_embed(const SkAdvancedTypefaceMetrics& metrics) {
     return !SkToBool(metrics.fFlags & SkAdvancedTypefaceMetrics::kNotEmbeddable_FontFlag);
 }
 
-const SkAdvancedTypefaceMetrics* SkPDFFont::GetMetrics(const SkTypeface* typeface,
-                                                       SkPDFDocument* canon) {
-    SkASSERT(typeface);
-    SkTypefaceID id = typeface->uniqueID();
-    if (std::unique_ptr<SkAdvancedTypefaceMetrics>* ptr = canon->fTypefaceMetrics.find(id)) {
-        return ptr->get();  // canon retains ownership.
+// The metrics and glyph to unicode map of a typeface are the same in every document, so they are
+// also kept in SkResourceCache for later documents.
+namespace {
+static unsigned gTypefaceKeyNamespaceLabel;
+
+struct TypefaceKey : public SkResourceCache::Key {
+    enum Kind : uint32_t { kMetrics, kGlyphToUnicode };
+
+    TypefaceKey(SkTypefaceID typefaceID, Kind kind) : fTypefaceID(typefaceID), fKind(kind) {
+        this->init(&gTypefaceKeyNamespaceLabel, 0, sizeof(fTypefaceID) + sizeof(fKind));
+    }
+
+    SkTypefaceID fTypefaceID;
+    Kind fKind;
+};
+
+// The metrics of a typeface, before a document prepends a subset tag to the PostScript name.
+struct MetricsRec : public SkResourceCache::Rec {
+    MetricsRec(SkTypefaceID typefaceID, const SkAdvancedTypefaceMetrics* metrics)
+        : fKey(typefaceID, TypefaceKey::kMetrics)
+        , fMetrics(metrics ? std::make_unique<SkAdvancedTypefaceMetrics>(*metrics) : nullptr) {}
+
+    TypefaceKey fKey;
+    std::unique_ptr<const SkAdvancedTypefaceMetrics> fMetrics;  // nullptr for a bad typeface.
+
+    const Key& getKey() const override { return fKey; }
+    size_t bytesUsed() const override {
+        return sizeof(*this) +
+               (fMetrics ? sizeof(*fMetrics) + fMetrics->fPostScriptName.size() : 0);
     }
+    const char* getCategory() const override { return "pdf-typeface-metrics"; }
+
+    static bool Visitor(const SkResourceCache::Rec& baseRec, void* contextData) {
+        const MetricsRec& rec = static_cast<const MetricsRec&>(baseRec);
+        auto result = static_cast<std::unique_ptr<SkAdvancedTypefaceMetrics>*>(contextData);
+        if (rec.fMetrics) {
+            *result = std::make_unique<SkAdvancedTypefaceMetrics>(*rec.fMetrics);
+        }
+        return true;
+    }
+};
+
+struct GlyphToUnicodeRec : public SkResourceCache::Rec {
+    GlyphToUnicodeRec(SkTypefaceID typefaceID, sk_sp<SkData> glyphToUnicode)
+        : fKey(typefaceID, TypefaceKey::kGlyphToUnicode)
+        , fGlyphToUnicode(std::move(glyphToUnicode)) {}
+
+    TypefaceKey fKey;
+    sk_sp<SkData> fGlyphToUnicode;
+
+    const Key& getKey() const override { return fKey; }
+    size_t bytesUsed() const override { return sizeof(*this) + fGlyphToUnicode->size(); }
+    const char* getCategory() const override { return "pdf-glyph-to-unicode"; }
+
+    static bool Visitor(const SkResourceCache::Rec& baseRec, void* contextData) {
+        const GlyphToUnicodeRec& rec = static_cast<const GlyphToUnicodeRec&>(baseRec);
+        *static_cast<sk_sp<SkData>*>(contextData) = rec.fGlyphToUnicode;
+        return true;
+    }
+};
+}  // namespace
+
+std::unique_ptr<SkAdvancedTypefaceMetrics> SkPDFFont::MakeMetrics(const SkTypeface* typeface) {
     int count = typeface->countGlyphs();
     if (count <= 0 || count > 1 + SkTo<int>(UINT16_MAX)) {
-        // Cache nullptr to skip this check.  Use SkSafeUnref().
-        canon->fTypefaceMetrics.set(id, nullptr);
         return nullptr;
     }
     std::unique_ptr<SkAdvancedTypefaceMetrics> metrics = typeface->getAdvancedMetrics();
@@ -158,22 +209,54 @@ const SkAdvancedTypefaceMetrics* SkPDFFont::GetMetrics(const SkTypeface* typefac
             metrics->fCapHeight = SkToS16(SkScalarRoundToInt(capHeight / 2));
         }
     }
+    return metrics;
+}
+
+const SkAdvancedTypefaceMetrics* SkPDFFont::GetMetrics(const SkTypeface* typeface,
+                                                       SkPDFDocument* canon) {
+    SkASSERT(typeface);
+    SkTypefaceID id = typeface->uniqueID();
+    const SkAdvancedTypefaceMetrics* found;
+    if (canon->findCanonical(canon->fTypefaceMetrics, id, &found)) {
+        return found;  // canon retains ownership.
+    }
+    std::unique_ptr<SkAdvancedTypefaceMetrics> metrics;
+    if (!SkResourceCache::Find(TypefaceKey(id, TypefaceKey::kMetrics), MetricsRec::Visitor,
+                               &metrics)) {
+        metrics = SkPDFFont::MakeMetrics(typeface);
+        SkResourceCache::Add(new MetricsRec(id, metrics.get()));
+    }
+    if (!metrics) {
+        // Remember that there are none, so this document doesn't look again.
+        canon->setCanonical(canon->fTypefaceMetrics, id, nullptr);
+        return nullptr;
+    }
     // Fonts are always subset, so always prepend the subset tag.
     metrics->fPostScriptName.prepend(canon->nextFontSubsetTag());
-    return canon->fTypefaceMetrics.set(id, std::move(metrics))->get();
+    return canon->setCanonical(canon->fTypefaceMetrics, id, std::move(metrics));
 }
 
-const std::vector<SkUnichar>& SkPDFFont::GetUnicodeMap(const SkTypeface* typeface,
-                                                       SkPDFDocument* canon) {
+static SkSpan<const SkUnichar> as_unichars(const sk_sp<SkData>& data) {
+    return {static_cast<const SkUnichar*>(data->data()), data->size() / sizeof(SkUnichar)};
+}
+
+SkSpan<const SkUnichar> SkPDFFont::GetUnicodeMap(const SkTypeface* typeface,
+                                                 SkPDFDocument* canon) {
     SkASSERT(typeface);
     SkASSERT(canon);
     SkTypefaceID id = typeface->uniqueID();
-    if (std::vector<SkUnichar>* ptr = canon->fToUnicodeMap.find(id)) {
-        return *ptr;
+    sk_sp<SkData> found;
+    if (canon->findCanonical(canon->fToUnicodeMap, id, &found)) {
+        return as_unichars(found);  // canon retains a ref.
+    }
+    sk_sp<SkData> glyphToUnicode;
+    if (!SkResourceCache::Find(TypefaceKey(id, TypefaceKey::kGlyphToUnicode),
+                               GlyphToUnicodeRec::Visitor, &glyphToUnicode)) {
+        glyphToUnicode = SkData::MakeZeroInitialized(typeface->countGlyphs() * sizeof(SkUnichar));
+        typeface->getGlyphToUnicodeMap(static_cast<SkUnichar*>(glyphToUnicode->writable_data()));
+        SkResourceCache::Add(new GlyphToUnicodeRec(id, glyphToUnicode));
     }
-    std::vector<SkUnichar> buffer(typeface->countGlyphs());
-    typeface->getGlyphToUnicodeMap(buffer.data());
-    return *canon->fToUnicodeMap.set(id, std::move(buffer));
+    return as_unichars(canon->setCanonical(canon->fToUnicodeMap, id, std::move(glyphToUnicode)));
 }
 
 SkAdvancedTypefaceMetrics::FontType SkPDFFont::FontType(const SkTypeface& typeface,
@@ -219,7 +302,8 @@ SkPDFFont* SkPDFFont::GetFontResource(SkPDFDocument* doc,
             multibyte ? 0 : first_nonzero_glyph_for_single_byte_encoding(glyph->getGlyphID());
     uint64_t typefaceID = (static_cast<uint64_t>(face->uniqueID()) << 16) | subsetCode;
 
-    if (SkPDFFont* found = doc->fFontMap.find(typefaceID)) {
+    SkPDFFont* found;
+    if (doc->findCanonical(doc->fFontMap, typefaceID, &found)) {
         SkASSERT(multibyte == found->multiByteGlyphs());
         return found;
     }
@@ -240,8 +324,9 @@ SkPDFFont* SkPDFFont::GetFontResource(SkPDFDocument* doc,
         lastGlyph = SkToU16(std::min<int>((int)lastGlyph, 254 + (int)subsetCode));
     }
     auto ref = doc->reserveRef();
-    return doc->fFontMap.set(
-            typefaceID, SkPDFFont(std::move(typeface), firstNonZeroGlyph, lastGlyph, type, ref));
+    std::unique_ptr<SkPDFFont> font(
+            new SkPDFFont(std::move(typeface), firstNonZeroGlyph, lastGlyph, type, ref));
+    return doc->setCanonical(doc->fFontMap, typefaceID, std::move(font));
 }
 
 SkPDFFont::SkPDFFont(sk_sp<SkTypeface> typeface,
@@ -394,8 +479,7 @@ static void emit_subset_type0(const SkPDFFont& font, SkPDFDocument* doc) {
     descendantFonts->appendRef(doc->emit(*newCIDFont));
     fontDict.insertObject("DescendantFonts", std::move(descendantFonts));
 
-    const std::vector<SkUnichar>& glyphToUnicode =
-        SkPDFFont::GetUnicodeMap(font.typeface(), doc);
+    SkSpan<const SkUnichar> glyphToUnicode = SkPDFFont::GetUnicodeMap(font.typeface(), doc);
     SkASSERT(SkToSizeT(font.typeface()->countGlyphs()) == glyphToUnicode.size());
     std::unique_ptr<SkStreamAsset> toUnicode =
             SkPDFMakeToUnicodeCmap(glyphToUnicode.data(),
@@ -702,7 +786,7 @@ static void emit_subset_type3(const SkPDFFont& pdfFont, SkPDFDocument* doc) {
 
     font.insertName("CIDToGIDMap", "Identity");
 
-    const std::vector<SkUnichar>& glyphToUnicode = SkPDFFont::GetUnicodeMap(typeface, doc);
+    SkSpan<const SkUnichar> glyphToUnicode = SkPDFFont::GetUnicodeMap(typeface, doc);
     SkASSERT(glyphToUnicode.size() == SkToSizeT(typeface->countGlyphs()));
     auto toUnicodeCmap = SkPDFMakeToUnicodeCmap(glyphToUnicode.data(),
                                                 &subset,
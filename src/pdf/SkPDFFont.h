@@ -8,14 +8,17 @@
 #define SkPDFFont_DEFINED
 
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkSpan.h"
 #include "include/core/SkTypeface.h"
 #include "include/core/SkTypes.h"
+#include "include/private/base/SkMutex.h"
 #include "src/base/SkUTF.h"
 #include "src/core/SkAdvancedTypefaceMetrics.h"
 #include "src/pdf/SkPDFGlyphUse.h"
 #include "src/pdf/SkPDFTypes.h"
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 class SkGlyph;
@@ -32,8 +35,6 @@ class SkString;
 class SkPDFFont {
 public:
     ~SkPDFFont();
-    SkPDFFont(SkPDFFont&&);
-    SkPDFFont& operator=(SkPDFFont&&);
 
     /** Returns the typeface represented by this class. Returns nullptr for the
      *  default typeface.
@@ -77,6 +78,8 @@ public:
 
     void noteGlyphUsage(SkGlyphID glyph) {
         SkASSERT(this->hasGlyph(glyph));
+        // Pages drawn concurrently share fonts.
+        SkAutoMutexExclusive lock(fGlyphUsageMutex);
         fGlyphUsage.set(glyph);
     }
 
@@ -101,8 +104,8 @@ public:
     static const SkAdvancedTypefaceMetrics* GetMetrics(const SkTypeface* typeface,
                                                        SkPDFDocument* canon);
 
-    static const std::vector<SkUnichar>& GetUnicodeMap(const SkTypeface* typeface,
-                                                       SkPDFDocument* canon);
+    static SkSpan<const SkUnichar> GetUnicodeMap(const SkTypeface* typeface,
+                                                 SkPDFDocument* canon);
 
     static void PopulateCommonFontDescriptor(SkPDFDict* descriptor,
                                              const SkAdvancedTypefaceMetrics&,
@@ -124,6 +127,7 @@ public:
 
 private:
     sk_sp<SkTypeface> fTypeface;
+    SkMutex fGlyphUsageMutex;
     SkPDFGlyphUse fGlyphUsage;
     SkPDFIndirectReference fIndirectReference;
     SkAdvancedTypefaceMetrics::FontType fFontType;
@@ -136,6 +140,9 @@ private:
     // The glyph IDs accessible with this font.  For Type1 (non CID) fonts,
     // this will be a subset if the font has more than 255 glyphs.
 
+    // The metrics of a typeface, which are the same in every document.
+    static std::unique_ptr<SkAdvancedTypefaceMetrics> MakeMetrics(const SkTypeface*);
+
     SkPDFFont() = delete;
     SkPDFFont(const SkPDFFont&) = delete;
     SkPDFFont& operator=(const SkPDFFont&) = delete;
@@ -9,6 +9,8 @@
 
 #include "include/core/SkMatrix.h"
 #include "include/core/SkStream.h"
+#include "src/core/SkStreamPriv.h"
+#include "src/pdf/SkPDFDocumentPriv.h"
 #include "src/pdf/SkPDFUtils.h"
 
 #include <utility>
@@ -39,5 +41,17 @@ SkPDFIndirectReference SkPDFMakeFormXObject(SkPDFDocument* doc,
     }
     group->insertBool("I", true);  // Isolated.
     dict->insertObject("Group", std::move(group));
-    return SkPDFStreamOut(std::move(dict), std::move(content), doc);
+
+    // Layers and masks with the same content, e.g. on every page, share one form XObject.
+    SkPDFDigestWStream digestStream;
+    dict->emitObject(&digestStream);
+    SkStreamCopy(&digestStream, content.get());
+    content->rewind();
+    const SkPDFDigestWStream::Digest digest = digestStream.digest();
+    SkPDFIndirectReference xobject;
+    if (!doc->findCanonical(doc->fFormXObjectDigestMap, digest, &xobject)) {
+        xobject = SkPDFStreamOut(std::move(dict), std::move(content), doc);
+        doc->setCanonical(doc->fFormXObjectDigestMap, digest, xobject);
+    }
+    return xobject;
 }
@@ -1011,17 +1011,16 @@ static SkPDFIndirectReference find_pdf_shader(SkPDFDocument* doc,
                                               SkPDFGradientShader::Key key,
                                               bool keyHasAlpha) {
     SkASSERT(gradient_has_alpha(key) == keyHasAlpha);
-    auto& gradientPatternMap = doc->fGradientPatternMap;
-    if (SkPDFIndirectReference* ptr = gradientPatternMap.find(key)) {
-        return *ptr;
-    }
     SkPDFIndirectReference pdfShader;
+    if (doc->findCanonical(doc->fGradientPatternMap, key, &pdfShader)) {
+        return pdfShader;
+    }
     if (keyHasAlpha) {
         pdfShader = make_alpha_function_shader(doc, key);
     } else {
         pdfShader = make_function_shader(doc, key);
     }
-    gradientPatternMap.set(std::move(key), pdfShader);
+    doc->setCanonical(doc->fGradientPatternMap, std::move(key), pdfShader);
     return pdfShader;
 }
 
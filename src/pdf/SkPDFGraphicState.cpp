@@ -66,16 +66,16 @@ SkPDFIndirectReference SkPDFGraphicState::GetGraphicStateForPaint(SkPDFDocument*
 
     if (SkPaint::kFill_Style == p.getStyle()) {
         SkPDFFillGraphicState fillKey = {p.getColor4f().fA, pdf_blend_mode(mode)};
-        auto& fillMap = doc->fFillGSMap;
-        if (SkPDFIndirectReference* statePtr = fillMap.find(fillKey)) {
-            return *statePtr;
+        SkPDFIndirectReference ref;
+        if (doc->findCanonical(doc->fFillGSMap, fillKey, &ref)) {
+            return ref;
         }
         SkPDFDict state;
         state.reserve(2);
         state.insertColorComponentF("ca", fillKey.fAlpha);
         state.insertName("BM", as_pdf_blend_mode_name((SkBlendMode)fillKey.fBlendMode));
-        SkPDFIndirectReference ref = doc->emit(state);
-        fillMap.set(fillKey, ref);
+        ref = doc->emit(state);
+        doc->setCanonical(doc->fFillGSMap, fillKey, ref);
         return ref;
     } else {
         SkPDFStrokeGraphicState strokeKey = {
@@ -86,9 +86,9 @@ SkPDFIndirectReference SkPDFGraphicState::GetGraphicStateForPaint(SkPDFDocument*
             SkToU8(p.getStrokeJoin()),
             pdf_blend_mode(mode)
         };
-        auto& sMap = doc->fStrokeGSMap;
-        if (SkPDFIndirectReference* statePtr = sMap.find(strokeKey)) {
-            return *statePtr;
+        SkPDFIndirectReference ref;
+        if (doc->findCanonical(doc->fStrokeGSMap, strokeKey, &ref)) {
+            return ref;
         }
         SkPDFDict state;
         state.reserve(8);
@@ -100,8 +100,8 @@ SkPDFIndirectReference SkPDFGraphicState::GetGraphicStateForPaint(SkPDFDocument*
         state.insertScalar("ML", strokeKey.fStrokeMiter);
         state.insertBool("SA", true);  // SA = Auto stroke adjustment.
         state.insertName("BM", as_pdf_blend_mode_name((SkBlendMode)strokeKey.fBlendMode));
-        SkPDFIndirectReference ref = doc->emit(state);
-        sMap.set(strokeKey, ref);
+        ref = doc->emit(state);
+        doc->setCanonical(doc->fStrokeGSMap, strokeKey, ref);
         return ref;
     }
 }
@@ -137,10 +137,12 @@ SkPDFIndirectReference SkPDFGraphicState::GetSMaskGraphicState(SkPDFIndirectRefe
     sMaskDict->insertRef("G", sMask);
     if (invert) {
         // let the doc deduplicate this object.
-        if (doc->fInvertFunction == SkPDFIndirectReference()) {
-            doc->fInvertFunction = make_invert_function(doc);
+        SkPDFIndirectReference invertFunction;
+        if (!doc->findCanonical(doc->fInvertFunction, &invertFunction)) {
+            invertFunction = make_invert_function(doc);
+            doc->setCanonical(&doc->fInvertFunction, invertFunction);
         }
-        sMaskDict->insertRef("TR", doc->fInvertFunction);
+        sMaskDict->insertRef("TR", invertFunction);
     }
     SkPDFDict result("ExtGState");
     result.insertObject("SMask", std::move(sMaskDict));
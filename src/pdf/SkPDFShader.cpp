@@ -357,11 +357,11 @@ SkPDFIndirectReference SkPDFMakeShader(SkPDFDocument* doc,
             SkBitmapKeyFromImage(skimg),
             {imageTileModes[0], imageTileModes[1]},
             paintColor};
-        SkPDFIndirectReference* shaderPtr = doc->fImageShaderMap.find(key);
-        if (shaderPtr) {
-            return *shaderPtr;
+        SkPDFIndirectReference pdfShader;
+        if (doc->findCanonical(doc->fImageShaderMap, key, &pdfShader)) {
+            return pdfShader;
         }
-        SkPDFIndirectReference pdfShader =
+        pdfShader =
                 make_image_shader(doc,
                                   finalMatrix,
                                   imageTileModes[0],
@@ -369,7 +369,7 @@ SkPDFIndirectReference SkPDFMakeShader(SkPDFDocument* doc,
                                   SkRect::Make(surfaceBBox),
                                   skimg,
                                   paintColor);
-        doc->fImageShaderMap.set(std::move(key), pdfShader);
+        doc->setCanonical(doc->fImageShaderMap, std::move(key), pdfShader);
         return pdfShader;
     }
     // Don't bother to de-dup fallback shader.
@@ -6,20 +6,24 @@
 #if defined(SK_PDF_USE_HARFBUZZ_SUBSET)
 
 #include "include/core/SkData.h"
+#include "include/core/SkRefCnt.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkTypeface.h"
 #include "include/private/base/SkAssert.h"
 #include "include/private/base/SkMalloc.h"
 #include "include/private/base/SkTemplates.h"
 #include "include/private/base/SkTo.h"
+#include "src/core/SkResourceCache.h"
 #include "src/pdf/SkPDFGlyphUse.h"
 
 #include "hb.h"  // NO_G3_REWRITE
 #include "hb-subset.h"  // NO_G3_REWRITE
 
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <utility>
+#include <vector>
 
 namespace {
 
@@ -103,10 +107,119 @@ sk_sp<SkData> subset_harfbuzz(const SkTypeface& typeface, const SkPDFGlyphUse& g
     return to_data(std::move(result));
 }
 
+// Subsets are kept in SkResourceCache, so that later documents with the same typefaces and about
+// the same glyphs don't subset them again. Subsets keep the glyph ids of the typeface, so a subset
+// with a few more glyphs than needed works too.
+static unsigned gSubsetKeyNamespaceLabel;
+
+// At most this many subsets of each typeface are cached.
+constexpr size_t kMaxSubsetsPerTypeface = 4;
+
+struct GlyphSet {
+    explicit GlyphSet(const SkPDFGlyphUse& glyphUsage) : fBits(glyphUsage.lastGlyph() / 32 + 1) {
+        glyphUsage.getSetValues([this](unsigned gid) {
+            fBits[gid / 32] |= 1u << (gid % 32);
+            fCount++;
+        });
+    }
+
+    bool contains(const GlyphSet& that) const {
+        if (that.fCount > fCount || that.fBits.size() != fBits.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < fBits.size(); ++i) {
+            if ((fBits[i] & that.fBits[i]) != that.fBits[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::vector<uint32_t> fBits;
+    int fCount = 0;
+};
+
+struct CachedSubset : public SkNVRefCnt<CachedSubset> {
+    CachedSubset(GlyphSet glyphs, sk_sp<SkData> data)
+        : fGlyphs(std::move(glyphs)), fData(std::move(data)) {}
+
+    size_t bytesUsed() const {
+        return sizeof(*this) + fGlyphs.fBits.size() * sizeof(uint32_t) + (fData ? fData->size() : 0);
+    }
+
+    const GlyphSet fGlyphs;
+    const sk_sp<SkData> fData;  // nullptr if the typeface couldn't be subset.
+};
+
+struct SubsetKey : public SkResourceCache::Key {
+    explicit SubsetKey(SkTypefaceID typefaceID) : fTypefaceID(typefaceID) {
+        this->init(&gSubsetKeyNamespaceLabel, 0, sizeof(fTypefaceID));
+    }
+
+    SkTypefaceID fTypefaceID;
+};
+
+struct SubsetFindContext {
+    const GlyphSet& fGlyphs;
+    sk_sp<CachedSubset> fFound;
+    // All the cached subsets of the typeface, for adding another one.
+    std::vector<sk_sp<CachedSubset>> fSubsets;
+};
+
+// The cached subsets of one typeface, the most recently made first.
+struct SubsetRec : public SkResourceCache::Rec {
+    SubsetRec(SkTypefaceID typefaceID, std::vector<sk_sp<CachedSubset>> subsets)
+        : fKey(typefaceID), fSubsets(std::move(subsets)) {}
+
+    SubsetKey fKey;
+    std::vector<sk_sp<CachedSubset>> fSubsets;
+
+    const Key& getKey() const override { return fKey; }
+    size_t bytesUsed() const override {
+        size_t bytes = sizeof(*this);
+        for (const sk_sp<CachedSubset>& subset : fSubsets) {
+            bytes += subset->bytesUsed();
+        }
+        return bytes;
+    }
+    const char* getCategory() const override { return "pdf-font-subsets"; }
+
+    static bool Visitor(const SkResourceCache::Rec& baseRec, void* contextData) {
+        const SubsetRec& rec = static_cast<const SubsetRec&>(baseRec);
+        SubsetFindContext* context = static_cast<SubsetFindContext*>(contextData);
+        const GlyphSet& glyphs = context->fGlyphs;
+        // Use the smallest subset with all the glyphs, if it has at most a quarter more.
+        for (const sk_sp<CachedSubset>& subset : rec.fSubsets) {
+            const GlyphSet& cached = subset->fGlyphs;
+            if (cached.fCount <= glyphs.fCount + glyphs.fCount / 4 &&
+                (!context->fFound || cached.fCount < context->fFound->fGlyphs.fCount) &&
+                cached.contains(glyphs)) {
+                context->fFound = subset;
+            }
+        }
+        context->fSubsets = rec.fSubsets;
+        return true;
+    }
+};
+
 }  // namespace
 
 sk_sp<SkData> SkPDFSubsetFont(const SkTypeface& typeface, const SkPDFGlyphUse& glyphUsage) {
-    return subset_harfbuzz(typeface, glyphUsage);
+    GlyphSet glyphs(glyphUsage);
+    SubsetFindContext context{glyphs, nullptr, {}};
+    if (SkResourceCache::Find(SubsetKey(typeface.uniqueID()), SubsetRec::Visitor, &context) &&
+        context.fFound) {
+        return context.fFound->fData;
+    }
+
+    sk_sp<SkData> subset = subset_harfbuzz(typeface, glyphUsage);
+    std::vector<sk_sp<CachedSubset>> subsets = std::move(context.fSubsets);
+    if (subsets.size() == kMaxSubsetsPerTypeface) {
+        subsets.pop_back();
+    }
+    subsets.insert(subsets.begin(), sk_make_sp<CachedSubset>(std::move(glyphs), subset));
+    SkResourceCache::Add(new SubsetRec(typeface.uniqueID(), std::move(subsets)));
+    return subset;
 }
 
 #else
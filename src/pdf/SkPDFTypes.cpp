@@ -541,6 +541,9 @@ void SkPDFDict::insertUnion(const char key[], SkPDFUnion&& value) {
 
 
 
+static_assert(static_cast<int>(SkPDF::Metadata::CompressionLevel::Fastest) ==
+              SkDeflateWStream::kFastestCompressionLevel);
+
 static void serialize_stream(SkPDFDict* origDict,
                              SkStreamAsset* stream,
                              SkPDFSteamCompressionEnabled compress,
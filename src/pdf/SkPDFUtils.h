@@ -16,6 +16,7 @@
 #include "include/private/base/SkDebug.h"
 #include "src/base/SkUTF.h"
 #include "src/base/SkUtils.h"
+#include "src/core/SkMD5.h"
 #include "src/shaders/SkShaderBase.h"
 #include "src/utils/SkFloatToDecimal.h"
 
@@ -42,6 +43,35 @@ bool SkPackedArrayEqual(T* u, T* v, size_t n) {
     return 0 == memcmp(u, v, n * sizeof(T));
 }
 
+/** An MD5 digest of everything written to it, used to find identical images and form XObjects
+    without holding on to their content.
+*/
+class SkPDFDigestWStream final : public SkWStream {
+public:
+    struct Digest {
+        SkMD5::Digest fMD5;
+        bool operator==(const Digest& that) const { return fMD5 == that.fMD5; }
+        bool operator!=(const Digest& that) const { return !(*this == that); }
+
+        struct Hash {
+            uint32_t operator()(const Digest& d) const {
+                uint32_t hash;
+                memcpy(&hash, d.fMD5.data, sizeof(hash));
+                return hash;
+            }
+        };
+    };
+
+    bool write(const void* buffer, size_t size) override { return fMD5.write(buffer, size); }
+    size_t bytesWritten() const override { return fMD5.bytesWritten(); }
+
+    /** Computes and returns the digest. Nothing may be written after this. */
+    Digest digest() { return {fMD5.finish()}; }
+
+private:
+    SkMD5 fMD5;
+};
+
 #if 0
 #define PRINT_NOT_IMPL(str) fprintf(stderr, str)
 #else
@@ -81,6 +81,18 @@ void sk_fmunmap(const void* addr, size_t length) {
     munmap(const_cast<void*>(addr), length);
 }
 
+void sk_fmprefetch(const void* addr, size_t length) {
+    if (!addr || !length) {
+        return;
+    }
+    // madvise() needs a page aligned start.
+    const uintptr_t pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    const uintptr_t start = reinterpret_cast<uintptr_t>(addr);
+    const uintptr_t alignedStart = start & ~(pageSize - 1);
+    madvise(reinterpret_cast<void*>(alignedStart), length + (start - alignedStart),
+            MADV_WILLNEED);
+}
+
 void* sk_fdmmap(int fd, size_t* size) {
     struct stat status = {};
     if (0 != fstat(fd, &status)) {
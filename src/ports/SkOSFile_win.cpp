@@ -87,6 +87,10 @@ void sk_fmunmap(const void* addr, size_t) {
     UnmapViewOfFile(addr);
 }
 
+void sk_fmprefetch(const void*, size_t) {
+    // PrefetchVirtualMemory() would do this, but isn't available before Windows 8.
+}
+
 void* sk_fdmmap(int fileno, size_t* length) {
     HANDLE file = (HANDLE)_get_osfhandle(fileno);
     if (INVALID_HANDLE_VALUE == file) {
@@ -0,0 +1,367 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/utils/SkPictureDamage.h"
+
+#include "include/core/SkBBHFactory.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkPath.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkPoint.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkRegion.h"
+#include "include/core/SkTextBlob.h"
+#include "include/core/SkVertices.h"
+#include "include/private/base/SkTemplates.h"
+#include "src/core/SkBigPicture.h"
+#include "src/core/SkDrawShadowInfo.h"
+#include "src/core/SkPicturePriv.h"
+#include "src/core/SkRecord.h"
+#include "src/core/SkRecordDraw.h"
+#include "src/core/SkRecords.h"
+
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+#include <vector>
+
+using namespace skia_private;
+
+namespace {
+
+// Damage made of more rects than this is played back in one pass, clipped to its outline.
+constexpr int kMaxPlaybackPasses = 4;
+
+template <typename T>
+bool same_optional(const SkRecords::Optional<T>& a, const SkRecords::Optional<T>& b) {
+    if (!a || !b) {
+        return !a && !b;
+    }
+    return *a == *b;
+}
+
+// Two ops are equal if drawing them in the same canvas state produces the same pixels. Anything
+// we don't know how to compare cheaply (or at all, like drawables) is never equal to anything.
+template <typename T>
+bool same_op(const T&, const T&) { return false; }
+
+bool same_op(const SkRecords::NoOp&,      const SkRecords::NoOp&)      { return true; }
+bool same_op(const SkRecords::Save&,      const SkRecords::Save&)      { return true; }
+bool same_op(const SkRecords::ResetClip&, const SkRecords::ResetClip&) { return true; }
+
+bool same_op(const SkRecords::Restore& a, const SkRecords::Restore& b) {
+    return a.matrix == b.matrix;
+}
+
+bool same_op(const SkRecords::SaveLayer& a, const SkRecords::SaveLayer& b) {
+    return same_optional(a.bounds, b.bounds) &&
+           same_optional(a.paint, b.paint) &&
+           a.backdrop == b.backdrop &&
+           a.saveLayerFlags == b.saveLayerFlags &&
+           a.backdropScale == b.backdropScale &&
+           a.filters.empty() && b.filters.empty();
+}
+
+bool same_op(const SkRecords::SaveBehind& a, const SkRecords::SaveBehind& b) {
+    return same_optional(a.subset, b.subset);
+}
+
+bool same_op(const SkRecords::SetMatrix& a, const SkRecords::SetMatrix& b) {
+    return a.matrix == b.matrix;
+}
+bool same_op(const SkRecords::SetM44& a, const SkRecords::SetM44& b) {
+    return a.matrix == b.matrix;
+}
+bool same_op(const SkRecords::Concat& a, const SkRecords::Concat& b) {
+    return a.matrix == b.matrix;
+}
+bool same_op(const SkRecords::Concat44& a, const SkRecords::Concat44& b) {
+    return a.matrix == b.matrix;
+}
+bool same_op(const SkRecords::Translate& a, const SkRecords::Translate& b) {
+    return a.dx == b.dx && a.dy == b.dy;
+}
+bool same_op(const SkRecords::Scale& a, const SkRecords::Scale& b) {
+    return a.sx == b.sx && a.sy == b.sy;
+}
+
+bool same_clip(const SkRecords::ClipOpAndAA& a, const SkRecords::ClipOpAndAA& b) {
+    return a.op() == b.op() && a.aa() == b.aa();
+}
+bool same_op(const SkRecords::ClipPath& a, const SkRecords::ClipPath& b) {
+    return same_clip(a.opAA, b.opAA) && a.path == b.path;
+}
+bool same_op(const SkRecords::ClipRRect& a, const SkRecords::ClipRRect& b) {
+    return same_clip(a.opAA, b.opAA) && a.rrect == b.rrect;
+}
+bool same_op(const SkRecords::ClipRect& a, const SkRecords::ClipRect& b) {
+    return same_clip(a.opAA, b.opAA) && a.rect == b.rect;
+}
+bool same_op(const SkRecords::ClipRegion& a, const SkRecords::ClipRegion& b) {
+    return a.op == b.op && a.region == b.region;
+}
+bool same_op(const SkRecords::ClipShader& a, const SkRecords::ClipShader& b) {
+    return a.op == b.op && a.shader == b.shader;
+}
+
+bool same_op(const SkRecords::DrawArc& a, const SkRecords::DrawArc& b) {
+    return a.paint == b.paint &&
+           a.oval == b.oval &&
+           a.startAngle == b.startAngle &&
+           a.sweepAngle == b.sweepAngle &&
+           a.useCenter == b.useCenter;
+}
+bool same_op(const SkRecords::DrawDRRect& a, const SkRecords::DrawDRRect& b) {
+    return a.paint == b.paint && a.outer == b.outer && a.inner == b.inner;
+}
+bool same_op(const SkRecords::DrawImage& a, const SkRecords::DrawImage& b) {
+    return same_optional(a.paint, b.paint) &&
+           a.image->uniqueID() == b.image->uniqueID() &&
+           a.left == b.left &&
+           a.top == b.top &&
+           a.sampling == b.sampling;
+}
+bool same_op(const SkRecords::DrawImageRect& a, const SkRecords::DrawImageRect& b) {
+    return same_optional(a.paint, b.paint) &&
+           a.image->uniqueID() == b.image->uniqueID() &&
+           a.src == b.src &&
+           a.dst == b.dst &&
+           a.sampling == b.sampling &&
+           a.constraint == b.constraint;
+}
+bool same_op(const SkRecords::DrawOval& a, const SkRecords::DrawOval& b) {
+    return a.paint == b.paint && a.oval == b.oval;
+}
+bool same_op(const SkRecords::DrawPaint& a, const SkRecords::DrawPaint& b) {
+    return a.paint == b.paint;
+}
+bool same_op(const SkRecords::DrawBehind& a, const SkRecords::DrawBehind& b) {
+    return a.paint == b.paint;
+}
+bool same_op(const SkRecords::DrawPath& a, const SkRecords::DrawPath& b) {
+    return a.paint == b.paint && a.path == b.path;
+}
+bool same_op(const SkRecords::DrawPicture& a, const SkRecords::DrawPicture& b) {
+    return same_optional(a.paint, b.paint) &&
+           a.picture->uniqueID() == b.picture->uniqueID() &&
+           a.matrix == b.matrix;
+}
+bool same_op(const SkRecords::DrawPoints& a, const SkRecords::DrawPoints& b) {
+    return a.paint == b.paint &&
+           a.mode == b.mode &&
+           a.count == b.count &&
+           0 == memcmp(a.pts, b.pts, a.count * sizeof(SkPoint));
+}
+bool same_op(const SkRecords::DrawRRect& a, const SkRecords::DrawRRect& b) {
+    return a.paint == b.paint && a.rrect == b.rrect;
+}
+bool same_op(const SkRecords::DrawRect& a, const SkRecords::DrawRect& b) {
+    return a.paint == b.paint && a.rect == b.rect;
+}
+bool same_op(const SkRecords::DrawRegion& a, const SkRecords::DrawRegion& b) {
+    return a.paint == b.paint && a.region == b.region;
+}
+bool same_op(const SkRecords::DrawTextBlob& a, const SkRecords::DrawTextBlob& b) {
+    return a.paint == b.paint &&
+           a.blob->uniqueID() == b.blob->uniqueID() &&
+           a.x == b.x &&
+           a.y == b.y;
+}
+bool same_op(const SkRecords::DrawVertices& a, const SkRecords::DrawVertices& b) {
+    return a.paint == b.paint &&
+           a.vertices->uniqueID() == b.vertices->uniqueID() &&
+           a.bmode == b.bmode;
+}
+bool same_op(const SkRecords::DrawShadowRec& a, const SkRecords::DrawShadowRec& b) {
+    return a.path == b.path &&
+           a.rec.fZPlaneParams == b.rec.fZPlaneParams &&
+           a.rec.fLightPos == b.rec.fLightPos &&
+           a.rec.fLightRadius == b.rec.fLightRadius &&
+           a.rec.fAmbientColor == b.rec.fAmbientColor &&
+           a.rec.fSpotColor == b.rec.fSpotColor &&
+           a.rec.fFlags == b.rec.fFlags;
+}
+bool same_op(const SkRecords::DrawEdgeAAQuad& a, const SkRecords::DrawEdgeAAQuad& b) {
+    if (!a.clip || !b.clip) {
+        if (a.clip || b.clip) {
+            return false;
+        }
+    } else if (0 != memcmp(a.clip, b.clip, 4 * sizeof(SkPoint))) {
+        return false;
+    }
+    return a.rect == b.rect && a.aa == b.aa && a.color == b.color && a.mode == b.mode;
+}
+
+// Visits an op of the second record once we know the type of the op from the first.
+template <typename T>
+struct MatchOp {
+    const T& fA;
+
+    template <typename U>
+    bool operator()(const U&) const { return false; }
+    bool operator()(const T& b) const { return same_op(fA, b); }
+};
+
+struct SameOp {
+    const SkRecord& fB;
+    int             fIndexB;
+
+    template <typename T>
+    bool operator()(const T& a) const { return fB.visit(fIndexB, MatchOp<T>{a}); }
+};
+
+// The ops of a picture and their bounds, as computed for its bounding box hierarchy.
+// A null record has no ops.
+struct RecordBounds {
+    RecordBounds(const SkRecord* record, const SkRect& cullRect)
+            : fRecord(record), fBounds(this->count()) {
+        if (fRecord) {
+            AutoTMalloc<SkBBoxHierarchy::Metadata> meta(fRecord->count());
+            SkRecordFillBounds(cullRect, *fRecord, fBounds.data(), meta);
+        }
+    }
+
+    int count() const { return fRecord ? fRecord->count() : 0; }
+
+    const SkRecord*    fRecord;
+    AutoTArray<SkRect> fBounds;
+};
+
+bool same_op_and_bounds(const RecordBounds& a, int i, const RecordBounds& b, int j) {
+    return a.fBounds[i] == b.fBounds[j] && a.fRecord->visit(i, SameOp{*b.fRecord, j});
+}
+
+void add_damage(const SkRect& bounds, std::vector<SkIRect>* rects) {
+    const SkIRect r = bounds.roundOut();
+    // Neighbouring ops often draw over the same area; skip the easy duplicates.
+    if (!r.isEmpty() && (rects->empty() || !rects->back().contains(r))) {
+        rects->push_back(r);
+    }
+}
+
+// Unions regions pairwise, so that each rect takes part in O(log N) unions rather than N.
+SkRegion union_rects(const SkIRect* rects, size_t count) {
+    if (count <= 2) {
+        SkRegion region;
+        region.setRects(rects, (int)count);
+        return region;
+    }
+    SkRegion region = union_rects(rects, count / 2);
+    region.op(union_rects(rects + count / 2, count - count / 2), SkRegion::kUnion_Op);
+    return region;
+}
+
+// Returns false if we can't look at the picture's ops. Otherwise sets 'record' to its ops, or
+// to null if it has none.
+bool get_record(const SkPicture* picture, const SkRecord** record) {
+    *record = nullptr;
+    if (!picture || picture->approximateOpCount() == 0) {
+        return true;
+    }
+    if (const SkBigPicture* big = SkPicturePriv::AsSkBigPicture(sk_ref_sp(picture))) {
+        *record = big->record();
+        return true;
+    }
+    return false;
+}
+
+}  // namespace
+
+SkRegion SkPictureDamage::Compute(const SkPicture* before, const SkPicture* after) {
+    const SkRecord* recordBefore;
+    const SkRecord* recordAfter;
+
+    std::vector<SkIRect> rects;
+    if (!get_record(before, &recordBefore) || !get_record(after, &recordAfter)) {
+        // We can't see inside one of the pictures, so anywhere either one draws is damaged.
+        for (const SkPicture* picture : {before, after}) {
+            if (picture) {
+                add_damage(picture->cullRect(), &rects);
+            }
+        }
+        return union_rects(rects.data(), rects.size());
+    }
+
+    const RecordBounds a(recordBefore, before ? before->cullRect() : SkRect::MakeEmpty()),
+                       b(recordAfter,  after  ? after->cullRect()  : SkRect::MakeEmpty());
+
+    // Frames usually share most of their ops, so first trim the common prefix and suffix.
+    int prefix = 0;
+    const int maxCommon = std::min(a.count(), b.count());
+    while (prefix < maxCommon && same_op_and_bounds(a, prefix, b, prefix)) {
+        prefix++;
+    }
+    int suffix = 0;
+    while (suffix < maxCommon - prefix &&
+           same_op_and_bounds(a, a.count() - 1 - suffix, b, b.count() - 1 - suffix)) {
+        suffix++;
+    }
+
+    // If the rest of the ops line up one-for-one, only the pairs that differ are damage.
+    // Otherwise ops were added or removed, and everything in between is damage.
+    const int endA = a.count() - suffix,
+              endB = b.count() - suffix;
+    if (endA - prefix == endB - prefix) {
+        for (int i = prefix; i < endA; i++) {
+            if (!same_op_and_bounds(a, i, b, i)) {
+                add_damage(a.fBounds[i], &rects);
+                add_damage(b.fBounds[i], &rects);
+            }
+        }
+    } else {
+        for (int i = prefix; i < endA; i++) {
+            add_damage(a.fBounds[i], &rects);
+        }
+        for (int i = prefix; i < endB; i++) {
+            add_damage(b.fBounds[i], &rects);
+        }
+    }
+    return union_rects(rects.data(), rects.size());
+}
+
+void SkPictureDamage::Playback(const SkPicture* picture,
+                               const SkRegion& damage,
+                               SkCanvas* canvas,
+                               bool clearDamage) {
+    if (damage.isEmpty()) {
+        return;
+    }
+
+    // Each pass clips to part of the damage, clears it if asked to, and draws the picture on top.
+    // Big pictures search their bounding box hierarchy with the clip, so only ops that touch the
+    // damage are played back.
+    auto draw = [&]() {
+        if (clearDamage) {
+            canvas->clear(SK_ColorTRANSPARENT);
+        }
+        if (picture) {
+            picture->playback(canvas);
+        }
+    };
+
+    int rectCount = 0;
+    for (SkRegion::Iterator iter(damage); !iter.done() && rectCount <= kMaxPlaybackPasses;
+         iter.next()) {
+        rectCount++;
+    }
+
+    if (rectCount <= kMaxPlaybackPasses) {
+        for (SkRegion::Iterator iter(damage); !iter.done(); iter.next()) {
+            SkAutoCanvasRestore acr(canvas, true);
+            canvas->clipIRect(iter.rect());
+            draw();
+        }
+    } else {
+        SkAutoCanvasRestore acr(canvas, true);
+        SkPath outline;
+        damage.getBoundaryPath(&outline);
+        canvas->clipPath(outline);
+        draw();
+    }
+}
@@ -8,10 +8,14 @@
 #include "include/codec/SkAndroidCodec.h"
 #include "include/codec/SkCodec.h"
 #include "include/codec/SkEncodedImageFormat.h"
+#include "include/core/SkBitmap.h"
 #include "include/core/SkColorSpace.h"
 #include "include/core/SkData.h"
 #include "include/core/SkImageInfo.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkSamplingOptions.h"
 #include "include/core/SkSize.h"
 #include "include/core/SkString.h"
 #include "include/core/SkTypes.h"
@@ -20,7 +24,9 @@
 #include "tests/Test.h"
 #include "tools/Resources.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
 #include <initializer_list>
 #include <memory>
@@ -272,3 +278,82 @@ DEF_TEST(AndroidCodec_PQ, r) {
     static constexpr skcms_Matrix3x3 kExpected = SkNamedGamut::kRec2020;
     REPORTER_ASSERT(r, 0 == memcmp(&matrix, &kExpected, sizeof(skcms_Matrix3x3)));
 }
+
+// Returns the mean difference between the channels of two 8888 bitmaps.
+static float mean_channel_diff(const SkBitmap& a, const SkBitmap& b) {
+    SkASSERT(a.dimensions() == b.dimensions());
+    int64_t sum = 0;
+    for (int y = 0; y < a.height(); y++) {
+        const uint8_t* rowA = static_cast<const uint8_t*>(a.getAddr(0, y));
+        const uint8_t* rowB = static_cast<const uint8_t*>(b.getAddr(0, y));
+        for (int i = 0; i < 4 * a.width(); i++) {
+            sum += std::abs(rowA[i] - rowB[i]);
+        }
+    }
+    return (float)sum / (4 * a.width() * a.height());
+}
+
+DEF_TEST(AndroidCodec_resampleToDimensions, r) {
+    if (GetResourcePath().isEmpty()) {
+        return;
+    }
+
+    struct {
+        const char* path;
+        SkIRect     subset;  // Empty for the whole image.
+        SkISize     size;
+    } kCases[] = {
+        {"images/mandrill_512_q075.jpg", SkIRect::MakeEmpty(),               {300, 200}},
+        {"images/mandrill_512_q075.jpg", SkIRect::MakeEmpty(),               {100, 100}},
+        {"images/mandrill_512_q075.jpg", SkIRect::MakeXYWH(100, 50, 300, 400), {97, 131}},
+        {"images/mandrill_cmyk.jpg",     SkIRect::MakeEmpty(),               {50, 70}},
+        {"images/yellow_rose.png",       SkIRect::MakeEmpty(),               {111, 77}},
+        {"images/plane_interlaced.png",  SkIRect::MakeXYWH(10, 10, 200, 100), {67, 33}},
+    };
+    for (const auto& c : kCases) {
+        auto codec = SkAndroidCodec::MakeFromData(GetResourceAsData(c.path));
+        if (!codec) {
+            ERRORF(r, "Failed to create codec from %s", c.path);
+            continue;
+        }
+        const SkIRect subset = c.subset.isEmpty() ? SkIRect::MakeSize(codec->getInfo().dimensions())
+                                                  : c.subset;
+        const SkImageInfo info = SkImageInfo::Make(
+                subset.size(), kRGBA_8888_SkColorType,
+                codec->getInfo().isOpaque() ? kOpaque_SkAlphaType : kPremul_SkAlphaType,
+                SkColorSpace::MakeSRGB());
+
+        SkAndroidCodec::AndroidOptions options;
+        options.fSubset = &subset;
+        SkBitmap full;
+        full.allocPixels(info);
+        REPORTER_ASSERT(r, codec->getAndroidPixels(full.info(), full.getPixels(), full.rowBytes(),
+                                                   &options) == SkCodec::kSuccess);
+
+        // Resampling to the subset's own dimensions is the same as decoding it.
+        options.fResampleToDimensions = true;
+        SkBitmap bm;
+        bm.allocPixels(info);
+        REPORTER_ASSERT(r, codec->getAndroidPixels(bm.info(), bm.getPixels(), bm.rowBytes(),
+                                                   &options) == SkCodec::kSuccess);
+        REPORTER_ASSERT(r, mean_channel_diff(bm, full) == 0, "%s", c.path);
+
+        // Otherwise the result should be close to filtering the full decode with a different
+        // (mipmapped) filter.
+        SkBitmap expected;
+        expected.allocPixels(info.makeDimensions(c.size));
+        full.pixmap().scalePixels(expected.pixmap(),
+                                  SkSamplingOptions(SkFilterMode::kLinear, SkMipmapMode::kLinear));
+        bm.allocPixels(expected.info());
+        REPORTER_ASSERT(r, codec->getAndroidPixels(bm.info(), bm.getPixels(), bm.rowBytes(),
+                                                   &options) == SkCodec::kSuccess);
+        const float diff = mean_channel_diff(bm, expected);
+        REPORTER_ASSERT(r, diff < 4, "%s resampled to %dx%d differs by %g", c.path,
+                        c.size.width(), c.size.height(), diff);
+
+        // The requested dimensions can't be larger than the subset.
+        bm.allocPixels(info.makeWH(subset.width() + 1, subset.height()));
+        REPORTER_ASSERT(r, codec->getAndroidPixels(bm.info(), bm.getPixels(), bm.rowBytes(),
+                                                   &options) == SkCodec::kInvalidScale);
+    }
+}
@@ -13,6 +13,8 @@
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkImage.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkPicture.h"
 #include "include/core/SkRect.h"
@@ -484,3 +486,78 @@ DEF_TEST(AnimatedImage, r) {
         }
     }
 }
+
+DEF_TEST(AnimatedImage_decodeAhead, r) {
+    if (GetResourcePath().isEmpty()) {
+        return;
+    }
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(3);
+    for (const char* file : { "images/alphabetAnim.gif",
+                              "images/colorTables.gif",
+                              "images/required.gif",
+                              "images/stoplight.webp",
+                              "images/required.webp",
+                              }) {
+        auto data = GetResourceAsData(file);
+        if (!data) {
+            ERRORF(r, "Could not get %s", file);
+            continue;
+        }
+
+        auto make = [&data]() {
+            return SkAnimatedImage::Make(SkAndroidCodec::MakeFromData(data));
+        };
+        auto reference = make();
+        if (!reference) {
+            ERRORF(r, "Could not create animated image for %s", file);
+            continue;
+        }
+        const int frameCount = reference->getFrameCount();
+        std::vector<SkBitmap> expected(frameCount);
+        for (int i = 0; i < frameCount; i++) {
+            expected[i].allocPixels(reference->getCurrentFrame()->imageInfo());
+            reference->getCurrentFrame()->readPixels(nullptr, expected[i].pixmap(), 0, 0);
+            reference->decodeNextFrame();
+        }
+
+        for (int maxCachedFrames : { 1, 3, frameCount * 2 }) {
+            auto animatedImage = make();
+            REPORTER_ASSERT(r, animatedImage->setDecodeAhead(executor.get(), maxCachedFrames));
+
+            // Play through twice, with a reset part way through the second time.
+            for (int loop = 0; loop < 2; loop++) {
+                for (int i = 0; i < frameCount; i++) {
+                    if (loop == 1 && i == frameCount / 2) {
+                        animatedImage->reset();
+                        break;
+                    }
+                    SkBitmap actual;
+                    actual.allocPixels(expected[i].info());
+                    animatedImage->getCurrentFrame()->readPixels(nullptr, actual.pixmap(), 0, 0);
+                    compare_bitmaps(r, file, i, expected[i], actual);
+                    animatedImage->decodeNextFrame();
+                }
+            }
+            for (int i = 0; i < frameCount; i++) {
+                SkBitmap actual;
+                actual.allocPixels(expected[i].info());
+                animatedImage->getCurrentFrame()->readPixels(nullptr, actual.pixmap(), 0, 0);
+                compare_bitmaps(r, file, i, expected[i], actual);
+                animatedImage->decodeNextFrame();
+            }
+
+            // Turning it back off goes back to decoding synchronously.
+            REPORTER_ASSERT(r, animatedImage->setDecodeAhead(nullptr, 0));
+            animatedImage->reset();
+            SkBitmap actual;
+            actual.allocPixels(expected[0].info());
+            animatedImage->getCurrentFrame()->readPixels(nullptr, actual.pixmap(), 0, 0);
+            compare_bitmaps(r, file, 0, expected[0], actual);
+        }
+    }
+
+    // A still image has nothing to decode ahead.
+    auto still = SkAnimatedImage::Make(
+            SkAndroidCodec::MakeFromData(GetResourceAsData("images/mandrill_512.png")));
+    REPORTER_ASSERT(r, still && !still->setDecodeAhead(executor.get(), 4));
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkColorPriv.h"
+#include "include/core/SkTypes.h"
+#include "src/base/SkRandom.h"
+#include "src/core/SkBlitRow.h"
+#include "tests/Test.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+
+static SkPMColor random_premul(SkRandom* rand) {
+    const U8CPU a = rand->nextULessThan(256);
+    return SkPackARGB32(a, rand->nextULessThan(a + 1),
+                           rand->nextULessThan(a + 1),
+                           rand->nextULessThan(a + 1));
+}
+
+// Whichever blit_row_s32a_opaque this CPU picked should match SkPMSrcOver() exactly, including
+// for the tails that vectorized code handles separately, and never write past the end of dst.
+DEF_TEST(BlitRow_s32a_opaque, r) {
+    SkOpts::Init_BlitRow();
+
+    constexpr int kMaxCount = 67;
+    constexpr SkPMColor kGuard = 0xDEADBEEF;
+
+    SkRandom rand;
+    SkPMColor src[kMaxCount], dst[kMaxCount];
+    for (int i = 0; i < kMaxCount; i++) {
+        src[i] = random_premul(&rand);
+        dst[i] = random_premul(&rand);
+    }
+    // Let some pixels be transparent and some opaque.
+    src[3] = 0;
+    src[5] = SkPackARGB32(0xFF, 0x12, 0x34, 0x56);
+
+    for (int count = 0; count <= kMaxCount; count++) {
+        SkPMColor actual[kMaxCount + 1];
+        std::fill(std::begin(actual), std::end(actual), kGuard);
+        std::copy(dst, dst + count, actual);
+        SkOpts::blit_row_s32a_opaque(actual, src, count, 0xFF);
+
+        for (int i = 0; i < count; i++) {
+            if (actual[i] != SkPMSrcOver(src[i], dst[i])) {
+                ERRORF(r, "pixel %d of %d: %08x != %08x",
+                       i, count, actual[i], SkPMSrcOver(src[i], dst[i]));
+                break;
+            }
+        }
+        REPORTER_ASSERT(r, actual[count] == kGuard, "count %d wrote past the end", count);
+    }
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/codec/SkCodec.h"
+#include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkStream.h"
+#include "tests/Test.h"
+#include "tools/Resources.h"
+#include "tools/ToolUtils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+static constexpr const char* kPaths[] = {
+    "images/mandrill_512.png",
+    "images/mandrill_512_q075.jpg",
+    "images/yellow_rose.png",
+    "images/color_wheel.jpg",
+    "images/orientation/6_420.jpg",
+    "images/mandrill_cmyk.jpg",
+};
+
+DEF_TEST(Codec_DecodeImages, r) {
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(3);
+    for (SkExecutor* exec : {(SkExecutor*)nullptr, executor.get()}) {
+        std::vector<SkCodecs::ImageDecodeRequest> requests;
+        std::vector<sk_sp<SkImage>> expected;
+        for (const char* path : kPaths) {
+            auto [image, result] = SkCodec::MakeFromData(GetResourceAsData(path))->getImage();
+            REPORTER_ASSERT(r, result == SkCodec::kSuccess, "%s", path);
+            expected.push_back(image);
+            // Read some from files, and some from memory.
+            std::unique_ptr<SkStream> stream;
+            if (expected.size() % 2) {
+                stream = GetResourceAsStream(path);
+            } else {
+                stream = SkMemoryStream::Make(GetResourceAsData(path));
+            }
+            requests.push_back({std::move(stream), SkImageInfo()});
+        }
+
+        // Decode one again to a different color type.
+        const SkImageInfo f16Info =
+                expected[0]->imageInfo().makeColorType(kRGBA_F16_SkColorType);
+        requests.push_back({GetResourceAsStream(kPaths[0]), f16Info});
+        expected.push_back(std::get<0>(
+                SkCodec::MakeFromData(GetResourceAsData(kPaths[0]))->getImage(f16Info, nullptr)));
+        // And some that fail.
+        requests.push_back({SkMemoryStream::MakeDirect("not an image", 12), SkImageInfo()});
+        requests.push_back({nullptr, SkImageInfo()});
+
+        std::vector<int> calls(requests.size(), 0);
+        std::vector<sk_sp<SkImage>> images(requests.size());
+        std::vector<SkCodec::Result> results(requests.size());
+        SkCodecs::DecodeImages(requests, exec, /*maxImagesInFlight=*/6,
+                               [&](size_t i, sk_sp<SkImage> image, SkCodec::Result result) {
+                                   calls[i]++;
+                                   images[i] = std::move(image);
+                                   results[i] = result;
+                               });
+
+        for (size_t i = 0; i < requests.size(); i++) {
+            REPORTER_ASSERT(r, calls[i] == 1);
+            REPORTER_ASSERT(r, !requests[i].fStream);
+            if (i < expected.size()) {
+                REPORTER_ASSERT(r, results[i] == SkCodec::kSuccess);
+                REPORTER_ASSERT(r, images[i] && ToolUtils::equal_pixels(images[i].get(),
+                                                                        expected[i].get()),
+                                "image %zu", i);
+            } else {
+                REPORTER_ASSERT(r, !images[i]);
+                REPORTER_ASSERT(r, results[i] != SkCodec::kSuccess);
+            }
+        }
+    }
+}
+
+namespace {
+// Counts how many streams have started being read. It is not backed by memory, so it gets copied.
+class ReadCountingStream final : public SkStream {
+public:
+    ReadCountingStream(sk_sp<SkData> data, std::atomic<int>* readsStarted)
+            : fStream(std::move(data)), fReadsStarted(readsStarted) {}
+
+    size_t read(void* buffer, size_t size) override {
+        if (!fStarted) {
+            fStarted = true;
+            (*fReadsStarted)++;
+        }
+        return fStream.read(buffer, size);
+    }
+    bool isAtEnd() const override { return fStream.isAtEnd(); }
+
+private:
+    SkMemoryStream    fStream;
+    std::atomic<int>* fReadsStarted;
+    bool              fStarted = false;
+};
+}  // namespace
+
+DEF_TEST(Codec_DecodeImages_LimitsReadsInFlight, r) {
+    const sk_sp<SkData> data = GetResourceAsData("images/color_wheel.jpg");
+    if (!data) {
+        return;
+    }
+    std::atomic<int> readsStarted{0};
+    std::vector<SkCodecs::ImageDecodeRequest> requests;
+    for (int i = 0; i < 40; i++) {
+        requests.push_back({std::make_unique<ReadCountingStream>(data, &readsStarted),
+                            SkImageInfo()});
+    }
+
+    // Reads don't get more than maxInFlight images ahead of the decodes, even with more threads.
+    const int maxInFlight = 3;
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    int decoded = 0;
+    int mostInFlight = 0;
+    SkCodecs::DecodeImages(requests, executor.get(), maxInFlight,
+                           [&](size_t, sk_sp<SkImage> image, SkCodec::Result result) {
+                               REPORTER_ASSERT(r, image && result == SkCodec::kSuccess);
+                               mostInFlight = std::max(mostInFlight, readsStarted - decoded);
+                               decoded++;
+                           });
+    REPORTER_ASSERT(r, decoded == 40);
+    REPORTER_ASSERT(r, mostInFlight <= maxInFlight, "%d > %d", mostInFlight, maxInFlight);
+}
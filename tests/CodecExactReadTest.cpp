@@ -7,6 +7,7 @@
 
 #include "include/codec/SkCodec.h"
 #include "include/core/SkBitmap.h"
+#include "include/core/SkColor.h"
 #include "include/core/SkColorType.h"
 #include "include/core/SkData.h"
 #include "include/core/SkImageInfo.h"
@@ -92,3 +93,45 @@ DEF_TEST(Codec_end, r) {
         }
     }
 }
+
+// Codecs read memory-backed streams (e.g. memory-mapped files) in place. Test that they decode
+// the same pixels that reading through a stream without a memory base does, including from
+// incomplete data.
+DEF_TEST(Codec_memoryBacked, r) {
+    for (const char* path : { "images/plane.png",
+                              "images/yellow_rose.png",
+                              "images/plane_interlaced.png",
+                              "images/mandrill_512_q075.jpg",
+                              }) {
+        sk_sp<SkData> fullData = GetResourceAsData(path);
+        if (!fullData) {
+            continue;
+        }
+
+        for (size_t size : { fullData->size(), fullData->size() / 2 }) {
+            sk_sp<SkData> data = SkData::MakeSubset(fullData.get(), 0, size);
+            SkMemoryStream unmapped(data);
+            std::unique_ptr<SkCodec> codecs[] = {
+                SkCodec::MakeFromStream(std::make_unique<SkMemoryStream>(data)),
+                SkCodec::MakeFromStream(std::make_unique<UnowningStream>(&unmapped)),
+            };
+            if (!codecs[0] || !codecs[1]) {
+                ERRORF(r, "Failed to create a codec from %s with %zu bytes", path, size);
+                continue;
+            }
+
+            SkBitmap bitmaps[2];
+            SkCodec::Result results[2];
+            for (int i = 0; i < 2; i++) {
+                bitmaps[i].allocPixels(codecs[i]->getInfo().makeColorType(kN32_SkColorType));
+                bitmaps[i].eraseColor(SK_ColorTRANSPARENT);
+                results[i] = codecs[i]->getPixels(bitmaps[i].pixmap());
+            }
+            REPORTER_ASSERT(r, results[0] == results[1], "%s with %zu bytes", path, size);
+            REPORTER_ASSERT(r, size < fullData->size() || results[0] == SkCodec::kSuccess);
+            REPORTER_ASSERT(r, 0 == memcmp(bitmaps[0].getPixels(), bitmaps[1].getPixels(),
+                                           bitmaps[0].computeByteSize()),
+                            "%s with %zu bytes", path, size);
+        }
+    }
+}
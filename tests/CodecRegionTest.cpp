@@ -0,0 +1,119 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/codec/SkAndroidCodec.h"
+#include "include/codec/SkCodec.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+#include "tests/Test.h"
+#include "tools/Resources.h"
+#include "tools/ToolUtils.h"
+
+#include <memory>
+
+// Decodes |subset| by decoding partial scanlines from the top of the image.
+static SkBitmap decode_scanlines(SkCodec* codec, const SkIRect& subset) {
+    const SkIRect columns = SkIRect::MakeLTRB(subset.left(), 0, subset.right(),
+                                              codec->dimensions().height());
+    SkCodec::Options options;
+    options.fSubset = &columns;
+
+    SkBitmap bm;
+    bm.allocPixels(codec->getInfo().makeDimensions(subset.size()));
+    if (codec->startScanlineDecode(codec->getInfo(), &options) != SkCodec::kSuccess ||
+        !codec->skipScanlines(subset.top()) ||
+        codec->getScanlines(bm.getPixels(), subset.height(), bm.rowBytes()) != subset.height()) {
+        bm.reset();
+    }
+    return bm;
+}
+
+DEF_TEST(Codec_jpegRestartMarkerSubsets, r) {
+    // Baseline JPEGs with restart markers: a YCbCr one with 4:2:0 chroma, where a band can start
+    // every 80 rows, and a CMYK one, where a band can start every 8 rows.
+    for (const char* path : {"images/icc-v2-gbr.jpg", "images/mandrill_cmyk.jpg"}) {
+        std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(GetResourceAsData(path));
+        std::unique_ptr<SkAndroidCodec> androidCodec =
+                SkAndroidCodec::MakeFromData(GetResourceAsData(path));
+        if (!codec || !androidCodec) {
+            ERRORF(r, "Could not create codec for %s", path);
+            continue;
+        }
+
+        const int w = codec->dimensions().width(), h = codec->dimensions().height();
+        std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(2);
+        const SkIRect subsets[] = {
+            SkIRect::MakeWH(w, h),
+            SkIRect::MakeXYWH(0, 0, 64, 16),
+            SkIRect::MakeXYWH(10, 5, w / 3, h / 4),
+            SkIRect::MakeXYWH(0, h / 3, w, h / 3),
+            SkIRect::MakeXYWH(w / 8, h / 2 - 1, w / 2, 3),
+            SkIRect::MakeLTRB(w / 3, h * 3 / 4, w, h),
+            SkIRect::MakeXYWH(1, h / 2, 1, 1),
+        };
+        for (const SkIRect& subset : subsets) {
+            SkIRect valid = subset;
+            REPORTER_ASSERT(r, codec->getValidSubset(&valid) && valid == subset);
+
+            const SkBitmap expected = decode_scanlines(codec.get(), subset);
+            REPORTER_ASSERT(r, !expected.empty());
+
+            for (SkExecutor* exec : {(SkExecutor*)nullptr, executor.get()}) {
+                SkCodec::Options options;
+                options.fSubset = &subset;
+                options.fExecutor = exec;
+
+                SkBitmap bm;
+                bm.allocPixels(codec->getInfo().makeDimensions(subset.size()));
+                REPORTER_ASSERT(r, codec->getPixels(bm.pixmap(), &options) == SkCodec::kSuccess);
+                REPORTER_ASSERT(r, ToolUtils::equal_pixels(bm, expected),
+                                "%s subset %d,%d %dx%d", path, subset.x(), subset.y(),
+                                subset.width(), subset.height());
+            }
+
+            SkAndroidCodec::AndroidOptions androidOptions;
+            androidOptions.fSubset = &subset;
+            SkBitmap bm;
+            bm.allocPixels(codec->getInfo().makeDimensions(subset.size()));
+            REPORTER_ASSERT(r, androidCodec->getAndroidPixels(bm.info(), bm.getPixels(),
+                                                              bm.rowBytes(), &androidOptions) ==
+                               SkCodec::kSuccess);
+            REPORTER_ASSERT(r, ToolUtils::equal_pixels(bm, expected));
+        }
+
+        // Scaled subsets aren't supported.
+        const SkIRect subset = SkIRect::MakeWH(100, 100);
+        SkCodec::Options options;
+        options.fSubset = &subset;
+        SkBitmap bm;
+        bm.allocPixels(codec->getInfo().makeWH(50, 50));
+        REPORTER_ASSERT(r, codec->getPixels(bm.pixmap(), &options) != SkCodec::kSuccess);
+    }
+}
+
+DEF_TEST(Codec_jpegWithoutRestartMarkers, r) {
+    for (const char* path : {"images/mandrill_512_q075.jpg", "images/color_wheel.jpg"}) {
+        std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(GetResourceAsData(path));
+        if (!codec) {
+            ERRORF(r, "Could not create codec for %s", path);
+            continue;
+        }
+        SkIRect subset = SkIRect::MakeXYWH(16, 16, 32, 32);
+        REPORTER_ASSERT(r, !codec->getValidSubset(&subset));
+
+        // An executor doesn't change full decodes.
+        std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(2);
+        SkCodec::Options options;
+        options.fExecutor = executor.get();
+        auto [image, result] = codec->getImage(codec->getInfo(), &options);
+        REPORTER_ASSERT(r, result == SkCodec::kSuccess);
+    }
+}
@@ -531,9 +531,9 @@ DEF_TEST(Codec_wbmp, r) {
 }
 
 DEF_TEST(Codec_webp, r) {
-    check(r, "images/baby_tux.webp", SkISize::Make(386, 395), false, true, true);
-    check(r, "images/color_wheel.webp", SkISize::Make(128, 128), false, true, true);
-    check(r, "images/yellow_rose.webp", SkISize::Make(400, 301), false, true, true);
+    check(r, "images/baby_tux.webp", SkISize::Make(386, 395), true, true, true);
+    check(r, "images/color_wheel.webp", SkISize::Make(128, 128), true, true, true);
+    check(r, "images/yellow_rose.webp", SkISize::Make(400, 301), true, true, true);
 }
 
 DEF_TEST(Codec_bmp, r) {
@@ -15,9 +15,11 @@
 #include "include/core/SkColorType.h"
 #include "include/core/SkData.h"
 #include "include/core/SkDataTable.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkPixmap.h"
+#include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkSurface.h"
@@ -28,6 +30,7 @@
 #include "include/encode/SkWebpEncoder.h"
 #include "include/private/base/SkMalloc.h"
 #include "include/private/base/SkTemplates.h"
+#include "src/base/SkRandom.h"
 #include "src/core/SkImageInfoPriv.h"
 #include "tests/Test.h"
 #include "tools/DecodeUtils.h"
@@ -37,6 +40,7 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <functional>
 #include <initializer_list>
 #include <memory>
 #include <string>
@@ -343,6 +347,144 @@ DEF_TEST(Encode_PngOptions, r) {
     REPORTER_ASSERT(r, almost_equals(bm0, bm2, 0));
 }
 
+// Decodes |data| to N32, optionally on |executor|. Returns an empty bitmap on failure.
+static SkBitmap decode_n32(sk_sp<SkData> data, SkExecutor* executor = nullptr) {
+    SkBitmap bm;
+    std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(std::move(data));
+    if (codec) {
+        bm.allocPixels(codec->getInfo().makeColorType(kN32_SkColorType));
+        SkCodec::Options options;
+        options.fExecutor = executor;
+        if (SkCodec::kSuccess != codec->getPixels(bm.pixmap(), &options)) {
+            bm.reset();
+        }
+    }
+    return bm;
+}
+
+using MakeEncoderProc = std::function<std::unique_ptr<SkEncoder>(SkWStream*, SkExecutor*)>;
+
+// Encodes |height| rows with encoders from |make|, serially and then on |executor|, both all at
+// once and |rowsPerCall| rows at a time. Checks that the parallel encodes decode to the same
+// pixels as the serial one and are less than |maxGrowthPercent| bigger. Returns the parallel
+// encode.
+static sk_sp<SkData> check_parallel_encode(skiatest::Reporter* r,
+                                           const MakeEncoderProc& make,
+                                           int height,
+                                           SkExecutor* executor,
+                                           int rowsPerCall,
+                                           int maxGrowthPercent) {
+    auto encode = [&](SkExecutor* exec, int rows) {
+        SkDynamicMemoryWStream dst;
+        std::unique_ptr<SkEncoder> encoder = make(&dst, exec);
+        REPORTER_ASSERT(r, encoder);
+        for (int y = 0; encoder && y < height; y += rows) {
+            REPORTER_ASSERT(r, encoder->encodeRows(rows));
+        }
+        return dst.detachAsData();
+    };
+    sk_sp<SkData> serial = encode(nullptr, height);
+    sk_sp<SkData> parallel = encode(executor, height);
+    sk_sp<SkData> incremental = encode(executor, rowsPerCall);
+
+    REPORTER_ASSERT(r, parallel->size() * 100 < serial->size() * (100 + maxGrowthPercent),
+                    "%zu vs %zu", parallel->size(), serial->size());
+
+    SkBitmap expected = decode_n32(serial);
+    SkBitmap actual = decode_n32(parallel);
+    REPORTER_ASSERT(r, !expected.drawsNothing() && !actual.drawsNothing());
+    REPORTER_ASSERT(r, almost_equals(expected, actual, 0));
+    REPORTER_ASSERT(r, almost_equals(expected, decode_n32(incremental), 0));
+    return parallel;
+}
+
+DEF_TEST(Encode_PngParallel, r) {
+    // tall enough to be split into several stripes, with smooth areas and noise to compress
+    SkBitmap src;
+    src.allocN32Pixels(300, 700);
+    SkRandom rand;
+    for (int y = 0; y < src.height(); y++) {
+        for (int x = 0; x < src.width(); x++) {
+            U8CPU a = y < 350 ? 0xFF : (x + y) & 0xFF;
+            U8CPU noise = rand.nextU() & 0x1F;
+            *src.getAddr32(x, y) = SkPreMultiplyARGB(a, x & 0xFF, y & 0xFF, noise);
+        }
+    }
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(2);
+    for (SkColorType ct : {kN32_SkColorType, kRGB_565_SkColorType, kGray_8_SkColorType,
+                           kRGBA_F16_SkColorType}) {
+        SkBitmap bm;
+        SkAlphaType at = ct == kN32_SkColorType || ct == kRGBA_F16_SkColorType
+                                 ? kPremul_SkAlphaType
+                                 : kOpaque_SkAlphaType;
+        bm.allocPixels(src.info().makeColorType(ct).makeAlphaType(at));
+        REPORTER_ASSERT(r, src.readPixels(bm.pixmap()));
+
+        for (auto filters : {SkPngEncoder::FilterFlag::kAll, SkPngEncoder::FilterFlag::kPaeth,
+                             SkPngEncoder::FilterFlag::kNone}) {
+            auto make = [&](SkWStream* dst, SkExecutor* exec) {
+                SkPngEncoder::Options options;
+                options.fFilterFlags = filters;
+                options.fExecutor = exec;
+                return SkPngEncoder::Make(dst, bm.pixmap(), options);
+            };
+            // Splitting the stream shouldn't cost much compression.
+            check_parallel_encode(r, make, bm.height(), executor.get(), 150, 10);
+        }
+    }
+}
+
+DEF_TEST(Encode_JpegParallel, r) {
+    SkBitmap src;
+    src.allocN32Pixels(640, 1400);
+    SkRandom rand;
+    for (int y = 0; y < src.height(); y++) {
+        for (int x = 0; x < src.width(); x++) {
+            U8CPU noise = rand.nextU() & 0x1F;
+            *src.getAddr32(x, y) = SkPackARGB32(0xFF, x & 0xFF, y & 0xFF, noise);
+        }
+    }
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(2);
+    for (SkColorType ct : {kN32_SkColorType, kRGB_565_SkColorType, kGray_8_SkColorType}) {
+        SkBitmap bm;
+        bm.allocPixels(src.info().makeColorType(ct).makeAlphaType(kOpaque_SkAlphaType));
+        REPORTER_ASSERT(r, src.readPixels(bm.pixmap()));
+
+        // 4:2:0 makes the MCU rows, and so the stripes, twice as tall as 4:4:4.
+        for (auto downsample : {SkJpegEncoder::Downsample::k420,
+                                SkJpegEncoder::Downsample::k444}) {
+            auto make = [&](SkWStream* dst, SkExecutor* exec) {
+                SkJpegEncoder::Options options;
+                options.fDownsample = downsample;
+                options.fQuality = 90;
+                options.fExecutor = exec;
+                return SkJpegEncoder::Make(dst, bm.pixmap(), options);
+            };
+            // The standard Huffman tables and the restart markers cost something, but not much.
+            // The coefficients are the same, so the pixels are too.
+            sk_sp<SkData> parallel =
+                    check_parallel_encode(r, make, bm.height(), executor.get(), 300, 25);
+
+            // Every MCU row is a restart interval, so the output can be decoded in parallel too.
+            SkBitmap expected = decode_n32(parallel);
+            REPORTER_ASSERT(r, almost_equals(expected, decode_n32(parallel, executor.get()), 0));
+        }
+    }
+
+    // An image that fits in one stripe is encoded as usual, with optimized Huffman tables and no
+    // restart markers.
+    SkBitmap small;
+    REPORTER_ASSERT(r, src.extractSubset(&small, SkIRect::MakeWH(64, 64)));
+    SkDynamicMemoryWStream serial, parallel;
+    SkJpegEncoder::Options options;
+    REPORTER_ASSERT(r, SkJpegEncoder::Encode(&serial, small.pixmap(), options));
+    options.fExecutor = executor.get();
+    REPORTER_ASSERT(r, SkJpegEncoder::Encode(&parallel, small.pixmap(), options));
+    REPORTER_ASSERT(r, serial.detachAsData()->equals(parallel.detachAsData().get()));
+}
+
 #ifndef SK_BUILD_FOR_GOOGLE3
 DEF_TEST(Encode_WebpQuality, r) {
     SkBitmap bm;
@@ -453,6 +595,41 @@ DEF_TEST(Encode_WebpOptions, r) {
     REPORTER_ASSERT(r, almost_equals(bm2, bm3, 50));
 }
 
+DEF_TEST(Encode_WebpStripes, r) {
+    // Tall enough that pixels which libwebp can't import directly are converted in several
+    // stripes, with rows of varying alpha.
+    SkBitmap src;
+    src.allocPixels(SkImageInfo::Make(300, 1001, kRGBA_8888_SkColorType, kUnpremul_SkAlphaType));
+    SkRandom rand;
+    for (int y = 0; y < src.height(); y++) {
+        for (int x = 0; x < src.width(); x++) {
+            U8CPU a = y < 500 ? 0xFF : rand.nextU() & 0xFF;
+            *src.getAddr32(x, y) = SkColorSetARGB(a, x & 0xFF, y & 0xFF, rand.nextU() & 0x3F);
+        }
+    }
+    // F16 holds the same pixels, but is converted to RGBA before libwebp can import it.
+    SkBitmap f16;
+    f16.allocPixels(src.info().makeColorType(kRGBA_F16_SkColorType));
+    REPORTER_ASSERT(r, src.readPixels(f16.pixmap()));
+
+    for (auto compression : {SkWebpEncoder::Compression::kLossy,
+                             SkWebpEncoder::Compression::kLossless}) {
+        for (int height : {src.height(), 499}) {
+            SkPixmap srcRows, f16Rows;
+            REPORTER_ASSERT(r, src.pixmap().extractSubset(&srcRows, SkIRect::MakeWH(300, height)));
+            REPORTER_ASSERT(r, f16.pixmap().extractSubset(&f16Rows, SkIRect::MakeWH(300, height)));
+
+            SkWebpEncoder::Options options;
+            options.fCompression = compression;
+            options.fQuality = 80.0f;
+            SkDynamicMemoryWStream direct, striped;
+            REPORTER_ASSERT(r, SkWebpEncoder::Encode(&direct, srcRows, options));
+            REPORTER_ASSERT(r, SkWebpEncoder::Encode(&striped, f16Rows, options));
+            REPORTER_ASSERT(r, direct.detachAsData()->equals(striped.detachAsData().get()));
+        }
+    }
+}
+
 DEF_TEST(Encode_WebpAnimated, r) {
     const int frameCount = 3;
     const int width = 16;
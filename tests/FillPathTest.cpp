@@ -6,16 +6,22 @@
  */
 
 #include "include/core/SkColor.h"
+#include "include/core/SkMatrix.h"
 #include "include/core/SkPath.h"
 #include "include/core/SkPathTypes.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkScalar.h"
 #include "include/core/SkTypes.h"
 #include "src/core/SkBlitter.h"
+#include "src/core/SkRasterClip.h"
 #include "src/core/SkScan.h"
 #include "tests/Test.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
 
 struct FakeBlitter : public SkBlitter {
     FakeBlitter()
@@ -52,3 +58,132 @@ DEF_TEST(FillPathInverse, reporter) {
 
     REPORTER_ASSERT(reporter, blitter.m_blitCount == expected_lines);
 }
+
+// Records the coverage blitted to each pixel of a small A8 image.
+struct CoverageBlitter : public SkBlitter {
+    static constexpr int kW = 128, kH = 128;
+
+    void blitH(int x, int y, int width) override {
+        SkASSERT(x >= 0 && x + width <= kW && y >= 0 && y < kH);
+        memset(&fCoverage[y][x], 0xFF, width);
+    }
+
+    void blitAntiH(int x, int y, const SkAlpha antialias[], const int16_t runs[]) override {
+        for (int n; (n = *runs) > 0; runs += n, antialias += n) {
+            SkASSERT(x >= 0 && x + n <= kW && y >= 0 && y < kH);
+            memset(&fCoverage[y][x], *antialias, n);
+            x += n;
+        }
+    }
+
+    SkAlpha fCoverage[kH][kW] = {};
+};
+
+// Counts the samples of each CoverageBlitter pixel covered by a non-AA fill, scaled up by kScale.
+struct SupersampleBlitter : public SkBlitter {
+    static constexpr int kScale = 16;
+
+    void blitH(int x, int y, int width) override {
+        for (int i = x; i < x + width; ++i) {
+            fSamples[y / kScale][i / kScale]++;
+        }
+    }
+
+    void blitAntiH(int x, int y, const SkAlpha antialias[], const int16_t runs[]) override {
+        SkDEBUGFAIL("blitAntiH not implemented");
+    }
+
+    int fSamples[CoverageBlitter::kH][CoverageBlitter::kW] = {};
+};
+
+// Compares accumulation AA to supersampled coverage within the rows the accumulation draws to,
+// returning the largest difference for any one pixel, and the difference in total coverage.
+static void accumulation_error(const SkPath& path, const SkIRect& clip,
+                               int* maxError, int* totalError) {
+    const SkIRect ir = path.getBounds().roundOut();
+    auto accum = std::make_unique<CoverageBlitter>();
+    SkScan::AccumFillPath(path, accum.get(), ir, clip);
+
+    constexpr int kScale = SupersampleBlitter::kScale;
+    auto reference = std::make_unique<SupersampleBlitter>();
+    SkPath scaled = path.makeTransform(SkMatrix::Scale(kScale, kScale));
+    SkScan::FillPath(scaled, SkIRect::MakeLTRB(clip.fLeft * kScale, clip.fTop * kScale,
+                                               clip.fRight * kScale, clip.fBottom * kScale),
+                     reference.get());
+
+    *maxError = *totalError = 0;
+    for (int y = std::max(ir.fTop, clip.fTop); y < std::min(ir.fBottom, clip.fBottom); ++y) {
+        for (int x = 0; x < CoverageBlitter::kW; ++x) {
+            const int expected = (reference->fSamples[y][x] * 255 + 128) / (kScale * kScale);
+            *maxError = std::max(*maxError, abs(expected - accum->fCoverage[y][x]));
+            *totalError += expected - accum->fCoverage[y][x];
+        }
+    }
+    *totalError = abs(*totalError);
+}
+
+DEF_TEST(FillPathAccumulationAA, reporter) {
+    const SkIRect clip = SkIRect::MakeWH(CoverageBlitter::kW, CoverageBlitter::kH);
+
+    // A rectangle's coverage is exact: full inside, and partial along the fractional edges.
+    {
+        auto blitter = std::make_unique<CoverageBlitter>();
+        SkPath rect = SkPath::Rect({10.5f, 20, 30.25f, 40});
+        SkScan::AccumFillPath(rect, blitter.get(), rect.getBounds().roundOut(), clip);
+        REPORTER_ASSERT(reporter, blitter->fCoverage[19][20] == 0);
+        REPORTER_ASSERT(reporter, blitter->fCoverage[20][9] == 0);
+        REPORTER_ASSERT(reporter, blitter->fCoverage[20][10] == 128);
+        REPORTER_ASSERT(reporter, blitter->fCoverage[30][20] == 255);
+        REPORTER_ASSERT(reporter, blitter->fCoverage[39][30] == 64);
+        REPORTER_ASSERT(reporter, blitter->fCoverage[40][20] == 0);
+        REPORTER_ASSERT(reporter, blitter->fCoverage[30][31] == 0);
+    }
+
+    // Winding and even-odd fills differ in the inner square. Its edges are at multiples of
+    // 1/16, so that the supersampled reference is exact.
+    SkPath nested = SkPath::Rect({8.25f, 10.5f, 119.5f, 117.25f});
+    nested.addRect({30.75f, 40.125f, 90.375f, 80.875f});
+
+    SkPath curves;
+    curves.moveTo(10.3f, 100.2f)
+          .cubicTo(20, 5, 108, 20, 117.6f, 90.1f)
+          .quadTo(64, 125, 30, 110)
+          .conicTo(10, 120, 10.3f, 100.2f, 0.7f);
+
+    SkPath star;
+    star.moveTo(64, 5);
+    for (int i = 1; i < 5; ++i) {
+        const float angle = i * 4 * SK_ScalarPI / 5;
+        star.lineTo(64 + 59 * sinf(angle), 64 - 59 * cosf(angle));
+    }
+    star.close();
+
+    struct {
+        const char* name;
+        SkPath      path;
+        bool        selfIntersecting;
+    } cases[] = {
+        {"circle",  SkPath::Circle(63.7f, 61.3f, 40.4f), false},
+        {"nested",  nested, false},
+        {"curves",  curves, false},
+        // Straddles the left, top and right edges of the clip.
+        {"clipped", SkPath::Oval({-40.2f, -30.6f, 150.1f, 100.3f}), false},
+        {"star",    star, true},
+    };
+    for (auto& c : cases) {
+        for (SkPathFillType fillType : {SkPathFillType::kWinding,
+                                        SkPathFillType::kEvenOdd,
+                                        SkPathFillType::kInverseWinding,
+                                        SkPathFillType::kInverseEvenOdd}) {
+            c.path.setFillType(fillType);
+            int maxError, totalError;
+            accumulation_error(c.path, clip, &maxError, &totalError);
+            // Like analytic AA, accumulation only approximates the coverage of pixels where
+            // edges cross, but that should even out over the whole path.
+            REPORTER_ASSERT(reporter, c.selfIntersecting || maxError <= 12,
+                            "%s, fill type %d: %d", c.name, (int)fillType, maxError);
+            REPORTER_ASSERT(reporter, totalError <= 255 * 4,
+                            "%s, fill type %d: %d", c.name, (int)fillType, totalError);
+        }
+    }
+}
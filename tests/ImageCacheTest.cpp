@@ -5,15 +5,18 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkExecutor.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkTypes.h"
 #include "include/private/chromium/SkDiscardableMemory.h"
 #include "src/core/SkResourceCache.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/lazy/SkDiscardableMemoryPool.h"
 #include "tests/Test.h"
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 
 namespace {
 static void* gGlobalAddress;
@@ -154,3 +157,56 @@ DEF_TEST(ImageCache_doubleAdd, r) {
     REPORTER_ASSERT(r, cache.find(key, TestingRec::Visitor, &value));
     REPORTER_ASSERT(r, 2 == value || 3 == value);
 }
+
+// The cache is split into shards, but should still purge the least recently used recs first.
+DEF_TEST(ImageCache_LRUAcrossShards, r) {
+    const size_t recSize = TestingRec(TestingKey(0), 0).bytesUsed();
+    const int kCount = 100;
+    SkResourceCache cache(recSize * kCount + recSize / 2);
+
+    for (int i = 0; i < kCount; ++i) {
+        cache.add(new TestingRec(TestingKey(i), i));
+    }
+    // Touch the first half, so the second half is now the least recently used.
+    intptr_t value;
+    for (int i = 0; i < kCount / 2; ++i) {
+        REPORTER_ASSERT(r, cache.find(TestingKey(i), TestingRec::Visitor, &value));
+    }
+    for (int i = kCount; i < kCount + kCount / 2; ++i) {
+        cache.add(new TestingRec(TestingKey(i), i));
+    }
+
+    REPORTER_ASSERT(r, cache.getTotalBytesUsed() <= cache.getTotalByteLimit());
+    for (int i = 0; i < kCount + kCount / 2; ++i) {
+        const bool expected = i < kCount / 2 || i >= kCount;
+        REPORTER_ASSERT(r, expected == cache.find(TestingKey(i), TestingRec::Visitor, &value),
+                        "key %d", i);
+    }
+}
+
+DEF_TEST(ImageCache_Threaded, r) {
+    const size_t recSize = TestingRec(TestingKey(0), 0).bytesUsed();
+    SkResourceCache cache(recSize * 64);
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+
+    SkTaskGroup tg(*executor);
+    tg.batch(8, [&](int thread) {
+        for (int i = 0; i < 2000; ++i) {
+            TestingKey key((i * 7 + thread) % 200, i & 3);
+            intptr_t value = -1;
+            if (cache.find(key, TestingRec::Visitor, &value)) {
+                REPORTER_ASSERT(r, value == key.fValue);
+            } else {
+                cache.add(new TestingRec(key, key.fValue));
+            }
+            if (i % 500 == 0) {
+                cache.purgeSharedID(thread & 3);
+            }
+        }
+    });
+    tg.wait();
+
+    REPORTER_ASSERT(r, cache.getTotalBytesUsed() <= cache.getTotalByteLimit());
+    cache.purgeAll();
+    REPORTER_ASSERT(r, cache.getTotalBytesUsed() == 0);
+}
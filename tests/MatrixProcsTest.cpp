@@ -7,13 +7,20 @@
 
 #include "tests/Test.h"
 
+#include "include/core/SkBitmap.h"
+#include "include/core/SkColorPriv.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkTileMode.h"
 #include "include/core/SkTypes.h"
 #include "include/private/base/SkFixed.h"
+#include "src/base/SkRandom.h"
 #include "src/core/SkBitmapProcState.h"
 #include "src/opts/SkBitmapProcState_opts.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <string>
 
 uint32_t highBits(uint32_t rv) {
@@ -281,3 +288,70 @@ DEF_TEST(MatrixProcs_unpack_int, r) {
         SkASSERT(tc.expectedUpperBound == lowBits(tc.input));
     }
 }
+
+// Whichever S32_alpha_D32_filter_DX this CPU picked should match a plain bilerp exactly, for every
+// count (so the tails that vectorized code handles separately are covered), and never write past
+// the end of colors.
+DEF_TEST(MatrixProcs_S32_alpha_D32_filter_DX, r) {
+    SkOpts::Init_BitmapProcState();
+
+    constexpr int kW = 64, kH = 4, kMaxCount = 41;
+    constexpr uint32_t kGuard = 0xDEADBEEF;
+
+    SkRandom rand;
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(kW, kH);
+    for (int y = 0; y < kH; y++) {
+        for (int x = 0; x < kW; x++) {
+            const U8CPU a = rand.nextULessThan(256);
+            *bitmap.getAddr32(x, y) = SkPackARGB32(a, rand.nextULessThan(a + 1),
+                                                      rand.nextULessThan(a + 1),
+                                                      rand.nextULessThan(a + 1));
+        }
+    }
+
+    SkBitmapProcState s(nullptr, SkTileMode::kClamp, SkTileMode::kClamp);
+    s.fPixmap = bitmap.pixmap();
+    s.fBilerp = true;
+
+    auto pack = [](uint32_t v0, uint32_t w, uint32_t v1) { return v0 << 18 | w << 14 | v1; };
+    const uint32_t y0 = 1, y1 = 2, wy = 5;
+    uint32_t xy[kMaxCount + 1];
+    xy[0] = pack(y0, wy, y1);
+    for (int i = 0; i < kMaxCount; i++) {
+        const uint32_t x0 = rand.nextULessThan(kW);
+        xy[i + 1] = pack(x0, rand.nextULessThan(16), std::min<uint32_t>(x0 + 1, kW - 1));
+    }
+
+    for (uint16_t alphaScale : {256, 255, 100}) {
+        s.fAlphaScale = alphaScale;
+        for (int count = 1; count <= kMaxCount; count++) {
+            uint32_t colors[kMaxCount + 1];
+            std::fill(std::begin(colors), std::end(colors), kGuard);
+            SkOpts::S32_alpha_D32_filter_DX(s, xy, count, colors);
+
+            for (int i = 0; i < count; i++) {
+                uint32_t x0, x1, wx;
+                sktests::decode_packed_coordinates_and_weight(xy[i + 1], &x0, &x1, &wx);
+                const uint32_t tl = *bitmap.getAddr32(x0, y0), tr = *bitmap.getAddr32(x1, y0),
+                               bl = *bitmap.getAddr32(x0, y1), br = *bitmap.getAddr32(x1, y1);
+                uint32_t expected = 0;
+                for (int shift = 0; shift < 32; shift += 8) {
+                    auto c = [shift](uint32_t px) { return (px >> shift) & 0xFF; };
+                    uint32_t v = (c(tl) * (16 - wx) * (16 - wy) + c(tr) * wx * (16 - wy) +
+                                  c(bl) * (16 - wx) * wy        + c(br) * wx * wy) >> 8;
+                    if (alphaScale < 256) {
+                        v = (v * alphaScale) >> 8;
+                    }
+                    expected |= v << shift;
+                }
+                if (colors[i] != expected) {
+                    ERRORF(r, "alpha scale %d, pixel %d of %d: %08x != %08x",
+                           alphaScale, i, count, colors[i], expected);
+                    break;
+                }
+            }
+            REPORTER_ASSERT(r, colors[count] == kGuard, "count %d wrote past the end", count);
+        }
+    }
+}
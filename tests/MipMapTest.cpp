@@ -10,6 +10,7 @@
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkColorType.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkPixmap.h"
@@ -21,11 +22,15 @@
 #include "include/core/SkSurface.h"
 #include "include/core/SkTypes.h"
 #include "include/private/base/SkMalloc.h"
+#include "include/private/base/SkTo.h"
 #include "src/base/SkRandom.h"
 #include "src/core/SkMipmap.h"
 #include "src/core/SkMipmapBuilder.h"
 #include "tests/Test.h"
 #include "tools/DecodeUtils.h"
+#include "tools/ToolUtils.h"
+
+#include <memory>
 
 static void make_bitmap(SkBitmap* bm, int width, int height) {
     bm->allocN32Pixels(width, height);
@@ -235,6 +240,108 @@ DEF_TEST(MipMap_F16, reporter) {
     sk_sp<SkMipmap> mipmap(SkMipmap::Build(bmp, nullptr));
 }
 
+static void make_noise_bitmap(SkBitmap* bm, const SkImageInfo& info, SkRandom* rand) {
+    bm->allocPixels(info);
+    uint8_t* row = static_cast<uint8_t*>(bm->getPixels());
+    for (int y = 0; y < info.height(); ++y, row += bm->rowBytes()) {
+        for (size_t i = 0; i < info.minRowBytes(); ++i) {
+            row[i] = rand->nextU() & 0xFF;
+            if (info.colorType() == kRGBA_F16_SkColorType && (i & 1)) {
+                row[i] &= 0x3F;  // Keep halfs positive and below 2, so there are no NaNs.
+            }
+        }
+    }
+}
+
+#ifndef SK_USE_DRAWING_MIPMAP_DOWNSAMPLER
+// Each dst pixel is a weighted sum of src pixels starting at (2x, 2y): a 2-tap box filter along
+// even dimensions and a 1-2-1 triangle filter along odd ones (or just 1 tap if the src is 1 wide).
+static void reference_downsample_8888(const SkPixmap& dst, const SkPixmap& src) {
+    auto weights = [](int srcSize, int w[3]) {
+        w[0] = 1;
+        w[1] = srcSize == 1 ? 0 : (srcSize & 1) ? 2 : 1;
+        w[2] = srcSize > 1 && (srcSize & 1) ? 1 : 0;
+        return w[0] + w[1] + w[2];
+    };
+    int wx[3], wy[3];
+    const int total = weights(src.width(), wx) * weights(src.height(), wy);
+    for (int y = 0; y < dst.height(); ++y) {
+        for (int x = 0; x < dst.width(); ++x) {
+            uint8_t* d = reinterpret_cast<uint8_t*>(dst.writable_addr32(x, y));
+            for (int c = 0; c < 4; ++c) {
+                int sum = 0;
+                for (int ty = 0; ty < 3; ++ty) {
+                    for (int tx = 0; tx < 3; ++tx) {
+                        if (wx[tx] && wy[ty]) {
+                            auto s = reinterpret_cast<const uint8_t*>(
+                                    src.addr32(2 * x + tx, 2 * y + ty));
+                            sum += wx[tx] * wy[ty] * s[c];
+                        }
+                    }
+                }
+                d[c] = SkToU8(sum / total);
+            }
+        }
+    }
+}
+
+DEF_TEST(MipMap_8888MatchesReference, reporter) {
+    SkRandom rand;
+    const SkISize sizes[] = {
+        {1, 37}, {37, 1}, {2, 2}, {9, 9}, {16, 16}, {17, 16}, {16, 17}, {67, 35}, {300, 301},
+    };
+    for (SkISize size : sizes) {
+        SkBitmap bm;
+        make_noise_bitmap(&bm, SkImageInfo::MakeN32Premul(size), &rand);
+        sk_sp<SkMipmap> mm(SkMipmap::Build(bm, nullptr));
+        REPORTER_ASSERT(reporter, mm);
+        if (!mm) {
+            return;
+        }
+
+        SkPixmap src = bm.pixmap();
+        for (int i = 0; i < mm->countLevels(); ++i) {
+            SkMipmap::Level level;
+            REPORTER_ASSERT(reporter, mm->getLevel(i, &level));
+
+            SkBitmap expected;
+            expected.allocPixels(level.fPixmap.info());
+            reference_downsample_8888(expected.pixmap(), src);
+            REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(expected.pixmap(), level.fPixmap),
+                            "%dx%d level %d", size.width(), size.height(), i);
+            src = level.fPixmap;
+        }
+    }
+}
+#endif
+
+// Building with an executor splits large levels into bands; it should make the same pixels.
+DEF_TEST(MipMap_Executor, reporter) {
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    SkRandom rand;
+    const SkISize sizes[] = { {1201, 700}, {1024, 1024}, {1, 2000} };
+    for (SkColorType ct : {kN32_SkColorType, kRGBA_F16_SkColorType, kAlpha_8_SkColorType}) {
+        for (SkISize size : sizes) {
+            SkBitmap bm;
+            make_noise_bitmap(&bm, SkImageInfo::Make(size, ct, kPremul_SkAlphaType), &rand);
+            sk_sp<SkMipmap> serial(SkMipmap::Build(bm, nullptr));
+            sk_sp<SkMipmap> threaded(SkMipmap::Build(bm, nullptr, executor.get()));
+            REPORTER_ASSERT(reporter, serial && threaded);
+            if (!serial || !threaded) {
+                return;
+            }
+
+            REPORTER_ASSERT(reporter, serial->countLevels() == threaded->countLevels());
+            for (int i = 0; i < serial->countLevels(); ++i) {
+                SkMipmap::Level a, b;
+                REPORTER_ASSERT(reporter, serial->getLevel(i, &a) && threaded->getLevel(i, &b));
+                REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(a.fPixmap, b.fPixmap),
+                                "ct %d %dx%d level %d", ct, size.width(), size.height(), i);
+            }
+        }
+    }
+}
+
 static void fill_in_mips(SkMipmapBuilder* builder, sk_sp<SkImage> img) {
     int count = builder->countLevels();
     for (int i = 0; i < count; ++i) {
@@ -21,6 +21,7 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 
 #include "zlib.h"
@@ -177,4 +178,57 @@ DEF_TEST(SkPDF_DeflateWStream, r) {
     REPORTER_ASSERT(r, !emptyDeflateWStream.writeText("FOO"));
 }
 
+DEF_TEST(SkPDF_DeflateWStream_Fastest, r) {
+    SkRandom random(654321);
+    for (int loop = 0; loop < 50; ++loop) {
+        // Larger inputs than above, partly repetitive, that span several of the fastest level's
+        // blocks.
+        uint32_t size = random.nextULessThan(200000);
+        AutoTMalloc<uint8_t> buffer(size);
+        const uint32_t alphabet = random.nextRangeU(1, 256);
+        for (uint32_t j = 0; j < size; ++j) {
+            if (j >= 300 && random.nextULessThan(4) != 0) {
+                uint32_t distance = random.nextRangeU(1, std::min(j, 40000u));
+                uint32_t length = std::min(size - j, random.nextRangeU(1, 300));
+                for (uint32_t k = 0; k < length; ++k, ++j) {
+                    buffer[j] = buffer[j - distance];
+                }
+                --j;
+                continue;
+            }
+            buffer[j] = random.nextULessThan(alphabet) & 0xff;
+        }
+
+        SkDynamicMemoryWStream dynamicMemoryWStream;
+        {
+            SkDeflateWStream deflateWStream(&dynamicMemoryWStream,
+                                            SkDeflateWStream::kFastestCompressionLevel);
+            uint32_t j = 0;
+            while (j < size) {
+                uint32_t writeSize = std::min(size - j, random.nextRangeU(1, 40000));
+                if (!deflateWStream.write(&buffer[j], writeSize)) {
+                    ERRORF(r, "something went wrong.");
+                    return;
+                }
+                j += writeSize;
+            }
+            REPORTER_ASSERT(r, deflateWStream.bytesWritten() == size);
+        }
+        std::unique_ptr<SkStreamAsset> compressed(dynamicMemoryWStream.detachAsStream());
+        std::unique_ptr<SkStreamAsset> decompressed(stream_inflate(r, compressed.get()));
+        if (!decompressed) {
+            ERRORF(r, "Decompression failed.");
+            return;
+        }
+        if (decompressed->getLength() != size) {
+            ERRORF(r, "Decompression failed to get right size [%d]. %u != %u",
+                   loop, (unsigned)(decompressed->getLength()), (unsigned)size);
+            continue;
+        }
+        AutoTMalloc<uint8_t> output(size);
+        REPORTER_ASSERT(r, decompressed->read(output.get(), size) == size);
+        REPORTER_ASSERT(r, 0 == memcmp(output.get(), buffer.get(), size), "[%d]", loop);
+    }
+}
+
 #endif
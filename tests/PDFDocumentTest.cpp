@@ -4,6 +4,7 @@
  * Use of this source code is governed by a BSD-style license that can be
  * found in the LICENSE file.
  */
+#include "include/core/SkAnnotation.h"
 #include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
@@ -11,20 +12,42 @@
 #include "include/core/SkDocument.h"
 #include "include/core/SkExecutor.h"
 #include "include/core/SkFont.h"
+#include "include/core/SkGraphics.h"
 #include "include/core/SkImage.h" // IWYU pragma: keep
+#include "include/core/SkImageInfo.h"
 #include "include/core/SkPaint.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkPictureRecorder.h"
+#include "include/core/SkPoint.h"
+#include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkString.h"
+#include "include/core/SkTypeface.h"
 #include "include/docs/SkPDFDocument.h"
+#include "include/effects/SkGradientShader.h"
+#include "include/private/base/SkMutex.h"
+#include "include/private/base/SkTo.h"
+#include "src/base/SkRandom.h"
+#include "src/pdf/SkPDFGlyphUse.h"
+#include "src/pdf/SkPDFSubsetFont.h"
 #include "src/utils/SkOSPath.h"
 #include "tests/Test.h"
+#include "tools/Resources.h"
 #include "tools/fonts/FontToolUtils.h"
 
+#include <chrono>
 #include <cstdint>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <functional>
+#include <map>
 #include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 static void test_empty(skiatest::Reporter* reporter) {
     SkDynamicMemoryWStream stream;
@@ -267,3 +290,323 @@ DEF_TEST(SkPDF_abort_jobs, rep) {
     doc->abort();
 }
 
+
+// Splits a PDF into its numbered objects, without their offsets in the file.
+static std::map<int, std::string> pdf_objects(const SkData& pdf) {
+    std::map<int, std::string> objects;
+    const std::string bytes(static_cast<const char*>(pdf.data()), pdf.size());
+    size_t start = 0;
+    while ((start = bytes.find(" 0 obj\n", start)) != std::string::npos) {
+        size_t number = bytes.rfind('\n', start) + 1;
+        size_t end = bytes.find("\nendobj\n", start);
+        if (end == std::string::npos) {
+            break;
+        }
+        objects[atoi(bytes.c_str() + number)] = bytes.substr(start, end - start);
+        start = end;
+    }
+    return objects;
+}
+
+// Returns the number of the object that `key` refers to in `object`, or 0 if there is none.
+static int find_ref(const std::string& object, const char key[]) {
+    size_t i = object.find(std::string(key) + " ");
+    return i == std::string::npos ? 0 : atoi(object.c_str() + i + strlen(key) + 1);
+}
+
+// Counts the pages below `node` in the page tree, checking the parent of each node.
+static int count_pages(skiatest::Reporter* r,
+                       const std::map<int, std::string>& objects,
+                       int node,
+                       int parent) {
+    auto found = objects.find(node);
+    if (found == objects.end()) {
+        ERRORF(r, "Missing page tree node %d", node);
+        return 0;
+    }
+    const std::string& object = found->second;
+    REPORTER_ASSERT(r, find_ref(object, "/Parent") == parent, "node %d", node);
+    if (object.find("/Type /Page\n") != std::string::npos) {
+        return 1;
+    }
+    int pages = 0;
+    size_t kids = object.find("/Kids [");
+    if (kids == std::string::npos) {
+        ERRORF(r, "Page tree node %d has no kids", node);
+        return 0;
+    }
+    for (const char* p = object.c_str() + kids + strlen("/Kids ["); *p != ']';) {
+        char* end;
+        int kid = strtol(p, &end, 10);
+        pages += count_pages(r, objects, kid, node);
+        p = end + strlen(" 0 R");
+        p += *p == ' ';
+    }
+    REPORTER_ASSERT(r, find_ref(object, "/Count") == pages, "node %d", node);
+    return pages;
+}
+
+static int count_pages(skiatest::Reporter* r, const SkData& pdf) {
+    std::map<int, std::string> objects = pdf_objects(pdf);
+    const std::string bytes(static_cast<const char*>(pdf.data()), pdf.size());
+    int catalog = find_ref(bytes.substr(bytes.rfind("trailer")), "/Root");
+    return count_pages(r, objects, find_ref(objects[catalog], "/Pages"), 0);
+}
+
+static sk_sp<SkData> make_concurrent_pages_pdf(SkExecutor* executor,
+                                               bool concurrent,
+                                               bool tagged,
+                                               bool streaming) {
+    using PDFTag = SkPDF::StructureElementNode;
+    constexpr int kPageCount = 40;
+
+    auto root = std::make_unique<PDFTag>();
+    root->fNodeId = 1;
+    root->fTypeString = "Document";
+    for (int i = 0; i < kPageCount; ++i) {
+        auto paragraph = std::make_unique<PDFTag>();
+        paragraph->fNodeId = 2 + i;
+        paragraph->fTypeString = "P";
+        root->fChildVector.push_back(std::move(paragraph));
+    }
+
+    SkPDF::Metadata metadata;
+    metadata.fExecutor = executor;
+    metadata.fConcurrentPages = concurrent;
+    metadata.fStreaming = streaming;
+    metadata.fStructureElementTreeRoot = tagged ? root.get() : nullptr;
+    SkDynamicMemoryWStream stream;
+    auto doc = SkPDF::MakeDocument(&stream, metadata);
+
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(32, 32);
+    bitmap.eraseColor(SK_ColorBLUE);
+    sk_sp<SkImage> logo = bitmap.asImage();
+    SkFont font = ToolUtils::DefaultFont();
+    const SkPoint points[] = {{0, 0}, {0, 400}};
+    const SkColor colors[] = {SK_ColorWHITE, SK_ColorGRAY};
+
+    for (int i = 0; i < kPageCount; ++i) {
+        // Record some pages ahead, as a caller recording pages on other threads would.
+        SkPictureRecorder recorder;
+        SkCanvas* canvas = (i % 3 == 0) ? recorder.beginRecording(612, 792)
+                                        : doc->beginPage(612, 792);
+        SkPaint paint;
+        paint.setShader(SkGradientShader::MakeLinear(points, colors, nullptr, 2,
+                                                     SkTileMode::kClamp));
+        canvas->drawRect({0, 0, 612, 400}, paint);
+        paint.setShader(nullptr);
+        paint.setColor(SkColorSetARGB(0x80 + (i % 4) * 0x20, 0xFF, 0x00, 0x00));
+        canvas->drawRect({36, 36 + i, 200, 200}, paint);
+        paint.setStyle(SkPaint::kStroke_Style);
+        paint.setStrokeWidth(1 + (i % 5));
+        canvas->drawCircle(300, 300, 50, paint);
+        canvas->drawImage(logo, 500, 36);
+        SkPDF::SetNodeId(canvas, 2 + i);
+        canvas->drawString(SkStringPrintf("Page %d", i).c_str(), 72, 450, font, SkPaint());
+        SkAnnotateRectWithURL(canvas, {72, 430, 200, 460},
+                              SkData::MakeWithCString("https://skia.org").get());
+        if (i % 10 == 0) {
+            SkAnnotateNamedDestination(canvas, {72, 72},
+                                       SkData::MakeWithCString(std::to_string(i).c_str()).get());
+        }
+        if (i % 3 == 0) {
+            doc->beginPage(612, 792)->drawPicture(recorder.finishRecordingAsPicture());
+        }
+        doc->endPage();
+    }
+    doc->close();
+    return stream.detachAsData();
+}
+
+// Runs each task on its own thread after a random delay, so that pages start out of order.
+class ShuffledExecutor final : public SkExecutor {
+public:
+    ~ShuffledExecutor() override {
+        for (std::thread& thread : fThreads) {
+            thread.join();
+        }
+    }
+
+    void add(std::function<void()> work) override {
+        SkAutoMutexExclusive lock(fMutex);
+        auto delay = std::chrono::microseconds(fRandom.nextULessThan(2000));
+        fThreads.emplace_back([work = std::move(work), delay]() {
+            std::this_thread::sleep_for(delay);
+            work();
+        });
+    }
+
+private:
+    SkMutex fMutex;
+    SkRandom fRandom;
+    std::vector<std::thread> fThreads;
+};
+
+DEF_TEST(SkPDF_concurrent_pages, r) {
+    REQUIRE_PDF_DOCUMENT(SkPDF_concurrent_pages, r);
+    for (auto [tagged, streaming] : {std::pair(false, false), std::pair(true, false),
+                                     std::pair(false, true), std::pair(true, true)}) {
+        sk_sp<SkData> pdf = make_concurrent_pages_pdf(nullptr, false, tagged, streaming);
+        std::map<int, std::string> expected = pdf_objects(*pdf);
+        REPORTER_ASSERT(r, expected.size() > 40 * 2);
+        REPORTER_ASSERT(r, count_pages(r, *pdf) == 40);
+        std::unique_ptr<SkExecutor> fifo = SkExecutor::MakeFIFOThreadPool(4);
+        // Later pages start first on a LIFO pool, so they have to draw the pages before them.
+        std::unique_ptr<SkExecutor> lifo = SkExecutor::MakeLIFOThreadPool(2);
+        ShuffledExecutor shuffled;
+        for (SkExecutor* executor : {(SkExecutor*)fifo.get(), (SkExecutor*)lifo.get(),
+                                     (SkExecutor*)&shuffled}) {
+            std::map<int, std::string> objects =
+                    pdf_objects(*make_concurrent_pages_pdf(executor, true, tagged, streaming));
+            REPORTER_ASSERT(r, objects == expected, "tagged %d streaming %d", tagged, streaming);
+        }
+    }
+}
+
+static int count(const SkData& pdf, const char substring[]) {
+    const std::string bytes(static_cast<const char*>(pdf.data()), pdf.size());
+    int n = 0;
+    for (size_t i = 0; (i = bytes.find(substring, i)) != std::string::npos; ++i) {
+        ++n;
+    }
+    return n;
+}
+
+// Images and layers with the same content are embedded once, even when they come from
+// different SkImages.
+DEF_TEST(SkPDF_dedupe_content, r) {
+    REQUIRE_PDF_DOCUMENT(SkPDF_dedupe_content, r);
+    sk_sp<SkData> encoded = GetResourceAsData("images/mandrill_32.png");
+    if (!encoded) {
+        return;
+    }
+    SkBitmap bitmap;
+    bitmap.allocPixels(SkImageInfo::MakeN32Premul(16, 16));
+    bitmap.eraseColor(SK_ColorBLUE);
+    bitmap.erase(SK_ColorGREEN, SkIRect::MakeLTRB(4, 4, 12, 12));
+
+    SkDynamicMemoryWStream stream;
+    auto doc = SkPDF::MakeDocument(&stream);
+    for (int page = 0; page < 4; ++page) {
+        SkCanvas* canvas = doc->beginPage(200, 200);
+        // A new SkImage on each page, but only the last page's has different pixels.
+        if (page == 3) {
+            bitmap.eraseColor(SK_ColorRED);
+        }
+        canvas->drawImage(SkImages::RasterFromPixmapCopy(bitmap.pixmap()), 0, 0);
+        canvas->drawImage(SkImages::DeferredFromEncodedData(encoded), 50, 0);
+        canvas->saveLayerAlpha(nullptr, 0x80);
+        canvas->drawRect({0, 100, 100, 200}, SkPaint(SkColors::kMagenta));
+        canvas->restore();
+        doc->endPage();
+    }
+    doc->close();
+    sk_sp<SkData> pdf = stream.detachAsData();
+    REPORTER_ASSERT(r, count(*pdf, "/Subtype /Image") == 3);
+    REPORTER_ASSERT(r, count(*pdf, "/Subtype /Form") == 1);
+}
+
+// A streamed document writes each page when it ends, so it doesn't hold on to thousands of them.
+DEF_TEST(SkPDF_streaming_pages, r) {
+    REQUIRE_PDF_DOCUMENT(SkPDF_streaming_pages, r);
+    constexpr int kPageCount = 10000;
+    SkPDF::Metadata metadata;
+    metadata.fStreaming = true;
+    SkDynamicMemoryWStream stream;
+    auto doc = SkPDF::MakeDocument(&stream, metadata);
+
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(32, 32);
+    bitmap.eraseColor(SK_ColorBLUE);
+    sk_sp<SkImage> logo = bitmap.asImage();
+    SkFont font = ToolUtils::DefaultFont();
+    std::vector<size_t> pageEnds;
+    for (int i = 0; i < kPageCount; ++i) {
+        SkCanvas* canvas = doc->beginPage(612, 792);
+        canvas->drawImage(logo, 500, 36);
+        canvas->drawString(SkStringPrintf("Page %d", i).c_str(), 72, 72, font, SkPaint());
+        doc->endPage();
+        pageEnds.push_back(stream.bytesWritten());
+    }
+    doc->close();
+    sk_sp<SkData> pdf = stream.detachAsData();
+
+    const std::string bytes(static_cast<const char*>(pdf->data()), pdf->size());
+    int pages = 0;
+    for (size_t i = 0; (i = bytes.find("/Type /Page\n", i)) != std::string::npos; ++i) {
+        if (pages < kPageCount) {
+            REPORTER_ASSERT(r, i < pageEnds[pages], "page %d", pages);
+        }
+        ++pages;
+    }
+    REPORTER_ASSERT(r, pages == kPageCount);
+    REPORTER_ASSERT(r, count(*pdf, "/Subtype /Image") == 1);
+    REPORTER_ASSERT(r, count_pages(r, *pdf) == kPageCount);
+}
+
+static sk_sp<SkData> make_text_pdf(const char text[]) {
+    SkDynamicMemoryWStream stream;
+    auto doc = SkPDF::MakeDocument(&stream);
+    SkCanvas* canvas = doc->beginPage(612, 792);
+    canvas->drawString(text, 72, 72, ToolUtils::DefaultFont(), SkPaint());
+    doc->endPage();
+    doc->close();
+    return stream.detachAsData();
+}
+
+// Font metrics and glyph-to-unicode maps are cached across documents, and a document made with
+// them is the same as one made without them. Font subsets are cached too, but a cached subset may
+// have more glyphs than the document uses (see SkPDF_subset_cache). Serial, since it purges the
+// global SkResourceCache that other tests' documents use.
+DEF_SERIAL_TEST(SkPDF_font_cache, r) {
+    REQUIRE_PDF_DOCUMENT(SkPDF_font_cache, r);
+    SkGraphics::PurgeResourceCache();
+    sk_sp<SkData> cold = make_text_pdf("Hello, World!");
+    sk_sp<SkData> warm = make_text_pdf("Hello, World!");
+    REPORTER_ASSERT(r, cold->equals(warm.get()));
+    REPORTER_ASSERT(r, count(*warm, "/ToUnicode") == 1);
+
+    sk_sp<SkData> fewer = make_text_pdf("Hello");
+    SkGraphics::PurgeResourceCache();
+    REPORTER_ASSERT(r, fewer->equals(make_text_pdf("Hello").get()));
+}
+
+#if defined(SK_PDF_USE_HARFBUZZ_SUBSET)
+// A cached subset is reused for a document that needs some of its glyphs, as long as it has at
+// most a quarter more glyphs than that document needs. Serial, since the subsets live in the
+// global SkResourceCache.
+DEF_SERIAL_TEST(SkPDF_subset_cache, r) {
+    sk_sp<SkTypeface> typeface = ToolUtils::CreateTypefaceFromResource("fonts/Roboto-Regular.ttf");
+    if (!typeface) {
+        // Not all SkFontMgr can MakeFromStream().
+        return;
+    }
+    const SkGlyphID lastGlyph = SkToU16(typeface->countGlyphs() - 1);
+    auto subset = [&](int glyphCount, SkGlyphID extraGlyph = 0) {
+        SkPDFGlyphUse glyphUsage(1, lastGlyph);
+        for (int gid = 1; gid <= glyphCount; ++gid) {
+            glyphUsage.set(SkToU16(gid));
+        }
+        if (extraGlyph) {
+            glyphUsage.set(extraGlyph);
+        }
+        return SkPDFSubsetFont(*typeface, glyphUsage);
+    };
+
+    SkGraphics::PurgeResourceCache();
+    sk_sp<SkData> forty = subset(40);
+    REPORTER_ASSERT(r, forty);
+    // 40 glyphs is at most a quarter more than 32.
+    REPORTER_ASSERT(r, subset(32).get() == forty.get());
+    REPORTER_ASSERT(r, subset(36).get() == forty.get());
+    // But not than 31.
+    sk_sp<SkData> thirtyOne = subset(31);
+    REPORTER_ASSERT(r, thirtyOne && thirtyOne.get() != forty.get());
+    // Nor does it cover a glyph outside it.
+    sk_sp<SkData> outside = subset(35, 50);
+    REPORTER_ASSERT(r, outside && outside.get() != forty.get());
+    // The smallest covering subset is used.
+    REPORTER_ASSERT(r, subset(30).get() == thirtyOne.get());
+}
+#endif
@@ -0,0 +1,235 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkColorSpace.h"
+#include "include/core/SkData.h"
+#include "include/core/SkGraphics.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkImageGenerator.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkPersistentImageCache.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkString.h"
+#include "src/core/SkOSFile.h"
+#include "src/core/SkTHash.h"
+#include "src/utils/SkOSPath.h"
+#include "tests/Test.h"
+#include "tools/Resources.h"
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <utility>
+
+namespace {
+// Counts how many times the image is decoded.
+class CountingGenerator final : public SkImageGenerator {
+public:
+    CountingGenerator(sk_sp<SkData> encoded, int* decodeCount)
+            : SkImageGenerator(SkImageInfo::MakeN32Premul(16, 8))
+            , fEncoded(std::move(encoded))
+            , fDecodeCount(decodeCount) {}
+
+protected:
+    sk_sp<SkData> onRefEncodedData() override { return fEncoded; }
+
+    bool onGetPixels(const SkImageInfo& info, void* pixels, size_t rowBytes,
+                     const Options&) override {
+        (*fDecodeCount)++;
+        SkPixmap pixmap(info, pixels, rowBytes);
+        for (int y = 0; y < info.height(); y++) {
+            for (int x = 0; x < info.width(); x++) {
+                *pixmap.writable_addr32(x, y) = 0xFF000000 | (y << 8) | x;
+            }
+        }
+        return true;
+    }
+
+private:
+    sk_sp<SkData> fEncoded;
+    int*          fDecodeCount;
+};
+
+class MemoryImageCache final : public SkPersistentImageCache {
+public:
+    sk_sp<SkData> load(const SkData& key) override {
+        sk_sp<SkData>* data = fEntries.find(ToString(key));
+        return data ? *data : nullptr;
+    }
+    void store(const SkData& key, const SkData& data) override {
+        fEntries.set(ToString(key), SkData::MakeWithCopy(data.data(), data.size()));
+    }
+
+    static SkString ToString(const SkData& key) {
+        return SkString(static_cast<const char*>(key.data()), key.size());
+    }
+
+    skia_private::THashMap<SkString, sk_sp<SkData>> fEntries;
+};
+
+// Installs a persistent cache for the duration of a test.
+class AutoPersistentImageCache {
+public:
+    explicit AutoPersistentImageCache(sk_sp<SkPersistentImageCache> cache)
+            : fPrevious(SkGraphics::SetPersistentImageCache(std::move(cache))) {}
+    ~AutoPersistentImageCache() { SkGraphics::SetPersistentImageCache(std::move(fPrevious)); }
+
+private:
+    sk_sp<SkPersistentImageCache> fPrevious;
+};
+}  // namespace
+
+static sk_sp<SkImage> make_image(const char* resource) {
+    return SkImages::DeferredFromEncodedData(GetResourceAsData(resource));
+}
+
+static sk_sp<SkImage> make_counting_image(const char* encoded, int* decodeCount) {
+    return SkImages::DeferredFromGenerator(std::make_unique<CountingGenerator>(
+            SkData::MakeWithCString(encoded), decodeCount));
+}
+
+static bool read_pixels(const sk_sp<SkImage>& image, SkImage::CachingHint hint,
+                        SkBitmap* bitmap) {
+    bitmap->allocPixels(image->imageInfo());
+    return image->readPixels(nullptr, bitmap->pixmap(), 0, 0, hint);
+}
+
+// Serial, since it installs a process-wide persistent cache (and corrupts an entry in it), which
+// tests decoding images at the same time would go through.
+DEF_SERIAL_TEST(PersistentImageCache_SkipsDecode, r) {
+    auto cache = sk_make_sp<MemoryImageCache>();
+    AutoPersistentImageCache autoCache(cache);
+
+    constexpr char kImage[] = "images/randPixels.png";
+    SkBitmap expected;
+    if (!read_pixels(make_image(kImage), SkImage::kAllow_CachingHint, &expected)) {
+        ERRORF(r, "Could not decode %s", kImage);
+        return;
+    }
+    REPORTER_ASSERT(r, cache->fEntries.count() == 1);
+
+    // Mark the stored pixels, to tell whether they are decoded again.
+    const size_t lastByte = expected.computeByteSize() - 1;
+    auto markedPixels = [&](const SkBitmap& bm) {
+        const uint8_t* pixels = static_cast<const uint8_t*>(bm.getPixels());
+        return 0 == memcmp(pixels, expected.getPixels(), lastByte) &&
+               pixels[lastByte] == (static_cast<const uint8_t*>(expected.getPixels())[lastByte] ^
+                                    0xFF);
+    };
+    cache->fEntries.foreach([](const SkString&, sk_sp<SkData>* data) {
+        sk_sp<SkData> marked = SkData::MakeWithCopy((*data)->data(), (*data)->size());
+        static_cast<uint8_t*>(marked->writable_data())[marked->size() - 1] ^= 0xFF;
+        *data = std::move(marked);
+    });
+
+    // A new image from the same data (e.g. in another process) finds the decoded pixels, whether
+    // or not it caches them in memory.
+    for (auto hint : {SkImage::kAllow_CachingHint, SkImage::kDisallow_CachingHint}) {
+        SkBitmap bm;
+        REPORTER_ASSERT(r, read_pixels(make_image(kImage), hint, &bm));
+        REPORTER_ASSERT(r, markedPixels(bm));
+    }
+
+    // Different data, or a different color space, is decoded again, and stored whether or not
+    // the image caches it in memory.
+    SkBitmap bm;
+    REPORTER_ASSERT(r, read_pixels(make_image("images/3x3.png"), SkImage::kDisallow_CachingHint,
+                                   &bm));
+    REPORTER_ASSERT(r, cache->fEntries.count() == 2);
+    sk_sp<SkImage> linear = make_image(kImage)->makeColorSpace(nullptr,
+                                                               SkColorSpace::MakeSRGBLinear());
+    REPORTER_ASSERT(r, linear && read_pixels(linear, SkImage::kAllow_CachingHint, &bm));
+    REPORTER_ASSERT(r, cache->fEntries.count() == 3);
+
+    // Entries that don't match the image are ignored.
+    cache->fEntries.foreach([](const SkString&, sk_sp<SkData>* data) {
+        *data = SkData::MakeSubset(data->get(), 0, (*data)->size() - 1);
+    });
+    REPORTER_ASSERT(r, read_pixels(make_image(kImage), SkImage::kAllow_CachingHint, &bm));
+    REPORTER_ASSERT(r, 0 == memcmp(bm.getPixels(), expected.getPixels(),
+                                   expected.computeByteSize()));
+}
+
+static std::unique_ptr<SkImageGenerator> make_counting_generator(sk_sp<SkData> encoded) {
+    static int gDecodeCount = 0;
+    return std::make_unique<CountingGenerator>(std::move(encoded), &gDecodeCount);
+}
+
+// Serial, since it also swaps the process-wide image generator factory.
+DEF_SERIAL_TEST(PersistentImageCache_OnlyCodecGenerators, r) {
+    auto cache = sk_make_sp<MemoryImageCache>();
+    AutoPersistentImageCache autoCache(cache);
+
+    // Other generators may decode the same data differently, so they don't share pixels.
+    int decodeCount = 0;
+    for (int i = 0; i < 2; i++) {
+        SkBitmap bm;
+        REPORTER_ASSERT(r, read_pixels(make_counting_image("a", &decodeCount),
+                                       SkImage::kAllow_CachingHint, &bm));
+        REPORTER_ASSERT(r, decodeCount == i + 1);
+    }
+
+    auto prevFactory = SkGraphics::SetImageGeneratorFromEncodedDataFactory(
+            make_counting_generator);
+    SkBitmap bm;
+    REPORTER_ASSERT(r, read_pixels(make_image("images/randPixels.png"),
+                                   SkImage::kAllow_CachingHint, &bm));
+    SkGraphics::SetImageGeneratorFromEncodedDataFactory(prevFactory);
+    REPORTER_ASSERT(r, cache->fEntries.count() == 0);
+}
+
+DEF_TEST(PersistentImageCache_Directory, r) {
+    const SkString tmpDir = skiatest::GetTmpDir();
+    if (tmpDir.isEmpty()) {
+        return;
+    }
+    const SkString dir = SkOSPath::Join(tmpDir.c_str(), "persistent_image_cache");
+    sk_mkdir(dir.c_str());
+    {
+        // Start empty.
+        SkOSFile::Iter iter(dir.c_str());
+        SkString name;
+        while (iter.next(&name)) {
+            std::remove(SkOSPath::Join(dir.c_str(), name.c_str()).c_str());
+        }
+    }
+    REPORTER_ASSERT(r, !SkPersistentImageCache::MakeDirectory(
+                               SkOSPath::Join(dir.c_str(), "missing").c_str(), 1000));
+
+    const sk_sp<SkData> keys[] = {SkData::MakeWithCString("one"), SkData::MakeWithCString("two"),
+                                  SkData::MakeWithCString("three")};
+    const sk_sp<SkData> value = SkData::MakeZeroInitialized(400);
+    {
+        sk_sp<SkPersistentImageCache> cache = SkPersistentImageCache::MakeDirectory(dir.c_str(),
+                                                                                    1000);
+        REPORTER_ASSERT(r, cache);
+        REPORTER_ASSERT(r, !cache->load(*keys[0]));
+        cache->store(*keys[0], *value);
+        cache->store(*keys[1], *value);
+        sk_sp<SkData> loaded = cache->load(*keys[0]);
+        REPORTER_ASSERT(r, loaded && loaded->equals(value.get()));
+
+        // The third entry goes over budget, so the least recently used one is deleted.
+        cache->store(*keys[2], *value);
+        REPORTER_ASSERT(r, !cache->load(*keys[1]));
+        REPORTER_ASSERT(r, cache->load(*keys[2]));
+
+        // Entries that don't fit at all aren't stored.
+        cache->store(*keys[1], *SkData::MakeZeroInitialized(1001));
+        REPORTER_ASSERT(r, !cache->load(*keys[1]));
+    }
+
+    // A new cache (e.g. in another process) picks up the entries, and trims them to its budget.
+    sk_sp<SkPersistentImageCache> cache = SkPersistentImageCache::MakeDirectory(dir.c_str(), 500);
+    int found = 0;
+    for (const sk_sp<SkData>& key : keys) {
+        found += cache->load(*key) ? 1 : 0;
+    }
+    REPORTER_ASSERT(r, found == 1);
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkBBHFactory.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkBlendMode.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkPictureRecorder.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkRegion.h"
+#include "include/utils/SkPictureDamage.h"
+#include "tests/Test.h"
+#include "tools/ToolUtils.h"
+
+#include <functional>
+
+static constexpr int kW = 200, kH = 150;
+
+static sk_sp<SkPicture> record(const std::function<void(SkCanvas*)>& draw) {
+    SkRTreeFactory factory;
+    SkPictureRecorder recorder;
+    draw(recorder.beginRecording(SkRect::MakeWH(kW, kH), &factory));
+    return recorder.finishRecordingAsPicture();
+}
+
+// A frame of a simple UI: a background, a few translucent, antialiased widgets, and a transformed
+// save block. 'selected' picks a widget to highlight and 'extra' adds a widget.
+static sk_sp<SkPicture> make_frame(int selected, bool extra = false) {
+    return record([&](SkCanvas* canvas) {
+        canvas->drawColor(SK_ColorWHITE);
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        for (int i = 0; i < 4; i++) {
+            paint.setColor(i == selected ? 0xC0FF0000 : 0x800000FF);
+            canvas->drawRoundRect(SkRect::MakeXYWH(10 + 45 * i, 10, 40, 30), 5, 5, paint);
+        }
+        if (extra) {
+            paint.setColor(0x8000FF00);
+            canvas->drawCircle(100, 80, 15, paint);
+        }
+        canvas->save();
+        canvas->translate(20, 100);
+        paint.setColor(SK_ColorBLACK);
+        canvas->drawRect(SkRect::MakeWH(160, 20), paint);
+        canvas->restore();
+    });
+}
+
+DEF_TEST(PictureDamage_Compute, r) {
+    // Identical frames have no damage.
+    REPORTER_ASSERT(r, SkPictureDamage::Compute(make_frame(1).get(),
+                                                make_frame(1).get()).isEmpty());
+
+    // Changing one widget damages the area under the widgets that changed, and nothing else.
+    SkRegion damage = SkPictureDamage::Compute(make_frame(1).get(), make_frame(2).get());
+    SkRegion expected;
+    expected.op(SkIRect::MakeXYWH(55, 10, 40, 30), SkRegion::kUnion_Op);
+    expected.op(SkIRect::MakeXYWH(100, 10, 40, 30), SkRegion::kUnion_Op);
+    REPORTER_ASSERT(r, damage == expected);
+
+    // Adding an op damages its bounds, even though the ops after it shift along.
+    damage = SkPictureDamage::Compute(make_frame(1).get(), make_frame(1, true).get());
+    REPORTER_ASSERT(r, damage.contains(SkIRect::MakeLTRB(85, 65, 115, 95)));
+    REPORTER_ASSERT(r, !damage.intersects(SkIRect::MakeXYWH(10, 10, 40, 30)));
+
+    // Going from nothing to a frame damages everything it draws.
+    damage = SkPictureDamage::Compute(nullptr, make_frame(0).get());
+    REPORTER_ASSERT(r, damage.contains(SkIRect::MakeWH(kW, kH)));
+}
+
+DEF_TEST(PictureDamage_Playback, r) {
+    const sk_sp<SkPicture> frames[] = {
+        make_frame(0), make_frame(3), make_frame(3, true), make_frame(1), make_frame(1),
+    };
+
+    SkBitmap incremental;
+    incremental.allocN32Pixels(kW, kH);
+    incremental.eraseColor(SK_ColorTRANSPARENT);
+    SkCanvas canvas(incremental);
+
+    const SkPicture* previous = nullptr;
+    for (const sk_sp<SkPicture>& frame : frames) {
+        SkPictureDamage::Playback(frame.get(),
+                                  SkPictureDamage::Compute(previous, frame.get()),
+                                  &canvas);
+        previous = frame.get();
+
+        SkBitmap full;
+        full.allocN32Pixels(kW, kH);
+        full.eraseColor(SK_ColorTRANSPARENT);
+        SkCanvas(full).drawPicture(frame);
+        REPORTER_ASSERT(r, ToolUtils::equal_pixels(incremental, full));
+    }
+}
+
+// Without clearing, the picture is drawn over whatever the caller has put under the damage.
+DEF_TEST(PictureDamage_PlaybackOverBackground, r) {
+    auto widget = [](SkScalar x) {
+        return record([x](SkCanvas* canvas) {
+            canvas->drawRect(SkRect::MakeXYWH(x, 10, 40, 30), SkPaint(SkColor4f{0, 0, 1, 0.5f}));
+        });
+    };
+    const sk_sp<SkPicture> before = widget(10),
+                           after  = widget(30);
+
+    SkBitmap incremental;
+    incremental.allocN32Pixels(kW, kH);
+    incremental.eraseColor(SK_ColorYELLOW);
+    SkCanvas canvas(incremental);
+    canvas.drawPicture(before);
+
+    const SkRegion damage = SkPictureDamage::Compute(before.get(), after.get());
+    canvas.save();
+    canvas.clipRegion(damage);
+    canvas.drawColor(SK_ColorYELLOW, SkBlendMode::kSrc);
+    canvas.restore();
+    SkPictureDamage::Playback(after.get(), damage, &canvas, /*clearDamage=*/false);
+
+    SkBitmap full;
+    full.allocN32Pixels(kW, kH);
+    full.eraseColor(SK_ColorYELLOW);
+    SkCanvas(full).drawPicture(after);
+    REPORTER_ASSERT(r, ToolUtils::equal_pixels(incremental, full));
+}
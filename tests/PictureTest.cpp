@@ -34,6 +34,7 @@
 #include "src/core/SkPicturePriv.h"
 #include "src/core/SkRectPriv.h"
 #include "tests/Test.h"
+#include "tools/ToolUtils.h"
 #include "tools/fonts/FontToolUtils.h"
 
 #include <cstddef>
@@ -793,6 +794,58 @@ DEF_TEST(Picture_empty_serial, reporter) {
     REPORTER_ASSERT(reporter, pic2);
 }
 
+DEF_TEST(Picture_lazy_serial, r) {
+    const SkRect cull = SkRect::MakeWH(64, 64);
+
+    SkPictureRecorder nestedRec;
+    nestedRec.beginRecording(cull)->drawCircle(32, 32, 20, SkPaint(SkColors::kBlue));
+    sk_sp<SkPicture> nested = nestedRec.finishRecordingAsPicture();
+
+    SkPictureRecorder rec;
+    SkCanvas* canvas = rec.beginRecording(cull);
+    canvas->drawColor(SK_ColorWHITE);
+    SkPath path = SkPath::Polygon({{4, 4}, {60, 10}, {30, 60}}, true);
+    SkPaint paint(SkColors::kRed);
+    paint.setAntiAlias(true);
+    canvas->drawPath(path, paint);
+    canvas->translate(8, 8);
+    canvas->drawPicture(nested);
+    sk_sp<SkPicture> pic = rec.finishRecordingAsPicture();
+    sk_sp<SkData> data = pic->serialize();
+
+    auto draw = [&](const SkPicture* p) {
+        SkBitmap bm;
+        bm.allocN32Pixels(64, 64);
+        bm.eraseColor(SK_ColorTRANSPARENT);
+        SkCanvas(bm).drawPicture(p);
+        return bm;
+    };
+
+    sk_sp<SkPicture> lazy = SkPicture::MakeLazyFromData(data);
+    REPORTER_ASSERT(r, lazy);
+    REPORTER_ASSERT(r, lazy->cullRect() == pic->cullRect());
+    REPORTER_ASSERT(r, lazy->approximateOpCount() > 0);
+    REPORTER_ASSERT(r, ToolUtils::equal_pixels(draw(lazy.get()), draw(pic.get())));
+    // Drawing it again reuses the parsed data.
+    REPORTER_ASSERT(r, ToolUtils::equal_pixels(draw(lazy.get()), draw(pic.get())));
+
+    // A lazy picture can be serialized again.
+    sk_sp<SkPicture> roundTrip = SkPicture::MakeFromData(lazy->serialize().get());
+    REPORTER_ASSERT(r, roundTrip);
+    REPORTER_ASSERT(r, ToolUtils::equal_pixels(draw(roundTrip.get()), draw(pic.get())));
+
+    // A bad header fails up front...
+    REPORTER_ASSERT(r, !SkPicture::MakeLazyFromData(nullptr));
+    REPORTER_ASSERT(r, !SkPicture::MakeLazyFromData(SkData::MakeWithCopy(data->data(), 16)));
+
+    // ... but a bad body is only noticed when the picture is drawn, which then draws nothing.
+    sk_sp<SkPicture> truncated =
+            SkPicture::MakeLazyFromData(SkData::MakeWithCopy(data->data(), data->size() / 2));
+    REPORTER_ASSERT(r, truncated);
+    SkBitmap bm = draw(truncated.get());
+    REPORTER_ASSERT(r, bm.getColor(32, 32) == SK_ColorTRANSPARENT);
+}
+
 
 DEF_TEST(Picture_drawsNothing, r) {
     // Tests that pic->cullRect().isEmpty() is a good way to test a picture
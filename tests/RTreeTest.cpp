@@ -54,11 +54,19 @@ static bool verify_query(SkRect query, SkRect rects[], const std::vector<int>& f
 
 static void run_queries(skiatest::Reporter* reporter, SkRandom& rand, SkRect rects[],
                         const SkRTree& tree) {
+    SkRect queries[NUM_QUERIES];
+    std::vector<int> hits[NUM_QUERIES];
     for (size_t i = 0; i < NUM_QUERIES; ++i) {
-        std::vector<int> hits;
-        SkRect query = random_rect(rand);
-        tree.search(query, &hits);
-        REPORTER_ASSERT(reporter, verify_query(query, rects, hits));
+        queries[i] = random_rect(rand);
+        tree.search(queries[i], &hits[i]);
+        REPORTER_ASSERT(reporter, verify_query(queries[i], rects, hits[i]));
+    }
+
+    // The batched search should find exactly the same ops, in the same order.
+    std::vector<int> batchHits[NUM_QUERIES];
+    tree.search(queries, (int)NUM_QUERIES, batchHits);
+    for (size_t i = 0; i < NUM_QUERIES; ++i) {
+        REPORTER_ASSERT(reporter, batchHits[i] == hits[i]);
     }
 }
 
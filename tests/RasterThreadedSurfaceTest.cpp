@@ -0,0 +1,190 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkPath.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkPictureRecorder.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkRRect.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkSurface.h"
+#include "src/core/SkCanvasPriv.h"
+#include "tests/Test.h"
+#include "tools/ToolUtils.h"
+
+#include <functional>
+#include <memory>
+
+static constexpr int kW = 700, kH = 530;  // Deliberately not a multiple of the tile size.
+
+static bool same_pixels(SkSurface* a, SkSurface* b) {
+    SkBitmap bmA, bmB;
+    bmA.allocPixels(a->imageInfo());
+    bmB.allocPixels(b->imageInfo());
+    return a->readPixels(bmA, 0, 0) &&
+           b->readPixels(bmB, 0, 0) &&
+           ToolUtils::equal_pixels(bmA, bmB);
+}
+
+static void draw_content(SkCanvas* canvas, const std::function<void()>& flush) {
+    SkPaint aa;
+    aa.setAntiAlias(true);
+
+    canvas->drawColor(SK_ColorWHITE);
+
+    canvas->save();                    // A save that's been performed...
+    canvas->translate(13.5f, 7.25f);
+    canvas->clipRRect(SkRRect::MakeOval(SkRect::MakeWH(600, 500)), true);
+    aa.setColor(SK_ColorBLUE);
+    canvas->drawCircle(300, 250, 260, aa);
+    flush();
+
+    canvas->save();                    // ... and one that's still deferred.
+    flush();
+
+    aa.setColor(0x8000FF00);
+    canvas->drawRect({-50, 100, 650, 140}, aa);
+    canvas->restore();
+    canvas->rotate(10);
+    SkPath path = SkPath::Polygon({{10, 10}, {500, 60}, {250, 400}}, true);
+    aa.setColor(0xC0FF0000);
+    canvas->drawPath(path, aa);
+    flush();
+
+    canvas->restore();
+    aa.setColor(SK_ColorBLACK);
+    aa.setStyle(SkPaint::kStroke_Style);
+    aa.setStrokeWidth(3);
+    canvas->drawLine(0, 0, kW, kH, aa);
+}
+
+// Draws the same content to a Raster() and a RasterThreaded() surface, calling 'flush' between
+// steps so that the threaded surface has to play back with canvas state still in effect.
+// Antialiasing depends slightly on the clip, so the Raster() surface plays the content back into
+// one tile of its pixels at a time, the way the threaded surface does.
+static void check_matches_raster(skiatest::Reporter* r,
+                                 SkExecutor* executor,
+                                 const std::function<void(SkSurface*)>& flush) {
+    static constexpr int kTileSize = 256;  // Matches SkSurface_RasterThreaded.
+
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(kW, kH);
+    sk_sp<SkSurface> expected = SkSurfaces::Raster(info);
+    sk_sp<SkSurface> actual   = SkSurfaces::RasterThreaded(info, executor);
+    REPORTER_ASSERT(r, expected && actual);
+
+    SkPictureRecorder recorder;
+    draw_content(recorder.beginRecording(SkRect::MakeWH(kW, kH)), [] {});
+    sk_sp<SkPicture> picture = recorder.finishRecordingAsPicture();
+    SkPixmap pixels;
+    REPORTER_ASSERT(r, expected->peekPixels(&pixels));
+    for (int y = 0; y < kH; y += kTileSize) {
+        for (int x = 0; x < kW; x += kTileSize) {
+            SkPixmap tilePixels;
+            pixels.extractSubset(&tilePixels, SkIRect::MakeXYWH(x, y, kTileSize, kTileSize));
+            std::unique_ptr<SkCanvas> tile = SkCanvas::MakeRasterDirect(tilePixels.info(),
+                                                                        tilePixels.writable_addr(),
+                                                                        tilePixels.rowBytes());
+            tile->translate(-x, -y);
+            tile->drawPicture(picture);
+        }
+    }
+
+    draw_content(actual->getCanvas(), [&] { flush(actual.get()); });
+    REPORTER_ASSERT(r, actual->getCanvas()->getSaveCount() == 1);
+    REPORTER_ASSERT(r, same_pixels(expected.get(), actual.get()));
+}
+
+DEF_TEST(RasterThreadedSurface_MatchesRaster, r) {
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+
+    check_matches_raster(r, executor.get(), [](SkSurface*) {});
+    check_matches_raster(r, executor.get(), [](SkSurface* surface) {
+        SkPixmap pm;
+        surface->peekPixels(&pm);
+    });
+    check_matches_raster(r, executor.get(), [](SkSurface* surface) {
+        surface->makeImageSnapshot();
+    });
+}
+
+// A recorded ResetClip must not let a tile draw outside itself, and a layer that is open when
+// the surface plays back its draws must not be composited until it is restored.
+DEF_TEST(RasterThreadedSurface_ResetClipAndLayers, r) {
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(kW, kH);
+    sk_sp<SkSurface> expected = SkSurfaces::Raster(info);
+    sk_sp<SkSurface> actual   = SkSurfaces::RasterThreaded(info, executor.get());
+    REPORTER_ASSERT(r, expected && actual);
+
+    for (SkSurface* surface : {expected.get(), actual.get()}) {
+        SkCanvas* canvas = surface->getCanvas();
+        canvas->drawColor(SK_ColorWHITE);
+        canvas->save();
+        canvas->clipRect({10, 10, 20, 20});
+        SkCanvasPriv::ResetClip(canvas);
+        canvas->drawRect({0, 0, kW, kH}, SkPaint(SkColor4f::FromColor(0x400000FF)));
+        canvas->restore();
+
+        canvas->saveLayerAlpha(nullptr, 0x80);
+        canvas->drawRect({100, 100, 500, 400}, SkPaint(SkColors::kRed));
+    }
+    REPORTER_ASSERT(r, same_pixels(expected.get(), actual.get()));
+
+    for (SkSurface* surface : {expected.get(), actual.get()}) {
+        SkCanvas* canvas = surface->getCanvas();
+        canvas->drawRect({300, 200, 650, 500}, SkPaint(SkColors::kGreen));
+        canvas->restore();
+    }
+    REPORTER_ASSERT(r, same_pixels(expected.get(), actual.get()));
+}
+
+DEF_TEST(RasterThreadedSurface_Snapshot, r) {
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(2);
+    sk_sp<SkSurface> surface =
+            SkSurfaces::RasterThreaded(SkImageInfo::MakeN32Premul(kW, kH), executor.get());
+    REPORTER_ASSERT(r, surface);
+
+    const uint32_t genID = surface->generationID();
+    surface->getCanvas()->drawColor(SK_ColorRED);
+    REPORTER_ASSERT(r, surface->generationID() != genID);
+
+    sk_sp<SkImage> red = surface->makeImageSnapshot();
+    REPORTER_ASSERT(r, red == surface->makeImageSnapshot());
+
+    // Recording a draw must invalidate the snapshot, even though nothing has been rasterized.
+    surface->getCanvas()->drawRect({0, 0, 10, 10}, SkPaint(SkColors::kBlue));
+    sk_sp<SkImage> blue = surface->makeImageSnapshot();
+    REPORTER_ASSERT(r, blue != red);
+
+    SkPixmap pm;
+    REPORTER_ASSERT(r, red->peekPixels(&pm));
+    REPORTER_ASSERT(r, *pm.addr32(5, 5) == SkPreMultiplyColor(SK_ColorRED));
+    REPORTER_ASSERT(r, blue->peekPixels(&pm));
+    REPORTER_ASSERT(r, *pm.addr32(5, 5) == SkPreMultiplyColor(SK_ColorBLUE));
+    REPORTER_ASSERT(r, *pm.addr32(kW - 1, kH - 1) == SkPreMultiplyColor(SK_ColorRED));
+}
+
+DEF_TEST(RasterThreadedSurface_NoExecutor, r) {
+    sk_sp<SkSurface> surface =
+            SkSurfaces::RasterThreaded(SkImageInfo::MakeN32Premul(kW, kH), nullptr);
+    REPORTER_ASSERT(r, surface);
+
+    // Without an executor, the surface draws directly into its pixels.
+    surface->getCanvas()->drawColor(SK_ColorGREEN);
+    SkBitmap bm;
+    bm.allocN32Pixels(1, 1);
+    REPORTER_ASSERT(r, surface->getCanvas()->readPixels(bm, kW / 2, kH / 2));
+    REPORTER_ASSERT(r, bm.getColor(0, 0) == SK_ColorGREEN);
+}
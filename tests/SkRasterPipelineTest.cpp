@@ -7,6 +7,7 @@
 
 #include "include/private/base/SkTo.h"
 #include "src/base/SkHalf.h"
+#include "src/base/SkRandom.h"
 #include "src/base/SkUtils.h"
 #include "src/core/SkOpts.h"
 #include "src/core/SkRasterPipeline.h"
@@ -15,7 +16,9 @@
 #include "src/sksl/tracing/SkSLTraceHook.h"
 #include "tests/Test.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <numeric>
 
 using namespace skia_private;
@@ -3269,6 +3272,72 @@ DEF_TEST(SkRasterPipeline_lowp, r) {
     }
 }
 
+DEF_TEST(SkRasterPipeline_highp_srcover_8888, r) {
+    // Highp pipelines that end by loading dst, blending with srcover and storing back to the same
+    // pixels (with the swaps around srcover for BGRA) fuse those stages into srcover_rgba_8888.
+    // That must not change any pixels, so compare against the same stages loading and storing
+    // different buffers. When more stages follow the store, nothing is fused, and those stages
+    // see the same registers either way. (Sourcing from load_f32 keeps these pipelines in highp.)
+    constexpr int N = 1027;
+    float src[N][4];
+    uint32_t dst[N];
+    SkRandom random;
+    for (int i = 0; i < N; i++) {
+        float a = random.nextF();
+        for (int c = 0; c < 3; c++) {
+            src[i][c] = random.nextRangeF(0, a);
+        }
+        src[i][3] = a;
+        dst[i] = random.nextU();
+    }
+
+    for (bool swapRB : {false, true})
+    for (bool moreStages : {false, true}) {
+        uint32_t fused[N], unfused[N];
+        float fusedDst[N][4], unfusedDst[N][4];
+        memcpy(fused, dst, sizeof(dst));
+        SkRasterPipeline_MemoryCtx srcCtx     = { src, 0 },
+                                   dstCtx     = { dst, 0 },
+                                   fusedCtx   = { fused, 0 },
+                                   unfusedCtx = { unfused, 0 },
+                                   fusedDstCtx   = { fusedDst, 0 },
+                                   unfusedDstCtx = { unfusedDst, 0 };
+
+        auto run = [&](SkRasterPipeline_MemoryCtx* loadCtx, SkRasterPipeline_MemoryCtx* storeCtx,
+                       SkRasterPipeline_MemoryCtx* storeDstCtx) {
+            SkRasterPipeline_<256> p;
+            p.append(SkRasterPipelineOp::load_f32, &srcCtx);
+            p.append(SkRasterPipelineOp::load_8888_dst, loadCtx);
+            if (swapRB) {
+                p.append(SkRasterPipelineOp::swap_rb_dst);
+            }
+            p.append(SkRasterPipelineOp::srcover);
+            if (swapRB) {
+                p.append(SkRasterPipelineOp::swap_rb);
+            }
+            p.append(SkRasterPipelineOp::store_8888, storeCtx);
+            if (moreStages) {
+                p.append(SkRasterPipelineOp::move_dst_src);
+                p.append(SkRasterPipelineOp::store_f32, storeDstCtx);
+            }
+            p.run(0,0,N,1);
+        };
+        run(&fusedCtx, &fusedCtx, &fusedDstCtx);
+        run(&dstCtx, &unfusedCtx, &unfusedDstCtx);
+
+        for (int i = 0; i < N; i++) {
+            if (fused[i] != unfused[i]) {
+                ERRORF(r, "swapRB=%d moreStages=%d, pixel %d: got %08x, want %08x\n",
+                       swapRB, moreStages, i, fused[i], unfused[i]);
+            }
+        }
+        if (moreStages) {
+            REPORTER_ASSERT(r, 0 == memcmp(fusedDst, unfusedDst, sizeof(fusedDst)),
+                            "swapRB=%d", swapRB);
+        }
+    }
+}
+
 DEF_TEST(SkRasterPipeline_swizzle, r) {
     // This takes the lowp code path
     {
@@ -5,6 +5,7 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFont.h"
 #include "include/core/SkFontStyle.h"
 #include "include/core/SkMatrix.h"
@@ -16,10 +17,14 @@
 #include "src/core/SkStrike.h"  // IWYU pragma: keep
 #include "src/core/SkStrikeCache.h"
 #include "src/core/SkStrikeSpec.h"
+#include "src/core/SkTaskGroup.h"
 #include "tests/Test.h"
 #include "tools/ToolUtils.h"
 #include "tools/fonts/FontToolUtils.h"
 
+#include <memory>
+#include <vector>
+
 DEF_TEST(SkStrikeCache_CachePurge, Reporter) {
     SkStrikeCache cache;
 
@@ -61,3 +66,63 @@ DEF_TEST(SkStrikeCache_CachePurge, Reporter) {
 
 
 }
+
+static std::vector<SkStrikeSpec> make_strike_specs(int count) {
+    SkFont font;
+    font.setEdging(SkFont::Edging::kAntiAlias);
+    font.setTypeface(ToolUtils::CreatePortableTypeface("serif", SkFontStyle::Italic()));
+
+    std::vector<SkStrikeSpec> specs;
+    for (int i = 0; i < count; ++i) {
+        font.setSize(8 + i);
+        specs.push_back(SkStrikeSpec::MakeMask(
+                font, SkPaint(), SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                SkScalerContextFlags::kNone, SkMatrix::I()));
+    }
+    return specs;
+}
+
+// The cache is split into shards by descriptor, but should still purge the least recently used
+// strikes first.
+DEF_TEST(SkStrikeCache_LRUAcrossShards, Reporter) {
+    SkStrikeCache cache;
+    const std::vector<SkStrikeSpec> specs = make_strike_specs(40);
+
+    for (const SkStrikeSpec& spec : specs) {
+        cache.findOrCreateStrike(spec);
+    }
+    // Touch the second half, so the first half is now the least recently used.
+    for (size_t i = specs.size() / 2; i < specs.size(); ++i) {
+        REPORTER_ASSERT(Reporter, cache.findStrike(specs[i].descriptor()));
+    }
+
+    // Purging down to 20 strikes (at least a quarter, since there are no small purges) must only
+    // remove strikes from the first half.
+    cache.setCacheCountLimit(20);
+    REPORTER_ASSERT(Reporter, cache.getCacheCountUsed() <= 20);
+    for (size_t i = specs.size() / 2; i < specs.size(); ++i) {
+        REPORTER_ASSERT(Reporter, cache.findStrike(specs[i].descriptor()), "strike %zu", i);
+    }
+}
+
+DEF_TEST(SkStrikeCache_Threaded, Reporter) {
+    SkStrikeCache cache;
+    cache.setCacheCountLimit(16);
+    const std::vector<SkStrikeSpec> specs = make_strike_specs(48);
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+
+    SkTaskGroup tg(*executor);
+    tg.batch(8, [&](int thread) {
+        for (int i = 0; i < 200; ++i) {
+            const SkStrikeSpec& spec = specs[(i * 5 + thread) % specs.size()];
+            sk_sp<SkStrike> strike = cache.findOrCreateStrike(spec);
+            REPORTER_ASSERT(Reporter, strike && strike->getDescriptor() == spec.descriptor());
+        }
+    });
+    tg.wait();
+
+    REPORTER_ASSERT(Reporter, cache.getCacheCountUsed() <= 16);
+    cache.purgeAll();
+    REPORTER_ASSERT(Reporter, cache.getCacheCountUsed() == 0);
+    REPORTER_ASSERT(Reporter, cache.getTotalMemoryUsed() == 0);
+}
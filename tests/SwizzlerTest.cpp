@@ -10,12 +10,18 @@
 #include "include/core/SkColorType.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkSwizzle.h"
+#include "src/base/SkRandom.h"
+#include "src/codec/SkCodecPriv.h"
+#include "src/codec/SkMaskSwizzler.h"
 #include "src/codec/SkSampler.h"
+#include "src/core/SkMasks.h"
 #include "src/core/SkSwizzlePriv.h"
 #include "tests/Test.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
+#include <iterator>
 #include <memory>
 
 static void check_fill(skiatest::Reporter* r,
@@ -184,6 +190,128 @@ static void test_reciprocal_alpha(
 #define SK_OPTS_TARGET SK_OPTS_TARGET_DEFAULT
 #include "src/opts/SkOpts_SetTarget.h"
 #include "src/opts/SkSwizzler_opts.inc"
+
+// Whichever SkOpts procs this CPU picked should match the portable code exactly, including
+// for the tails that vectorized code handles separately, and never write past the end of dst.
+template <typename Src>
+static void check_matches_portable(skiatest::Reporter* r, const char* name,
+                                   void (*fn)(uint32_t*, const Src*, int),
+                                   void (*portable)(uint32_t*, const Src*, int),
+                                   const void* src, int count) {
+    constexpr uint32_t kGuard = 0xDEADBEEF;
+    uint32_t actual[128], expected[128];
+    SkASSERT(count < (int)std::size(actual));
+    std::fill(std::begin(actual), std::end(actual), kGuard);
+    std::fill(std::begin(expected), std::end(expected), kGuard);
+
+    fn(actual, (const Src*)src, count);
+    portable(expected, (const Src*)src, count);
+    if (0 != memcmp(actual, expected, sizeof(actual))) {
+        ERRORF(r, "%s does not match portable code for count %d", name, count);
+    }
+}
+
+DEF_TEST(SwizzleOptsMatchPortable, r) {
+    constexpr int kMaxCount = 67;
+
+    SkRandom rand;
+    // Enough for kMaxCount 16-bit RGBA pixels.
+    uint32_t src[kMaxCount * 2];
+    for (uint32_t& px : src) {
+        px = rand.nextU();
+    }
+    // Let some pixels be transparent and some opaque, so premul has its edge cases covered.
+    src[3] &= 0x00ffffff;
+    src[5] |= 0xff000000;
+
+    for (int count = 0; count <= kMaxCount; count++) {
+#define CHECK(fn) check_matches_portable(r, #fn, SkOpts::fn, test::fn##_portable, src, count)
+        CHECK(RGBA_to_rgbA);
+        CHECK(RGBA_to_bgrA);
+        CHECK(RGBA_to_BGRA);
+        CHECK(rgbA_to_RGBA);
+        CHECK(rgbA_to_BGRA);
+        CHECK(inverted_CMYK_to_RGB1);
+        CHECK(inverted_CMYK_to_BGR1);
+        CHECK(gray_to_RGB1);
+        CHECK(grayA_to_RGBA);
+        CHECK(grayA_to_rgbA);
+        CHECK(RGB16_to_RGB1);
+        CHECK(RGB16_to_BGR1);
+        CHECK(RGBA16_to_RGBA);
+        CHECK(RGBA16_to_BGRA);
+#undef CHECK
+
+        uint32_t table[256];
+        for (uint32_t& px : table) {
+            px = rand.nextU();
+        }
+        uint32_t actual[kMaxCount + 1], expected[kMaxCount + 1];
+        actual[count] = expected[count] = 0xDEADBEEF;
+        SkOpts::index_to_8888(actual, (const uint8_t*)src, count, table);
+        test::index_to_8888_portable(expected, (const uint8_t*)src, count, table);
+        REPORTER_ASSERT(r, 0 == memcmp(actual, expected, (count + 1) * sizeof(uint32_t)),
+                        "index_to_8888 does not match portable code for count %d", count);
+    }
+}
+
+DEF_TEST(MaskSwizzler, r) {
+    struct {
+        SkMasks::InputMasks fMasks;
+        int                 fBitsPerPixel;
+    } kFormats[] = {
+        {{0x7C00, 0x03E0, 0x001F, 0x0000}, 16},          // 555, the default for 16-bit BMPs
+        {{0xF800, 0x07E0, 0x001F, 0x0000}, 16},          // 565
+        {{0x0F00, 0x00F0, 0x000F, 0xF000}, 16},          // 4444
+        {{0x7C00, 0x03E0, 0x001F, 0x8000}, 16},          // 1555
+        {{0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000}, 32},
+        {{0x3FF00000, 0x000FFC00, 0x000003FF, 0xC0000000}, 32},  // 10-bit components
+        {{0x0000FF00, 0x00FF0000, 0xFF000000, 0x00000000}, 32},
+    };
+
+    // Every 16-bit value, plus a few so the width isn't a multiple of 8 pixels.
+    constexpr int kWidth = 65536 + 5;
+    std::unique_ptr<uint16_t[]> src16(new uint16_t[kWidth]);
+    std::unique_ptr<uint32_t[]> src32(new uint32_t[kWidth]);
+    SkRandom rand;
+    for (int i = 0; i < kWidth; i++) {
+        src16[i] = (uint16_t)i;
+        src32[i] = rand.nextU();
+    }
+    std::unique_ptr<uint32_t[]> actual(new uint32_t[kWidth]);
+    std::unique_ptr<uint32_t[]> expected(new uint32_t[kWidth]);
+
+    for (const auto& format : kFormats) {
+        std::unique_ptr<SkMasks> masks(SkMasks::CreateMasks(format.fMasks,
+                                                            format.fBitsPerPixel / 8));
+        REPORTER_ASSERT(r, masks);
+        for (SkColorType ct : {kRGBA_8888_SkColorType, kBGRA_8888_SkColorType}) {
+            for (SkAlphaType at : {kOpaque_SkAlphaType, kUnpremul_SkAlphaType,
+                                   kPremul_SkAlphaType}) {
+                const SkImageInfo info = SkImageInfo::Make(kWidth, 1, ct, at);
+                const bool opaque = at == kOpaque_SkAlphaType;
+                std::unique_ptr<SkMaskSwizzler> swizzler(SkMaskSwizzler::CreateMaskSwizzler(
+                        info, opaque, masks.get(), format.fBitsPerPixel, SkCodec::Options()));
+                const uint8_t* src = format.fBitsPerPixel == 16 ? (const uint8_t*)src16.get()
+                                                                : (const uint8_t*)src32.get();
+                swizzler->swizzle(actual.get(), src);
+
+                const PackColorProc pack =
+                        choose_pack_color_proc(at == kPremul_SkAlphaType, ct);
+                for (int i = 0; i < kWidth; i++) {
+                    const uint32_t p = format.fBitsPerPixel == 16 ? src16[i] : src32[i];
+                    expected[i] = pack(opaque ? 0xFF : masks->getAlpha(p), masks->getRed(p),
+                                       masks->getGreen(p), masks->getBlue(p));
+                }
+                REPORTER_ASSERT(r, 0 == memcmp(actual.get(), expected.get(),
+                                               kWidth * sizeof(uint32_t)),
+                                "%d bpp, color type %d, alpha type %d",
+                                format.fBitsPerPixel, ct, at);
+            }
+        }
+    }
+}
+
 DEF_TEST(ReciprocalAlphaOptimized, reporter) {
     test_reciprocal_alpha(reporter,
                           SK_OPTS_NS::reciprocal_alpha_times_255,
@@ -9,6 +9,7 @@
 #include "include/codec/SkEncodedOrigin.h"
 #include "include/core/SkColorType.h"
 #include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkPixmap.h"
 #include "include/core/SkScalar.h"
@@ -187,6 +188,7 @@ DEF_TEST(Jpeg_YUV_Encode, r) {
             "images/cropped_mandrill.jpg",
             "images/randPixels.jpg",
     };
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(2);
     for (const auto* path : paths) {
         SkYUVAPixmaps decoded;
         {
@@ -201,6 +203,13 @@ DEF_TEST(Jpeg_YUV_Encode, r) {
             REPORTER_ASSERT(r, SkJpegEncoder::Encode(&encodeStream, decoded, nullptr, options));
             auto encodedData = encodeStream.detachAsData();
             roundtrip = decode_yuva(r, SkMemoryStream::Make(encodedData));
+
+            // The executor is ignored for planes, so it can't change the output.
+            options.fExecutor = executor.get();
+            SkDynamicMemoryWStream parallelStream;
+            REPORTER_ASSERT(r, SkJpegEncoder::Encode(&parallelStream, decoded, nullptr, options));
+            REPORTER_ASSERT(r, encodedData->equals(parallelStream.detachAsData().get()), "%s",
+                            path);
         }
 
         verify_same(r, decoded, roundtrip);
@@ -22,6 +22,7 @@ CORE_TESTS = [
     "BitmapGetColorTest.cpp",
     "BitmapTest.cpp",
     "BlitMaskClip.cpp",
+    "BlitRowTest.cpp",
     "CachedDecodingPixelRefTest.cpp",
     "CanvasTest.cpp",
     "ChecksumTest.cpp",
@@ -88,6 +89,7 @@ CORE_TESTS = [
     "PathCoverageTest.cpp",
     "PathMeasureTest.cpp",
     "PictureBBHTest.cpp",
+    "PictureDamageTest.cpp",
     "PictureShaderTest.cpp",
     "PixelRefTest.cpp",
     "Point3Test.cpp",
@@ -97,6 +99,7 @@ CORE_TESTS = [
     "RRectInPathTest.cpp",
     "RTreeTest.cpp",
     "RandomTest.cpp",
+    "RasterThreadedSurfaceTest.cpp",
     "ReadPixelsTest.cpp",
     "RecorderTest.cpp",
     "RecordingXfermodeTest.cpp",